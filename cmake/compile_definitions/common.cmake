@@ -112,12 +112,25 @@ set(SUNSHINE_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/rtsp.h"
         "${CMAKE_SOURCE_DIR}/src/stream.cpp"
         "${CMAKE_SOURCE_DIR}/src/stream_protocol.cpp"
+        "${CMAKE_SOURCE_DIR}/src/abr_controller.cpp"
+        "${CMAKE_SOURCE_DIR}/src/abr_controller.h"
+        "${CMAKE_SOURCE_DIR}/src/fec_controller.cpp"
+        "${CMAKE_SOURCE_DIR}/src/fec_controller.h"
+        "${CMAKE_SOURCE_DIR}/src/ping_table.h"
+        "${CMAKE_SOURCE_DIR}/src/video_pacing.cpp"
+        "${CMAKE_SOURCE_DIR}/src/video_pacing.h"
+        "${CMAKE_SOURCE_DIR}/src/video_packetizer.cpp"
+        "${CMAKE_SOURCE_DIR}/src/video_packetizer.h"
         "${CMAKE_SOURCE_DIR}/src/stream.h"
         "${CMAKE_SOURCE_DIR}/src/video.cpp"
         "${CMAKE_SOURCE_DIR}/src/video_policy.cpp"
         "${CMAKE_SOURCE_DIR}/src/video.h"
         "${CMAKE_SOURCE_DIR}/src/video_colorspace.cpp"
         "${CMAKE_SOURCE_DIR}/src/video_colorspace.h"
+        "${CMAKE_SOURCE_DIR}/src/video_change.cpp"
+        "${CMAKE_SOURCE_DIR}/src/video_change.h"
+        "${CMAKE_SOURCE_DIR}/src/video_convert.cpp"
+        "${CMAKE_SOURCE_DIR}/src/video_convert.h"
         "${CMAKE_SOURCE_DIR}/src/input.cpp"
         "${CMAKE_SOURCE_DIR}/src/input.h"
         "${CMAKE_SOURCE_DIR}/src/input_validation_policy.cpp"
@@ -126,8 +139,13 @@ set(SUNSHINE_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/mouse_input.h"
         "${CMAKE_SOURCE_DIR}/src/audio.cpp"
         "${CMAKE_SOURCE_DIR}/src/audio.h"
+        "${CMAKE_SOURCE_DIR}/src/audio_encoder.cpp"
+        "${CMAKE_SOURCE_DIR}/src/audio_encoder.h"
         "${CMAKE_SOURCE_DIR}/src/audio_policy.cpp"
         "${CMAKE_SOURCE_DIR}/src/audio_policy.h"
+        "${CMAKE_SOURCE_DIR}/src/audio_pool.h"
+        "${CMAKE_SOURCE_DIR}/src/audio_silence.cpp"
+        "${CMAKE_SOURCE_DIR}/src/audio_silence.h"
         "${CMAKE_SOURCE_DIR}/src/platform/common.h"
         "${CMAKE_SOURCE_DIR}/src/platform/common_services.cpp"
         "${CMAKE_SOURCE_DIR}/src/platform/common_services.h"
@@ -150,12 +168,15 @@ set(SUNSHINE_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/task_pool.h"
         "${CMAKE_SOURCE_DIR}/src/thread_pool.h"
         "${CMAKE_SOURCE_DIR}/src/thread_safe.h"
+        "${CMAKE_SOURCE_DIR}/src/timer_wheel.h"
         "${CMAKE_SOURCE_DIR}/src/sync.h"
         "${CMAKE_SOURCE_DIR}/src/round_robin.h"
         "${CMAKE_SOURCE_DIR}/src/stat_trackers.h"
         "${CMAKE_SOURCE_DIR}/src/stat_trackers.cpp"
         "${CMAKE_SOURCE_DIR}/src/rswrapper.h"
         "${CMAKE_SOURCE_DIR}/src/rswrapper.c"
+        "${CMAKE_SOURCE_DIR}/src/rs_cache.cpp"
+        "${CMAKE_SOURCE_DIR}/src/rs_cache.h"
         "${CMAKE_SOURCE_DIR}/src/http_auth.cpp"
         "${CMAKE_SOURCE_DIR}/src/http_auth_request_policy.cpp"
         "${CMAKE_SOURCE_DIR}/src/state_storage.cpp"
@@ -179,6 +200,7 @@ set(SUNSHINE_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/host_stats_service.cpp"
         "${CMAKE_SOURCE_DIR}/src/host_stats_service.h"
         "${CMAKE_SOURCE_DIR}/src/host_stats_types.h"
+        "${CMAKE_SOURCE_DIR}/src/timer_stats_types.h"
         ${PLATFORM_TARGET_FILES})
 
 if(NOT SUNSHINE_ASSETS_DIR_DEF)
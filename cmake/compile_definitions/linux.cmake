@@ -362,7 +362,20 @@ list(APPEND PLATFORM_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/platform/linux/graphics.cpp"
         "${CMAKE_SOURCE_DIR}/src/platform/linux/misc.h"
         "${CMAKE_SOURCE_DIR}/src/platform/linux/misc.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/hybrid_timer.h"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/hybrid_timer.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/recv_batch.h"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/recv_batch.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/send_batch.h"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/send_batch.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/txtime.h"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/txtime.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/uring_send.h"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/uring_send.cpp"
         "${CMAKE_SOURCE_DIR}/src/platform/linux/host_stats.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/synthetic.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/synthetic_frames.h"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/synthetic_frames.cpp"
         "${CMAKE_SOURCE_DIR}/src/platform/linux/audio.cpp"
         "${CMAKE_SOURCE_DIR}/third-party/glad/src/egl.c"
         "${CMAKE_SOURCE_DIR}/third-party/glad/src/gl.c"
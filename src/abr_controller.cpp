@@ -0,0 +1,197 @@
+/**
+ * @file src/abr_controller.cpp
+ * @brief Per-session encoder bitrate driven by network and pacing signals.
+ */
+#include "abr_controller.h"
+
+#include <algorithm>
+
+using namespace std::literals;
+
+namespace stream {
+  namespace {
+    constexpr auto WINDOW = 500ms;
+
+    // Loss rates, in percent of packets sent, that mark a window congested or clean
+    constexpr double CONGESTED_LOSS_PERCENT = 2.0;
+    constexpr double HEAVY_LOSS_PERCENT = 10.0;
+    constexpr double CLEAN_LOSS_PERCENT = 0.5;
+
+    // Multiplicative decrease, harder when loss is heavy
+    constexpr double DECREASE = 0.85;
+    constexpr double HEAVY_DECREASE = 0.7;
+    constexpr auto DECREASE_COOLDOWN = 1s;  // lets the encoder settle at the new rate
+
+    // Additive increase as a fraction of the ceiling, reduced near the last congested bitrate
+    constexpr double INCREASE_STEP = 0.05;
+    constexpr double CAUTIOUS_DIVISOR = 4.0;
+    constexpr double CAUTIOUS_MARGIN = 0.9;
+    constexpr auto INCREASE_INTERVAL = 1s;
+
+    // Share of the bitrate the encoder must produce for a clean window to justify more
+    constexpr double MIN_UTILIZATION = 0.6;
+
+    // Clean time before increasing, doubled when an increase is quickly followed by congestion
+    constexpr auto BASE_HOLD = 3s;
+    constexpr auto MAX_HOLD = 32s;
+    constexpr auto OSCILLATION_WINDOW = 10s;
+
+    // Frame intervals after a key frame during which queueing delays are expected: it may be
+    // spread over up to 3 intervals, and the frames behind it take a few more to catch up
+    constexpr int KEY_FRAME_GRACE_FRAMES = 8;
+
+    // Without congestion for this long, the hold and the last congested bitrate are forgotten
+    constexpr auto FORGET_CONGESTION = 60s;
+  }  // namespace
+
+  abr_controller_t::abr_controller_t(int ceiling_kbps, int floor_kbps, int fps):
+      ceiling_ {std::max(ceiling_kbps, 1)},
+      floor_ {std::clamp(floor_kbps, 1, ceiling_)},
+      frame_interval_ {std::chrono::microseconds {1s} / std::max(fps, 1)},
+      bitrate_ {ceiling_},
+      hold_ {BASE_HOLD} {
+  }
+
+  std::optional<int> abr_controller_t::update(const abr_sample_t &sample) {
+    std::optional<int> changed;
+
+    if (auto ceiling = pending_ceiling_.exchange(0, std::memory_order_relaxed); ceiling > 0) {
+      ceiling_ = ceiling;
+      floor_ = std::min(floor_, ceiling_);
+      bitrate_ = ceiling_;
+      clean_ = 0ms;
+      congested_kbps_ = 0;
+      hold_ = BASE_HOLD;
+    }
+
+    const auto elapsed = std::max(sample.elapsed, 0ms);
+    now_ += elapsed;
+
+    if (previous_) {
+      window_elapsed_ += elapsed;
+      window_lost_ += std::max<std::int64_t>(sample.lost_packets - previous_->lost_packets, 0);
+      window_sent_ += sample.packets_sent >= previous_->packets_sent ? sample.packets_sent - previous_->packets_sent : 0;
+      window_bytes_ += sample.encoded_bytes >= previous_->encoded_bytes ? sample.encoded_bytes - previous_->encoded_bytes : 0;
+      window_recoveries_ += sample.recovery_requests >= previous_->recovery_requests ? sample.recovery_requests - previous_->recovery_requests : 0;
+      if (sample.key_frames > previous_->key_frames) {
+        last_key_frame_ = now_;
+      }
+
+      const auto key_frame_grace = last_key_frame_ && now_ - *last_key_frame_ < frame_interval_ * KEY_FRAME_GRACE_FRAMES;
+      if (sample.queue_latency && sample.pacer_delay && !key_frame_grace) {
+        window_queue_latency_ += *sample.queue_latency;
+        window_pacer_delay_ += *sample.pacer_delay;
+        ++window_delay_samples_;
+      }
+    }
+    previous_ = sample;
+
+    if (window_elapsed_ < WINDOW) {
+      return changed;
+    }
+
+    // Parity packets can be lost too, so the loss rate covers every packet sent
+    const auto total = window_sent_ + window_lost_;
+    const auto loss_percent = total > 0 ? 100.0 * (double) window_lost_ / (double) total : 0.0;
+    const auto verdict = judge(loss_percent);
+    const auto window = window_elapsed_;
+    const auto utilization = (double) window_bytes_ * 8 / std::chrono::duration<double>(window).count() / 1000 / bitrate_;
+
+    window_elapsed_ = 0ms;
+    window_lost_ = 0;
+    window_sent_ = 0;
+    window_bytes_ = 0;
+    window_recoveries_ = 0;
+    window_queue_latency_ = 0us;
+    window_pacer_delay_ = 0us;
+    window_delay_samples_ = 0;
+
+    if (last_congestion_ && now_ - *last_congestion_ >= FORGET_CONGESTION) {
+      last_congestion_.reset();
+      congested_kbps_ = 0;
+      hold_ = BASE_HOLD;
+    }
+
+    if (verdict == window_e::congested) {
+      clean_ = 0ms;
+
+      // An increase that congests soon after means the ceiling is lower than it looked
+      if (last_increase_ && now_ - *last_increase_ < OSCILLATION_WINDOW) {
+        hold_ = std::min(hold_ * 2, std::chrono::duration_cast<std::chrono::milliseconds>(MAX_HOLD));
+        last_increase_.reset();
+      }
+      last_congestion_ = now_;
+
+      if (last_decrease_ && now_ - *last_decrease_ < DECREASE_COOLDOWN) {
+        return changed;
+      }
+
+      congested_kbps_ = bitrate_;
+      auto bitrate = std::max(floor_, (int) (bitrate_ * (loss_percent >= HEAVY_LOSS_PERCENT ? HEAVY_DECREASE : DECREASE)));
+      if (bitrate != bitrate_) {
+        bitrate_ = bitrate;
+        last_decrease_ = now_;
+        changed = bitrate_;
+      }
+      return changed;
+    }
+
+    if (verdict == window_e::uncertain) {
+      clean_ = 0ms;
+      return changed;
+    }
+
+    clean_ += window;
+    if (clean_ < hold_ || bitrate_ >= ceiling_ || utilization < MIN_UTILIZATION) {
+      return changed;
+    }
+
+    auto since_change = std::min(
+      last_increase_ ? now_ - *last_increase_ : now_,
+      last_decrease_ ? now_ - *last_decrease_ : now_
+    );
+    if (since_change < INCREASE_INTERVAL) {
+      return changed;
+    }
+
+    auto step = ceiling_ * INCREASE_STEP;
+    if (congested_kbps_ > 0 && bitrate_ + step > congested_kbps_ * CAUTIOUS_MARGIN) {
+      step /= CAUTIOUS_DIVISOR;
+    }
+    bitrate_ = std::min(ceiling_, bitrate_ + std::max((int) step, 1));
+    last_increase_ = now_;
+    changed = bitrate_;
+    return changed;
+  }
+
+  void abr_controller_t::set_ceiling(int kbps) {
+    pending_ceiling_.store(std::max(kbps, 1), std::memory_order_relaxed);
+  }
+
+  int abr_controller_t::bitrate() const {
+    return bitrate_;
+  }
+
+  abr_controller_t::window_e abr_controller_t::judge(double loss_percent) const {
+    const auto samples = std::max(window_delay_samples_, 1);
+    const auto queue_latency = window_queue_latency_ / samples;
+    const auto pacer_delay = window_pacer_delay_ / samples;
+
+    // Frames waiting on the pacer or the broadcast loop mean the link can't carry the bitrate
+    if (loss_percent >= CONGESTED_LOSS_PERCENT ||
+        window_recoveries_ >= 2 ||
+        pacer_delay > frame_interval_ / 2 ||
+        queue_latency > frame_interval_) {
+      return window_e::congested;
+    }
+
+    if (loss_percent < CLEAN_LOSS_PERCENT &&
+        window_recoveries_ == 0 &&
+        pacer_delay <= frame_interval_ / 4 &&
+        queue_latency <= frame_interval_ / 2) {
+      return window_e::clean;
+    }
+
+    return window_e::uncertain;
+  }
+}  // namespace stream
@@ -0,0 +1,109 @@
+/**
+ * @file src/abr_controller.h
+ * @brief Per-session encoder bitrate driven by network and pacing signals.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace stream {
+  /**
+   * @brief Signals the host has about a session at one point in time.
+   * @details Counters are running totals; the controller works with their differences.
+   */
+  struct abr_sample_t {
+    std::chrono::milliseconds elapsed;  // time since the previous sample
+    std::int64_t lost_packets;  // packets the client reported lost
+    std::uint64_t packets_sent;  // video packets sent, including parity
+    std::uint64_t encoded_bytes;  // encoded video bytes handed to the network
+    std::uint32_t recovery_requests;  // IDR requests and reference frame invalidations
+    std::uint64_t key_frames;  // key frames sent
+
+    // Only known when the session has a broadcast loop of its own. In a shared loop they include
+    // time spent sending other sessions' frames.
+    std::optional<std::chrono::microseconds> queue_latency;  // last frame's wait between encoder and broadcast loop
+    std::optional<std::chrono::microseconds> pacer_delay;  // last frame's wait for the previous frame to be paced out
+  };
+
+  /**
+   * @brief Chooses a session's encoder bitrate from the signals in abr_sample_t.
+   * @details Samples are judged in half-second windows. A congested window (client loss,
+   *          recovery requests, or frames backing up behind the pacer or the broadcast loop)
+   *          cuts the bitrate at once. Clean windows where the encoder fills its budget add
+   *          small steps back towards the ceiling after a hold period. Steps shrink close to
+   *          the bitrate that last congested, and the hold doubles when an increase is quickly
+   *          followed by congestion, so the bitrate settles instead of oscillating.
+   *
+   *          A key frame holds up the frames after it by design, so queueing delays are not
+   *          judged for a few frame intervals after one is sent.
+   *          update() is called from a single thread; set_ceiling() may be called from any.
+   */
+  class abr_controller_t {
+  public:
+    /**
+     * @param ceiling_kbps Bitrate the session negotiated, which is never exceeded.
+     * @param floor_kbps Lowest bitrate the controller may choose.
+     * @param fps Frame rate of the stream, used to judge queueing delays.
+     */
+    abr_controller_t(int ceiling_kbps, int floor_kbps, int fps);
+
+    /**
+     * @brief Feed a sample.
+     * @return The new bitrate in kbps when it should change.
+     */
+    std::optional<int> update(const abr_sample_t &sample);
+
+    /**
+     * @brief Replace the ceiling after the client requested a new bitrate.
+     * @details The controller restarts from the new ceiling on the next update().
+     */
+    void set_ceiling(int kbps);
+
+    /**
+     * @brief The bitrate most recently chosen, in kbps.
+     */
+    int bitrate() const;
+
+  private:
+    enum class window_e {
+      clean,
+      uncertain,
+      congested,
+    };
+
+    window_e judge(double loss_percent) const;
+
+    int ceiling_;
+    int floor_;
+    std::chrono::microseconds frame_interval_;
+
+    int bitrate_;
+    std::atomic<int> pending_ceiling_ {0};
+
+    // Totals at the previous sample
+    std::optional<abr_sample_t> previous_;
+
+    // Current window
+    std::chrono::milliseconds window_elapsed_ {0};
+    std::int64_t window_lost_ = 0;
+    std::uint64_t window_sent_ = 0;
+    std::uint64_t window_bytes_ = 0;
+    std::uint32_t window_recoveries_ = 0;
+    std::chrono::microseconds window_queue_latency_ {0};
+    std::chrono::microseconds window_pacer_delay_ {0};
+    int window_delay_samples_ = 0;  // samples whose queueing delays count
+
+    // Time keeping across windows
+    std::chrono::milliseconds now_ {0};
+    std::chrono::milliseconds clean_ {0};  // consecutive clean time
+    std::chrono::milliseconds hold_;  // clean time needed before increasing
+    std::optional<std::chrono::milliseconds> last_decrease_;
+    std::optional<std::chrono::milliseconds> last_increase_;
+    std::optional<std::chrono::milliseconds> last_congestion_;
+    std::optional<std::chrono::milliseconds> last_key_frame_;
+    int congested_kbps_ = 0;  // bitrate at the last congestion, 0 once forgotten
+  };
+}  // namespace stream
@@ -10,7 +10,9 @@
 
 // local includes
 #include "audio.h"
+#include "audio_encoder.h"
 #include "audio_policy.h"
+#include "audio_silence.h"
 #include "config.h"
 #include "globals.h"
 #include "logging.h"
@@ -22,7 +24,15 @@
 namespace audio {
   using namespace std::literals;
   using opus_t = util::safe_ptr<OpusMSEncoder, opus_multistream_encoder_destroy>;
-  using sample_queue_t = std::shared_ptr<safe::queue_t<std::vector<float>>>;
+  using sample_pool_t = buffer_pool_t<std::vector<float>>;
+
+  // A captured frame and when its first sample was captured
+  struct sample_t {
+    sample_pool_t::handle_t buffer;
+    std::chrono::steady_clock::time_point captured;
+  };
+
+  using sample_queue_t = std::shared_ptr<spsc_ring_t<sample_t>>;
 
   static int start_audio_control(audio_ctx_t &ctx);
   static void stop_audio_control(audio_ctx_t &);
@@ -32,6 +42,20 @@ namespace audio {
 
   constexpr auto SAMPLE_RATE = 48000;
 
+  constexpr std::size_t MAX_PACKET_SIZE = 1400;
+
+  // Frames waiting for the encoder before new ones are dropped
+  constexpr std::size_t SAMPLE_QUEUE_SIZE = 30;
+
+  // Encoded packets waiting for the broadcast before the oldest are dropped
+  constexpr std::uint32_t PACKET_QUEUE_SIZE = 32;
+
+  // Encoded packets that can wait in the broadcast queues before the pool spills to the heap
+  constexpr std::size_t PACKET_POOL_SIZE = 64;
+
+  // Silence that must pass before comfort packets replace encoding, so pauses in speech or music never clip
+  constexpr auto SILENCE_HANGOVER = 200ms;
+
   // NOTE: If you adjust the bitrates listed here, make sure to update the
   // corresponding bitrate adjustment logic in rtsp_stream::cmd_announce()
   opus_stream_config_t stream_configs[MAX_STREAM_CONFIG] {
@@ -85,8 +109,14 @@ namespace audio {
     },
   };
 
-  void encodeThread(sample_queue_t samples, config_t config, void *channel_data) {
-    auto packets = mail::man->queue<packet_t>(mail::audio_packets);
+  packet_queue_t packet_queue(safe::mail_raw_t &mail) {
+    constexpr safe::channel_t<safe::ring_queue_t<packet_t>> audio_packets {(std::size_t) mail::id_e::audio_packets, "audio_packets"};
+
+    return mail.ring(audio_packets, PACKET_QUEUE_SIZE, safe::drop_e::oldest);
+  }
+
+  void encodeThread(sample_queue_t samples, config_t config, void *channel_data, stats_t *stats) {
+    auto packets = packet_queue(*mail::man);
     auto stream = stream_configs[map_stream(config.channels, config.flags[config_t::HIGH_QUALITY])];
     if (config.flags[config_t::CUSTOM_SURROUND_PARAMS]) {
       apply_surround_params(stream, config.customStreamParams);
@@ -96,32 +126,147 @@ namespace audio {
     platf::set_thread_name("audio::encode");
     platf::adjust_thread_priority(platf::thread_priority_e::high);
 
-    opus_t opus {opus_multistream_encoder_create(
-      stream.sampleRate,
-      stream.channelCount,
-      stream.streams,
-      stream.coupledStreams,
-      stream.mapping,
-      OPUS_APPLICATION_RESTRICTED_LOWDELAY,
-      nullptr
-    )};
+    auto frame_size = config.packetDuration * stream.sampleRate / 1000;
+
+    // Surround streams can be split across threads, each encoding some of the elementary streams.
+    // That is opt-in, so by default frames go straight to libopus.
+    opus_t opus;
+    std::unique_ptr<multistream_encoder_t> parallel;
+    if (config::audio.encode_threads > 1) {
+      std::string note;
+      parallel = multistream_encoder_t::make(
+        {stream.sampleRate, stream.channelCount, stream.streams, stream.coupledStreams, stream.mapping, stream.bitrate, frame_size},
+        config::audio.encode_threads,
+        [](int index) {
+          platf::set_thread_name("audio::encode-" + std::to_string(index));
+          platf::adjust_thread_priority(platf::thread_priority_e::high);
+        },
+        note
+      );
+      if (parallel && !note.empty()) {
+        BOOST_LOG(warning) << "Encoding audio on a single thread: "sv << note;
+      }
+    } else {
+      opus.reset(opus_multistream_encoder_create(
+        stream.sampleRate,
+        stream.channelCount,
+        stream.streams,
+        stream.coupledStreams,
+        stream.mapping,
+        OPUS_APPLICATION_RESTRICTED_LOWDELAY,
+        nullptr
+      ));
+      if (opus) {
+        opus_multistream_encoder_ctl(opus.get(), OPUS_SET_BITRATE(stream.bitrate));
+        opus_multistream_encoder_ctl(opus.get(), OPUS_SET_VBR(0));
+      }
+    }
+    if (!opus && !parallel) {
+      BOOST_LOG(error) << "Couldn't create the Opus encoder"sv;
+      packets->stop();
 
-    opus_multistream_encoder_ctl(opus.get(), OPUS_SET_BITRATE(stream.bitrate));
-    opus_multistream_encoder_ctl(opus.get(), OPUS_SET_VBR(0));
+      return;
+    }
+
+    auto threads = [&]() {
+      return parallel ? parallel->threads() : 1;
+    };
+    auto set_vbr = [&](bool vbr) {
+      if (parallel) {
+        parallel->set_vbr(vbr);
+      } else {
+        opus_multistream_encoder_ctl(opus.get(), OPUS_SET_VBR(vbr ? 1 : 0));
+      }
+    };
+    auto encode = [&](const float *pcm, unsigned char *data, std::int32_t max_data_bytes) {
+      if (parallel) {
+        return parallel->encode(pcm, data, max_data_bytes);
+      }
+      return opus_multistream_encode_float(opus.get(), pcm, frame_size, data, max_data_bytes);
+    };
 
     BOOST_LOG(info) << "Opus initialized: "sv << stream.sampleRate / 1000 << " kHz, "sv
                     << stream.channelCount << " channels, "sv
-                    << stream.bitrate / 1000 << " kbps (total), LOWDELAY"sv;
+                    << stream.bitrate / 1000 << " kbps (total), LOWDELAY, "sv
+                    << threads() << (threads() == 1 ? " thread"sv : " threads"sv);
+
+    // Packets go back to the pool once the broadcast thread has sent them
+    auto packet_pool = buffer_pool_t<buffer_t>::make(PACKET_POOL_SIZE, buffer_t {MAX_PACKET_SIZE});
+
+    // Sessions without counters of their own still get the summary logged below
+    stats_t local_stats;
+    auto &counters = stats ? *stats : local_stats;
+
+    // A comfort packet is the encoding of a silent frame without padding, so while the
+    // source stays silent the same packet is sent again and the encoder sits idle
+    const bool silence_detection = config::audio.silence_detection;
+    silence::gate_t gate {FEC_BLOCK_FRAMES, (int) (SILENCE_HANGOVER / std::chrono::milliseconds {config.packetDuration})};
+
+    // Packets are sent with the sequence number they're raised with, so the gate's FEC blocks
+    // stay the client's even when the broadcast drops packets
+    std::uint16_t sequence_number = 0;
+    std::vector<float> silent_frame;
+    buffer_t comfort_packet {MAX_PACKET_SIZE};
+    if (silence_detection) {
+      silent_frame.resize(frame_size * stream.channelCount);
+    }
+
+    auto fg = util::fail_guard([&]() {
+      auto per_minute = [&](std::uint64_t value, std::uint64_t frames) {
+        return frames ? value * 60'000 / (frames * config.packetDuration) : 0;
+      };
+      auto active_frames = counters.active_frames.load(std::memory_order_relaxed);
+      auto idle_frames = counters.idle_frames.load(std::memory_order_relaxed);
+
+      BOOST_LOG(info) << "Audio encoder: "sv
+                      << active_frames * config.packetDuration / 1000 << "s active, "sv
+                      << per_minute(counters.active_encode_us.load(std::memory_order_relaxed), active_frames) / 1000 << " ms encoding and "sv
+                      << per_minute(counters.active_bytes.load(std::memory_order_relaxed), active_frames) << " bytes per minute; "sv
+                      << idle_frames * config.packetDuration / 1000 << "s idle, "sv
+                      << per_minute(counters.idle_encode_us.load(std::memory_order_relaxed), idle_frames) / 1000 << " ms encoding and "sv
+                      << per_minute(counters.idle_bytes.load(std::memory_order_relaxed), idle_frames) << " bytes per minute"sv;
+    });
 
-    auto frame_size = config.packetDuration * stream.sampleRate / 1000;
     while (auto sample = samples->pop()) {
-      buffer_t packet {1400};
+      if (stats) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sample->captured);
+        stats->capture_latency_us.store((std::uint32_t) std::max<std::int64_t>(latency.count(), 0), std::memory_order_relaxed);
+      }
+
+      auto packet = packet_pool->acquire();
+      packet->fake_resize(MAX_PACKET_SIZE);
 
       if (webrtc_stream::has_active_sessions() && channel_data == nullptr) {
-        webrtc_stream::submit_audio_frame(*sample, stream.sampleRate, stream.channelCount, frame_size);
+        webrtc_stream::submit_audio_frame(*sample->buffer, stream.sampleRate, stream.channelCount, frame_size);
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      const bool silent = silence::is_silent(sample->buffer->data(), sample->buffer->size());
+
+      int bytes;
+      if (silence_detection && gate.comfort(sequence_number, silent)) {
+        if (gate.entered()) {
+          // Settle the encoder on silence so the packet after the run decodes cleanly
+          set_vbr(true);
+          comfort_packet.fake_resize(MAX_PACKET_SIZE);
+          bytes = encode(silent_frame.data(), std::begin(comfort_packet), (std::int32_t) comfort_packet.size());
+          set_vbr(false);
+          comfort_packet.fake_resize(std::max(bytes, 0));
+        } else {
+          bytes = (int) comfort_packet.size();
+        }
+
+        if (bytes > 0) {
+          std::copy_n(std::begin(comfort_packet), bytes, std::begin(*packet));
+        }
+      } else {
+        auto encode_threads = threads();
+        bytes = encode(sample->buffer->data(), std::begin(*packet), (std::int32_t) packet->size());
+        if (threads() < encode_threads) {
+          BOOST_LOG(warning) << "Encoding audio on a single thread: a stream encoded in parallel outgrew its budget"sv;
+        }
       }
 
-      int bytes = opus_multistream_encode_float(opus.get(), sample->data(), frame_size, std::begin(packet), (opus_int32) packet.size());
       if (bytes < 0) {
         BOOST_LOG(error) << "Couldn't encode audio: "sv << opus_strerror(bytes);
         packets->stop();
@@ -129,12 +274,17 @@ namespace audio {
         return;
       }
 
-      packet.fake_resize(bytes);
-      packets->raise(channel_data, std::move(packet));
+      auto elapsed = (std::uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+      (silent ? counters.idle_frames : counters.active_frames).fetch_add(1, std::memory_order_relaxed);
+      (silent ? counters.idle_bytes : counters.active_bytes).fetch_add(bytes, std::memory_order_relaxed);
+      (silent ? counters.idle_encode_us : counters.active_encode_us).fetch_add(elapsed, std::memory_order_relaxed);
+
+      packet->fake_resize(bytes);
+      packets->raise(channel_data, sequence_number++, std::move(packet));
     }
   }
 
-  void capture(safe::mail_t mail, config_t config, void *channel_data) {
+  void capture(safe::mail_t mail, config_t config, void *channel_data, stats_t *stats) {
     auto shutdown_event = mail->event<bool>(mail::shutdown);
     if (!config::audio.stream || config.input_only) {
       shutdown_event->view();
@@ -208,11 +358,16 @@ namespace audio {
     // Capture takes place on this thread
     platf::adjust_thread_priority(platf::thread_priority_e::critical);
 
-    std::shared_ptr<sample_queue_t::element_type> samples;
+    int samples_per_frame = frame_size * stream.channelCount;
+
+    // Every frame in flight has a buffer: one being captured, a full queue and one being encoded
+    auto sample_pool = sample_pool_t::make(SAMPLE_QUEUE_SIZE + 2, std::vector<float>(samples_per_frame));
+
+    sample_queue_t samples;
     std::thread thread;
     if (!config.bypass_opus) {
-      samples = std::make_shared<sample_queue_t::element_type>(30);
-      thread = std::thread {encodeThread, samples, config, channel_data};
+      samples = std::make_shared<sample_queue_t::element_type>(SAMPLE_QUEUE_SIZE);
+      thread = std::thread {encodeThread, samples, config, channel_data, stats};
     }
 
     auto fg = util::fail_guard([&]() {
@@ -226,13 +381,10 @@ namespace audio {
       shutdown_event->view();
     });
 
-    int samples_per_frame = frame_size * stream.channelCount;
-
     while (!shutdown_event->peek()) {
-      std::vector<float> sample_buffer;
-      sample_buffer.resize(samples_per_frame);
+      auto sample_buffer = sample_pool->acquire();
 
-      auto status = mic->sample(sample_buffer);
+      auto status = mic->sample(*sample_buffer);
       policy::sample_status_e policy_status;
       switch (status) {
         case platf::capture_e::ok:
@@ -275,10 +427,14 @@ namespace audio {
 
       if (config.bypass_opus) {
         if (channel_data == nullptr) {
-          webrtc_stream::submit_audio_frame(sample_buffer, stream.sampleRate, stream.channelCount, frame_size);
+          webrtc_stream::submit_audio_frame(*sample_buffer, stream.sampleRate, stream.channelCount, frame_size);
         }
       } else {
-        samples->raise(std::move(sample_buffer));
+        // Frames are read as soon as they're captured
+        auto captured = std::chrono::steady_clock::now();
+
+        // When the encoder has fallen behind the frame is dropped and its buffer recycled
+        samples->push({std::move(sample_buffer), captured});
       }
     }
   }
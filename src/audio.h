@@ -5,11 +5,14 @@
 #pragma once
 
 // local includes
+#include "audio_pool.h"
 #include "platform/common.h"
 #include "thread_safe.h"
 #include "utility.h"
 
+#include <atomic>
 #include <bitset>
+#include <tuple>
 
 namespace audio {
   enum stream_config_e : int {
@@ -76,10 +79,47 @@ namespace audio {
   };
 
   using buffer_t = util::buffer_t<std::uint8_t>;
-  using packet_t = std::pair<void *, buffer_t>;
+  using packet_buffer_t = buffer_pool_t<buffer_t>::handle_t;  // encoded packet, recycled once sent
+  using packet_t = std::tuple<void *, std::uint16_t, packet_buffer_t>;  // channel_data, sequence number, encoded packet
   using audio_ctx_ref_t = safe::shared_t<audio_ctx_t>::ptr_t;
+  using packet_queue_t = safe::mail_raw_t::ring_queue_t<packet_t>;
 
-  void capture(safe::mail_t mail, config_t config, void *channel_data);
+  /**
+   * @brief The queue encoded packets are raised on.
+   * @details When the broadcast falls behind, the oldest packets are dropped so latency stays bounded.
+   *          The encoder numbers its packets, so a dropped packet leaves a gap in the sequence
+   *          numbers instead of moving the FEC blocks of the packets after it.
+   */
+  packet_queue_t packet_queue(safe::mail_raw_t &mail);
+
+  /**
+   * @brief Counters a capture reports while it runs.
+   */
+  struct stats_t {
+    std::atomic<std::uint32_t> capture_latency_us {0};  ///< Last frame's capture to the start of its encode
+
+    // Frames are idle when they are digital silence, whether or not they were sent as comfort packets
+    std::atomic<std::uint64_t> active_frames {0};  ///< Frames with sound
+    std::atomic<std::uint64_t> idle_frames {0};  ///< Silent frames
+    std::atomic<std::uint64_t> active_bytes {0};  ///< Encoded bytes of frames with sound
+    std::atomic<std::uint64_t> idle_bytes {0};  ///< Encoded bytes of silent frames
+    std::atomic<std::uint64_t> active_encode_us {0};  ///< Time spent encoding frames with sound
+    std::atomic<std::uint64_t> idle_encode_us {0};  ///< Time spent encoding silent frames
+  };
+
+  /**
+   * @brief Data packets in an audio FEC block, RTPA_DATA_SHARDS in moonlight-common-c.
+   */
+  constexpr int FEC_BLOCK_FRAMES = 4;
+
+  /**
+   * @brief Capture and encode audio until the shutdown event is raised.
+   * @param mail The session's mailbox.
+   * @param config The negotiated audio stream.
+   * @param channel_data Tags every packet raised on packet_queue().
+   * @param stats Optional counters to update, which must outlive the capture.
+   */
+  void capture(safe::mail_t mail, config_t config, void *channel_data, stats_t *stats = nullptr);
 
   /**
    * @brief Get the reference to the audio context.
@@ -0,0 +1,450 @@
+/**
+ * @file src/audio_encoder.cpp
+ * @brief Definitions for the Opus multistream encoder that can encode its streams in parallel.
+ */
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// local includes
+#include "audio_encoder.h"
+
+namespace audio {
+  using namespace std::literals;
+
+  namespace {
+    // Largest packet a single Opus stream can produce
+    constexpr int MAX_STREAM_PACKET = 1276;
+
+    // Per-stream scratch limit in opus_multistream_encoder.c
+    constexpr int MS_FRAME_TMP = 6 * 1275 + 12;
+
+    // Frames compared against a plain OpusMSEncoder before encoding in parallel
+    constexpr int CHECK_FRAMES = 32;
+
+    // encode_parallel() result for a stream larger than the room the streams before it left
+    constexpr int OVER_BUDGET = -1000;
+
+    int first_channel(const unsigned char *mapping, int channels, int id) {
+      for (int x = 0; x < channels; ++x) {
+        if (mapping[x] == id) {
+          return x;
+        }
+      }
+
+      return -1;
+    }
+
+    /**
+     * @brief Append a stream's single-frame packet in self-delimited framing, as the
+     *        multistream repacketizer does for every stream but the last.
+     */
+    int append_self_delimited(const unsigned char *packet, int length, unsigned char *data, int room) {
+      unsigned char toc;
+      const unsigned char *frames[48];
+      opus_int16 sizes[48];
+      auto count = opus_packet_parse(packet, length, &toc, frames, sizes, nullptr);
+      if (count < 0) {
+        return OPUS_INTERNAL_ERROR;
+      }
+      if (count != 1) {
+        // CELT frames are never longer than 20 ms, so RESTRICTED_LOWDELAY never gets here
+        return OPUS_UNIMPLEMENTED;
+      }
+
+      int size = sizes[0];
+      int header = size >= 252 ? 3 : 2;
+      if (header + size > room) {
+        return OPUS_BUFFER_TOO_SMALL;
+      }
+
+      data[0] = toc & 0xFC;
+      if (size < 252) {
+        data[1] = (unsigned char) size;
+      } else {
+        data[1] = (unsigned char) (252 + (size & 0x3));
+        data[2] = (unsigned char) ((size - data[1]) >> 2);
+      }
+      std::memcpy(data + header, frames[0], size);
+
+      return header + size;
+    }
+
+    /**
+     * @brief Deterministic test signal: a tone under noise, silence, then loud noise.
+     */
+    void check_frame(std::vector<float> &pcm, int channels, int frame, std::uint32_t &seed) {
+      auto frames = pcm.size() / channels;
+      for (std::size_t x = 0; x < frames; ++x) {
+        for (int c = 0; c < channels; ++c) {
+          seed = seed * 1664525 + 1013904223;
+          auto noise = (float) (seed >> 8) / (float) (1 << 24) * 2.0f - 1.0f;
+
+          float value;
+          if (frame < 12) {
+            auto t = (float) (frame * frames + x) / 48000.0f;
+            value = 0.4f * std::sin(2.0f * 3.14159265f * (220.0f * (c + 1)) * t) + 0.05f * noise;
+          } else if (frame < 20) {
+            value = 0.0f;
+          } else {
+            value = noise;
+          }
+          pcm[x * channels + c] = value;
+        }
+      }
+    }
+  }  // namespace
+
+  multistream_encoder_t::multistream_encoder_t(const encoder_params_t &params):
+      params {params},
+      mapping(params.mapping, params.mapping + params.channels) {
+    this->params.mapping = mapping.data();
+  }
+
+  multistream_encoder_t::~multistream_encoder_t() {
+    stop_workers();
+    if (repacketizer) {
+      opus_repacketizer_destroy(repacketizer);
+    }
+    if (opus) {
+      opus_multistream_encoder_destroy(opus);
+    }
+  }
+
+  std::unique_ptr<multistream_encoder_t> multistream_encoder_t::make(const encoder_params_t &params, int threads, const thread_init_t &thread_init, std::string &note) {
+    auto create = [&params]() -> OpusMSEncoder * {
+      int error;
+      auto opus = opus_multistream_encoder_create(params.sample_rate, params.channels, params.streams, params.coupled_streams, params.mapping, OPUS_APPLICATION_RESTRICTED_LOWDELAY, &error);
+      if (opus) {
+        opus_multistream_encoder_ctl(opus, OPUS_SET_BITRATE(params.bitrate));
+        opus_multistream_encoder_ctl(opus, OPUS_SET_VBR(0));
+      }
+      return opus;
+    };
+
+    std::unique_ptr<multistream_encoder_t> encoder {new multistream_encoder_t(params)};
+    encoder->opus = create();
+    if (!encoder->opus) {
+      return nullptr;
+    }
+
+    if (threads <= 1) {
+      return encoder;
+    }
+    if (params.streams <= 2) {
+      note = "the last stream waits for the others, so there is nothing to encode in parallel";
+      return encoder;
+    }
+
+    if (auto error = encoder->init(threads, thread_init)) {
+      note = "couldn't split the multistream encoder: "s + opus_strerror(error);
+      encoder->stop_workers();
+      return encoder;
+    }
+
+    // The split relies on how libopus allocates bytes between streams, so it is only used
+    // when it reproduces what this build of libopus would have sent
+    std::unique_ptr<OpusMSEncoder, decltype(&opus_multistream_encoder_destroy)> reference {create(), &opus_multistream_encoder_destroy};
+    std::vector<float> pcm(params.frame_size * params.channels);
+    std::vector<unsigned char> expected(MAX_STREAM_PACKET * params.streams);
+    std::vector<unsigned char> actual(expected.size());
+    std::uint32_t seed = 1;
+
+    bool identical = (bool) reference;
+    for (int frame = 0; identical && frame < CHECK_FRAMES; ++frame) {
+      check_frame(pcm, params.channels, frame, seed);
+
+      // Comfort packets are encoded in VBR
+      bool comfort = frame == 16;
+      if (comfort) {
+        opus_multistream_encoder_ctl(reference.get(), OPUS_SET_VBR(1));
+        encoder->set_vbr(true);
+      }
+
+      auto expected_bytes = opus_multistream_encode_float(reference.get(), pcm.data(), params.frame_size, expected.data(), (opus_int32) expected.size());
+      auto actual_bytes = encoder->encode(pcm.data(), actual.data(), (std::int32_t) actual.size());
+      identical = expected_bytes > 0 && expected_bytes == actual_bytes && std::equal(expected.begin(), expected.begin() + expected_bytes, actual.begin());
+
+      if (comfort) {
+        opus_multistream_encoder_ctl(reference.get(), OPUS_SET_VBR(0));
+        encoder->set_vbr(false);
+      }
+    }
+
+    // Start the session from the same state a new encoder would have
+    opus_multistream_encoder_ctl(encoder->opus, OPUS_RESET_STATE);
+
+    if (!identical) {
+      note = "parallel encoding doesn't reproduce "s + opus_get_version_string() + " multistream packets";
+      encoder->stop_workers();
+    }
+
+    return encoder;
+  }
+
+  int multistream_encoder_t::init(int threads, const thread_init_t &thread_init) {
+    repacketizer = opus_repacketizer_create();
+    if (!repacketizer) {
+      return OPUS_ALLOC_FAIL;
+    }
+
+    streams.resize(params.streams);
+    for (int s = 0; s < params.streams; ++s) {
+      auto &stream = streams[s];
+      if (opus_multistream_encoder_ctl(opus, OPUS_MULTISTREAM_GET_ENCODER_STATE(s, &stream.enc)) != OPUS_OK) {
+        return OPUS_INTERNAL_ERROR;
+      }
+
+      // Coupled streams come first, as in opus_multistream_encoder.c
+      if (s < params.coupled_streams) {
+        stream.left = first_channel(params.mapping, params.channels, s * 2);
+        stream.right = first_channel(params.mapping, params.channels, s * 2 + 1);
+        if (stream.left < 0 || stream.right < 0) {
+          return OPUS_BAD_ARG;
+        }
+      } else {
+        stream.left = first_channel(params.mapping, params.channels, s + params.coupled_streams);
+        stream.right = -1;
+        if (stream.left < 0) {
+          return OPUS_BAD_ARG;
+        }
+      }
+
+      stream.pcm.resize(params.frame_size * (stream.right < 0 ? 1 : 2));
+      stream.packet.resize(MAX_STREAM_PACKET);
+    }
+
+    // Each stream's share of the bitrate is only applied as a frame is encoded. In VBR
+    // every stream, the last included, keeps the share it was given.
+    std::vector<float> silence(params.frame_size * params.channels);
+    std::vector<unsigned char> scratch(MAX_STREAM_PACKET * params.streams);
+    opus_multistream_encoder_ctl(opus, OPUS_SET_VBR(1));
+    auto bytes = opus_multistream_encode_float(opus, silence.data(), params.frame_size, scratch.data(), (opus_int32) scratch.size());
+    opus_multistream_encoder_ctl(opus, OPUS_SET_VBR(0));
+    if (bytes < 0) {
+      return bytes;
+    }
+
+    for (auto &stream : streams) {
+      opus_int32 bitrate;
+      opus_encoder_ctl(stream.enc, OPUS_GET_BITRATE(&bitrate));
+      stream.bitrate = bitrate;
+    }
+    opus_multistream_encoder_ctl(opus, OPUS_RESET_STATE);
+
+    // The caller encodes a share too, and the last stream is never split off
+    participants = std::min(threads, params.streams - 1);
+    for (int x = 1; x < participants; ++x) {
+      workers.emplace_back(&multistream_encoder_t::worker_main, this, x, thread_init);
+    }
+
+    return OPUS_OK;
+  }
+
+  void multistream_encoder_t::set_vbr(bool vbr) {
+    this->vbr = vbr;
+    opus_multistream_encoder_ctl(opus, OPUS_SET_VBR(vbr ? 1 : 0));
+  }
+
+  int multistream_encoder_t::encode(const float *pcm, unsigned char *data, std::int32_t max_data_bytes) {
+    if (workers.empty()) {
+      return opus_multistream_encode_float(opus, pcm, params.frame_size, data, max_data_bytes);
+    }
+
+    // Every stream's budget depends on the ones before it, which is only known up front in CBR
+    if (vbr) {
+      return encode_sequential(pcm, data, max_data_bytes);
+    }
+
+    auto bytes = encode_parallel(pcm, data, max_data_bytes);
+    if (bytes != OVER_BUDGET) {
+      return bytes;
+    }
+
+    // The checks when the encoder was made didn't catch this, so don't trust the parallel
+    // packets any further. The streams already encoded encode this frame a second time.
+    stop_workers();
+    return opus_multistream_encode_float(opus, pcm, params.frame_size, data, max_data_bytes);
+  }
+
+  int multistream_encoder_t::max_stream_bytes(int s, int max_data_bytes, int tot_size) const {
+    // Budget opus_multistream_encode_native() gives stream s after tot_size bytes of earlier streams
+    auto curr_max = max_data_bytes - tot_size;
+    curr_max -= std::max(0, 2 * (params.streams - s - 1) - 1);
+    if (params.sample_rate / params.frame_size == 10) {
+      curr_max -= params.streams - s - 1;
+    }
+    curr_max = std::min(curr_max, MS_FRAME_TMP);
+    if (s != params.streams - 1) {
+      curr_max -= curr_max > 253 ? 2 : 1;
+    }
+
+    return curr_max;
+  }
+
+  void multistream_encoder_t::encode_stream(stream_t &stream, const float *pcm) {
+    auto channels = stream.right < 0 ? 1 : 2;
+    for (int x = 0; x < params.frame_size; ++x) {
+      stream.pcm[x * channels] = pcm[x * params.channels + stream.left];
+      if (channels == 2) {
+        stream.pcm[x * 2 + 1] = pcm[x * params.channels + stream.right];
+      }
+    }
+
+    stream.length = opus_encode_float(stream.enc, stream.pcm.data(), params.frame_size, stream.packet.data(), std::min(stream.max_bytes, MAX_STREAM_PACKET));
+  }
+
+  int multistream_encoder_t::encode_sequential(const float *pcm, unsigned char *data, std::int32_t max_data_bytes) {
+    const int smallest_packet = params.streams * 2 - 1 + (params.sample_rate / params.frame_size == 10 ? params.streams : 0);
+    if (max_data_bytes < smallest_packet) {
+      return OPUS_BUFFER_TOO_SMALL;
+    }
+
+    int tot_size = 0;
+    for (int s = 0; s < params.streams; ++s) {
+      auto &stream = streams[s];
+      opus_encoder_ctl(stream.enc, OPUS_SET_BITRATE(stream.bitrate));
+
+      stream.max_bytes = max_stream_bytes(s, max_data_bytes, tot_size);
+      encode_stream(stream, pcm);
+      if (stream.length < 0) {
+        return stream.length;
+      }
+
+      int bytes;
+      if (s != params.streams - 1) {
+        bytes = append_self_delimited(stream.packet.data(), stream.length, data + tot_size, max_data_bytes - tot_size);
+      } else {
+        opus_repacketizer_init(repacketizer);
+        if (opus_repacketizer_cat(repacketizer, stream.packet.data(), stream.length) != OPUS_OK) {
+          return OPUS_INTERNAL_ERROR;
+        }
+        bytes = opus_repacketizer_out(repacketizer, data + tot_size, max_data_bytes - tot_size);
+      }
+      if (bytes < 0) {
+        return bytes;
+      }
+      tot_size += bytes;
+    }
+
+    return tot_size;
+  }
+
+  int multistream_encoder_t::encode_parallel(const float *pcm, unsigned char *data, std::int32_t max_data_bytes) {
+    const int smallest_packet = params.streams * 2 - 1 + (params.sample_rate / params.frame_size == 10 ? params.streams : 0);
+    if (max_data_bytes < smallest_packet) {
+      return OPUS_BUFFER_TOO_SMALL;
+    }
+
+    // CBR caps the whole packet at the bitrate, clamped as OPUS_SET_BITRATE does
+    const auto bitrate = std::clamp(params.bitrate, 500 * params.channels, 300000 * params.channels);
+    max_data_bytes = std::min(max_data_bytes, std::max(smallest_packet, 3 * bitrate / (3 * 8 * params.sample_rate / params.frame_size)));
+
+    // A stream's budget only shrinks as earlier streams use bytes, so budgeting as if it
+    // came first and checking afterwards gives the same packets whenever the check passes
+    const int last = params.streams - 1;
+    for (int s = 0; s < last; ++s) {
+      streams[s].max_bytes = max_stream_bytes(s, max_data_bytes, 0);
+    }
+
+    frame_pcm = pcm;
+    pending.store((int) workers.size(), std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    const int participants = threads();
+    for (int s = 0; s < last; s += participants) {
+      encode_stream(streams[s], pcm);
+    }
+
+    for (auto remaining = pending.load(std::memory_order_acquire); remaining; remaining = pending.load(std::memory_order_acquire)) {
+      pending.wait(remaining, std::memory_order_acquire);
+    }
+
+    int tot_size = 0;
+    for (int s = 0; s < last; ++s) {
+      auto &stream = streams[s];
+      if (stream.length < 0) {
+        return stream.length;
+      }
+
+      // The CBR packet is exactly its budget, so a smaller real budget would have changed it
+      if (stream.length > max_stream_bytes(s, max_data_bytes, tot_size)) {
+        return OVER_BUDGET;
+      }
+
+      auto bytes = append_self_delimited(stream.packet.data(), stream.length, data + tot_size, max_data_bytes - tot_size);
+      if (bytes < 0) {
+        return bytes;
+      }
+      tot_size += bytes;
+    }
+
+    // In CBR the last stream fills whatever the others left
+    auto &stream = streams[last];
+    stream.max_bytes = max_stream_bytes(last, max_data_bytes, tot_size);
+    opus_encoder_ctl(stream.enc, OPUS_SET_BITRATE(stream.max_bytes * (8 * params.sample_rate / params.frame_size)));
+    encode_stream(stream, pcm);
+    if (stream.length < 0) {
+      return stream.length;
+    }
+
+    opus_repacketizer_init(repacketizer);
+    if (opus_repacketizer_cat(repacketizer, stream.packet.data(), stream.length) != OPUS_OK) {
+      return OPUS_INTERNAL_ERROR;
+    }
+    auto room = max_data_bytes - tot_size;
+    auto bytes = opus_repacketizer_out(repacketizer, data + tot_size, room);
+    if (bytes < 0) {
+      return bytes;
+    }
+    if (bytes < room) {
+      if (auto error = opus_packet_pad(data + tot_size, bytes, room); error != OPUS_OK) {
+        return error;
+      }
+      bytes = room;
+    }
+
+    return tot_size + bytes;
+  }
+
+  void multistream_encoder_t::stop_workers() {
+    if (workers.empty()) {
+      return;
+    }
+
+    stopping.store(true, std::memory_order_release);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    workers.clear();
+    participants = 1;
+  }
+
+  void multistream_encoder_t::worker_main(int index, thread_init_t thread_init) {
+    if (thread_init) {
+      thread_init(index);
+    }
+
+    std::uint32_t seen = 0;
+    while (true) {
+      generation.wait(seen, std::memory_order_acquire);
+      seen = generation.load(std::memory_order_acquire);
+      if (stopping.load(std::memory_order_acquire)) {
+        return;
+      }
+
+      const int participants = threads();
+      for (int s = index; s < params.streams - 1; s += participants) {
+        encode_stream(streams[s], frame_pcm);
+      }
+
+      if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        pending.notify_one();
+      }
+    }
+  }
+}  // namespace audio
@@ -0,0 +1,120 @@
+/**
+ * @file src/audio_encoder.h
+ * @brief Declarations for the Opus multistream encoder that can encode its streams in parallel.
+ */
+#pragma once
+
+// standard includes
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// lib includes
+#include <opus/opus_multistream.h>
+
+namespace audio {
+  struct encoder_params_t {
+    std::int32_t sample_rate;
+    int channels;
+    int streams;
+    int coupled_streams;
+    const unsigned char *mapping;
+    int bitrate;
+    int frame_size;  ///< Samples per channel in each frame
+  };
+
+  /**
+   * @brief An OpusMSEncoder in RESTRICTED_LOWDELAY mode that can split each frame across threads.
+   * @details A multistream packet is each elementary stream's packet in turn, self-delimited
+   *          except for the last. With more than one thread, the elementary streams are encoded
+   *          on a small worker pool through the multistream encoder's own stream encoders,
+   *          applying the same per-stream bitrates and byte budgets it would, and reassembled
+   *          into the packet it would have produced. In CBR the last stream gets whatever the
+   *          others left, so it is encoded once they are done.
+   *
+   *          The output is checked against a plain OpusMSEncoder when the encoder is made, and
+   *          any difference with the linked libopus falls back to encoding on the calling thread.
+   *          So does a later frame with a stream larger than its real budget, for good.
+   */
+  class multistream_encoder_t {
+  public:
+    /**
+     * @brief Called on each worker before it encodes anything, with its index from 1.
+     */
+    using thread_init_t = std::function<void(int)>;
+
+    /**
+     * @param params The stream layout and bitrate, encoded in CBR.
+     * @param threads Threads to encode on, including the caller's.
+     * @param thread_init Optional worker setup.
+     * @param note Set to why the encoder doesn't encode in parallel when threads asked for it.
+     * @return nullptr if libopus rejects the layout.
+     */
+    static std::unique_ptr<multistream_encoder_t> make(const encoder_params_t &params, int threads, const thread_init_t &thread_init, std::string &note);
+
+    ~multistream_encoder_t();
+
+    multistream_encoder_t(const multistream_encoder_t &) = delete;
+    multistream_encoder_t &operator=(const multistream_encoder_t &) = delete;
+
+    /**
+     * @brief Encode one frame. Must always be called from the same thread.
+     * @param pcm frame_size interleaved samples per channel.
+     * @return Bytes written, or a negative Opus error code.
+     */
+    int encode(const float *pcm, unsigned char *data, std::int32_t max_data_bytes);
+
+    /**
+     * @brief Switch between VBR and CBR for the following frames.
+     */
+    void set_vbr(bool vbr);
+
+    /**
+     * @return Threads frames are encoded on, which drops to 1 if encoding in parallel fails.
+     */
+    int threads() const {
+      return participants;
+    }
+
+  private:
+    struct stream_t {
+      OpusEncoder *enc;
+      int left;  // channel in pcm
+      int right;  // second channel for coupled streams, -1 for mono
+      int bitrate;  // the share the multistream encoder gives this stream
+      std::vector<float> pcm;  // this stream's channels
+      std::vector<unsigned char> packet;
+      int max_bytes;  // budget for this frame
+      int length;  // bytes in packet, or an Opus error code
+    };
+
+    explicit multistream_encoder_t(const encoder_params_t &params);
+
+    int init(int threads, const thread_init_t &thread_init);
+    int max_stream_bytes(int s, int max_data_bytes, int tot_size) const;
+    void encode_stream(stream_t &stream, const float *pcm);
+    int encode_sequential(const float *pcm, unsigned char *data, std::int32_t max_data_bytes);
+    int encode_parallel(const float *pcm, unsigned char *data, std::int32_t max_data_bytes);
+    void stop_workers();
+    void worker_main(int index, thread_init_t thread_init);
+
+    encoder_params_t params;
+    std::vector<unsigned char> mapping;
+    OpusMSEncoder *opus = nullptr;
+    OpusRepacketizer *repacketizer = nullptr;
+    bool vbr = false;
+
+    std::vector<stream_t> streams;
+
+    int participants = 1;  // the caller and its workers
+    std::vector<std::thread> workers;
+    const float *frame_pcm = nullptr;
+    std::atomic<std::uint32_t> generation {0};
+    std::atomic<int> pending {0};
+    std::atomic<bool> stopping {false};
+  };
+}  // namespace audio
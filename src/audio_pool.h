@@ -0,0 +1,232 @@
+/**
+ * @file src/audio_pool.h
+ * @brief Recycled audio buffers and the ring that hands them from capture to encode.
+ */
+#pragma once
+
+// standard includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace audio {
+  /**
+   * @brief Fixed set of buffers that are handed out and recycled instead of freed.
+   * @details One thread acquires buffers; handles may be released on any thread. The free
+   *          list is a lock-free stack, which is safe from ABA because only the acquiring
+   *          thread ever pops. When every buffer is in use, acquire() falls back to a copy
+   *          of the prototype on the heap, so a stalled consumer costs allocations rather
+   *          than audio.
+   */
+  template<class T>
+  class buffer_pool_t: public std::enable_shared_from_this<buffer_pool_t<T>> {
+    struct private_t {};
+
+  public:
+    /**
+     * @brief A buffer from the pool, returned to it on destruction.
+     */
+    class handle_t {
+    public:
+      handle_t() = default;
+
+      handle_t(handle_t &&other) noexcept:
+          pool {std::move(other.pool)},
+          index {other.index},
+          spill {std::move(other.spill)} {
+      }
+
+      handle_t &operator=(handle_t &&other) noexcept {
+        if (this != &other) {
+          release();
+          pool = std::move(other.pool);
+          index = other.index;
+          spill = std::move(other.spill);
+        }
+        return *this;
+      }
+
+      ~handle_t() {
+        release();
+      }
+
+      T &operator*() const {
+        return spill ? *spill : pool->buffers[index];
+      }
+
+      T *operator->() const {
+        return &**this;
+      }
+
+      explicit operator bool() const {
+        return pool || spill;
+      }
+
+      /**
+       * @return true if the buffer came from the pool rather than the heap.
+       */
+      bool pooled() const {
+        return (bool) pool;
+      }
+
+    private:
+      friend class buffer_pool_t;
+
+      void release() {
+        if (pool) {
+          pool->push_free(index);
+          pool.reset();
+        }
+        spill.reset();
+      }
+
+      std::shared_ptr<buffer_pool_t> pool;
+      std::uint32_t index = 0;
+      std::unique_ptr<T> spill;
+    };
+
+    buffer_pool_t(private_t, std::size_t count, const T &prototype):
+        buffers(count, prototype),
+        next(std::make_unique<std::atomic<std::uint32_t>[]>(count)),
+        prototype {prototype} {
+      for (std::size_t x = 0; x < count; ++x) {
+        next[x].store(x + 1 < count ? (std::uint32_t) (x + 1) : NIL, std::memory_order_relaxed);
+      }
+      head.store(count > 0 ? 0 : NIL, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Create a pool of copies of a buffer.
+     * @param count Number of buffers, which should cover every buffer in flight at once.
+     * @param prototype Buffer every pooled buffer starts as.
+     */
+    static std::shared_ptr<buffer_pool_t> make(std::size_t count, const T &prototype) {
+      return std::make_shared<buffer_pool_t>(private_t {}, count, prototype);
+    }
+
+    /**
+     * @brief Take a buffer. Must always be called from the same thread.
+     * @details Buffers come back with the contents they were released with.
+     */
+    handle_t acquire() {
+      handle_t handle;
+
+      auto index = head.load(std::memory_order_acquire);
+      while (index != NIL) {
+        auto following = next[index].load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(index, following, std::memory_order_acquire, std::memory_order_acquire)) {
+          handle.pool = this->shared_from_this();
+          handle.index = index;
+          return handle;
+        }
+      }
+
+      handle.spill = std::make_unique<T>(prototype);
+      return handle;
+    }
+
+    /**
+     * @return Number of buffers the pool holds.
+     */
+    std::size_t size() const {
+      return buffers.size();
+    }
+
+  private:
+    static constexpr std::uint32_t NIL = std::numeric_limits<std::uint32_t>::max();
+
+    void push_free(std::uint32_t index) {
+      auto top = head.load(std::memory_order_relaxed);
+      do {
+        next[index].store(top, std::memory_order_relaxed);
+      } while (!head.compare_exchange_weak(top, index, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    std::vector<T> buffers;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> next;
+    std::atomic<std::uint32_t> head;
+    T prototype;
+  };
+
+  /**
+   * @brief Bounded single-producer single-consumer queue with a blocking pop().
+   * @details push() never blocks and never allocates: when the consumer has fallen behind
+   *          the newest value is refused, and the caller decides what to do with it.
+   */
+  template<class T>
+  class spsc_ring_t {
+  public:
+    explicit spsc_ring_t(std::size_t capacity):
+        slots(capacity) {
+    }
+
+    /**
+     * @brief Queue a value. Must always be called from the same thread.
+     * @return false if the ring is full or stopped, in which case value is left untouched.
+     */
+    bool push(T &&value) {
+      if (stopped.load(std::memory_order_relaxed)) {
+        return false;
+      }
+
+      auto t = tail.load(std::memory_order_relaxed);
+      if (t - head.load(std::memory_order_acquire) == slots.size()) {
+        return false;
+      }
+
+      slots[t % slots.size()] = std::move(value);
+      tail.store(t + 1, std::memory_order_release);
+      wake();
+      return true;
+    }
+
+    /**
+     * @brief Wait for a value. Must always be called from the same thread.
+     * @return The oldest value, or std::nullopt once the ring is stopped and empty.
+     */
+    std::optional<T> pop() {
+      while (true) {
+        auto seen = signal.load(std::memory_order_acquire);
+
+        auto h = head.load(std::memory_order_relaxed);
+        if (h != tail.load(std::memory_order_acquire)) {
+          std::optional<T> value {std::move(*slots[h % slots.size()])};
+          slots[h % slots.size()].reset();
+          head.store(h + 1, std::memory_order_release);
+          return value;
+        }
+
+        if (stopped.load(std::memory_order_acquire)) {
+          return std::nullopt;
+        }
+
+        signal.wait(seen, std::memory_order_acquire);
+      }
+    }
+
+    /**
+     * @brief Refuse further values and wake the consumer once the ring drains.
+     */
+    void stop() {
+      stopped.store(true, std::memory_order_release);
+      wake();
+    }
+
+  private:
+    void wake() {
+      signal.fetch_add(1, std::memory_order_release);
+      signal.notify_one();
+    }
+
+    std::vector<std::optional<T>> slots;
+    std::atomic<std::size_t> head {0};
+    std::atomic<std::size_t> tail {0};
+    std::atomic<std::uint32_t> signal {0};
+    std::atomic<bool> stopped {false};
+  };
+}  // namespace audio
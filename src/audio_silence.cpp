@@ -0,0 +1,79 @@
+/**
+ * @file src/audio_silence.cpp
+ * @brief Definitions for detecting silent audio frames.
+ */
+// standard includes
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define SUNSHINE_SILENCE_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #include <arm_neon.h>
+  #define SUNSHINE_SILENCE_NEON
+#endif
+
+// local includes
+#include "audio_silence.h"
+
+namespace audio::silence {
+  float peak(const float *samples, std::size_t count) {
+    std::size_t x = 0;
+    float result = 0.0f;
+
+#if defined(SUNSHINE_SILENCE_SSE2)
+    // Clearing the sign bit gives the absolute value. With a NaN operand maxps returns its
+    // second operand, so keeping the running peak second skips NaN samples.
+    const auto abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    auto peak0 = _mm_setzero_ps();
+    auto peak1 = _mm_setzero_ps();
+    for (; x + 8 <= count; x += 8) {
+      peak0 = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(samples + x), abs_mask), peak0);
+      peak1 = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(samples + x + 4), abs_mask), peak1);
+    }
+
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_max_ps(peak0, peak1));
+    result = std::max({lanes[0], lanes[1], lanes[2], lanes[3]});
+#elif defined(SUNSHINE_SILENCE_NEON)
+    // maxnm returns the number when one operand is NaN
+    auto peak0 = vdupq_n_f32(0.0f);
+    auto peak1 = vdupq_n_f32(0.0f);
+    for (; x + 8 <= count; x += 8) {
+      peak0 = vmaxnmq_f32(peak0, vabsq_f32(vld1q_f32(samples + x)));
+      peak1 = vmaxnmq_f32(peak1, vabsq_f32(vld1q_f32(samples + x + 4)));
+    }
+    result = vmaxnmvq_f32(vmaxnmq_f32(peak0, peak1));
+#endif
+
+    for (; x < count; ++x) {
+      auto value = std::fabs(samples[x]);
+      if (value > result) {
+        result = value;
+      }
+    }
+
+    return result;
+  }
+
+  gate_t::gate_t(int block_frames, int hangover_frames):
+      block_frames {std::max(block_frames, 1)},
+      hangover_frames {std::max(hangover_frames, 0)} {
+  }
+
+  bool gate_t::comfort(std::uint16_t sequence, bool silent) {
+    started = false;
+    if (sequence % block_frames == 0) {
+      auto next = silent && silent_run >= hangover_frames;
+      started = next && !in_comfort;
+      in_comfort = next;
+    } else if (!silent) {
+      in_comfort = false;
+    }
+
+    silent_run = silent ? std::min(silent_run + 1, hangover_frames) : 0;
+
+    return in_comfort;
+  }
+}  // namespace audio::silence
@@ -0,0 +1,72 @@
+/**
+ * @file src/audio_silence.h
+ * @brief Declarations for detecting silent audio frames.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace audio::silence {
+  /**
+   * @brief Loudest sample that still counts as digital silence, half a 16-bit step.
+   */
+  constexpr float SILENCE_PEAK = 1.0f / 65536;
+
+  /**
+   * @brief Largest absolute sample value in a frame.
+   * @param samples Interleaved samples.
+   * @param count Number of samples.
+   * @return The peak, 0 for an empty frame. NaN samples are ignored.
+   */
+  float peak(const float *samples, std::size_t count);
+
+  /**
+   * @brief Check whether a frame is digital silence.
+   */
+  inline bool is_silent(const float *samples, std::size_t count) {
+    return peak(samples, count) <= SILENCE_PEAK;
+  }
+
+  /**
+   * @brief Decides which frames are sent as comfort packets instead of being encoded.
+   * @details Comfort packets are smaller than encoded ones, and audio FEC parity needs every
+   *          packet of a block to be the same size. So comfort packets only start with a block
+   *          whose frames before it have been silent for the hangover. Sound is never held back:
+   *          a frame with sound ends them at once, and the block it interrupts goes without parity.
+   *
+   *          Blocks are found from the sequence number each frame is sent with, so packets
+   *          dropped on their way to the client leave a gap instead of moving the blocks after them.
+   */
+  class gate_t {
+  public:
+    /**
+     * @param block_frames Frames in an FEC block.
+     * @param hangover_frames Silent frames needed before comfort packets start.
+     */
+    gate_t(int block_frames, int hangover_frames);
+
+    /**
+     * @brief Decide how to send the next frame. Must be called once for every frame, in order.
+     * @param sequence The sequence number the frame is sent with.
+     * @param silent Whether the frame is silent.
+     * @return true to send a comfort packet, false to encode the frame.
+     */
+    bool comfort(std::uint16_t sequence, bool silent);
+
+    /**
+     * @return true if the last frame passed to comfort() started a run of comfort packets.
+     */
+    bool entered() const {
+      return started;
+    }
+
+  private:
+    int block_frames;
+    int hangover_frames;
+
+    int silent_run = 0;  // silent frames before the current one
+    bool in_comfort = false;
+    bool started = false;
+  };
+}  // namespace audio::silence
@@ -844,6 +844,8 @@ namespace config {
       "superfast"s,  // preset
       "zerolatency"s,  // tune
       11,  // superfast
+      false,  // damage_roi
+      true,  // static_frame_skip
     },  // software
 
     {},  // nv
@@ -909,6 +911,14 @@ namespace config {
     },  // rtx_hdr
 
     {},  // capture
+
+    {
+      "motion",  // synthetic.pattern
+      0,  // synthetic.width
+      0,  // synthetic.height
+      0,  // synthetic.refresh_rate
+    },  // synthetic
+
     {},  // encoder
     {},  // adapter_name
     {},  // adapter_pnp_id
@@ -961,6 +971,8 @@ namespace config {
     true,  // install_steam_drivers
     true,  // keep_sink_default
     true,  // auto_capture
+    false,  // silence_detection
+    1,  // encode_threads
   };
 
   stream_t stream {
@@ -971,11 +983,26 @@ namespace config {
     20,  // fecPercentage
     64,  // video_max_batch_size_kb
 
+    false,  // adaptive_fec
+    10,  // adaptive_fec_min_percentage
+    50,  // adaptive_fec_max_percentage
+
+    false,  // adaptive_bitrate
+    2000,  // adaptive_bitrate_min_kbps
+
     ENCRYPTION_MODE_NEVER,  // lan_encryption_mode
     ENCRYPTION_MODE_OPPORTUNISTIC,  // wan_encryption_mode
 
     0,  // pacing_max_bitrate_kbps (0 = legacy 1 Gbps Ethernet assumption)
     0,  // packetsize (0 = off)
+    false,  // video_broadcast_per_session
+    0,  // video_fec_pipeline_threads (0 = inline)
+    false,  // video_kernel_pacing
+    100,  // timer_spin_budget_us
+    false,  // video_io_uring_send
+    false,  // video_frame_pacing
+    75,  // video_frame_pacing_percent
+    1,  // audio_broadcast_threads
   };
 
   nvhttp_t nvhttp {
@@ -1733,6 +1760,8 @@ namespace config {
       video.sw.svtav1_preset = sw::svtav1_preset_from_view(video.sw.sw_preset);
     }
     string_f(vars, "sw_tune", video.sw.sw_tune);
+    bool_f(vars, "sw_damage_roi", video.sw.damage_roi);
+    bool_f(vars, "sw_static_frame_skip", video.sw.static_frame_skip);
 
     int_between_f(vars, "nvenc_preset", video.nv.quality_preset, {1, 7});
     int_between_f(vars, "nvenc_vbv_increase", video.nv.vbv_percentage_increase, {0, 400});
@@ -1842,6 +1871,10 @@ namespace config {
     int_between_f(vars, "rtx_hdr_peak_brightness", video.rtx_hdr.peak_brightness, {400, 2000});
 
     string_f(vars, "capture", video.capture);
+    string_restricted_f(vars, "synthetic_capture_pattern", video.synthetic.pattern, {"scrolling_text"sv, "gradient"sv, "motion"sv, "static"sv});
+    int_between_f(vars, "synthetic_capture_width", video.synthetic.width, {0, 7680});
+    int_between_f(vars, "synthetic_capture_height", video.synthetic.height, {0, 4320});
+    int_between_f(vars, "synthetic_capture_refresh_rate", video.synthetic.refresh_rate, {0, 480});
     bool_f(vars, "wgc_pacing_smoothing", video.wgc_pacing_smoothing);
     string_f(vars, "encoder", video.encoder);
     string_f(vars, "adapter_name", video.adapter_name);
@@ -2017,6 +2050,8 @@ namespace config {
     bool_f(vars, "install_steam_audio_drivers", audio.install_steam_drivers);
     bool_f(vars, "keep_sink_default", audio.keep_default);
     bool_f(vars, "auto_capture_sink", audio.auto_capture);
+    bool_f(vars, "audio_silence_detection", audio.silence_detection);
+    int_between_f(vars, "audio_encode_threads", audio.encode_threads, {1, 8});
 
     string_restricted_f(vars, "origin_web_ui_allowed", nvhttp.origin_web_ui_allowed, {"pc"sv, "lan"sv, "wan"sv});
     // reflect origin ACL update immediately in HTTP layer
@@ -2069,8 +2104,21 @@ namespace config {
 #endif
 
     int_between_f(vars, "fec_percentage", stream.fec_percentage, {1, 255});
+    bool_f(vars, "adaptive_fec", stream.adaptive_fec);
+    int_between_f(vars, "adaptive_fec_min_percentage", stream.adaptive_fec_min_percentage, {1, 255});
+    int_between_f(vars, "adaptive_fec_max_percentage", stream.adaptive_fec_max_percentage, {1, 255});
+    bool_f(vars, "adaptive_bitrate", stream.adaptive_bitrate);
+    int_between_f(vars, "adaptive_bitrate_min_kbps", stream.adaptive_bitrate_min_kbps, {500, 500000});
     int_between_f(vars, "pacing_max_bitrate_kbps", stream.pacing_max_bitrate_kbps, {0, 10000000});
     int_between_f(vars, "packetsize", stream.packetsize, {0, PACKETSIZE_MAX});
+    bool_f(vars, "video_broadcast_per_session", stream.video_broadcast_per_session);
+    int_between_f(vars, "video_fec_pipeline_threads", stream.video_fec_pipeline_threads, {0, 16});
+    bool_f(vars, "video_kernel_pacing", stream.video_kernel_pacing);
+    int_between_f(vars, "timer_spin_budget_us", stream.timer_spin_budget_us, {0, 1000});
+    bool_f(vars, "video_io_uring_send", stream.video_io_uring_send);
+    bool_f(vars, "video_frame_pacing", stream.video_frame_pacing);
+    int_between_f(vars, "video_frame_pacing_percent", stream.video_frame_pacing_percent, {10, 100});
+    int_between_f(vars, "audio_broadcast_threads", stream.audio_broadcast_threads, {1, 16});
     int_between_f(vars, "video_max_batch_size_kb", stream.video_max_batch_size_kb, {0, 64});
     if (stream.video_max_batch_size_kb == 0) {
       stream.video_max_batch_size_kb = 64;
@@ -2591,6 +2639,11 @@ namespace config {
 
         // Codec / capture negotiation
         "fec_percentage",
+        "adaptive_fec",
+        "adaptive_fec_min_percentage",
+        "adaptive_fec_max_percentage",
+        "adaptive_bitrate",
+        "adaptive_bitrate_min_kbps",
         "video_max_batch_size_kb",
         "qp",
         "min_threads",
@@ -70,6 +70,8 @@ namespace config {
       std::string sw_preset;
       std::string sw_tune;
       std::optional<int> svtav1_preset;
+      bool damage_roi;  // Hint the encoder to favor damaged regions of captured frames
+      bool static_frame_skip;  // Skip converting and encoding captured frames that didn't change
     } sw;
 
     nvenc::nvenc_config nv;
@@ -150,6 +152,15 @@ namespace config {
     } rtx_hdr;
 
     std::string capture;
+
+    // capture = synthetic (Linux): generated frames for benchmarking without a GPU or desktop
+    struct synthetic_t {
+      std::string pattern;  ///< scrolling_text, gradient, motion or static
+      int width;  ///< 0 uses the stream's width
+      int height;  ///< 0 uses the stream's height
+      int refresh_rate;  ///< 0 uses the stream's framerate
+    } synthetic;
+
     std::string encoder;
     std::string adapter_name;
     std::string adapter_pnp_id;
@@ -253,6 +264,8 @@ namespace config {
     bool install_steam_drivers;
     bool keep_default;
     bool auto_capture;
+    bool silence_detection;  // send comfort packets instead of encoding sustained digital silence
+    int encode_threads;  // threads a surround Opus frame is split across
   };
 
   constexpr int ENCRYPTION_MODE_NEVER = 0;  // Never use video encryption, even if the client supports it
@@ -267,6 +280,17 @@ namespace config {
     int fec_percentage;
     int video_max_batch_size_kb;
 
+    // Adapt each session's FEC percentage to the loss its client reports, starting
+    // from fec_percentage and staying within [min, max].
+    bool adaptive_fec;
+    int adaptive_fec_min_percentage;
+    int adaptive_fec_max_percentage;
+
+    // Lower each session's encoder bitrate when the host sees congestion and raise it
+    // back towards the negotiated bitrate once the link is clean. Never below the minimum.
+    bool adaptive_bitrate;
+    int adaptive_bitrate_min_kbps;
+
     // Video encryption settings for LAN and WAN streams
     int lan_encryption_mode;
     int wan_encryption_mode;
@@ -278,6 +302,35 @@ namespace config {
 
     // Limit the packetsize to avoid fragmentation on a low MTU link. 0 = off.
     int packetsize;
+
+    // Give each session its own video send thread so one session's pacing
+    // cannot delay another's frames. Off = single shared broadcast thread.
+    bool video_broadcast_per_session;
+
+    // Non-zero gives each video broadcast loop a thread that builds FEC and encrypted
+    // shards for the next frame while the current one is paced out. 0 = inline.
+    int video_fec_pipeline_threads;
+
+    // Stamp video batches with SO_TXTIME departure times and let the qdisc pace
+    // them (Linux with fq). Falls back to timer pacing when unsupported.
+    bool video_kernel_pacing;
+
+    // Longest the high-precision timer may spin before a deadline, in microseconds,
+    // to absorb sleep wakeup latency. 0 = sleep only.
+    int timer_spin_budget_us;
+
+    // Queue video sends on an io_uring (Linux) so a frame's batches need fewer
+    // syscalls. Falls back to send_batch() when unavailable.
+    bool video_io_uring_send;
+
+    // Spread each frame's packets over this share of the frame interval instead of
+    // sending at the pacing rate; key frames may borrow from later frames.
+    bool video_frame_pacing;
+    int video_frame_pacing_percent;
+
+    // Threads that send audio, with sessions spread across them. Each thread sends
+    // the packets it has queued, FEC parity included, with as few syscalls as possible.
+    int audio_broadcast_threads;
   };
 
   struct nvhttp_t {
@@ -735,6 +735,24 @@ namespace confighttp {
     output["client_reported_losses"] = info.client_reported_losses;
     output["encode_latency_ms"] = round_to(info.encode_latency_ms, 10.0);
     output["last_frame_index"] = info.last_frame_index;
+    output["video_queue_latency_ms"] = round_to(info.video_queue_latency_ms, 100.0);
+    output["video_send_latency_ms"] = round_to(info.video_send_latency_ms, 100.0);
+    output["fec_percentage"] = info.fec_percentage;
+    output["pacing_mode"] = info.pacing_mode;
+    output["pacing_budget_ms"] = round_to(info.pacing_budget_ms, 100.0);
+    output["pacing_spread_ms"] = round_to(info.pacing_spread_ms, 100.0);
+    output["pacing_backlog_ms"] = round_to(info.pacing_backlog_ms, 100.0);
+    output["audio_send_syscalls"] = info.audio_send_syscalls;
+    output["audio_send_syscalls_per_second"] = round_to(info.audio_send_syscalls_per_second, 10.0);
+    output["audio_capture_latency_ms"] = round_to(info.audio_capture_latency_ms, 100.0);
+    output["audio_active_seconds"] = round_to(info.audio_active_seconds, 10.0);
+    output["audio_idle_seconds"] = round_to(info.audio_idle_seconds, 10.0);
+    output["audio_active_encode_ms_per_minute"] = round_to(info.audio_active_encode_ms_per_minute, 10.0);
+    output["audio_idle_encode_ms_per_minute"] = round_to(info.audio_idle_encode_ms_per_minute, 10.0);
+    output["audio_active_bytes_per_minute"] = std::llround(info.audio_active_bytes_per_minute);
+    output["audio_idle_bytes_per_minute"] = std::llround(info.audio_idle_bytes_per_minute);
+    output["video_static_skipped"] = info.video_static_skipped;
+    output["video_static_refreshes"] = info.video_static_refreshes;
     output["uptime_seconds"] = round_to(info.uptime_seconds, 10.0);
     return output;
   }
@@ -779,6 +797,28 @@ namespace confighttp {
     return output;
   }
 
+  nlohmann::json timer_overshoot_to_json(const platf::timer_overshoot_histogram_t &histogram) {
+    nlohmann::json output;
+    output["samples"] = histogram.samples;
+    output["mean_us"] = histogram.samples > 0
+                          ? std::chrono::duration<double, std::micro>(histogram.total_overshoot).count() / histogram.samples
+                          : 0.0;
+    output["max_us"] = std::chrono::duration<double, std::micro>(histogram.max_overshoot).count();
+    output["buckets"] = nlohmann::json::array();
+    for (std::size_t x = 0; x < histogram.counts.size(); ++x) {
+      nlohmann::json bucket;
+      // The overflow bucket has no upper bound
+      if (x < histogram.bucket_limits.size()) {
+        bucket["le_us"] = histogram.bucket_limits[x].count();
+      } else {
+        bucket["le_us"] = nullptr;
+      }
+      bucket["count"] = histogram.counts[x];
+      output["buckets"].push_back(std::move(bucket));
+    }
+    return output;
+  }
+
   nlohmann::json session_summary_to_json(const session_history::session_summary_t &summary) {
     nlohmann::json output;
     output["uuid"] = summary.uuid;
@@ -820,6 +860,7 @@ namespace confighttp {
     output["idr_requests"] = sample.idr_requests;
     output["ref_invalidations"] = sample.ref_invalidations;
     output["encode_latency_ms"] = round_to(sample.encode_latency_ms, 10.0);
+    output["fec_percentage"] = sample.fec_percentage;
     output["actual_fps"] = round_to(sample.actual_fps, 10.0);
     output["actual_bitrate_kbps"] = round_to(sample.actual_bitrate_kbps, 10.0);
     output["frame_interval_jitter_ms"] = round_to(sample.frame_interval_jitter_ms, 100.0);
@@ -3255,7 +3296,9 @@ namespace confighttp {
     }
     print_req(request);
 
-    send_response(response, host_stats_to_json(host_stats::latest()));
+    auto output = host_stats_to_json(host_stats::latest());
+    output["timer_overshoot"] = timer_overshoot_to_json(platf::high_precision_timer_overshoot());
+    send_response(response, output);
   }
 
   // Static host info â€” model strings + total RAM/VRAM, sampled once.
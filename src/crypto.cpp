@@ -2,6 +2,9 @@
  * @file src/crypto.cpp
  * @brief Definitions for cryptography functions.
  */
+// standard includes
+#include <cstring>
+
 // lib includes
 #include <openssl/pem.h>
 #include <openssl/rsa.h>
@@ -238,6 +241,83 @@ namespace crypto {
       return encrypt(plaintext, tagged_cipher, tagged_cipher + tag_size, iv);
     }
 
+    /**
+     * GCM is a stream mode, so feeding the two parts through separate EVP_EncryptUpdate() calls
+     * produces the same ciphertext and tag as encrypting their concatenation. This lets callers
+     * encrypt a header and a payload that live in different buffers without joining them first.
+     */
+    static int encrypt_gcm_parts(EVP_CIPHER_CTX *ctx, const std::uint8_t *iv, const std::string_view &head, std::uint8_t *head_cipher, const std::string_view &body, std::uint8_t *body_cipher, std::uint8_t *tag) {
+      // Calling with cipher == nullptr results in a parameter change
+      // without requiring a reallocation of the internal cipher ctx.
+      if (EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) != 1) {
+        return -1;
+      }
+
+      int head_outlen = 0;
+      int body_outlen = 0;
+      int final_outlen;
+
+      if (!head.empty() && EVP_EncryptUpdate(ctx, head_cipher, &head_outlen, (const std::uint8_t *) head.data(), (int) head.size()) != 1) {
+        return -1;
+      }
+
+      if (!body.empty() && EVP_EncryptUpdate(ctx, body_cipher, &body_outlen, (const std::uint8_t *) body.data(), (int) body.size()) != 1) {
+        return -1;
+      }
+
+      // GCM encryption won't ever fill ciphertext here but we have to call it anyway
+      auto *final_cipher = body.empty() ? head_cipher + head_outlen : body_cipher + body_outlen;
+      if (EVP_EncryptFinal_ex(ctx, final_cipher, &final_outlen) != 1) {
+        return -1;
+      }
+
+      if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, tag_size, tag) != 1) {
+        return -1;
+      }
+
+      return head_outlen + body_outlen + final_outlen;
+    }
+
+    int gcm_t::encrypt(const std::string_view &head, std::uint8_t *head_cipher, const std::string_view &body, std::uint8_t *body_cipher, std::uint8_t *tag, aes_t *iv) {
+      if (!encrypt_ctx && init_encrypt_gcm(encrypt_ctx, &key, iv, padding)) {
+        return -1;
+      }
+
+      return encrypt_gcm_parts(encrypt_ctx.get(), iv->data(), head, head_cipher, body, body_cipher, tag);
+    }
+
+    /**
+     * OpenSSL exposes no multi-buffer mode for AES-GCM through EVP, and its GCM kernel already
+     * interleaves AES-NI/VAES rounds with the GHASH of each message. The batch therefore runs
+     * every message through one context back to back, building each IV in place rather than
+     * round-tripping it through an aes_t, so the key schedule and GHASH tables stay hot.
+     */
+    int gcm_t::encrypt_batch(const batch_item_t *items, std::size_t count, std::uint64_t &iv_counter, std::uint8_t iv_fixed) {
+      std::array<std::uint8_t, 12> iv {};
+      iv[11] = iv_fixed;
+
+      if (!encrypt_ctx) {
+        aes_t initial_iv(iv.size());
+        if (init_encrypt_gcm(encrypt_ctx, &key, &initial_iv, padding)) {
+          return -1;
+        }
+      }
+
+      for (std::size_t i = 0; i < count; ++i) {
+        auto &item = items[i];
+
+        std::memcpy(iv.data(), &iv_counter, sizeof(iv_counter));
+        if (encrypt_gcm_parts(encrypt_ctx.get(), iv.data(), item.head, item.head_cipher, item.body, item.body_cipher, item.tag) < 0) {
+          return -1;
+        }
+        std::copy(std::begin(iv), std::end(iv), item.iv);
+
+        ++iv_counter;
+      }
+
+      return 0;
+    }
+
     int ecb_t::decrypt(const std::string_view &cipher, std::vector<std::uint8_t> &plaintext) {
       auto fg = util::fail_guard([this]() {
         EVP_CIPHER_CTX_reset(decrypt_ctx.get());
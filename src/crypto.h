@@ -219,6 +219,45 @@ namespace crypto {
        */
       int encrypt(const std::string_view &plaintext, std::uint8_t *tagged_cipher, aes_t *iv);
 
+      /**
+       * @brief Encrypts a plaintext made of two discontiguous parts as a single GCM message.
+       * @param head The first part of the plaintext.
+       * @param head_cipher The buffer where the ciphertext of head will be written. May alias head.
+       * @param body The second part of the plaintext.
+       * @param body_cipher The buffer where the ciphertext of body will be written. May alias body.
+       * @param tag The buffer where the GCM tag will be written.
+       * @param iv The initialization vector to be used for the encryption.
+       * @return The total length of the ciphertext. Returns -1 in case of an error.
+       */
+      int encrypt(const std::string_view &head, std::uint8_t *head_cipher, const std::string_view &body, std::uint8_t *body_cipher, std::uint8_t *tag, aes_t *iv);
+
+      /**
+       * @brief One message of a batch encryption.
+       * @details The plaintext is the concatenation of head and body. Either part may be empty,
+       *          and each cipher buffer may alias its plaintext to encrypt in place.
+       */
+      struct batch_item_t {
+        std::string_view head;
+        std::uint8_t *head_cipher;
+        std::string_view body;
+        std::uint8_t *body_cipher;
+        std::uint8_t *tag;  // receives the tag_size byte GCM tag
+        std::uint8_t *iv;  // receives the 12 byte IV the message was encrypted with
+      };
+
+      /**
+       * @brief Encrypts a batch of messages with sequential deterministic IVs.
+       * @details Message i uses the IV [iv_counter + i in host byte order][0][0][iv_fixed], the
+       *          construction from NIST SP 800-38D Section 8.2.1 with the counter as the
+       *          invocation field. iv_counter is advanced past every message that was encrypted.
+       * @param items The messages to encrypt.
+       * @param count The number of messages.
+       * @param iv_counter The invocation counter of the first message.
+       * @param iv_fixed The fixed field identifying this use of the key.
+       * @return 0 on success. Returns -1 in case of an error.
+       */
+      int encrypt_batch(const batch_item_t *items, std::size_t count, std::uint64_t &iv_counter, std::uint8_t iv_fixed);
+
       int decrypt(const std::string_view &cipher, std::vector<std::uint8_t> &plaintext, aes_t *iv);
     };
 
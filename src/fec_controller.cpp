@@ -0,0 +1,158 @@
+/**
+ * @file src/fec_controller.cpp
+ * @brief Per-session FEC percentage driven by client loss reports.
+ */
+#include "fec_controller.h"
+
+#include "rs_cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std::literals;
+
+namespace stream {
+  namespace {
+    // Parity points added per percent of packet loss, leaving room for bursts within a block
+    constexpr double LOSS_HEADROOM = 3.0;
+
+    // Time for a reported loss rate to lose half its weight
+    constexpr auto LOSS_HALF_LIFE = 500ms;
+
+    // Loss rates below this are forgotten, so a clean link can return to the minimum
+    constexpr double MIN_LOSS_PERCENT = 0.1;
+
+    // Parity points added each report interval that saw a recovery request or a stall
+    constexpr double RECOVERY_STEP = 10.0;
+
+    // A stall is the client not completing a frame while this many newer ones were sent
+    constexpr std::int64_t STALL_FRAMES = 4;
+
+    // Clean time before parity starts dropping, and the rate it drops at afterwards
+    constexpr auto CLEAN_HOLD = 2s;
+    constexpr auto LOWER_POINT_INTERVAL = 200ms;
+
+    // Without a loss report for this long, ticks update the controller instead
+    constexpr auto REPORT_TIMEOUT = 250ms;
+
+    // Published percentages are multiples of this so FEC block geometries, and the
+    // Reed-Solomon contexts cached for them, stay few
+    constexpr int PERCENTAGE_STEP = 5;
+  }  // namespace
+
+  int frame_fec_percentage(int fec_percentage, std::size_t data_shards) {
+    auto fits = [&](int percentage) {
+      return fec::max_data_shards_per_block(percentage) * MAX_FEC_BLOCKS >= data_shards;
+    };
+
+    if (data_shards == 0 || fits(fec_percentage)) {
+      return fec_percentage;
+    }
+    if (!fits(0)) {
+      return 0;
+    }
+
+    // D = 255 / (1 + F) per block, so F <= 100 * 255 * blocks / shards - 100
+    auto percentage = std::clamp<int>((int) ((100 * 255 * MAX_FEC_BLOCKS) / data_shards) - 100, 0, fec_percentage);
+    while (percentage > 0 && !fits(percentage)) {
+      --percentage;
+    }
+    return percentage;
+  }
+
+  fec_controller_t::fec_controller_t(int initial_percentage, int min_percentage, int max_percentage):
+      min_ {min_percentage},
+      max_ {std::max(min_percentage, max_percentage)},
+      level_ {(double) std::clamp(initial_percentage, min_, max_)},
+      percentage_ {std::clamp(initial_percentage, min_, max_)} {
+  }
+
+  void fec_controller_t::on_loss_report(std::int64_t lost_packets, std::chrono::milliseconds elapsed, std::int64_t last_good_frame, std::uint64_t packets_sent, std::int64_t last_sent_frame) {
+    elapsed = std::max(elapsed, 0ms);
+    lost_packets = std::max<std::int64_t>(lost_packets, 0);
+
+    auto sent = packets_sent >= last_packets_sent_ ? packets_sent - last_packets_sent_ : 0;
+    last_packets_sent_ = packets_sent;
+
+    // Count a stall once, when the client stops completing frames the host keeps sending
+    bool stall = false;
+    if (last_good_frame != last_good_frame_) {
+      last_good_frame_ = last_good_frame;
+      stalled_ = false;
+    } else if (!stalled_ && last_sent_frame - last_good_frame >= STALL_FRAMES) {
+      stalled_ = true;
+      stall = true;
+    }
+
+    // Parity packets can be lost too, so the loss rate covers every packet sent
+    auto loss_percent = 0.0;
+    if (sent > 0 && lost_packets > 0) {
+      loss_percent = 100.0 * (double) lost_packets / (double) (sent + lost_packets);
+    }
+
+    since_report_ = 0ms;
+    step(elapsed, loss_percent, lost_packets > 0, stall);
+  }
+
+  void fec_controller_t::on_recovery_request() {
+    ++recovery_requests_;
+  }
+
+  void fec_controller_t::tick(std::chrono::milliseconds elapsed) {
+    // Clients that send periodic pings instead of loss reports still ask for recovery
+    since_report_ += std::max(elapsed, 0ms);
+    if (since_report_ >= REPORT_TIMEOUT) {
+      step(elapsed, 0, false, false);
+    }
+  }
+
+  int fec_controller_t::percentage() const {
+    return percentage_.load(std::memory_order_relaxed);
+  }
+
+  void fec_controller_t::step(std::chrono::milliseconds elapsed, double loss_percent, bool lost, bool stall) {
+    elapsed = std::max(elapsed, 0ms);
+
+    const auto decay = std::exp2(-std::chrono::duration<double>(elapsed) / LOSS_HALF_LIFE);
+    loss_percent_ *= decay;
+    if (loss_percent_ < MIN_LOSS_PERCENT) {
+      loss_percent_ = 0;
+    }
+    loss_percent_ = std::max(loss_percent_, loss_percent);
+
+    const bool recovery = recovery_requests_ > 0 || stall;
+    recovery_requests_ = 0;
+
+    if (lost || recovery) {
+      clean_ = 0ms;
+    } else {
+      clean_ += elapsed;
+    }
+
+    const double headroom = max_ - min_;
+    if (recovery) {
+      boost_ = std::min(boost_ + RECOVERY_STEP, headroom);
+    }
+
+    auto lowered = 0.0;
+    if (clean_ >= CLEAN_HOLD) {
+      lowered = std::chrono::duration<double>(elapsed) / LOWER_POINT_INTERVAL;
+      boost_ = std::max(boost_ - lowered, 0.0);
+    }
+
+    // Raise straight to the target, but only walk down once the link has stayed clean
+    auto target = std::min(min_ + loss_percent_ * LOSS_HEADROOM + boost_, (double) max_);
+    if (target >= level_) {
+      level_ = target;
+    } else {
+      level_ = std::max(level_ - lowered, target);
+    }
+
+    publish();
+  }
+
+  void fec_controller_t::publish() {
+    auto quantized = (int) std::ceil(level_ / PERCENTAGE_STEP - 1e-9) * PERCENTAGE_STEP;
+    percentage_.store(std::clamp(quantized, min_, max_), std::memory_order_relaxed);
+  }
+}  // namespace stream
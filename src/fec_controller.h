@@ -0,0 +1,89 @@
+/**
+ * @file src/fec_controller.h
+ * @brief Per-session FEC percentage driven by client loss reports.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace stream {
+  // There are 2 bits for FEC block count for a maximum of 4 FEC blocks
+  constexpr std::size_t MAX_FEC_BLOCKS = 4;
+
+  /**
+   * @brief Highest FEC percentage up to `fec_percentage` at which a frame fits the protocol.
+   * @details A frame may span at most MAX_FEC_BLOCKS blocks of 255 data and parity shards.
+   *          Large frames get less parity rather than none at all.
+   * @return The percentage to use, or 0 if the frame does not fit even without parity.
+   */
+  int frame_fec_percentage(int fec_percentage, std::size_t data_shards);
+
+  /**
+   * @brief Adapts a session's FEC percentage to the loss its client reports.
+   * @details Parity rises as soon as the client reports packet loss, asks for an IDR frame,
+   *          invalidates reference frames or stops completing frames, and falls back slowly
+   *          once the link has been clean for a while. The result stays within the operator's
+   *          bounds. Updates come from the control thread; percentage() may be read from any thread.
+   */
+  class fec_controller_t {
+  public:
+    /**
+     * @param initial_percentage Percentage used until the first loss report.
+     * @param min_percentage Lowest percentage the controller may choose.
+     * @param max_percentage Highest percentage the controller may choose.
+     */
+    fec_controller_t(int initial_percentage, int min_percentage, int max_percentage);
+
+    /**
+     * @brief Feed an IDX_LOSS_STATS report.
+     * @param lost_packets Packets the client lost since its previous report.
+     * @param elapsed Time the client says passed since its previous report.
+     * @param last_good_frame Last frame the client received intact.
+     * @param packets_sent Video packets sent to the client so far, including parity.
+     * @param last_sent_frame Last frame index sent to the client.
+     */
+    void on_loss_report(std::int64_t lost_packets, std::chrono::milliseconds elapsed, std::int64_t last_good_frame, std::uint64_t packets_sent, std::int64_t last_sent_frame);
+
+    /**
+     * @brief Note an IDR request or reference frame invalidation from the client.
+     * @details Either means FEC failed to recover a frame. Applied with the next loss report or tick.
+     */
+    void on_recovery_request();
+
+    /**
+     * @brief Advance the controller while the client sends no loss reports.
+     * @details Newer clients send periodic pings instead of IDX_LOSS_STATS. Once no report has
+     *          arrived for a while, ticks apply recovery requests and lower parity on clean links.
+     * @param elapsed Time since the previous tick.
+     */
+    void tick(std::chrono::milliseconds elapsed);
+
+    /**
+     * @brief The FEC percentage for the next frame.
+     */
+    int percentage() const;
+
+  private:
+    void step(std::chrono::milliseconds elapsed, double loss_percent, bool lost, bool stall);
+    void publish();
+
+    int min_;
+    int max_;
+
+    double level_;  // unquantized percentage
+    double loss_percent_ = 0;  // decaying peak of the reported packet loss
+    double boost_ = 0;  // extra points added after recovery requests and stalls
+    std::chrono::milliseconds clean_ {0};  // time since loss or a recovery request was last seen
+    std::chrono::milliseconds since_report_ {0};
+
+    std::uint64_t last_packets_sent_ = 0;
+    std::int64_t last_good_frame_ = 0;
+    bool stalled_ = false;
+    int recovery_requests_ = 0;
+
+    std::atomic<int> percentage_;
+  };
+}  // namespace stream
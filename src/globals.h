@@ -7,6 +7,7 @@
 // local includes
 #include "entry_handler.h"
 #include "thread_pool.h"
+#include "thread_safe.h"
 
 /**
  * @brief A thread pool for processing tasks.
@@ -28,12 +29,44 @@ extern bool display_cursor;
 extern nvprefs::nvprefs_interface nvprefs_instance;
 #endif
 
+namespace input {
+  struct touch_port_t;
+}  // namespace input
+
+namespace platf {
+  struct gamepad_feedback_msg_t;
+}  // namespace platf
+
+namespace video {
+  struct hdr_info_raw_t;
+}  // namespace video
+
 /**
  * @brief Handles process-wide communication.
  */
 namespace mail {
-#define MAIL(x) \
-  constexpr auto x = std::string_view { \
+  /**
+   * @brief The slot each channel has in safe::mail_raw_t.
+   */
+  enum class id_e : std::size_t {
+    shutdown,
+    broadcast_shutdown,
+    video_packets,  ///< Resolved with video::packet_queue()
+    audio_packets,  ///< Resolved with audio::packet_queue()
+    switch_display,
+    touch_port,
+    idr,
+    invalidate_ref_frames,
+    gamepad_feedback,
+    hdr,
+    dynamic_bitrate,
+    count
+  };
+  static_assert((std::size_t) id_e::count <= safe::mail_raw_t::max_channels);
+
+#define MAIL(x, ...) \
+  constexpr safe::channel_t<__VA_ARGS__> x { \
+    (std::size_t) id_e::x, \
     #x \
   }
 
@@ -43,19 +76,17 @@ namespace mail {
   extern safe::mail_t man;
 
   // Global mail
-  MAIL(shutdown);
-  MAIL(broadcast_shutdown);
-  MAIL(video_packets);
-  MAIL(audio_packets);
-  MAIL(switch_display);
+  MAIL(shutdown, safe::event_t<bool>);
+  MAIL(broadcast_shutdown, safe::event_t<bool>);
+  MAIL(switch_display, safe::event_t<int>);
 
   // Local mail
-  MAIL(touch_port);
-  MAIL(idr);
-  MAIL(invalidate_ref_frames);
-  MAIL(gamepad_feedback);
-  MAIL(hdr);
-  MAIL(dynamic_bitrate);  // Runtime encoder bitrate change (kbps), posted from the HTTP /bitrate handler
+  MAIL(touch_port, safe::event_t<input::touch_port_t>);
+  MAIL(idr, safe::event_t<bool>);
+  MAIL(invalidate_ref_frames, safe::event_t<std::pair<int64_t, int64_t>>);
+  MAIL(gamepad_feedback, safe::queue_t<platf::gamepad_feedback_msg_t>);
+  MAIL(hdr, safe::event_t<std::unique_ptr<video::hdr_info_raw_t>>);  // video::hdr_info_t
+  MAIL(dynamic_bitrate, safe::event_t<int>);  // Runtime encoder bitrate change (kbps), posted from the HTTP /bitrate handler
 #undef MAIL
 
 }  // namespace mail
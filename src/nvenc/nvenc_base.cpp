@@ -898,7 +898,7 @@ namespace nvenc {
                     << " nits, MaxFALL " << metadata.maxFrameAverageLightLevel << " nits)";
   }
 
-  nvenc_encoded_frame nvenc_base::encode_frame(uint64_t frame_index, bool force_idr) {
+  nvenc_encoded_frame nvenc_base::encode_frame(uint64_t frame_index, bool force_idr, std::vector<uint8_t> buffer) {
     if (!encoder) {
       return {};
     }
@@ -1003,8 +1003,9 @@ namespace nvenc {
     }
 
     auto data_pointer = (uint8_t *) lock_bitstream.bitstreamBufferPtr;
+    buffer.assign(data_pointer, data_pointer + lock_bitstream.bitstreamSizeInBytes);
     nvenc_encoded_frame encoded_frame {
-      {data_pointer, data_pointer + lock_bitstream.bitstreamSizeInBytes},
+      std::move(buffer),
       lock_bitstream.outputTimeStamp,
       lock_bitstream.pictureType == NV_ENC_PIC_TYPE_IDR,
       encoder_state.rfi_needs_confirmation,
@@ -67,9 +67,10 @@ namespace nvenc {
      *        Afterwards serves as parameter for `invalidate_ref_frames()`.
      *        No restrictions on the first frame index, but later frame indexes must be subsequent.
      * @param force_idr Whether to encode frame as forced IDR.
+     * @param buffer Storage to copy the bitstream into, so its capacity can be reused.
      * @return Encoded frame.
      */
-    nvenc_encoded_frame encode_frame(uint64_t frame_index, bool force_idr);
+    nvenc_encoded_frame encode_frame(uint64_t frame_index, bool force_idr, std::vector<uint8_t> buffer = {});
 
     /**
      * @brief Perform reference frame invalidation (RFI) procedure.
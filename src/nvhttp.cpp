@@ -4383,10 +4383,21 @@ namespace nvhttp {
       return;
     }
 
-    // Server-side adaptive bitrate decisioning is not implemented. Reporting it unsupported makes
-    // Foundation-compatible clients (e.g. Moonlight V+) drive their own local ABR controller, which
-    // applies decisions through the runtime /bitrate endpoint above.
-    const std::string body = R"({"supported":false,"version":1,"features":["runtime_bitrate"]})";
+    // Response fields:
+    //   supported        true when the host adapts the bitrate itself (adaptive_bitrate), so
+    //                    Foundation-compatible clients (e.g. Moonlight V+) should not run their
+    //                    own ABR controller. When false, clients drive /bitrate themselves.
+    //   version          version of this response format
+    //   features         "runtime_bitrate": /bitrate is available and sets the ceiling the
+    //                    host adapts under; "server_abr": the host adapts the bitrate
+    //   min_bitrate_kbps lowest bitrate the host adapts down to, only when supported
+    std::string body;
+    if (config::stream.adaptive_bitrate) {
+      body = R"({"supported":true,"version":1,"features":["runtime_bitrate","server_abr"],"min_bitrate_kbps":)" +
+             std::to_string(config::stream.adaptive_bitrate_min_kbps) + "}";
+    } else {
+      body = R"({"supported":false,"version":1,"features":["runtime_bitrate"]})";
+    }
     SimpleWeb::CaseInsensitiveMultimap headers;
     headers.emplace("Content-Type", "application/json");
     response->write(SimpleWeb::StatusCode::success_ok, body, headers);
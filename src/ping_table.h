@@ -0,0 +1,179 @@
+/**
+ * @file src/ping_table.h
+ * @brief Allocation-free lookup of the session a video or audio PING belongs to.
+ */
+#pragma once
+
+// standard includes
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// lib includes
+#include <boost/asio/ip/address.hpp>
+
+namespace stream {
+  /**
+   * @brief Identifies a session by its PING payload, or by address for legacy clients.
+   */
+  struct ping_key_t {
+    enum class kind_e : std::uint8_t {
+      payload,  ///< SS_PING payload negotiated in the RTSP handshake
+      address,  ///< Client address, for clients that send the legacy "PING"
+    };
+
+    static constexpr std::size_t payload_size = 16;
+
+    kind_e kind;
+    std::array<std::uint8_t, payload_size> bytes;
+
+    /**
+     * @brief Key for a PING payload. Longer payloads are cut and shorter ones zero padded.
+     */
+    static ping_key_t from_payload(std::string_view payload) {
+      ping_key_t key {kind_e::payload, {}};
+      std::memcpy(key.bytes.data(), payload.data(), std::min(payload.size(), payload_size));
+      return key;
+    }
+
+    /**
+     * @brief Key for a client address. IPv4 addresses use their IPv4-mapped IPv6 form.
+     */
+    static ping_key_t from_address(const boost::asio::ip::address &address) {
+      auto v6 = address.is_v4() ?
+                  boost::asio::ip::make_address_v6(boost::asio::ip::v4_mapped, address.to_v4()) :
+                  address.to_v6();
+      return {kind_e::address, v6.to_bytes()};
+    }
+
+    bool operator==(const ping_key_t &other) const = default;
+  };
+
+  /**
+   * @brief Open-addressing hash table from ping_key_t to a session's value.
+   * @details The receive thread looks up every datagram the video and audio sockets get, and
+   *          clients keep pinging for the whole stream, so find() neither allocates nor follows
+   *          pointers. Insertions and removals only happen when sessions start and stop.
+   *          Not thread safe.
+   */
+  template<class T>
+  class ping_table_t {
+  public:
+    ping_table_t():
+        slots(min_capacity) {
+    }
+
+    /**
+     * @brief Add a key, or replace the value of a key already present.
+     */
+    void insert_or_assign(const ping_key_t &key, T value) {
+      if ((count + 1) * 2 > slots.size()) {
+        grow();
+      }
+
+      auto index = home(key);
+      while (slots[index].used) {
+        if (slots[index].key == key) {
+          slots[index].value = std::move(value);
+          return;
+        }
+        index = next(index);
+      }
+
+      slots[index] = {true, key, std::move(value)};
+      ++count;
+    }
+
+    /**
+     * @brief Remove a key if present.
+     */
+    void erase(const ping_key_t &key) {
+      auto index = home(key);
+      while (slots[index].used) {
+        if (slots[index].key == key) {
+          break;
+        }
+        index = next(index);
+      }
+      if (!slots[index].used) {
+        return;
+      }
+
+      // Backward shift deletion keeps every probe sequence unbroken without tombstones
+      auto hole = index;
+      for (auto probe = next(hole); slots[probe].used; probe = next(probe)) {
+        auto ideal = home(slots[probe].key);
+        if (distance(ideal, probe) >= distance(hole, probe)) {
+          slots[hole] = std::move(slots[probe]);
+          hole = probe;
+        }
+      }
+      slots[hole] = {};
+      --count;
+    }
+
+    /**
+     * @return The value for the key, or nullptr if absent.
+     */
+    T *find(const ping_key_t &key) {
+      for (auto index = home(key); slots[index].used; index = next(index)) {
+        if (slots[index].key == key) {
+          return &slots[index].value;
+        }
+      }
+      return nullptr;
+    }
+
+    std::size_t size() const {
+      return count;
+    }
+
+  private:
+    static constexpr std::size_t min_capacity = 16;
+
+    struct slot_t {
+      bool used = false;
+      ping_key_t key {};
+      T value {};
+    };
+
+    static std::uint64_t hash(const ping_key_t &key) {
+      // FNV-1a: payloads are random client-chosen bytes, so a simple hash spreads them well
+      std::uint64_t h = 0xcbf29ce484222325ull ^ (std::uint64_t) key.kind;
+      for (auto byte : key.bytes) {
+        h = (h ^ byte) * 0x100000001b3ull;
+      }
+      return h;
+    }
+
+    std::size_t home(const ping_key_t &key) const {
+      return hash(key) & (slots.size() - 1);
+    }
+
+    std::size_t next(std::size_t index) const {
+      return (index + 1) & (slots.size() - 1);
+    }
+
+    std::size_t distance(std::size_t from, std::size_t to) const {
+      return (to - from) & (slots.size() - 1);
+    }
+
+    void grow() {
+      std::vector<slot_t> old(slots.size() * 2);
+      old.swap(slots);
+      count = 0;
+      for (auto &slot : old) {
+        if (slot.used) {
+          insert_or_assign(slot.key, std::move(slot.value));
+        }
+      }
+    }
+
+    std::vector<slot_t> slots;
+    std::size_t count = 0;
+  };
+}  // namespace stream
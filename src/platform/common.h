@@ -6,6 +6,7 @@
 
 // standard includes
 #include <bitset>
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <functional>
@@ -13,6 +14,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 // lib includes
 #include <boost/core/noncopyable.hpp>
@@ -26,6 +28,7 @@
 #include "src/host_stats_types.h"
 #include "src/logging.h"
 #include "src/thread_safe.h"
+#include "src/timer_stats_types.h"
 #include "src/utility.h"
 #include "src/video_colorspace.h"
 
@@ -357,6 +360,35 @@ namespace platf {
     virtual ~deinit_t() = default;
   };
 
+  /**
+   * @brief A region of a captured image, in pixels.
+   */
+  struct damage_rect_t {
+    std::int32_t x;
+    std::int32_t y;
+    std::int32_t width;
+    std::int32_t height;
+  };
+
+  using damage_t = std::optional<std::vector<damage_rect_t>>;
+
+  /**
+   * @brief Add the damage of one image to what has built up, as long as it stays small.
+   * @details Unknown damage on either side makes the sum unknown, meaning anything may have changed.
+   */
+  inline void accumulate_damage(damage_t &sum, const damage_t &damage, std::size_t max_rects = 64) {
+    if (!sum) {
+      return;
+    }
+
+    if (!damage || sum->size() + damage->size() > max_rects) {
+      sum.reset();
+      return;
+    }
+
+    sum->insert(sum->end(), damage->begin(), damage->end());
+  }
+
   struct img_t: std::enable_shared_from_this<img_t> {
   public:
     img_t() = default;
@@ -372,6 +404,13 @@ namespace platf {
     std::int32_t pixel_pitch {};
     std::int32_t row_pitch {};
 
+    // Numbers the images of one capture from 1, so a consumer can tell whether it saw the previous
+    // one. Zero when the capture doesn't number them.
+    std::uint64_t capture_sequence {};
+
+    // What changed since the previous image of the capture, or std::nullopt when anything may have
+    damage_t damage;
+
     std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
     std::optional<std::chrono::steady_clock::time_point> host_processing_timestamp;
     std::optional<std::chrono::steady_clock::time_point> capture_pacing_timestamp;
@@ -436,6 +475,13 @@ namespace platf {
       return -1;
     }
 
+    /**
+     * @brief Called instead of convert() for an image with the same pixels as the last one converted.
+     */
+    virtual void skip(const platf::img_t &img) {
+      (void) img;
+    }
+
     virtual void apply_colorspace() {
     }
 
@@ -771,7 +817,7 @@ namespace platf {
     const char *headers;
     size_t header_size;
 
-    // One or more data buffers to use for the payloads
+    // One or more data buffers to use for the payloads, unless payload_pointers is set
     //
     // NB: Data buffers must be aligned to payload size!
     std::vector<buffer_descriptor_t> &payload_buffers;
@@ -789,6 +835,26 @@ namespace platf {
     uint16_t target_port;
     boost::asio::ip::address &source_address;
 
+    // Optional scatter-gather payloads, one pointer per message block. When set,
+    // each block's payload is read from here instead of from payload_buffers.
+    const char *const *payload_pointers = nullptr;
+
+    // Optional departure time for the batch. Only honored on sockets where
+    // enable_socket_txtime() succeeded; the kernel then releases the packets.
+    std::optional<std::chrono::steady_clock::time_point> departure_time;
+
+    /**
+     * @brief Returns the payload of the given message block.
+     * @param block The block index (including block_offset).
+     * @return Pointer to payload_size bytes of payload.
+     */
+    const char *payload_for_block(size_t block) {
+      if (payload_pointers) {
+        return payload_pointers[block];
+      }
+      return buffer_for_payload_offset(block * payload_size).buffer;
+    }
+
     /**
      * @brief Returns a payload buffer descriptor for the given payload offset.
      * @param offset The offset in the total payload data (bytes).
@@ -811,6 +877,81 @@ namespace platf {
 
   bool send_batch(batched_send_info_t &send_info);
 
+  /**
+   * @brief Sends batches asynchronously, reading their buffers after send() returns.
+   * @details Batches are queued by send() and handed to the kernel by submit(). The headers
+   *          and payloads of a batch must stay valid until a fence() taken after it completes.
+   */
+  class async_batch_sender_t: private boost::noncopyable {
+  public:
+    virtual ~async_batch_sender_t() = default;
+
+    /**
+     * @brief Queue a batch.
+     * @param send_info The batch. Only the buffers it points to must outlive the call.
+     * @return false if the batch was not queued and should be sent with send_batch().
+     */
+    virtual bool send(batched_send_info_t &send_info) = 0;
+
+    /**
+     * @brief Hand every queued batch to the kernel without waiting for it to be sent.
+     */
+    virtual void submit() = 0;
+
+    /**
+     * @brief Mark the batches queued so far.
+     * @return A ticket for completed().
+     */
+    virtual std::uint64_t fence() = 0;
+
+    /**
+     * @brief Check whether every batch queued before a fence is done with its buffers.
+     * @param ticket A ticket returned by fence().
+     * @param wait Block until it is.
+     * @return true once the buffers may be released.
+     */
+    virtual bool completed(std::uint64_t ticket, bool wait) = 0;
+  };
+
+  /**
+   * @brief Create the platform's asynchronous batch sender.
+   * @return The sender, or nullptr if the platform only supports send_batch().
+   */
+  std::unique_ptr<async_batch_sender_t> create_async_batch_sender();
+
+  /**
+   * @brief Receives several datagrams with one system call into preallocated buffers.
+   */
+  class batched_receiver_t: private boost::noncopyable {
+  public:
+    virtual ~batched_receiver_t() = default;
+
+    /**
+     * @brief Receive the datagrams already queued on a socket, without waiting for more.
+     * @param native_socket The native socket handle.
+     * @return Datagrams received, 0 if none were queued, or -1 on error.
+     */
+    virtual int receive(std::uintptr_t native_socket) = 0;
+
+    /**
+     * @brief Payload of a datagram from the last receive(), valid until the next one.
+     */
+    virtual std::string_view data(std::size_t index) const = 0;
+
+    /**
+     * @brief Sender of a datagram from the last receive().
+     */
+    virtual boost::asio::ip::udp::endpoint peer(std::size_t index) const = 0;
+  };
+
+  /**
+   * @brief Create the platform's batched receiver.
+   * @param count Datagrams received per call.
+   * @param buffer_size Bytes kept per datagram; longer datagrams are truncated.
+   * @return The receiver, or nullptr if the platform receives one datagram at a time.
+   */
+  std::unique_ptr<batched_receiver_t> create_batched_receiver(std::size_t count, std::size_t buffer_size);
+
   struct send_info_t {
     const char *header;
     size_t header_size;
@@ -825,6 +966,17 @@ namespace platf {
 
   bool send(send_info_t &send_info);
 
+  /**
+   * @brief Send packets that may differ in size and destination, with as few system calls as the platform allows.
+   * @details Every packet must be sent from the same socket. Linux hands them to sendmmsg();
+   *          other platforms send them one at a time. A packet that can't be sent, such as one
+   *          for an unreachable peer, is logged and skipped, and the rest still go out.
+   * @param messages The packets.
+   * @param count Number of packets.
+   * @return The number of system calls made, or -1 if the socket failed.
+   */
+  int send_messages(send_info_t *messages, std::size_t count);
+
   enum class qos_data_type_e : int {
     audio,  ///< Audio
     video  ///< Video
@@ -840,6 +992,26 @@ namespace platf {
    */
   std::unique_ptr<deinit_t> enable_socket_qos(uintptr_t native_socket, boost::asio::ip::address &address, uint16_t port, qos_data_type_e data_type, bool dscp_tagging);
 
+  /**
+   * @brief Let the kernel pace batches sent on the given socket.
+   * @details Once enabled, send_batch() stamps each batch with its departure_time and returns
+   *          without waiting for it. Only Linux implements this (SO_TXTIME), and the egress
+   *          qdisc must honor departure times (fq) for packets to actually be held.
+   * @param native_socket The native socket handle.
+   * @return true if departure times are supported on this socket.
+   */
+  bool enable_socket_txtime(uintptr_t native_socket);
+
+  /**
+   * @brief Check whether batches stamped with a departure time are held until then on their way to an address.
+   * @details The socket option is accepted whatever the qdisc, so Linux looks up the interface
+   *          the route to the address leaves through and checks its qdisc, logging a warning
+   *          when it sends stamped packets immediately.
+   * @param address The destination.
+   * @return true if the kernel paces batches to the address.
+   */
+  bool socket_txtime_honored(const boost::asio::ip::address &address);
+
   /**
    * @brief Open a url in the default web browser.
    * @param url The url to open.
@@ -974,6 +1146,17 @@ namespace platf {
      */
     virtual void sleep_for(const std::chrono::nanoseconds &duration) = 0;
 
+    /**
+     * @brief Sleep until the deadline
+     * @param deadline Wakeup time, returns immediately if it has already passed
+     */
+    virtual void sleep_until(const std::chrono::steady_clock::time_point &deadline) {
+      auto now = std::chrono::steady_clock::now();
+      if (deadline > now) {
+        sleep_for(deadline - now);
+      }
+    }
+
     /**
      * @brief Check if platform-specific timer backend has been initialized successfully
      * @return `true` on success, `false` on error
@@ -987,6 +1170,12 @@ namespace platf {
    */
   std::unique_ptr<high_precision_timer> create_high_precision_timer();
 
+  /**
+   * @brief Overshoot of every high-precision timer wakeup since startup
+   * @return Histogram of how late wakeups were, empty if the platform does not record it
+   */
+  timer_overshoot_histogram_t high_precision_timer_overshoot();
+
   std::string
     get_clipboard();
 
@@ -787,7 +787,7 @@ namespace cuda {
         while (true) {
           auto now = std::chrono::steady_clock::now();
           if (next_frame > now) {
-            std::this_thread::sleep_for(next_frame - now);
+            timer->sleep_until(next_frame);
             sleep_overshoot_logger.first_point(next_frame);
             sleep_overshoot_logger.second_point_now_and_log();
           }
@@ -960,6 +960,7 @@ namespace cuda {
       }
 
       std::chrono::nanoseconds delay;
+      std::unique_ptr<platf::high_precision_timer> timer = platf::create_high_precision_timer();
 
       bool cursor_visible;
       handle_t handle;
@@ -0,0 +1,106 @@
+/**
+ * @file src/platform/linux/hybrid_timer.cpp
+ * @brief Definitions for the Linux high-precision timer.
+ */
+// standard includes
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+// platform includes
+#include <time.h>
+
+// local includes
+#include "hybrid_timer.h"
+
+namespace platf {
+  namespace {
+    inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      asm volatile("yield");
+#endif
+    }
+
+    // Wakeups later than this are preemption rather than timer slack and would skew calibration
+    constexpr std::chrono::nanoseconds max_latency_sample = std::chrono::milliseconds {1};
+
+    void sleep_until_monotonic(std::chrono::steady_clock::time_point deadline) {
+      // std::chrono::steady_clock is CLOCK_MONOTONIC on Linux
+      auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+
+      timespec ts;
+      ts.tv_sec = since_epoch / 1'000'000'000;
+      ts.tv_nsec = since_epoch % 1'000'000'000;
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+      }
+    }
+  }  // namespace
+
+  void overshoot_recorder_t::record(std::chrono::nanoseconds overshoot) {
+    overshoot = std::max(overshoot, std::chrono::nanoseconds {0});
+
+    counts[timer_overshoot_histogram_t::bucket_for(overshoot)].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    total_ns.fetch_add(overshoot.count(), std::memory_order_relaxed);
+
+    auto current_max = max_ns.load(std::memory_order_relaxed);
+    while (overshoot.count() > current_max && !max_ns.compare_exchange_weak(current_max, overshoot.count(), std::memory_order_relaxed)) {
+    }
+  }
+
+  timer_overshoot_histogram_t overshoot_recorder_t::snapshot() const {
+    timer_overshoot_histogram_t histogram;
+    for (std::size_t x = 0; x < counts.size(); ++x) {
+      histogram.counts[x] = counts[x].load(std::memory_order_relaxed);
+    }
+    histogram.samples = samples.load(std::memory_order_relaxed);
+    histogram.total_overshoot = std::chrono::nanoseconds {total_ns.load(std::memory_order_relaxed)};
+    histogram.max_overshoot = std::chrono::nanoseconds {max_ns.load(std::memory_order_relaxed)};
+    return histogram;
+  }
+
+  overshoot_recorder_t &timer_overshoot_recorder() {
+    static overshoot_recorder_t recorder;
+    return recorder;
+  }
+
+  hybrid_timer_t::hybrid_timer_t(std::chrono::nanoseconds spin_budget, overshoot_recorder_t *recorder):
+      spin_budget {std::max(spin_budget, std::chrono::nanoseconds {0})},
+      wake_latency_estimate {this->spin_budget},
+      recorder {recorder} {
+  }
+
+  void hybrid_timer_t::sleep_until(std::chrono::steady_clock::time_point deadline) {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      return;
+    }
+
+    // Wake early by the expected wakeup latency and spin out the rest
+    auto guard = std::min(spin_budget, wake_latency_estimate);
+    auto coarse_deadline = deadline - guard;
+    if (coarse_deadline > now) {
+      sleep_until_monotonic(coarse_deadline);
+      now = std::chrono::steady_clock::now();
+
+      // Track the upper envelope of the wakeup latency: rise immediately, decay slowly
+      auto latency = std::clamp<std::chrono::nanoseconds>(now - coarse_deadline, std::chrono::nanoseconds {0}, max_latency_sample);
+      if (latency > wake_latency_estimate) {
+        wake_latency_estimate = latency;
+      } else {
+        wake_latency_estimate -= (wake_latency_estimate - latency) / 16;
+      }
+    }
+
+    while (now < deadline) {
+      cpu_relax();
+      now = std::chrono::steady_clock::now();
+    }
+
+    if (recorder) {
+      recorder->record(now - deadline);
+    }
+  }
+}  // namespace platf
@@ -0,0 +1,76 @@
+/**
+ * @file src/platform/linux/hybrid_timer.h
+ * @brief Declarations for the Linux high-precision timer.
+ */
+#pragma once
+
+// standard includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// local includes
+#include "src/timer_stats_types.h"
+
+namespace platf {
+  /**
+   * @brief Lock-free accumulator for timer overshoot samples.
+   */
+  class overshoot_recorder_t {
+  public:
+    /**
+     * @brief Add one wakeup to the histogram.
+     * @param overshoot How long after the deadline the caller resumed.
+     */
+    void record(std::chrono::nanoseconds overshoot);
+
+    /**
+     * @brief Copy the current counters.
+     */
+    timer_overshoot_histogram_t snapshot() const;
+
+  private:
+    std::array<std::atomic<std::uint64_t>, timer_overshoot_histogram_t::bucket_count> counts {};
+    std::atomic<std::uint64_t> samples {0};
+    std::atomic<std::int64_t> total_ns {0};
+    std::atomic<std::int64_t> max_ns {0};
+  };
+
+  /**
+   * @brief Histogram shared by every Linux high-precision timer in the process.
+   */
+  overshoot_recorder_t &timer_overshoot_recorder();
+
+  /**
+   * @brief Absolute sleep on CLOCK_MONOTONIC followed by a short spin.
+   * @details The coarse sleep is scheduled to wake early by the wakeup latency observed on
+   *          previous sleeps, capped at the spin budget, and the remainder is spun out.
+   *          With a zero budget this is a plain `clock_nanosleep(TIMER_ABSTIME)`.
+   */
+  class hybrid_timer_t {
+  public:
+    /**
+     * @param spin_budget The longest the timer may spin before a deadline.
+     * @param recorder Where to record overshoot, or `nullptr` to not record.
+     */
+    explicit hybrid_timer_t(std::chrono::nanoseconds spin_budget, overshoot_recorder_t *recorder = &timer_overshoot_recorder());
+
+    /**
+     * @brief Sleep until the deadline. Returns immediately if it has already passed.
+     */
+    void sleep_until(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Current estimate of how late the coarse sleep wakes up.
+     */
+    std::chrono::nanoseconds wake_latency() const {
+      return wake_latency_estimate;
+    }
+
+  private:
+    std::chrono::nanoseconds spin_budget;
+    std::chrono::nanoseconds wake_latency_estimate;
+    overshoot_recorder_t *recorder;
+  };
+}  // namespace platf
@@ -1136,6 +1136,7 @@ namespace platf {
       mem_type_e mem_type;
 
       std::chrono::nanoseconds delay;
+      std::unique_ptr<high_precision_timer> timer = create_high_precision_timer();
 
       int img_width;
       int img_height;
@@ -1201,7 +1202,7 @@ namespace platf {
           auto now = std::chrono::steady_clock::now();
 
           if (next_frame > now) {
-            std::this_thread::sleep_for(next_frame - now);
+            timer->sleep_until(next_frame);
             sleep_overshoot_logger.first_point(next_frame);
             sleep_overshoot_logger.second_point_now_and_log();
           }
@@ -1422,7 +1423,7 @@ namespace platf {
           auto now = std::chrono::steady_clock::now();
 
           if (next_frame > now) {
-            std::this_thread::sleep_for(next_frame - now);
+            timer->sleep_until(next_frame);
             sleep_overshoot_logger.first_point(next_frame);
             sleep_overshoot_logger.second_point_now_and_log();
           }
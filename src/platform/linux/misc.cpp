@@ -9,6 +9,7 @@
 #endif
 
 // standard includes
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -51,7 +52,12 @@
 
 // local includes
 #include "graphics.h"
+#include "hybrid_timer.h"
 #include "misc.h"
+#include "recv_batch.h"
+#include "send_batch.h"
+#include "txtime.h"
+#include "uring_send.h"
 #include "src/platform/common_services.h"
 #include "src/boost_process_shim.h"
 #include "src/config.h"
@@ -639,42 +645,42 @@ namespace platf {
     return saddr_v6;
   }
 
-  bool send_batch(batched_send_info_t &send_info) {
-    auto sockfd = (int) send_info.native_socket;
-    struct msghdr msg = {};
+  // Room for the PKTINFO option, a departure time and the UDP_SEGMENT option of a batch
+#ifdef IP_PKTINFO
+  constexpr std::size_t batch_cmsg_space = CMSG_SPACE(sizeof(uint16_t)) + txtime::cmsg_space + std::max(CMSG_SPACE(sizeof(struct in_pktinfo)), CMSG_SPACE(sizeof(struct in6_pktinfo)));
+#elif defined(IP_SENDSRCADDR)
+  // FreeBSD uses IP_SENDSRCADDR with struct in_addr instead of IP_PKTINFO with struct in_pktinfo
+  constexpr std::size_t batch_cmsg_space = CMSG_SPACE(sizeof(uint16_t)) + txtime::cmsg_space + std::max(CMSG_SPACE(sizeof(struct in_addr)), CMSG_SPACE(sizeof(struct in6_pktinfo)));
+#endif
 
+  /**
+   * @brief Fill in the destination and the control messages shared by every message of a batch.
+   * @param send_info The batch.
+   * @param msg Message whose msg_control points at batch_cmsg_space zeroed bytes.
+   * @param target Storage for the destination address.
+   * @return The last control message written. msg_controllen covers it, but not UDP_SEGMENT.
+   */
+  struct cmsghdr *fill_batch_msghdr(batched_send_info_t &send_info, struct msghdr &msg, struct sockaddr_in6 &target) {
     // Convert the target address into a sockaddr
-    struct sockaddr_in taddr_v4 = {};
-    struct sockaddr_in6 taddr_v6 = {};
     if (send_info.target_address.is_v6()) {
-      taddr_v6 = to_sockaddr(send_info.target_address.to_v6(), send_info.target_port);
+      target = to_sockaddr(send_info.target_address.to_v6(), send_info.target_port);
 
-      msg.msg_name = (struct sockaddr *) &taddr_v6;
-      msg.msg_namelen = sizeof(taddr_v6);
+      msg.msg_name = (struct sockaddr *) &target;
+      msg.msg_namelen = sizeof(target);
     } else {
-      taddr_v4 = to_sockaddr(send_info.target_address.to_v4(), send_info.target_port);
+      auto taddr_v4 = to_sockaddr(send_info.target_address.to_v4(), send_info.target_port);
+      memcpy(&target, &taddr_v4, sizeof(taddr_v4));
 
-      msg.msg_name = (struct sockaddr *) &taddr_v4;
+      msg.msg_name = (struct sockaddr *) &target;
       msg.msg_namelen = sizeof(taddr_v4);
     }
 
-    union {
-#ifdef IP_PKTINFO
-      char buf[CMSG_SPACE(sizeof(uint16_t)) + std::max(CMSG_SPACE(sizeof(struct in_pktinfo)), CMSG_SPACE(sizeof(struct in6_pktinfo)))];
-#elif defined(IP_SENDSRCADDR)
-      // FreeBSD uses IP_SENDSRCADDR with struct in_addr instead of IP_PKTINFO with struct in_pktinfo
-      char buf[CMSG_SPACE(sizeof(uint16_t)) + std::max(CMSG_SPACE(sizeof(struct in_addr)), CMSG_SPACE(sizeof(struct in6_pktinfo)))];
-#endif
-      struct cmsghdr alignment;
-    } cmbuf = {};  // Must be zeroed for CMSG_NXTHDR()
-
     socklen_t cmbuflen = 0;
+    msg.msg_controllen = batch_cmsg_space;
 
-    msg.msg_control = cmbuf.buf;
-    msg.msg_controllen = sizeof(cmbuf.buf);
-
-    // The PKTINFO option will always be first, then we will conditionally
-    // append the UDP_SEGMENT option next if applicable.
+    // The PKTINFO option will always be first, followed by the departure time
+    // when kernel pacing is in use, then we will conditionally append the
+    // UDP_SEGMENT option next if applicable.
     auto pktinfo_cm = CMSG_FIRSTHDR(&msg);
     if (send_info.source_address.is_v6()) {
       struct in6_pktinfo pktInfo;
@@ -717,57 +723,103 @@ namespace platf {
 #endif
     }
 
-    auto const max_iovs_per_msg = send_info.payload_buffers.size() + (send_info.headers ? 1 : 0);
+    auto last_cm = pktinfo_cm;
+    if (send_info.departure_time) {
+      // The whole batch (or GSO super-packet) is released by the qdisc at this time
+      last_cm = CMSG_NXTHDR(&msg, pktinfo_cm);
+      txtime::fill_cmsg(last_cm, *send_info.departure_time);
+      cmbuflen += txtime::cmsg_space;
+    }
+
+    msg.msg_controllen = cmbuflen;
+    return last_cm;
+  }
+
+  /**
+   * @brief Describe `segs_in_batch` blocks of a batch, starting at `seg_index`, as iovecs.
+   * @return The number of iovecs written.
+   */
+  int fill_batch_iovs(batched_send_info_t &send_info, size_t seg_index, size_t segs_in_batch, struct iovec *iovs) {
+    int iovlen = 0;
+    if (send_info.headers || send_info.payload_pointers) {
+      // Interleave iovs for headers and payloads
+      for (auto i = 0; i < segs_in_batch; i++) {
+        if (send_info.headers) {
+          iovs[iovlen].iov_base = (void *) &send_info.headers[(send_info.block_offset + seg_index + i) * send_info.header_size];
+          iovs[iovlen].iov_len = send_info.header_size;
+          iovlen++;
+        }
+        iovs[iovlen].iov_base = (void *) send_info.payload_for_block(send_info.block_offset + seg_index + i);
+        iovs[iovlen].iov_len = send_info.payload_size;
+        iovlen++;
+      }
+    } else {
+      // Translate buffer descriptors into iovs
+      auto payload_offset = (send_info.block_offset + seg_index) * send_info.payload_size;
+      auto payload_length = payload_offset + (segs_in_batch * send_info.payload_size);
+      while (payload_offset < payload_length) {
+        auto payload_desc = send_info.buffer_for_payload_offset(payload_offset);
+        iovs[iovlen].iov_base = (void *) payload_desc.buffer;
+        iovs[iovlen].iov_len = std::min(payload_desc.size, payload_length - payload_offset);
+        payload_offset += iovs[iovlen].iov_len;
+        iovlen++;
+      }
+    }
+
+    return iovlen;
+  }
+
+#ifdef UDP_SEGMENT
+  /**
+   * @brief Append a UDP_SEGMENT option after `last_cm` to have the kernel split the message.
+   */
+  void append_gso_cmsg(struct msghdr &msg, struct cmsghdr *last_cm, uint16_t segment_size) {
+    msg.msg_controllen += CMSG_SPACE(sizeof(uint16_t));
+
+    auto cm = CMSG_NXTHDR(&msg, last_cm);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    *((uint16_t *) CMSG_DATA(cm)) = segment_size;
+  }
+#endif
+
+  bool send_batch(batched_send_info_t &send_info) {
+    auto sockfd = (int) send_info.native_socket;
+    struct msghdr msg = {};
+    struct sockaddr_in6 target = {};
+
+    union {
+      char buf[batch_cmsg_space];
+      struct cmsghdr alignment;
+    } cmbuf = {};  // Must be zeroed for CMSG_NXTHDR()
+
+    msg.msg_control = cmbuf.buf;
+    auto last_cm = fill_batch_msghdr(send_info, msg, target);
+    socklen_t cmbuflen = msg.msg_controllen;
+
+    // Headers and scatter-gather payloads are both described per block
+    auto const per_block_iovs = send_info.headers || send_info.payload_pointers;
+    auto const max_iovs_per_msg = per_block_iovs ? 2 : send_info.payload_buffers.size();
 
 #ifdef UDP_SEGMENT
     {
       // UDP GSO on Linux currently only supports sending 64K or 64 segments at a time
       size_t seg_index = 0;
       const size_t seg_max = 65536 / 1500;
-      struct iovec iovs[(send_info.headers ? std::min(seg_max, send_info.block_count) : 1) * max_iovs_per_msg];
+      struct iovec iovs[(per_block_iovs ? std::min(seg_max, send_info.block_count) : 1) * max_iovs_per_msg];
       auto msg_size = send_info.header_size + send_info.payload_size;
       while (seg_index < send_info.block_count) {
-        int iovlen = 0;
         auto segs_in_batch = std::min(send_info.block_count - seg_index, seg_max);
-        if (send_info.headers) {
-          // Interleave iovs for headers and payloads
-          for (auto i = 0; i < segs_in_batch; i++) {
-            iovs[iovlen].iov_base = (void *) &send_info.headers[(send_info.block_offset + seg_index + i) * send_info.header_size];
-            iovs[iovlen].iov_len = send_info.header_size;
-            iovlen++;
-            auto payload_desc = send_info.buffer_for_payload_offset((send_info.block_offset + seg_index + i) * send_info.payload_size);
-            iovs[iovlen].iov_base = (void *) payload_desc.buffer;
-            iovs[iovlen].iov_len = send_info.payload_size;
-            iovlen++;
-          }
-        } else {
-          // Translate buffer descriptors into iovs
-          auto payload_offset = (send_info.block_offset + seg_index) * send_info.payload_size;
-          auto payload_length = payload_offset + (segs_in_batch * send_info.payload_size);
-          while (payload_offset < payload_length) {
-            auto payload_desc = send_info.buffer_for_payload_offset(payload_offset);
-            iovs[iovlen].iov_base = (void *) payload_desc.buffer;
-            iovs[iovlen].iov_len = std::min(payload_desc.size, payload_length - payload_offset);
-            payload_offset += iovs[iovlen].iov_len;
-            iovlen++;
-          }
-        }
 
         msg.msg_iov = iovs;
-        msg.msg_iovlen = iovlen;
+        msg.msg_iovlen = fill_batch_iovs(send_info, seg_index, segs_in_batch, iovs);
+        msg.msg_controllen = cmbuflen;
 
         // We should not use GSO if the data is <= one full block size
         if (segs_in_batch > 1) {
-          msg.msg_controllen = cmbuflen + CMSG_SPACE(sizeof(uint16_t));
-
           // Enable GSO to perform segmentation of our buffer for us
-          auto cm = CMSG_NXTHDR(&msg, pktinfo_cm);
-          cm->cmsg_level = SOL_UDP;
-          cm->cmsg_type = UDP_SEGMENT;
-          cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
-          *((uint16_t *) CMSG_DATA(cm)) = msg_size;
-        } else {
-          msg.msg_controllen = cmbuflen;
+          append_gso_cmsg(msg, last_cm, msg_size);
         }
 
         // This will fail if GSO is not available, so we will fall back to non-GSO if
@@ -820,8 +872,7 @@ namespace platf {
           iovs[iov_idx].iov_len = send_info.header_size;
           iov_idx++;
         }
-        auto payload_desc = send_info.buffer_for_payload_offset((send_info.block_offset + i) * send_info.payload_size);
-        iovs[iov_idx].iov_base = (void *) payload_desc.buffer;
+        iovs[iov_idx].iov_base = (void *) send_info.payload_for_block(send_info.block_offset + i);
         iovs[iov_idx].iov_len = send_info.payload_size;
         iov_idx++;
 
@@ -864,39 +915,174 @@ namespace platf {
     }
   }
 
-  bool send(send_info_t &send_info) {
-    auto sockfd = (int) send_info.native_socket;
-    struct msghdr msg = {};
+#if defined(__linux__) && defined(UDP_SEGMENT)
+  /**
+   * @brief Batch sender that queues GSO sends on an io_uring, zero-copy where supported.
+   */
+  class uring_batch_sender_t: public async_batch_sender_t {
+  public:
+    explicit uring_batch_sender_t(std::unique_ptr<uring::sender_t> sender):
+        sender {std::move(sender)} {
+    }
 
-    // Convert the target address into a sockaddr
-    struct sockaddr_in taddr_v4 = {};
-    struct sockaddr_in6 taddr_v6 = {};
-    if (send_info.target_address.is_v6()) {
-      taddr_v6 = to_sockaddr(send_info.target_address.to_v6(), send_info.target_port);
+    bool send(batched_send_info_t &send_info) override {
+      // Buffer descriptors may need more iovs than a message has, so only per-block batches are queued
+      if (disabled || (!send_info.headers && !send_info.payload_pointers)) {
+        return false;
+      }
 
-      msg.msg_name = (struct sockaddr *) &taddr_v6;
-      msg.msg_namelen = sizeof(taddr_v6);
-    } else {
-      taddr_v4 = to_sockaddr(send_info.target_address.to_v4(), send_info.target_port);
+      // Stop using the ring if it breaks, or if sends have only ever failed (no UDP GSO)
+      auto &stats = sender->stats();
+      if (sender->is_broken() || (stats.errors > 0 && stats.sent == 0)) {
+        BOOST_LOG(warning) << "io_uring video sends failed, falling back to send_batch()"sv;
+        disabled = true;
+        return false;
+      }
 
-      msg.msg_name = (struct sockaddr *) &taddr_v4;
-      msg.msg_namelen = sizeof(taddr_v4);
+      if (sender->take_error()) {
+        BOOST_LOG(verbose) << "io_uring sendmsg() failed"sv;
+      }
+
+      // Mirror send_batch(): one GSO send per 64 segments
+      static_assert(sizeof(uring::message_t::control) >= batch_cmsg_space);
+      const size_t seg_max = std::min<size_t>(65536 / 1500, uring::message_t::max_iovs / 2);
+      auto msg_size = send_info.header_size + send_info.payload_size;
+
+      for (size_t seg_index = 0; seg_index < send_info.block_count;) {
+        auto segs_in_batch = std::min(send_info.block_count - seg_index, seg_max);
+
+        auto message = sender->prepare();
+        if (!message) {
+          return false;
+        }
+
+        auto &msg = message->msg;
+        msg.msg_control = message->control;
+        auto last_cm = fill_batch_msghdr(send_info, msg, message->address);
+        msg.msg_iov = message->iovs;
+        msg.msg_iovlen = fill_batch_iovs(send_info, seg_index, segs_in_batch, message->iovs);
+        if (segs_in_batch > 1) {
+          append_gso_cmsg(msg, last_cm, msg_size);
+        }
+
+        sender->queue(message, (int) send_info.native_socket);
+        seg_index += segs_in_batch;
+      }
+
+      return true;
     }
 
-    union {
+    void submit() override {
+      sender->submit();
+    }
+
+    std::uint64_t fence() override {
+      return sender->fence();
+    }
+
+    bool completed(std::uint64_t ticket, bool wait) override {
+      // A broken ring never completes anything, but the kernel holds no more of our memory either
+      return sender->completed(ticket, wait) || sender->is_broken();
+    }
+
+  private:
+    std::unique_ptr<uring::sender_t> sender;
+    bool disabled = false;
+  };
+#endif
+
+  std::unique_ptr<async_batch_sender_t> create_async_batch_sender() {
+#if defined(__linux__) && defined(UDP_SEGMENT)
+    // Enough slots for several frames of 64 KB sends in flight
+    auto sender = uring::sender_t::create(256, true);
+    if (!sender) {
+      BOOST_LOG(warning) << "io_uring is unavailable, using send_batch() for video"sv;
+      return nullptr;
+    }
+
+    BOOST_LOG(info) << "Using io_uring for video sends"sv;
+    return std::make_unique<uring_batch_sender_t>(std::move(sender));
+#else
+    return nullptr;
+#endif
+  }
+
+#ifdef __linux__
+  /**
+   * @brief Batched receiver backed by recvmmsg().
+   */
+  class recvmmsg_receiver_t: public batched_receiver_t {
+  public:
+    recvmmsg_receiver_t(std::size_t count, std::size_t buffer_size):
+        receiver {count, buffer_size} {
+    }
+
+    int receive(std::uintptr_t native_socket) override {
+      return receiver.receive((int) native_socket);
+    }
+
+    std::string_view data(std::size_t index) const override {
+      return receiver.data(index);
+    }
+
+    boost::asio::ip::udp::endpoint peer(std::size_t index) const override {
+      boost::asio::ip::udp::endpoint endpoint;
+      auto size = std::min<std::size_t>(receiver.address_size(index), endpoint.capacity());
+      std::memcpy(endpoint.data(), receiver.address(index), size);
+      endpoint.resize(size);
+      return endpoint;
+    }
+
+  private:
+    recv_batch::receiver_t receiver;
+  };
+#endif
+
+  std::unique_ptr<batched_receiver_t> create_batched_receiver(std::size_t count, std::size_t buffer_size) {
+#ifdef __linux__
+    return std::make_unique<recvmmsg_receiver_t>(count, buffer_size);
+#else
+    return nullptr;
+#endif
+  }
+
+  // Room for the PKTINFO option of a single message
 #ifdef IP_PKTINFO
-      char buf[std::max(CMSG_SPACE(sizeof(struct in_pktinfo)), CMSG_SPACE(sizeof(struct in6_pktinfo)))];
+  constexpr std::size_t send_cmsg_space = std::max(CMSG_SPACE(sizeof(struct in_pktinfo)), CMSG_SPACE(sizeof(struct in6_pktinfo)));
 #elif defined(IP_SENDSRCADDR)
-      // FreeBSD uses IP_SENDSRCADDR with struct in_addr instead of IP_PKTINFO with struct in_pktinfo
-      char buf[std::max(CMSG_SPACE(sizeof(struct in_addr)), CMSG_SPACE(sizeof(struct in6_pktinfo)))];
+  // FreeBSD uses IP_SENDSRCADDR with struct in_addr instead of IP_PKTINFO with struct in_pktinfo
+  constexpr std::size_t send_cmsg_space = std::max(CMSG_SPACE(sizeof(struct in_addr)), CMSG_SPACE(sizeof(struct in6_pktinfo)));
 #endif
-      struct cmsghdr alignment;
-    } cmbuf;
+
+  /**
+   * @brief Describe a single packet as a msghdr.
+   * @param send_info The packet.
+   * @param msg Message to fill.
+   * @param target Storage for the destination address.
+   * @param cmbuf send_cmsg_space bytes, aligned for a cmsghdr, for the PKTINFO option.
+   * @param iovs Storage for the header and payload iovecs.
+   */
+  void fill_send_msghdr(send_info_t &send_info, struct msghdr &msg, struct sockaddr_in6 &target, char *cmbuf, struct iovec (&iovs)[2]) {
+    msg = {};
+
+    // Convert the target address into a sockaddr
+    if (send_info.target_address.is_v6()) {
+      target = to_sockaddr(send_info.target_address.to_v6(), send_info.target_port);
+
+      msg.msg_name = (struct sockaddr *) &target;
+      msg.msg_namelen = sizeof(target);
+    } else {
+      auto taddr_v4 = to_sockaddr(send_info.target_address.to_v4(), send_info.target_port);
+      memcpy(&target, &taddr_v4, sizeof(taddr_v4));
+
+      msg.msg_name = (struct sockaddr *) &target;
+      msg.msg_namelen = sizeof(taddr_v4);
+    }
 
     socklen_t cmbuflen = 0;
 
-    msg.msg_control = cmbuf.buf;
-    msg.msg_controllen = sizeof(cmbuf.buf);
+    msg.msg_control = cmbuf;
+    msg.msg_controllen = send_cmsg_space;
 
     auto pktinfo_cm = CMSG_FIRSTHDR(&msg);
     if (send_info.source_address.is_v6()) {
@@ -940,7 +1126,6 @@ namespace platf {
 #endif
     }
 
-    struct iovec iovs[2];
     int iovlen = 0;
     if (send_info.header) {
       iovs[iovlen].iov_base = (void *) send_info.header;
@@ -955,6 +1140,20 @@ namespace platf {
     msg.msg_iovlen = iovlen;
 
     msg.msg_controllen = cmbuflen;
+  }
+
+  bool send(send_info_t &send_info) {
+    auto sockfd = (int) send_info.native_socket;
+    struct msghdr msg;
+    struct sockaddr_in6 target;
+    struct iovec iovs[2];
+
+    union {
+      char buf[send_cmsg_space];
+      struct cmsghdr alignment;
+    } cmbuf;
+
+    fill_send_msghdr(send_info, msg, target, cmbuf.buf, iovs);
 
     auto bytes_sent = sendmsg(sockfd, &msg, 0);
 
@@ -982,6 +1181,54 @@ namespace platf {
     return true;
   }
 
+  int send_messages(send_info_t *messages, std::size_t count) {
+#ifdef __linux__
+    if (count == 0) {
+      return 0;
+    }
+    auto sockfd = (int) messages[0].native_socket;
+
+    // Messages differ in size and destination, so each one is described on its own
+    // and the whole group is handed to sendmmsg()
+    constexpr std::size_t max_msgs = 64;
+    struct mmsghdr msgs[max_msgs];
+    struct sockaddr_in6 targets[max_msgs];
+    struct iovec iovs[max_msgs][2];
+
+    union cmbuf_t {
+      char buf[send_cmsg_space];
+      struct cmsghdr alignment;
+    } cmbufs[max_msgs];
+
+    int syscalls = 0;
+    for (std::size_t offset = 0; offset < count; offset += max_msgs) {
+      auto group = std::min(count - offset, max_msgs);
+      for (std::size_t i = 0; i < group; ++i) {
+        fill_send_msghdr(messages[offset + i], msgs[i].msg_hdr, targets[i], cmbufs[i].buf, iovs[i]);
+        msgs[i].msg_len = 0;
+      }
+
+      auto result = send_batch::send(sockfd, msgs, group);
+      if (result.syscalls < 0) {
+        BOOST_LOG(warning) << "poll() failed: "sv << result.error;
+        return -1;
+      }
+      if (result.failed) {
+        BOOST_LOG(warning) << "sendmmsg() failed for "sv << result.failed << " of "sv << group << " packets: "sv << result.error;
+      }
+      syscalls += result.syscalls;
+    }
+
+    return syscalls;
+#else
+    // A packet that can't be sent is logged by send(), and the rest still go out
+    for (std::size_t i = 0; i < count; ++i) {
+      send(messages[i]);
+    }
+    return (int) count;
+#endif
+  }
+
   // We can't track QoS state separately for each destination on this OS,
   // so we keep a ref count to only disable QoS options when all clients
   // are disconnected.
@@ -1087,6 +1334,41 @@ namespace platf {
     return std::make_unique<qos_t>(sockfd, reset_options);
   }
 
+  bool enable_socket_txtime(uintptr_t native_socket) {
+    if (!txtime::enable((int) native_socket)) {
+      BOOST_LOG(warning) << "SO_TXTIME is not supported: "sv << errno;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool socket_txtime_honored(const boost::asio::ip::address &address) {
+    // Dual-stack sockets see IPv4 peers as mapped IPv6 addresses, which are routed as IPv4
+    std::optional<txtime::egress_t> egress;
+    if (address.is_v6() && !address.to_v6().is_v4_mapped()) {
+      auto destination = to_sockaddr(address.to_v6(), 0);
+      egress = txtime::egress((struct sockaddr *) &destination);
+    } else {
+      auto v4 = address.is_v4() ? address.to_v4() : boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, address.to_v6());
+      auto destination = to_sockaddr(v4, 0);
+      egress = txtime::egress((struct sockaddr *) &destination);
+    }
+
+    if (!egress) {
+      BOOST_LOG(warning) << "Couldn't find the qdisc video to ["sv << address.to_string() << "] leaves through, falling back to timer pacing"sv;
+      return false;
+    }
+    if (!egress->honors_departure_times) {
+      BOOST_LOG(warning) << "The qdisc of "sv << egress->interface << " ignores SO_TXTIME departure times, falling back to timer pacing for ["sv
+                         << address.to_string() << "]. Attach fq to pace in the kernel: tc qdisc replace dev "sv << egress->interface << " root fq"sv;
+      return false;
+    }
+
+    BOOST_LOG(info) << "Pacing video to ["sv << address.to_string() << "] in the kernel through "sv << egress->interface;
+    return true;
+  }
+
   std::string get_host_name() {
     services::function_host_name_provider_t provider {[]() -> std::optional<std::string> {
       try {
@@ -1119,6 +1401,7 @@ namespace platf {
 #ifdef SUNSHINE_BUILD_PORTAL
       PORTAL,  ///< XDG PORTAL
 #endif
+      SYNTHETIC,  ///< Generated frames
       MAX_FLAGS  ///< The maximum number of flags
     };
   }  // namespace source
@@ -1181,7 +1464,13 @@ namespace platf {
   }
 #endif
 
+  std::vector<std::string> synthetic_display_names();
+  std::shared_ptr<display_t> synthetic_display(mem_type_e hwdevice_type, const std::string &display_name, const video::config_t &config);
+
   std::vector<std::string> display_names(mem_type_e hwdevice_type) {
+    if (sources[source::SYNTHETIC]) {
+      return synthetic_display_names();
+    }
 #ifdef SUNSHINE_BUILD_CUDA
     // display using NvFBC only supports mem_type_e::cuda
     if (sources[source::NVFBC] && hwdevice_type == mem_type_e::cuda) {
@@ -1245,6 +1534,10 @@ namespace platf {
       drop_elevated_privileges(false);
     }
 
+    if (sources[source::SYNTHETIC]) {
+      return synthetic_display(hwdevice_type, display_name, config);
+    }
+
 #ifdef SUNSHINE_BUILD_CUDA
     if (sources[source::NVFBC] && hwdevice_type == mem_type_e::cuda) {
       BOOST_LOG(info) << "Screencasting with NvFBC"sv;
@@ -1306,6 +1599,13 @@ namespace platf {
     }
 #endif
 
+    // Never picked automatically, and needs neither a display server nor EGL
+    if (config::video.capture == "synthetic") {
+      BOOST_LOG(info) << "Screencasting generated frames; only the software encoder can be used"sv;
+      sources[source::SYNTHETIC] = true;
+      return std::make_unique<deinit_t>();
+    }
+
 #ifdef SUNSHINE_BUILD_CUDA
     if (((config::video.capture.empty() && sources.none()) || config::video.capture == "nvfbc") && verify_nvfbc()) {
       sources[source::NVFBC] = true;
@@ -1354,19 +1654,34 @@ namespace platf {
 
   class linux_high_precision_timer: public high_precision_timer {
   public:
+    linux_high_precision_timer():
+        timer {std::chrono::microseconds {config::stream.timer_spin_budget_us}} {
+    }
+
     void sleep_for(const std::chrono::nanoseconds &duration) override {
-      std::this_thread::sleep_for(duration);
+      timer.sleep_until(std::chrono::steady_clock::now() + duration);
+    }
+
+    void sleep_until(const std::chrono::steady_clock::time_point &deadline) override {
+      timer.sleep_until(deadline);
     }
 
     operator bool() override {
       return true;
     }
+
+  private:
+    hybrid_timer_t timer;
   };
 
   std::unique_ptr<high_precision_timer> create_high_precision_timer() {
     return std::make_unique<linux_high_precision_timer>();
   }
 
+  timer_overshoot_histogram_t high_precision_timer_overshoot() {
+    return timer_overshoot_recorder().snapshot();
+  }
+
   std::string
     get_clipboard() {
     // Placeholder
@@ -83,6 +83,8 @@ namespace pipewire {
     std::vector<uint8_t> *front_buffer;
     // Points to the buffer currently being written by on_process
     std::vector<uint8_t> *back_buffer;
+    // Damage of the buffers processed since fill_img last took it
+    platf::damage_t damage;
 
     stream_data_t():
         front_buffer(&buffer_a),
@@ -295,10 +297,31 @@ namespace pipewire {
         img_descriptor->pw_flags = buf->datas[0].chunk->flags;
       }
 
-      struct spa_meta_region *damage = static_cast<struct spa_meta_region *>(
-        spa_buffer_find_meta_data(buf, SPA_META_VideoDamage, sizeof(*damage))
-      );
-      img_descriptor->pw_damage = (damage && damage->region.size.width > 0 && damage->region.size.height > 0) ? std::optional<bool>(true) : std::nullopt;
+    }
+
+    static platf::damage_t damage_of(struct spa_buffer *buf) {
+      auto meta = spa_buffer_find_meta(buf, SPA_META_VideoDamage);
+      if (!meta) {
+        return std::nullopt;
+      }
+
+      // The regions end at the first invalid one
+      std::vector<platf::damage_rect_t> rects;
+      struct spa_meta_region *region;
+      spa_meta_for_each(region, meta) {
+        if (!spa_meta_region_is_valid(region)) {
+          break;
+        }
+
+        rects.push_back({region->region.position.x, region->region.position.y, (std::int32_t) region->region.size.width, (std::int32_t) region->region.size.height});
+      }
+
+      // Not every compositor fills the metadata, so no regions means unknown rather than unchanged
+      if (rects.empty()) {
+        return std::nullopt;
+      }
+
+      return rects;
     }
 
     static void fill_img_dmabuf(egl::img_descriptor_t *img_descriptor, struct spa_buffer *buf, const stream_data_t &d) {
@@ -317,6 +340,9 @@ namespace pipewire {
       pw_thread_loop_lock(loop);
       std::scoped_lock lock(stream_data.frame_mutex);
 
+      // Nothing changed unless there's a new buffer
+      img->damage.emplace();
+
       if (stream_data.shared && stream_data.shared->stream_dead.load()) {
         img->data = nullptr;
         close_img_fds(static_cast<egl::img_descriptor_t *>(img));
@@ -334,6 +360,7 @@ namespace pipewire {
       if (buf->datas[0].chunk->size != 0) {
         auto *img_descriptor = static_cast<egl::img_descriptor_t *>(img);
         fill_img_metadata(img_descriptor, buf);
+        img->damage = std::exchange(stream_data.damage, platf::damage_t {std::in_place});
         if (buf->datas[0].type == SPA_DATA_DmaBuf) {
           fill_img_dmabuf(img_descriptor, buf, stream_data);
         } else {
@@ -462,13 +489,15 @@ namespace pipewire {
     static void on_process(void *user_data) {
       const auto d = static_cast<struct stream_data_t *>(user_data);
       struct pw_buffer *b = nullptr;
+      platf::damage_t damage {std::in_place};
 
-      // 1. Drain the queue: Always grab the most recent buffer
+      // 1. Drain the queue: Always grab the most recent buffer, but keep the damage of all of them
       while (struct pw_buffer *aux = pw_stream_dequeue_buffer(d->stream)) {
         if (b) {
           pw_stream_queue_buffer(d->stream, b);  // Return the older, unused buffer
         }
         b = aux;
+        platf::accumulate_damage(damage, damage_of(b->buffer));
       }
 
       if (!b) {
@@ -483,6 +512,7 @@ namespace pipewire {
         }
         d->current_buffer = b;
         d->frame_ready = true;
+        platf::accumulate_damage(d->damage, damage);
       }
       // 3. Optimized Path: Software/MemPtr
       else if (b->buffer->datas[0].data != nullptr) {
@@ -502,6 +532,7 @@ namespace pipewire {
           d->local_stride = b->buffer->datas[0].chunk->stride;
           d->frame_ready = true;
           d->current_buffer = b;
+          platf::accumulate_damage(d->damage, damage);
         }
 
         // Release the PW buffer immediately after copy
@@ -515,6 +546,7 @@ namespace pipewire {
       const auto d = static_cast<struct stream_data_t *>(user_data);
 
       d->current_buffer = nullptr;
+      d->damage.reset();
 
       if (param == nullptr || id != SPA_PARAM_Format) {
         return;
@@ -778,7 +810,13 @@ namespace pipewire {
         pipewire.fill_img(img_egl);
 
         // Check if we got valid data (either DMA-BUF fd or memory pointer), then filter duplicates
-        if ((img_egl->sd.fds[0] >= 0 || img_egl->data != nullptr) && !is_buffer_redundant(img_egl)) {
+        auto valid = (img_egl->sd.fds[0] >= 0 || img_egl->data != nullptr) && !is_buffer_redundant(img_egl);
+
+        // Damage of skipped buffers carries over to the next image that's pushed
+        platf::accumulate_damage(skipped_damage, img_egl->damage);
+        if (valid) {
+          img_egl->damage = std::exchange(skipped_damage, platf::damage_t {std::in_place});
+
           // Update frame metadata
           update_metadata(img_egl, retries);
           return platf::capture_e::ok;
@@ -838,7 +876,7 @@ namespace pipewire {
         }
 
         if (next_frame > now) {
-          std::this_thread::sleep_until(next_frame);
+          timer->sleep_until(next_frame);
           sleep_overshoot_logger.first_point(next_frame);
           sleep_overshoot_logger.second_point_now_and_log();
         }
@@ -966,7 +1004,7 @@ namespace pipewire {
 
       // If PTS is identical, only drop if damage metadata confirms no change
       if (img->pts.has_value() && last_pts.has_value() && img->pts.value() == last_pts.value()) {
-        return img->pw_damage.has_value() && !img->pw_damage.value();
+        return img->damage.has_value() && img->damage->empty();
       }
 
       return false;
@@ -976,6 +1014,7 @@ namespace pipewire {
       last_seq = img->seq;
       last_pts = img->pts;
       img->sequence = ++sequence;
+      img->capture_sequence = sequence;
 
       if (retries > 0) {
         BOOST_LOG(debug) << "[pipewire] Processed frame after " << retries << " redundant events."sv;
@@ -1093,9 +1132,11 @@ namespace pipewire {
     int n_dmabuf_infos;
     bool display_is_nvidia = false;  // Track if display GPU is NVIDIA
     std::chrono::nanoseconds delay;
+    std::unique_ptr<platf::high_precision_timer> timer = platf::create_high_precision_timer();
     std::optional<std::uint64_t> last_pts {};
     std::optional<std::uint64_t> last_seq {};
     std::uint64_t sequence {};
+    platf::damage_t skipped_damage {std::in_place};
     uint32_t framerate;
 
   protected:
@@ -0,0 +1,53 @@
+/**
+ * @file src/platform/linux/recv_batch.cpp
+ * @brief Definitions for batched datagram receives using recvmmsg().
+ */
+// standard includes
+#include <cerrno>
+
+// local includes
+#include "recv_batch.h"
+
+namespace platf::recv_batch {
+  receiver_t::receiver_t(std::size_t count, std::size_t buffer_size):
+      buffer_size {buffer_size},
+      buffers(count * buffer_size),
+      iovs(count),
+      addresses(count),
+      messages(count) {
+    for (std::size_t i = 0; i < count; ++i) {
+      iovs[i] = {buffers.data() + i * buffer_size, buffer_size};
+    }
+  }
+
+  int receiver_t::receive(int sockfd) {
+    // recvmmsg() overwrites the lengths, so the headers are reset on every call
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+      auto &hdr = messages[i].msg_hdr;
+      hdr = {};
+      hdr.msg_name = &addresses[i];
+      hdr.msg_namelen = sizeof(addresses[i]);
+      hdr.msg_iov = &iovs[i];
+      hdr.msg_iovlen = 1;
+      messages[i].msg_len = 0;
+    }
+
+    auto received = recvmmsg(sockfd, messages.data(), messages.size(), MSG_DONTWAIT, nullptr);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return 0;
+    }
+    return received;
+  }
+
+  std::string_view receiver_t::data(std::size_t index) const {
+    return {buffers.data() + index * buffer_size, messages[index].msg_len};
+  }
+
+  const sockaddr *receiver_t::address(std::size_t index) const {
+    return (const sockaddr *) &addresses[index];
+  }
+
+  socklen_t receiver_t::address_size(std::size_t index) const {
+    return messages[index].msg_hdr.msg_namelen;
+  }
+}  // namespace platf::recv_batch
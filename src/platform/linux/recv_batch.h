@@ -0,0 +1,69 @@
+/**
+ * @file src/platform/linux/recv_batch.h
+ * @brief Declarations for batched datagram receives using recvmmsg().
+ */
+#pragma once
+
+// standard includes
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// platform includes
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace platf::recv_batch {
+  /**
+   * @brief Receives up to a batch of datagrams with a single recvmmsg() call.
+   * @details Buffers and message headers are allocated once, so receiving does not allocate.
+   *          The datagrams of a batch stay valid until the next call to receive().
+   */
+  class receiver_t {
+  public:
+    /**
+     * @param count Datagrams received per call.
+     * @param buffer_size Bytes kept per datagram; longer datagrams are truncated.
+     */
+    receiver_t(std::size_t count, std::size_t buffer_size);
+
+    receiver_t(const receiver_t &) = delete;
+    receiver_t &operator=(const receiver_t &) = delete;
+
+    /**
+     * @brief Receive the datagrams already queued on a socket, without waiting for more.
+     * @param sockfd The socket.
+     * @return Datagrams received, 0 if none were queued, or -1 with errno set on error.
+     */
+    int receive(int sockfd);
+
+    /**
+     * @brief Payload of a datagram from the last receive().
+     */
+    std::string_view data(std::size_t index) const;
+
+    /**
+     * @brief Sender of a datagram from the last receive().
+     */
+    const sockaddr *address(std::size_t index) const;
+
+    /**
+     * @brief Size of the sender address of a datagram from the last receive().
+     */
+    socklen_t address_size(std::size_t index) const;
+
+    /**
+     * @brief Number of datagrams received per call.
+     */
+    std::size_t capacity() const {
+      return messages.size();
+    }
+
+  private:
+    std::size_t buffer_size;
+    std::vector<char> buffers;
+    std::vector<iovec> iovs;
+    std::vector<sockaddr_in6> addresses;  // large enough for either address family
+    std::vector<mmsghdr> messages;
+  };
+}  // namespace platf::recv_batch
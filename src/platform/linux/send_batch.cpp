@@ -0,0 +1,54 @@
+/**
+ * @file src/platform/linux/send_batch.cpp
+ * @brief Definitions for sending a batch of datagrams with sendmmsg().
+ */
+// standard includes
+#include <cerrno>
+
+// platform includes
+#include <poll.h>
+
+// local includes
+#include "send_batch.h"
+
+namespace platf::send_batch {
+  result_t send(int sockfd, struct mmsghdr *msgs, std::size_t count) {
+    result_t result;
+
+    std::size_t msgs_sent = 0;
+    while (msgs_sent < count) {
+      // Only an error on the first message fails the call. After that, sendmmsg() returns
+      // what it sent and the error comes back from the next call, starting at the message
+      // that failed.
+      auto sent = sendmmsg(sockfd, &msgs[msgs_sent], count - msgs_sent, 0);
+      ++result.syscalls;
+      if (sent >= 0) {
+        msgs_sent += sent;
+        continue;
+      }
+
+      // If there's no send buffer space, wait for some to be available
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        struct pollfd pfd;
+
+        pfd.fd = sockfd;
+        pfd.events = POLLOUT;
+
+        if (poll(&pfd, 1, -1) != 1) {
+          result.syscalls = -1;
+          result.error = errno;
+          return result;
+        }
+
+        // Try to send again
+        continue;
+      }
+
+      ++result.failed;
+      result.error = errno;
+      msgs_sent += 1;
+    }
+
+    return result;
+  }
+}  // namespace platf::send_batch
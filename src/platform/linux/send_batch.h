@@ -0,0 +1,30 @@
+/**
+ * @file src/platform/linux/send_batch.h
+ * @brief Declarations for sending a batch of datagrams with sendmmsg().
+ */
+#pragma once
+
+// standard includes
+#include <cstddef>
+
+// platform includes
+#include <sys/socket.h>
+
+namespace platf::send_batch {
+  struct result_t {
+    int syscalls = 0;  ///< sendmmsg() calls made, or -1 if the socket failed
+    std::size_t failed = 0;  ///< Messages the kernel refused, which were skipped
+    int error = 0;  ///< errno of the last message refused
+  };
+
+  /**
+   * @brief Send every message, with as few sendmmsg() calls as the kernel allows.
+   * @details Waits for send buffer space whenever the socket is full. A message the kernel
+   *          refuses, such as one for an unreachable destination, is counted and skipped, so
+   *          the messages after it still go out.
+   * @param sockfd The socket.
+   * @param msgs The messages.
+   * @param count Number of messages.
+   */
+  result_t send(int sockfd, struct mmsghdr *msgs, std::size_t count);
+}  // namespace platf::send_batch
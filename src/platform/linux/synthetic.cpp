@@ -0,0 +1,156 @@
+/**
+ * @file src/platform/linux/synthetic.cpp
+ * @brief Definitions for the synthetic capture backend, which generates frames instead of capturing a screen.
+ */
+// standard includes
+#include <algorithm>
+#include <memory>
+
+// local includes
+#include "src/config.h"
+#include "src/logging.h"
+#include "src/platform/common.h"
+#include "src/video.h"
+#include "synthetic_frames.h"
+
+using namespace std::literals;
+
+namespace platf {
+  namespace synthetic {
+    struct img_t: public platf::img_t {
+      ~img_t() override {
+        delete[] data;
+        data = nullptr;
+      }
+    };
+
+    /**
+     * @brief Frames of generated content at a fixed rate, for benchmarking without a GPU or desktop.
+     * @details Frames are BGR0 in system memory, so only the software encoder can use them.
+     */
+    class display_t: public platf::display_t {
+    public:
+      display_t(pattern_e pattern, int width, int height, std::chrono::nanoseconds delay):
+          source {pattern, width, height},
+          delay {delay} {
+        this->width = width;
+        this->height = height;
+        logical_width = width;
+        logical_height = height;
+        env_width = width;
+        env_height = height;
+        env_logical_width = width;
+        env_logical_height = height;
+      }
+
+      capture_e capture(const push_captured_image_cb_t &push_captured_image_cb, const pull_free_image_cb_t &pull_free_image_cb, bool *cursor) override {
+        auto next_frame = std::chrono::steady_clock::now();
+
+        sleep_overshoot_logger.reset();
+
+        while (true) {
+          auto now = std::chrono::steady_clock::now();
+
+          if (next_frame > now) {
+            timer->sleep_until(next_frame);
+            sleep_overshoot_logger.first_point(next_frame);
+            sleep_overshoot_logger.second_point_now_and_log();
+          }
+
+          next_frame += delay;
+          if (next_frame < now) {  // some major slowdown happened; we couldn't keep up
+            next_frame = now + delay;
+          }
+
+          std::shared_ptr<platf::img_t> img_out;
+          if (!pull_free_image_cb(img_out)) {
+            return capture_e::interrupted;
+          }
+
+          source.render(frame, img_out->data, img_out->row_pitch);
+          img_out->frame_timestamp = std::chrono::steady_clock::now();
+
+          img_out->capture_sequence = frame + 1;
+          img_out->damage.reset();
+          if (auto damage = source.damage(frame)) {
+            auto &rects = img_out->damage.emplace();
+            for (const auto &rect : *damage) {
+              rects.push_back({rect.x, rect.y, rect.width, rect.height});
+            }
+          }
+          ++frame;
+
+          if (!push_captured_image_cb(std::move(img_out), true)) {
+            return capture_e::ok;
+          }
+        }
+      }
+
+      std::shared_ptr<platf::img_t> alloc_img() override {
+        auto img = std::make_shared<synthetic::img_t>();
+        img->width = width;
+        img->height = height;
+        img->pixel_pitch = 4;
+        img->row_pitch = img->pixel_pitch * width;
+        img->data = new std::uint8_t[height * img->row_pitch];
+
+        return img;
+      }
+
+      int dummy_img(platf::img_t *img) override {
+        if (!img) {
+          return -1;
+        }
+
+        std::fill_n(img->data, img->height * img->row_pitch, 0);
+        return 0;
+      }
+
+      std::unique_ptr<avcodec_encode_device_t> make_avcodec_encode_device(pix_fmt_e pix_fmt) override {
+        return std::make_unique<avcodec_encode_device_t>();
+      }
+
+    private:
+      frame_source_t source;
+      std::uint64_t frame = 0;
+
+      std::chrono::nanoseconds delay;
+      std::unique_ptr<high_precision_timer> timer = create_high_precision_timer();
+    };
+  }  // namespace synthetic
+
+  std::vector<std::string> synthetic_display_names() {
+    return {"synthetic"};
+  }
+
+  std::shared_ptr<display_t> synthetic_display(mem_type_e hwdevice_type, const std::string &display_name, const video::config_t &config) {
+    if (hwdevice_type != mem_type_e::system) {
+      BOOST_LOG(debug) << "Synthetic capture only provides frames in system memory"sv;
+      return nullptr;
+    }
+
+    auto &settings = config::video.synthetic;
+    auto pattern = synthetic::pattern_from_view(settings.pattern);
+    if (!pattern) {
+      BOOST_LOG(error) << "Unknown synthetic capture pattern ["sv << settings.pattern << ']';
+      return nullptr;
+    }
+
+    auto width = settings.width > 0 ? settings.width : config.width;
+    auto height = settings.height > 0 ? settings.height : config.height;
+
+    std::chrono::nanoseconds delay;
+    if (settings.refresh_rate > 0) {
+      delay = std::chrono::nanoseconds {1s} / settings.refresh_rate;
+    } else if (config.framerateX100 > 0) {
+      delay = std::chrono::nanoseconds {100s} / config.framerateX100;
+    } else {
+      delay = std::chrono::nanoseconds {1s} / std::max(config.framerate, 1);
+    }
+
+    BOOST_LOG(info) << "Generating "sv << settings.pattern << " frames at "sv << width << 'x' << height
+                    << ", "sv << std::chrono::duration<double, std::milli>(delay).count() << " ms apart"sv;
+
+    return std::make_shared<synthetic::display_t>(*pattern, width, height, delay);
+  }
+}  // namespace platf
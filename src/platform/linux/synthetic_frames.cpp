@@ -0,0 +1,316 @@
+/**
+ * @file src/platform/linux/synthetic_frames.cpp
+ * @brief Definitions for the generated content of the synthetic capture backend.
+ */
+// standard includes
+#include <algorithm>
+#include <cstring>
+
+// local includes
+#include "synthetic_frames.h"
+
+using namespace std::literals;
+
+namespace platf::synthetic {
+  namespace {
+    constexpr int cell_width = 8;
+    constexpr int cell_height = 16;
+
+    // Rows the text scrolls per frame
+    constexpr int scroll_speed = 2;
+
+    // The motion texture wraps every texture_size pixels in both directions
+    constexpr int texture_size = 512;
+    constexpr int tile_size = 32;
+
+    // Frames the caret stays on, then off
+    constexpr std::uint64_t caret_period = 30;
+
+    std::uint32_t mix(std::uint32_t x) {
+      x ^= x >> 16;
+      x *= 0x7feb352du;
+      x ^= x >> 15;
+      x *= 0x846ca68bu;
+      x ^= x >> 16;
+      return x;
+    }
+
+    std::uint32_t mix(std::uint32_t a, std::uint32_t b) {
+      return mix((a * 0x9e3779b9u) ^ mix(b));
+    }
+
+    constexpr std::uint32_t bgr0(std::uint32_t r, std::uint32_t g, std::uint32_t b) {
+      return (r << 16) | (g << 8) | b;
+    }
+
+    class canvas_t {
+    public:
+      canvas_t(std::uint32_t *pixels, int width, int height):
+          pixels {pixels},
+          width {width},
+          height {height} {
+      }
+
+      void fill(rect_t rect, std::uint32_t color) {
+        auto x0 = std::clamp(rect.x, 0, width);
+        auto y0 = std::clamp(rect.y, 0, height);
+        auto x1 = std::clamp(rect.x + rect.width, 0, width);
+        auto y1 = std::clamp(rect.y + rect.height, 0, height);
+
+        for (auto y = y0; y < y1; ++y) {
+          std::fill(pixels + y * width + x0, pixels + y * width + x1, color);
+        }
+      }
+
+      /**
+       * @brief Fill a rectangle with lines of ragged, glyph-like text.
+       */
+      void text(rect_t rect, std::uint32_t seed, std::uint32_t foreground, std::uint32_t background) {
+        fill(rect, background);
+
+        auto columns = rect.width / cell_width;
+        auto lines = rect.height / cell_height;
+        for (int line = 0; line < lines; ++line) {
+          auto length = (int) (mix(seed, line) % (columns + 1));
+
+          // Some lines are blank, like paragraphs
+          if (length < columns / 8) {
+            continue;
+          }
+
+          for (int column = 0; column < length; ++column) {
+            auto code = mix(seed ^ (std::uint32_t) line, column);
+            if (code % 6 == 0) {
+              continue;
+            }
+
+            glyph(rect.x + column * cell_width, rect.y + line * cell_height, code, foreground);
+          }
+        }
+      }
+
+    private:
+      /**
+       * @brief Draw 3x5 blocks of 2x2 pixels, lit by the bits of the character code.
+       */
+      void glyph(int x, int y, std::uint32_t code, std::uint32_t color) {
+        for (int gy = 0; gy < 10; ++gy) {
+          for (int gx = 0; gx < 6; ++gx) {
+            if (!((code >> (gy / 2 * 3 + gx / 2)) & 1)) {
+              continue;
+            }
+
+            auto px = x + 1 + gx;
+            auto py = y + 3 + gy;
+            if (px < width && py < height) {
+              pixels[py * width + px] = color;
+            }
+          }
+        }
+      }
+
+      std::uint32_t *pixels;
+      int width;
+      int height;
+    };
+
+    rect_t scaled(int width, int height, int x, int y, int w, int h) {
+      return {width * x / 100, height * y / 100, width * w / 100, height * h / 100};
+    }
+
+    constexpr int title_height = 24;
+
+    // Where the caret blinks: the start of the text in the front window
+    rect_t caret_rect(int width, int height) {
+      auto window = scaled(width, height, 40, 20, 50, 55);
+      return {window.x + cell_width, window.y + title_height + cell_height / 2, 2, cell_height - 2};
+    }
+
+    void copy_row(const std::uint32_t *page, int page_width, int offset, std::uint32_t *row, int width) {
+      // The page wraps horizontally
+      for (int x = 0; x < width;) {
+        auto from = (offset + x) % page_width;
+        auto count = std::min(width - x, page_width - from);
+        std::memcpy(row + x, page + from, count * sizeof(std::uint32_t));
+        x += count;
+      }
+    }
+  }  // namespace
+
+  std::optional<pattern_e> pattern_from_view(std::string_view name) {
+    if (name == "scrolling_text"sv) {
+      return pattern_e::scrolling_text;
+    }
+    if (name == "gradient"sv) {
+      return pattern_e::gradient;
+    }
+    if (name == "motion"sv) {
+      return pattern_e::motion;
+    }
+    if (name == "static"sv) {
+      return pattern_e::static_desktop;
+    }
+
+    return std::nullopt;
+  }
+
+  frame_source_t::frame_source_t(pattern_e pattern, int width, int height):
+      _pattern {pattern},
+      _width {width},
+      _height {height} {
+    switch (pattern) {
+      case pattern_e::scrolling_text:
+        {
+          // A whole number of lines longer than the screen, so the scroll wraps between lines
+          _page_width = width;
+          _page_height = (height + cell_height - 1) / cell_height * cell_height + 16 * cell_height;
+          _page.resize((std::size_t) _page_width * _page_height);
+
+          canvas_t canvas {_page.data(), _page_width, _page_height};
+          canvas.text({0, 0, _page_width, _page_height}, 1, bgr0(0xcc, 0xcc, 0xcc), bgr0(0x1e, 0x1e, 0x1e));
+          break;
+        }
+      case pattern_e::gradient:
+        {
+          // The horizontal part of each channel, shifted per frame
+          _page_width = width;
+          _page_height = 1;
+          _page.resize(width);
+          for (int x = 0; x < width; ++x) {
+            _page[x] = bgr0(x * 255 / std::max(width, 1), 0, x * 127 / std::max(width, 1));
+          }
+          break;
+        }
+      case pattern_e::motion:
+        {
+          _page_width = texture_size;
+          _page_height = texture_size;
+          _page.resize(texture_size * texture_size);
+          for (int y = 0; y < texture_size; ++y) {
+            for (int x = 0; x < texture_size; ++x) {
+              auto tile = mix(x / tile_size, y / tile_size);
+              auto noise = (int) (mix(mix(x, y)) & 31) - 16;
+              auto stripe = ((x + y) / 8) % 4 == 0 ? 48 : 0;
+
+              auto channel = [&](int shift) {
+                return (std::uint32_t) std::clamp((int) ((tile >> shift) & 0xbf) + noise + stripe, 0, 255);
+              };
+              _page[y * texture_size + x] = bgr0(channel(0), channel(8), channel(16));
+            }
+          }
+          break;
+        }
+      case pattern_e::static_desktop:
+        {
+          _page_width = width;
+          _page_height = height;
+          _page.resize((std::size_t) width * height);
+
+          // Wallpaper
+          for (int y = 0; y < height; ++y) {
+            auto shade = y * 96 / std::max(height, 1);
+            std::fill_n(_page.data() + y * width, width, bgr0(0x10, 0x30 + shade / 2, 0x60 + shade));
+          }
+
+          canvas_t canvas {_page.data(), width, height};
+          const rect_t windows[] {
+            scaled(width, height, 5, 8, 45, 60),
+            scaled(width, height, 15, 55, 35, 35),
+            scaled(width, height, 40, 20, 50, 55),
+          };
+
+          std::uint32_t seed = 2;
+          for (auto &window : windows) {
+            canvas.fill({window.x, window.y, window.width, title_height}, bgr0(0x2b, 0x57, 0x9a));
+            canvas.text({window.x, window.y + title_height, window.width, window.height - title_height}, seed++, bgr0(0x20, 0x20, 0x20), bgr0(0xf3, 0xf3, 0xf3));
+          }
+
+          // Taskbar
+          canvas.fill({0, height - 32, width, 32}, bgr0(0x20, 0x20, 0x28));
+          break;
+        }
+    }
+  }
+
+  void frame_source_t::render(std::uint64_t frame, std::uint8_t *data, int row_pitch) const {
+    auto row_of = [&](int y) {
+      return (std::uint32_t *) (data + (std::ptrdiff_t) y * row_pitch);
+    };
+
+    switch (_pattern) {
+      case pattern_e::scrolling_text:
+        {
+          auto offset = (int) (frame * scroll_speed % _page_height);
+          for (int y = 0; y < _height; ++y) {
+            auto from = (offset + y) % _page_height;
+            std::memcpy(row_of(y), _page.data() + (std::size_t) from * _page_width, _width * sizeof(std::uint32_t));
+          }
+          break;
+        }
+      case pattern_e::gradient:
+        {
+          auto phase = (std::uint32_t) frame;
+          if (_height < 1) {
+            break;
+          }
+
+          // The first row holds the horizontal part of red and blue for this frame
+          auto first = row_of(0);
+          for (int x = 0; x < _width; ++x) {
+            auto horizontal = _page[x];
+            first[x] = bgr0(((horizontal >> 16) + phase * 2) & 0xff, phase & 0xff, ((horizontal & 0xff) + phase * 3) & 0xff);
+          }
+
+          for (int y = 1; y < _height; ++y) {
+            auto row = row_of(y);
+            auto g = ((std::uint32_t) (y * 255 / _height) + phase) & 0xff;
+            auto b = (std::uint32_t) (y * 128 / _height);
+            for (int x = 0; x < _width; ++x) {
+              row[x] = (first[x] & 0xff0000) | (g << 8) | (((first[x] & 0xff) + b) & 0xff);
+            }
+          }
+          break;
+        }
+      case pattern_e::motion:
+        {
+          auto dx = (int) (frame * 7 % texture_size);
+          auto dy = (int) (frame * 3 % texture_size);
+          for (int y = 0; y < _height; ++y) {
+            auto from = (dy + y) % texture_size;
+            copy_row(_page.data() + from * texture_size, texture_size, dx, row_of(y), _width);
+          }
+          break;
+        }
+      case pattern_e::static_desktop:
+        {
+          for (int y = 0; y < _height; ++y) {
+            std::memcpy(row_of(y), _page.data() + (std::size_t) y * _page_width, _width * sizeof(std::uint32_t));
+          }
+
+          if ((frame / caret_period) % 2 == 0) {
+            auto caret = caret_rect(_width, _height);
+            auto x0 = std::clamp(caret.x, 0, _width);
+            auto x1 = std::clamp(caret.x + caret.width, 0, _width);
+            for (auto y = std::max(caret.y, 0); y < std::min(caret.y + caret.height, _height); ++y) {
+              std::fill(row_of(y) + x0, row_of(y) + x1, bgr0(0x20, 0x20, 0x20));
+            }
+          }
+          break;
+        }
+    }
+  }
+
+  std::optional<std::vector<rect_t>> frame_source_t::damage(std::uint64_t frame) const {
+    // Every other pattern moves all over the screen
+    if (_pattern != pattern_e::static_desktop || frame == 0) {
+      return std::nullopt;
+    }
+
+    // Only the caret changes, when it blinks
+    if (frame % caret_period) {
+      return std::vector<rect_t> {};
+    }
+
+    return std::vector<rect_t> {caret_rect(_width, _height)};
+  }
+}  // namespace platf::synthetic
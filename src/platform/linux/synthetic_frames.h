@@ -0,0 +1,72 @@
+/**
+ * @file src/platform/linux/synthetic_frames.h
+ * @brief Declarations for the generated content of the synthetic capture backend.
+ */
+#pragma once
+
+// standard includes
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace platf::synthetic {
+  enum class pattern_e {
+    scrolling_text,  ///< Lines of text scrolling up a terminal
+    gradient,  ///< Colour gradients shifting across the whole screen
+    motion,  ///< A detailed texture panning diagonally, so every pixel changes every frame
+    static_desktop  ///< Windows on a wallpaper, with only a blinking caret changing
+  };
+
+  /**
+   * @return The pattern named by the `synthetic_capture_pattern` option, or std::nullopt.
+   */
+  std::optional<pattern_e> pattern_from_view(std::string_view name);
+
+  struct rect_t {
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+
+  /**
+   * @brief Renders deterministic BGR0 frames.
+   * @details A frame depends only on the pattern, the size and the frame number, so runs are
+   *          reproducible. The expensive content is drawn once, and most frames are copies of
+   *          rows from it at a moving offset.
+   */
+  class frame_source_t {
+  public:
+    frame_source_t(pattern_e pattern, int width, int height);
+
+    /**
+     * @brief Draw a frame.
+     * @param frame The frame number.
+     * @param data Top-left pixel of a width x height BGR0 image.
+     * @param row_pitch Bytes between rows of the image.
+     */
+    void render(std::uint64_t frame, std::uint8_t *data, int row_pitch) const;
+
+    /**
+     * @brief What changed since the previous frame.
+     * @param frame The frame number.
+     * @return The regions that differ from the previous frame, or std::nullopt when all of it may.
+     */
+    [[nodiscard]] std::optional<std::vector<rect_t>> damage(std::uint64_t frame) const;
+
+    [[nodiscard]] pattern_e pattern() const {
+      return _pattern;
+    }
+
+  private:
+    pattern_e _pattern;
+    int _width;
+    int _height;
+
+    // Content that frames are copied from, _page_width pixels per row
+    std::vector<std::uint32_t> _page;
+    int _page_width = 0;
+    int _page_height = 0;
+  };
+}  // namespace platf::synthetic
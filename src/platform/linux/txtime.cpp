@@ -0,0 +1,259 @@
+/**
+ * @file src/platform/linux/txtime.cpp
+ * @brief Definitions for kernel-paced sends using SO_TXTIME.
+ */
+// standard includes
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+// platform includes
+#ifdef __linux__
+  #include <linux/net_tstamp.h>
+  #include <linux/pkt_sched.h>
+  #include <linux/rtnetlink.h>
+  #include <net/if.h>
+  #include <netinet/in.h>
+  #include <time.h>
+  #include <unistd.h>
+#endif
+
+// local includes
+#include "txtime.h"
+
+namespace platf::txtime {
+#ifdef __linux__
+  namespace {
+    class netlink_t {
+    public:
+      netlink_t():
+          fd {socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE)} {
+      }
+
+      ~netlink_t() {
+        if (fd >= 0) {
+          close(fd);
+        }
+      }
+
+      netlink_t(const netlink_t &) = delete;
+      netlink_t &operator=(const netlink_t &) = delete;
+
+      /**
+       * @brief Send a request and hand each reply to on_reply.
+       * @param dump Whether replies continue until NLMSG_DONE, rather than ending with the first batch.
+       * @return false if the request failed.
+       */
+      bool request(struct nlmsghdr *message, bool dump, const std::function<void(const struct nlmsghdr *)> &on_reply) {
+        if (fd < 0) {
+          return false;
+        }
+
+        message->nlmsg_seq = ++sequence;
+        if (::send(fd, message, message->nlmsg_len, 0) < 0) {
+          return false;
+        }
+
+        alignas(struct nlmsghdr) char buffer[32 * 1024];
+        while (true) {
+          auto bytes = recv(fd, buffer, sizeof(buffer), 0);
+          if (bytes < 0) {
+            return false;
+          }
+
+          auto length = (int) bytes;
+          for (auto reply = (const struct nlmsghdr *) buffer; NLMSG_OK(reply, length); reply = NLMSG_NEXT(reply, length)) {
+            if (reply->nlmsg_seq != sequence) {
+              continue;
+            }
+            if (reply->nlmsg_type == NLMSG_DONE) {
+              return true;
+            }
+            if (reply->nlmsg_type == NLMSG_ERROR) {
+              return ((const struct nlmsgerr *) NLMSG_DATA(reply))->error == 0;
+            }
+
+            on_reply(reply);
+          }
+
+          if (!dump) {
+            return true;
+          }
+        }
+      }
+
+    private:
+      int fd;
+      std::uint32_t sequence = 0;
+    };
+
+    std::optional<int> route_interface(netlink_t &netlink, const struct sockaddr *destination) {
+      const void *address;
+      std::size_t address_size;
+      if (destination->sa_family == AF_INET) {
+        address = &((const struct sockaddr_in *) destination)->sin_addr;
+        address_size = sizeof(struct in_addr);
+      } else if (destination->sa_family == AF_INET6) {
+        address = &((const struct sockaddr_in6 *) destination)->sin6_addr;
+        address_size = sizeof(struct in6_addr);
+      } else {
+        return std::nullopt;
+      }
+
+      struct {
+        struct nlmsghdr header;
+        struct rtmsg route;
+        char attributes[RTA_SPACE(sizeof(struct in6_addr))];
+      } message = {};
+
+      message.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+      message.header.nlmsg_type = RTM_GETROUTE;
+      message.header.nlmsg_flags = NLM_F_REQUEST;
+      message.route.rtm_family = destination->sa_family;
+      message.route.rtm_dst_len = address_size * 8;
+
+      auto attribute = (struct rtattr *) ((char *) &message + NLMSG_ALIGN(message.header.nlmsg_len));
+      attribute->rta_type = RTA_DST;
+      attribute->rta_len = RTA_LENGTH(address_size);
+      std::memcpy(RTA_DATA(attribute), address, address_size);
+      message.header.nlmsg_len = NLMSG_ALIGN(message.header.nlmsg_len) + RTA_ALIGN(attribute->rta_len);
+
+      std::optional<int> interface;
+      auto ok = netlink.request(&message.header, false, [&](const struct nlmsghdr *reply) {
+        if (reply->nlmsg_type != RTM_NEWROUTE) {
+          return;
+        }
+
+        auto route = (const struct rtmsg *) NLMSG_DATA(reply);
+        auto length = (int) RTM_PAYLOAD(reply);
+        for (auto attribute = RTM_RTA(route); RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length)) {
+          if (attribute->rta_type == RTA_OIF) {
+            interface = *(const int *) RTA_DATA(attribute);
+          }
+        }
+      });
+
+      return ok ? interface : std::nullopt;
+    }
+
+    std::optional<std::vector<qdisc_t>> interface_qdiscs(netlink_t &netlink, int interface) {
+      struct {
+        struct nlmsghdr header;
+        struct tcmsg tc;
+      } message = {};
+
+      message.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct tcmsg));
+      message.header.nlmsg_type = RTM_GETQDISC;
+      message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+      message.tc.tcm_family = AF_UNSPEC;
+      message.tc.tcm_ifindex = interface;
+
+      // Older kernels dump every interface's qdiscs regardless of tcm_ifindex
+      std::vector<qdisc_t> qdiscs;
+      auto ok = netlink.request(&message.header, true, [&](const struct nlmsghdr *reply) {
+        auto tc = (const struct tcmsg *) NLMSG_DATA(reply);
+        if (reply->nlmsg_type != RTM_NEWQDISC || tc->tcm_ifindex != interface) {
+          return;
+        }
+
+        qdisc_t qdisc {tc->tcm_handle, tc->tcm_parent, {}};
+        auto length = (int) TCA_PAYLOAD(reply);
+        for (auto attribute = TCA_RTA(tc); RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length)) {
+          if (attribute->rta_type == TCA_KIND) {
+            qdisc.kind = (const char *) RTA_DATA(attribute);
+          }
+        }
+        qdiscs.push_back(std::move(qdisc));
+      });
+
+      return ok ? std::make_optional(std::move(qdiscs)) : std::nullopt;
+    }
+  }  // namespace
+#endif
+
+  bool enable(int sockfd) {
+#if defined(__linux__) && defined(SO_TXTIME)
+    // std::chrono::steady_clock is CLOCK_MONOTONIC on Linux, which is the clock fq schedules against
+    struct sock_txtime config = {};
+    config.clockid = CLOCK_MONOTONIC;
+    config.flags = 0;
+
+    return setsockopt(sockfd, SOL_SOCKET, SO_TXTIME, &config, sizeof(config)) == 0;
+#else
+    return false;
+#endif
+  }
+
+  bool honors_departure_times(const std::vector<qdisc_t> &qdiscs) {
+#ifdef __linux__
+    auto paces = [](const qdisc_t &qdisc) {
+      return qdisc.kind == "fq" || qdisc.kind == "etf";
+    };
+
+    auto root = std::find_if(qdiscs.begin(), qdiscs.end(), [](const qdisc_t &qdisc) {
+      return qdisc.parent == TC_H_ROOT;
+    });
+    if (root == qdiscs.end()) {
+      return false;
+    }
+    if (paces(*root)) {
+      return true;
+    }
+    if (root->kind != "mq" && root->kind != "mqprio") {
+      return false;
+    }
+
+    // Multiqueue devices get a qdisc of their own for each transmit queue
+    int queues = 0;
+    for (const auto &qdisc : qdiscs) {
+      if (qdisc.parent == TC_H_ROOT || qdisc.parent == TC_H_INGRESS || TC_H_MAJ(qdisc.parent) != TC_H_MAJ(root->handle)) {
+        continue;
+      }
+      if (!paces(qdisc)) {
+        return false;
+      }
+      ++queues;
+    }
+
+    return queues > 0;
+#else
+    return false;
+#endif
+  }
+
+  std::optional<egress_t> egress(const struct sockaddr *destination) {
+#ifdef __linux__
+    netlink_t netlink;
+
+    auto interface = route_interface(netlink, destination);
+    if (!interface) {
+      return std::nullopt;
+    }
+
+    auto qdiscs = interface_qdiscs(netlink, *interface);
+    if (!qdiscs) {
+      return std::nullopt;
+    }
+
+    char name[IF_NAMESIZE] = {};
+    if (!if_indextoname(*interface, name)) {
+      return std::nullopt;
+    }
+
+    return egress_t {name, honors_departure_times(*qdiscs)};
+#else
+    return std::nullopt;
+#endif
+  }
+
+  void fill_cmsg(struct cmsghdr *cm, std::chrono::steady_clock::time_point departure) {
+#if defined(__linux__) && defined(SCM_TXTIME)
+    std::uint64_t departure_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(departure.time_since_epoch()).count();
+
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_TXTIME;
+    cm->cmsg_len = CMSG_LEN(sizeof(departure_ns));
+    std::memcpy(CMSG_DATA(cm), &departure_ns, sizeof(departure_ns));
+#endif
+  }
+}  // namespace platf::txtime
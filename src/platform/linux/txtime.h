@@ -0,0 +1,67 @@
+/**
+ * @file src/platform/linux/txtime.h
+ * @brief Declarations for kernel-paced sends using SO_TXTIME.
+ */
+#pragma once
+
+// standard includes
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// platform includes
+#include <sys/socket.h>
+
+namespace platf::txtime {
+  /**
+   * @brief Space a departure time control message takes in a msghdr control buffer.
+   */
+  constexpr std::size_t cmsg_space = CMSG_SPACE(sizeof(std::uint64_t));
+
+  /**
+   * @brief Enable SO_TXTIME on a socket using the steady clock.
+   * @details Departure times are only honored by a qdisc that supports them, such as fq
+   *          (or etf with a CLOCK_TAI socket). Other qdiscs send stamped packets immediately,
+   *          and the option is accepted either way, so check egress() too.
+   * @param sockfd The socket.
+   * @return true if the kernel accepted the option.
+   */
+  bool enable(int sockfd);
+
+  struct qdisc_t {
+    std::uint32_t handle;
+    std::uint32_t parent;
+    std::string kind;
+  };
+
+  /**
+   * @brief Whether an interface's qdiscs hold packets until their departure time.
+   * @details fq and etf do, and so do mq and mqprio when every transmit queue under them is
+   *          fq or etf. Any other root qdisc, noqueue included, sends stamped packets at once.
+   * @param qdiscs The qdiscs of one interface.
+   */
+  bool honors_departure_times(const std::vector<qdisc_t> &qdiscs);
+
+  struct egress_t {
+    std::string interface;
+    bool honors_departure_times;
+  };
+
+  /**
+   * @brief Find the interface packets to a destination leave through, and check its qdiscs.
+   * @details Asks the kernel over rtnetlink for the route to the destination, then for the
+   *          qdiscs of the route's interface.
+   * @param destination An IPv4 or IPv6 address.
+   * @return The interface, or std::nullopt if either lookup failed.
+   */
+  std::optional<egress_t> egress(const struct sockaddr *destination);
+
+  /**
+   * @brief Write an SCM_TXTIME control message.
+   * @param cm The control message header to fill, with cmsg_space bytes available.
+   * @param departure When the kernel should release the packets.
+   */
+  void fill_cmsg(struct cmsghdr *cm, std::chrono::steady_clock::time_point departure);
+}  // namespace platf::txtime
@@ -0,0 +1,365 @@
+/**
+ * @file src/platform/linux/uring_send.cpp
+ * @brief Definitions for asynchronous socket sends over io_uring.
+ */
+// standard includes
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+// platform includes
+#ifdef __linux__
+  #include <linux/io_uring.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+// local includes
+#include "uring_send.h"
+
+#ifdef __linux__
+namespace platf::uring {
+  namespace {
+    int io_uring_setup(unsigned entries, io_uring_params *params) {
+      return (int) syscall(__NR_io_uring_setup, entries, params);
+    }
+
+    int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+      return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+    }
+
+    int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+      return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+    }
+
+    // Below this, copying is cheaper than pinning pages and waiting for the notification
+    constexpr std::size_t zerocopy_min_bytes = 10 * 1024;
+
+    // Zero-copy fragments must fit an skb (MAX_SKB_FRAGS is 17 by default), and an iovec
+    // may straddle a page boundary
+    constexpr std::size_t zerocopy_max_iovs = 8;
+
+    bool opcode_supported(int fd, unsigned opcode) {
+      // The probe is followed by one io_uring_probe_op per opcode
+      constexpr unsigned probe_ops = 256;
+      std::vector<char> buffer(sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op));
+      auto probe = (io_uring_probe *) buffer.data();
+
+      if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, probe_ops) < 0) {
+        return false;
+      }
+
+      return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+    }
+  }  // namespace
+
+  bool zerocopy_eligible(const msghdr &msg) {
+    if (msg.msg_iovlen > zerocopy_max_iovs) {
+      return false;
+    }
+
+    std::size_t bytes = 0;
+    for (std::size_t x = 0; x < msg.msg_iovlen; ++x) {
+      bytes += msg.msg_iov[x].iov_len;
+    }
+    return bytes >= zerocopy_min_bytes;
+  }
+
+  std::unique_ptr<sender_t> sender_t::create(unsigned entries, bool zerocopy) {
+    io_uring_params params {};
+    auto fd = io_uring_setup(entries, &params);
+    if (fd < 0) {
+      return nullptr;
+    }
+
+    std::unique_ptr<sender_t> sender {new sender_t};
+    sender->ring_fd = fd;
+
+    if (!opcode_supported(fd, IORING_OP_SENDMSG)) {
+      return nullptr;
+    }
+#ifdef IORING_CQE_F_NOTIF
+    sender->use_zerocopy = zerocopy && opcode_supported(fd, IORING_OP_SENDMSG_ZC);
+#endif
+
+    sender->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    sender->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sender->sq_ring_size = sender->cq_ring_size = std::max(sender->sq_ring_size, sender->cq_ring_size);
+    }
+
+    auto map = [fd](std::size_t size, off_t offset) -> void * {
+      auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+      return ptr == MAP_FAILED ? nullptr : ptr;
+    };
+
+    sender->sq_ring = map(sender->sq_ring_size, IORING_OFF_SQ_RING);
+    if (!sender->sq_ring) {
+      return nullptr;
+    }
+
+    if (single_mmap) {
+      sender->cq_ring = sender->sq_ring;
+    } else {
+      sender->cq_ring = map(sender->cq_ring_size, IORING_OFF_CQ_RING);
+      if (!sender->cq_ring) {
+        return nullptr;
+      }
+    }
+
+    sender->sqe_array_size = params.sq_entries * sizeof(io_uring_sqe);
+    sender->sqe_array = map(sender->sqe_array_size, IORING_OFF_SQES);
+    if (!sender->sqe_array) {
+      return nullptr;
+    }
+
+    auto sq = (char *) sender->sq_ring;
+    sender->sq_head = (unsigned *) (sq + params.sq_off.head);
+    sender->sq_tail = (unsigned *) (sq + params.sq_off.tail);
+    sender->sq_mask = *(unsigned *) (sq + params.sq_off.ring_mask);
+    sender->sq_index_array = (unsigned *) (sq + params.sq_off.array);
+    sender->sq_local_tail = *sender->sq_tail;
+
+    auto cq = (char *) sender->cq_ring;
+    sender->cq_head = (unsigned *) (cq + params.cq_off.head);
+    sender->cq_tail = (unsigned *) (cq + params.cq_off.tail);
+    sender->cq_mask = *(unsigned *) (cq + params.cq_off.ring_mask);
+    sender->cqe_array = cq + params.cq_off.cqes;
+
+    // The completion queue holds at least twice the submission queue, which is room for
+    // both completions of every zero-copy request when there is one request per SQE
+    sender->slots.resize(params.sq_entries);
+    sender->free_slots.reserve(params.sq_entries);
+    for (auto x = params.sq_entries; x > 0; --x) {
+      sender->free_slots.push_back(x - 1);
+    }
+
+    return sender;
+  }
+
+  sender_t::~sender_t() {
+    // The kernel may still read from the slots, so drain before unmapping them
+    if (sqe_array && !broken) {
+      completed(fence(), true);
+    }
+
+    if (sqe_array) {
+      munmap(sqe_array, sqe_array_size);
+    }
+    if (cq_ring && cq_ring != sq_ring) {
+      munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring) {
+      munmap(sq_ring, sq_ring_size);
+    }
+    if (ring_fd >= 0) {
+      close(ring_fd);
+    }
+  }
+
+  message_t *sender_t::prepare() {
+    while (free_slots.empty()) {
+      if (!submit()) {
+        return nullptr;
+      }
+
+      reap();
+      if (free_slots.empty() && !enter(0, 1)) {
+        return nullptr;
+      }
+    }
+
+    auto &slot = slots[free_slots.back()];
+    free_slots.pop_back();
+
+    auto &message = slot.message;
+    std::memset(&message.msg, 0, sizeof(message.msg));
+    std::memset(&message.address, 0, sizeof(message.address));
+    std::memset(message.control, 0, sizeof(message.control));  // Must be zeroed for CMSG_NXTHDR()
+    return &message;
+  }
+
+  void sender_t::queue(message_t *message, int sockfd) {
+    static_assert(offsetof(slot_t, message) == 0);
+    auto index = (std::uint32_t) (reinterpret_cast<slot_t *>(message) - slots.data());
+    auto &slot = slots[index];
+    slot.ticket = next_ticket;
+    slot.sockfd = sockfd;
+    slot.zerocopy = use_zerocopy && zerocopy_eligible(message->msg);
+    slot.pending = 1;
+
+    queue_slot(index);
+    ++counters.messages;
+    if (slot.zerocopy) {
+      ++counters.zerocopy;
+    }
+  }
+
+  void sender_t::queue_slot(std::uint32_t index) {
+    auto &slot = slots[index];
+
+    auto sq_index = sq_local_tail & sq_mask;
+    auto sqe = (io_uring_sqe *) sqe_array + sq_index;
+    std::memset(sqe, 0, sizeof(*sqe));
+#ifdef IORING_CQE_F_NOTIF
+    sqe->opcode = slot.zerocopy ? IORING_OP_SENDMSG_ZC : IORING_OP_SENDMSG;
+#else
+    sqe->opcode = IORING_OP_SENDMSG;
+#endif
+    sqe->fd = slot.sockfd;
+    sqe->addr = (std::uint64_t) &slot.message.msg;
+    sqe->len = 1;
+    sqe->user_data = index;
+
+    sq_index_array[sq_index] = sq_index;
+    ++sq_local_tail;
+    ++unsubmitted;
+  }
+
+  bool sender_t::submit() {
+    if (unsubmitted == 0) {
+      return true;
+    }
+
+    __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+    if (!enter(unsubmitted, 0)) {
+      return false;
+    }
+
+    unsubmitted = 0;
+    return true;
+  }
+
+  std::uint64_t sender_t::fence() {
+    return next_ticket++;
+  }
+
+  bool sender_t::completed(std::uint64_t ticket, bool wait) {
+    while (true) {
+      // Reaping may requeue requests that hit a full socket buffer
+      if (!submit()) {
+        return false;
+      }
+      reap();
+
+      auto in_flight = std::any_of(std::begin(slots), std::end(slots), [ticket](const slot_t &slot) {
+        return slot.pending > 0 && slot.ticket <= ticket;
+      });
+      if (!in_flight) {
+        return true;
+      }
+
+      if (!wait || !enter(0, 1)) {
+        return false;
+      }
+    }
+  }
+
+  bool sender_t::take_error() {
+    return std::exchange(failed, false);
+  }
+
+  bool sender_t::enter(unsigned to_submit, unsigned min_complete) {
+    if (broken) {
+      return false;
+    }
+
+    auto flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (true) {
+      ++counters.enters;
+      auto ret = io_uring_enter(ring_fd, to_submit, min_complete, flags);
+      if (ret >= 0) {
+        if ((unsigned) ret >= to_submit) {
+          return true;
+        }
+
+        // The kernel stopped early; submit the rest
+        to_submit -= ret;
+        continue;
+      }
+
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EBUSY) {
+        // Completions must be reaped before the kernel accepts more work
+        reap();
+        flags |= IORING_ENTER_GETEVENTS;
+        min_complete = std::max(min_complete, 1u);
+        continue;
+      }
+
+      broken = true;
+      return false;
+    }
+  }
+
+  void sender_t::reap() {
+    auto head = *cq_head;
+    auto tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+      auto cqe = (io_uring_cqe *) cqe_array + (head & cq_mask);
+      auto index = (std::uint32_t) cqe->user_data;
+      auto &slot = slots[index];
+
+#ifdef IORING_CQE_F_NOTIF
+      if (cqe->flags & IORING_CQE_F_NOTIF) {
+  #ifdef IORING_NOTIF_USAGE_ZC_COPIED
+        if (cqe->res & IORING_NOTIF_USAGE_ZC_COPIED) {
+          ++counters.copied;
+        }
+  #endif
+      } else
+#endif
+      {
+        if (cqe->res == -EAGAIN || (cqe->res == -EMSGSIZE && slot.zerocopy)) {
+          // The socket buffer was full, or the message needed more fragments than a
+          // zero-copy send allows. The message is still intact, so send it again (copying
+          // in the latter case); the retry replaces this completion, but any notification
+          // is still owed.
+          if (cqe->res == -EMSGSIZE) {
+            slot.zerocopy = false;
+          }
+#ifdef IORING_CQE_F_MORE
+          if (cqe->flags & IORING_CQE_F_MORE) {
+            ++slot.pending;
+          }
+#endif
+          retry.push_back(index);
+          ++head;
+          continue;
+        }
+
+        if (cqe->res < 0) {
+          ++counters.errors;
+          failed = true;
+        } else {
+          ++counters.sent;
+        }
+#ifdef IORING_CQE_F_MORE
+        // A zero-copy send posts a notification once the kernel is done with the buffers
+        if (cqe->flags & IORING_CQE_F_MORE) {
+          ++slot.pending;
+        }
+#endif
+      }
+
+      if (--slot.pending == 0) {
+        free_slots.push_back(index);
+      }
+      ++head;
+    }
+
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+    for (auto index : retry) {
+      ++counters.retries;
+      queue_slot(index);
+    }
+    retry.clear();
+  }
+}  // namespace platf::uring
+#endif
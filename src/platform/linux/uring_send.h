@@ -0,0 +1,175 @@
+/**
+ * @file src/platform/linux/uring_send.h
+ * @brief Declarations for asynchronous socket sends over io_uring.
+ */
+#pragma once
+
+// standard includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// platform includes
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace platf::uring {
+  /**
+   * @brief Storage for one queued sendmsg().
+   * @details Owned by the sender so it stays valid until the kernel has completed the send.
+   */
+  struct message_t {
+    // A GSO send carries at most 64 segments, each a header and a payload
+    static constexpr std::size_t max_iovs = 128;
+
+    msghdr msg;
+    iovec iovs[max_iovs];
+    sockaddr_in6 address;  // large enough for either address family
+    alignas(cmsghdr) char control[128];
+  };
+
+  /**
+   * @brief Counters describing how the sender has been used.
+   */
+  struct sender_stats_t {
+    std::uint64_t messages = 0;  // sendmsg requests queued
+    std::uint64_t enters = 0;  // io_uring_enter() syscalls
+    std::uint64_t sent = 0;  // requests that completed successfully
+    std::uint64_t errors = 0;  // requests that completed with an error
+    std::uint64_t retries = 0;  // requests resubmitted after the socket buffer filled up
+    std::uint64_t zerocopy = 0;  // requests sent with IORING_OP_SENDMSG_ZC
+    std::uint64_t copied = 0;  // zero-copy requests the kernel had to copy anyway
+  };
+
+  /**
+   * @brief Whether a message is worth sending zero-copy.
+   * @details Pinning pages only pays off for large sends, and the kernel rejects zero-copy
+   *          sends that need more fragments than an skb holds, so scatter-gather messages
+   *          made of many small iovecs are always copied.
+   */
+  bool zerocopy_eligible(const msghdr &msg);
+
+  /**
+   * @brief Queues sendmsg() requests on an io_uring and reaps their completions.
+   * @details Requests are only handed to the kernel by submit(), so several can be
+   *          submitted with a single syscall. With zero-copy sends the kernel reads the
+   *          iovecs' memory until the request completes, so callers group requests with
+   *          fence() and keep the memory alive until completed() reports the fence done.
+   */
+  class sender_t {
+  public:
+    /**
+     * @brief Create a sender.
+     * @param entries Maximum number of requests in flight.
+     * @param zerocopy Use IORING_OP_SENDMSG_ZC for messages that benefit, when the kernel supports it.
+     * @return The sender, or nullptr if io_uring is unavailable.
+     */
+    static std::unique_ptr<sender_t> create(unsigned entries, bool zerocopy);
+
+    ~sender_t();
+
+    /**
+     * @brief Whether requests are sent with IORING_OP_SENDMSG_ZC.
+     */
+    bool zerocopy() const {
+      return use_zerocopy;
+    }
+
+    /**
+     * @brief Reserve storage for the next request.
+     * @details Blocks on completions if every slot is in flight. The returned message is
+     *          zeroed apart from its iovec and control buffers.
+     * @return The message to fill in, or nullptr on a ring error.
+     */
+    message_t *prepare();
+
+    /**
+     * @brief Queue a prepared message for sending on `sockfd`.
+     * @param message A message returned by prepare().
+     * @param sockfd The socket to send on.
+     */
+    void queue(message_t *message, int sockfd);
+
+    /**
+     * @brief Hand every queued request to the kernel.
+     * @return false on a ring error.
+     */
+    bool submit();
+
+    /**
+     * @brief Close the current group of requests.
+     * @return A ticket that completed() reports once every request queued so far has completed.
+     */
+    std::uint64_t fence();
+
+    /**
+     * @brief Reap completions and check a fence.
+     * @param ticket A ticket returned by fence().
+     * @param wait Block until the fence completes.
+     * @return true once the kernel no longer references any memory queued before the fence.
+     */
+    bool completed(std::uint64_t ticket, bool wait);
+
+    /**
+     * @brief Whether a request has failed since the last call, which clears the flag.
+     */
+    bool take_error();
+
+    /**
+     * @brief Whether the ring itself has failed, after which nothing more can be sent.
+     */
+    bool is_broken() const {
+      return broken;
+    }
+
+    const sender_stats_t &stats() const {
+      return counters;
+    }
+
+  private:
+    sender_t() = default;
+
+    bool enter(unsigned to_submit, unsigned min_complete);
+    void reap();
+    void queue_slot(std::uint32_t index);
+
+    struct slot_t {
+      message_t message;
+      int sockfd = -1;
+      bool zerocopy = false;
+      std::uint64_t ticket = 0;
+      int pending = 0;  // completions still expected from the kernel
+    };
+
+    int ring_fd = -1;
+    bool use_zerocopy = false;
+
+    void *sq_ring = nullptr;
+    std::size_t sq_ring_size = 0;
+    void *cq_ring = nullptr;
+    std::size_t cq_ring_size = 0;
+    void *sqe_array = nullptr;
+    std::size_t sqe_array_size = 0;
+
+    unsigned *sq_head = nullptr;
+    unsigned *sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned *sq_index_array = nullptr;
+    unsigned sq_local_tail = 0;
+    unsigned *cq_head = nullptr;
+    unsigned *cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    void *cqe_array = nullptr;
+
+    std::vector<slot_t> slots;
+    std::vector<std::uint32_t> free_slots;
+    std::vector<std::uint32_t> retry;
+    std::uint64_t next_ticket = 1;
+    unsigned unsubmitted = 0;
+    bool failed = false;  // a request completed with an error
+    bool broken = false;  // io_uring_enter() failed, so nothing more can be submitted
+
+    sender_stats_t counters;
+  };
+}  // namespace platf::uring
@@ -283,6 +283,9 @@ namespace wl {
     shm_info.supported = false;
     dmabuf_info.supported = false;
 
+    // Damage stays unknown unless the compositor reports it
+    get_next_frame()->damage.reset();
+
     // Create new frame
     auto frame = zwlr_screencopy_manager_v1_capture_output(
       screencopy_manager,
@@ -504,7 +507,14 @@ namespace wl {
     std::uint32_t y,
     std::uint32_t width,
     std::uint32_t height
-  ) {};
+  ) {
+    auto next_frame = get_next_frame();
+    if (!next_frame->damage) {
+      next_frame->damage.emplace();
+    }
+
+    next_frame->damage->push_back({(std::int32_t) x, (std::int32_t) y, (std::int32_t) width, (std::int32_t) height});
+  };
 
   void frame_t::destroy() {
     for (auto x = 0; x < 4; ++x) {
@@ -32,6 +32,9 @@ namespace wl {
 
     egl::surface_descriptor_t sd;
     std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
+
+    // Reported by the compositor for copy_with_damage(), unknown otherwise
+    platf::damage_t damage;
   };
 
   class dmabuf_t {
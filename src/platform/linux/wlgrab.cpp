@@ -156,6 +156,7 @@ namespace wl {
     platf::mem_type_e mem_type;
 
     std::chrono::nanoseconds delay;
+    std::unique_ptr<platf::high_precision_timer> timer = platf::create_high_precision_timer();
 
     wl::display_t display;
     interface_t interface;
@@ -175,7 +176,7 @@ namespace wl {
         auto now = std::chrono::steady_clock::now();
 
         if (next_frame > now) {
-          std::this_thread::sleep_for(next_frame - now);
+          timer->sleep_until(next_frame);
           sleep_overshoot_logger.first_point(next_frame);
           sleep_overshoot_logger.second_point_now_and_log();
         }
@@ -242,6 +243,8 @@ namespace wl {
       gl::ctx.BindTexture(GL_TEXTURE_2D, 0);
 
       img_out->frame_timestamp = current_frame->frame_timestamp;
+      img_out->capture_sequence = ++sequence;
+      img_out->damage = current_frame->damage;
 
       return platf::capture_e::ok;
     }
@@ -295,6 +298,9 @@ namespace wl {
 
     egl::display_t egl_display;
     egl::ctx_t ctx;
+
+    // Numbers the images pushed, for capture_sequence
+    std::uint64_t sequence {};
   };
 
   class wlr_vram_t: public wlr_t {
@@ -308,7 +314,7 @@ namespace wl {
         auto now = std::chrono::steady_clock::now();
 
         if (next_frame > now) {
-          std::this_thread::sleep_for(next_frame - now);
+          timer->sleep_until(next_frame);
           sleep_overshoot_logger.first_point(next_frame);
           sleep_overshoot_logger.second_point_now_and_log();
         }
@@ -364,6 +364,7 @@ namespace platf {
 
   struct x11_attr_t: public display_t {
     std::chrono::nanoseconds delay;
+    std::unique_ptr<high_precision_timer> timer = create_high_precision_timer();
 
     x11::xdisplay_t xdisplay;
     Window xwindow;
@@ -465,7 +466,7 @@ namespace platf {
         auto now = std::chrono::steady_clock::now();
 
         if (next_frame > now) {
-          std::this_thread::sleep_for(next_frame - now);
+          timer->sleep_until(next_frame);
           sleep_overshoot_logger.first_point(next_frame);
           sleep_overshoot_logger.second_point_now_and_log();
         }
@@ -604,7 +605,7 @@ namespace platf {
         auto now = std::chrono::steady_clock::now();
 
         if (next_frame > now) {
-          std::this_thread::sleep_for(next_frame - now);
+          timer->sleep_until(next_frame);
           sleep_overshoot_logger.first_point(next_frame);
           sleep_overshoot_logger.second_point_now_and_log();
         }
@@ -391,6 +391,34 @@ namespace platf {
     return false;
   }
 
+  bool enable_socket_txtime(uintptr_t native_socket) {
+    // Departure times are not supported, so the caller keeps pacing with sleeps
+    return false;
+  }
+
+  bool socket_txtime_honored(const boost::asio::ip::address &address) {
+    return false;
+  }
+
+  std::unique_ptr<async_batch_sender_t> create_async_batch_sender() {
+    // Only synchronous batched sends are supported
+    return nullptr;
+  }
+
+  std::unique_ptr<batched_receiver_t> create_batched_receiver(std::size_t count, std::size_t buffer_size) {
+    // Datagrams are received one at a time
+    return nullptr;
+  }
+
+  int send_messages(send_info_t *messages, std::size_t count) {
+    // No multi-message send, so each packet costs a system call. A packet that can't be
+    // sent is logged by send(), and the rest still go out.
+    for (std::size_t i = 0; i < count; ++i) {
+      send(messages[i]);
+    }
+    return (int) count;
+  }
+
   bool send(send_info_t &send_info) {
     auto sockfd = (int) send_info.native_socket;
     struct msghdr msg = {};
@@ -624,6 +652,10 @@ namespace platf {
     return std::make_unique<macos_high_precision_timer>();
   }
 
+  timer_overshoot_histogram_t high_precision_timer_overshoot() {
+    return {};
+  }
+
   std::string
     get_clipboard() {
     // Placeholder
@@ -1835,18 +1835,21 @@ namespace platf {
       msg.namelen = sizeof(taddr_v4);
     }
 
-    auto const max_bufs_per_msg = send_info.payload_buffers.size() + (send_info.headers ? 1 : 0);
+    // Headers and scatter-gather payloads are both described per block
+    auto const per_block_bufs = send_info.headers || send_info.payload_pointers;
+    auto const max_bufs_per_msg = per_block_bufs ? 2 : send_info.payload_buffers.size();
 
-    std::vector<WSABUF> bufs((send_info.headers ? send_info.block_count : 1) * max_bufs_per_msg);
+    std::vector<WSABUF> bufs((per_block_bufs ? send_info.block_count : 1) * max_bufs_per_msg);
     DWORD bufcount = 0;
-    if (send_info.headers) {
+    if (per_block_bufs) {
       // Interleave buffers for headers and payloads
       for (auto i = 0; i < send_info.block_count; i++) {
-        bufs[bufcount].buf = (char *) &send_info.headers[(send_info.block_offset + i) * send_info.header_size];
-        bufs[bufcount].len = send_info.header_size;
-        bufcount++;
-        auto payload_desc = send_info.buffer_for_payload_offset((send_info.block_offset + i) * send_info.payload_size);
-        bufs[bufcount].buf = (char *) payload_desc.buffer;
+        if (send_info.headers) {
+          bufs[bufcount].buf = (char *) &send_info.headers[(send_info.block_offset + i) * send_info.header_size];
+          bufs[bufcount].len = send_info.header_size;
+          bufcount++;
+        }
+        bufs[bufcount].buf = (char *) send_info.payload_for_block(send_info.block_offset + i);
         bufs[bufcount].len = send_info.payload_size;
         bufcount++;
       }
@@ -1920,6 +1923,34 @@ namespace platf {
     return WSASendMsg((SOCKET) send_info.native_socket, &msg, 0, &bytes_sent, nullptr, nullptr) != SOCKET_ERROR;
   }
 
+  bool enable_socket_txtime(uintptr_t native_socket) {
+    // Departure times are not supported, so the caller keeps pacing with sleeps
+    return false;
+  }
+
+  bool socket_txtime_honored(const boost::asio::ip::address &address) {
+    return false;
+  }
+
+  std::unique_ptr<async_batch_sender_t> create_async_batch_sender() {
+    // Only synchronous batched sends are supported
+    return nullptr;
+  }
+
+  std::unique_ptr<batched_receiver_t> create_batched_receiver(std::size_t count, std::size_t buffer_size) {
+    // Datagrams are received one at a time
+    return nullptr;
+  }
+
+  int send_messages(send_info_t *messages, std::size_t count) {
+    // No multi-message send, so each packet costs a system call. A packet that can't be
+    // sent is logged by send(), and the rest still go out.
+    for (std::size_t i = 0; i < count; ++i) {
+      send(messages[i]);
+    }
+    return (int) count;
+  }
+
   bool send(send_info_t &send_info) {
     WSAMSG msg;
 
@@ -2876,6 +2907,10 @@ namespace platf {
     return std::make_unique<win32_high_precision_timer>();
   }
 
+  timer_overshoot_histogram_t high_precision_timer_overshoot() {
+    return {};
+  }
+
   std::string
     get_clipboard() {
     std::string currentClipboard = utf_utils::to_utf8(getClipboardData());
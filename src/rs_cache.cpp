@@ -0,0 +1,132 @@
+/**
+ * @file src/rs_cache.cpp
+ * @brief Bounded cache of prebuilt Reed-Solomon encoder contexts.
+ */
+#include "rs_cache.h"
+
+#include <algorithm>
+
+namespace fec {
+  namespace {
+    // There are 8 bits for the total shard count of a video FEC block
+    constexpr std::size_t MAX_TOTAL_FEC_SHARDS = 255;
+
+    // Data shard counts warmed around the average frame size
+    constexpr std::size_t WARM_WINDOW = 32;
+  }  // namespace
+
+  shard_geometry_t video_shard_geometry(std::size_t data_shards, std::size_t fec_percentage, std::size_t min_parity_shards) {
+    auto parity_shards = (data_shards * fec_percentage + 99) / 100;
+
+    // increase the FEC percentage for this frame if the parity shard minimum is not met
+    if (parity_shards < min_parity_shards && fec_percentage != 0) {
+      parity_shards = min_parity_shards;
+      fec_percentage = (100 * parity_shards) / data_shards;
+    }
+
+    return {data_shards, parity_shards, fec_percentage};
+  }
+
+  std::size_t max_data_shards_per_block(std::size_t fec_percentage) {
+    // D = 255 / (1 + F), multiplied by 100 since F is the percentage as an integer
+    return (MAX_TOTAL_FEC_SHARDS * 100) / (100 + fec_percentage);
+  }
+
+  std::vector<shard_geometry_t> expected_video_geometries(std::size_t blocksize, std::size_t fec_percentage, std::size_t min_parity_shards, int bitrate_kbps, int fps) {
+    std::vector<shard_geometry_t> geometries;
+    if (fec_percentage == 0 || blocksize == 0) {
+      return geometries;
+    }
+
+    const auto max_data_shards = max_data_shards_per_block(fec_percentage);
+    const auto frame_bytes = (std::size_t) std::max(bitrate_kbps, 0) * 1000 / 8 / (std::size_t) std::max(fps, 1);
+    const auto typical_shards = std::clamp<std::size_t>((frame_bytes + blocksize - 1) / blocksize, 1, max_data_shards);
+
+    const auto first = typical_shards > WARM_WINDOW / 2 ? typical_shards - WARM_WINDOW / 2 : 1;
+    const auto last = std::min(first + WARM_WINDOW - 1, max_data_shards);
+
+    geometries.reserve(last - first + 2);
+    for (auto data_shards = first; data_shards <= last; ++data_shards) {
+      geometries.push_back(video_shard_geometry(data_shards, fec_percentage, min_parity_shards));
+    }
+    if (last < max_data_shards) {
+      geometries.push_back(video_shard_geometry(max_data_shards, fec_percentage, min_parity_shards));
+    }
+
+    return geometries;
+  }
+
+  rs_cache_t::rs_cache_t(std::size_t capacity, reed_solomon_new_t create, reed_solomon_release_t release):
+      capacity_ {std::max<std::size_t>(capacity, 1)},
+      create_ {create},
+      release_ {release} {
+    index_.reserve(capacity_ + 1);
+  }
+
+  std::uint64_t rs_cache_t::key(int data_shards, int parity_shards) {
+    return ((std::uint64_t) (std::uint32_t) data_shards << 32) | (std::uint32_t) parity_shards;
+  }
+
+  rs_cache_t::context_t rs_cache_t::get(int data_shards, int parity_shards) {
+    const auto geometry = key(data_shards, parity_shards);
+
+    {
+      std::lock_guard lg {mutex_};
+      auto it = index_.find(geometry);
+      if (it != std::end(index_)) {
+        ++hits_;
+        // Splicing keeps list iterators valid, so the index needs no update
+        entries_.splice(std::begin(entries_), entries_, it->second);
+        return entries_.front().context;
+      }
+      ++misses_;
+    }
+
+    // Build outside the lock so a miss never stalls other broadcast threads
+    auto *rs = create_(data_shards, parity_shards);
+    if (!rs) {
+      return nullptr;
+    }
+    context_t context {rs, release_};
+
+    std::lock_guard lg {mutex_};
+    auto it = index_.find(geometry);
+    if (it != std::end(index_)) {
+      // Another thread built the same geometry first
+      entries_.splice(std::begin(entries_), entries_, it->second);
+      return entries_.front().context;
+    }
+
+    entries_.push_front(entry_t {data_shards, parity_shards, context});
+    index_.emplace(geometry, std::begin(entries_));
+    if (entries_.size() > capacity_) {
+      // In-flight users keep their shared_ptr, so eviction never frees a context mid-encode
+      const auto &oldest = entries_.back();
+      index_.erase(key(oldest.data_shards, oldest.parity_shards));
+      entries_.pop_back();
+    }
+
+    return context;
+  }
+
+  void rs_cache_t::warm(const std::vector<shard_geometry_t> &geometries) {
+    for (const auto &geometry : geometries) {
+      get((int) geometry.data_shards, (int) geometry.parity_shards);
+    }
+  }
+
+  std::size_t rs_cache_t::size() const {
+    std::lock_guard lg {mutex_};
+    return entries_.size();
+  }
+
+  std::uint64_t rs_cache_t::hits() const {
+    std::lock_guard lg {mutex_};
+    return hits_;
+  }
+
+  std::uint64_t rs_cache_t::misses() const {
+    std::lock_guard lg {mutex_};
+    return misses_;
+  }
+}  // namespace fec
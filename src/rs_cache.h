@@ -0,0 +1,87 @@
+/**
+ * @file src/rs_cache.h
+ * @brief Bounded cache of prebuilt Reed-Solomon encoder contexts.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "rswrapper.h"
+}
+
+namespace fec {
+  struct shard_geometry_t {
+    std::size_t data_shards;
+    std::size_t parity_shards;
+    std::size_t percentage;  // effective FEC percentage after the parity minimum is applied
+  };
+
+  /**
+   * @brief Parity shard count used by the video stream for a block of `data_shards`.
+   * @details Raises the percentage when `min_parity_shards` is not met, as Moonlight expects.
+   */
+  shard_geometry_t video_shard_geometry(std::size_t data_shards, std::size_t fec_percentage, std::size_t min_parity_shards);
+
+  /**
+   * @brief Largest number of data shards that fit a single FEC block at `fec_percentage`.
+   */
+  std::size_t max_data_shards_per_block(std::size_t fec_percentage);
+
+  /**
+   * @brief Shard geometries a session is expected to hit, used to warm the cache.
+   * @details Covers a window of data shard counts around the average encoded frame size for
+   *          the bitrate and frame rate, plus the full block that large (IDR) frames are split into.
+   */
+  std::vector<shard_geometry_t> expected_video_geometries(std::size_t blocksize, std::size_t fec_percentage, std::size_t min_parity_shards, int bitrate_kbps, int fps);
+
+  /**
+   * @brief Thread-safe LRU cache of nanors contexts keyed by (data, parity) shard counts.
+   * @details Building a context constructs and inverts the coding matrix, which dominates the
+   *          cost of encoding small FEC blocks. Encoding only reads the context, so a cached
+   *          instance can be shared by every broadcast thread at once.
+   */
+  class rs_cache_t {
+  public:
+    using context_t = std::shared_ptr<reed_solomon>;
+
+    rs_cache_t(std::size_t capacity, reed_solomon_new_t create, reed_solomon_release_t release);
+
+    /**
+     * @brief Return the context for a geometry, building it on a miss.
+     * @return The context, or nullptr if nanors rejected the geometry.
+     */
+    context_t get(int data_shards, int parity_shards);
+
+    void warm(const std::vector<shard_geometry_t> &geometries);
+
+    std::size_t size() const;
+    std::uint64_t hits() const;
+    std::uint64_t misses() const;
+
+  private:
+    struct entry_t {
+      int data_shards;
+      int parity_shards;
+      context_t context;
+    };
+
+    static std::uint64_t key(int data_shards, int parity_shards);
+
+    std::size_t capacity_;
+    reed_solomon_new_t create_;
+    reed_solomon_release_t release_;
+
+    mutable std::mutex mutex_;
+    std::list<entry_t> entries_;  // most recently used first
+    std::unordered_map<std::uint64_t, std::list<entry_t>::iterator> index_;  // (data, parity) -> entry in entries_
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+  };
+}  // namespace fec
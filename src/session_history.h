@@ -62,6 +62,9 @@ namespace session_history {
 
     double encode_latency_ms = 0;
 
+    // FEC percentage applied to the latest video frame. -1 when the protocol has no video FEC.
+    std::int32_t fec_percentage = -1;
+
     // Computed by the history module's aggregator (not from atomics)
     double actual_fps = 0;
     double actual_bitrate_kbps = 0;
@@ -105,6 +105,7 @@ namespace session_history::sampler {
       std::uint32_t idr_requests = 0;
       std::uint32_t ref_invalidations = 0;
       double encode_latency_ms = 0;
+      std::int32_t fec_percentage = -1;
     };
 
     std::thread g_sampler_thread;
@@ -230,6 +231,7 @@ namespace session_history::sampler {
       sample.idr_requests = snapshot.idr_requests;
       sample.ref_invalidations = snapshot.ref_invalidations;
       sample.encode_latency_ms = snapshot.encode_latency_ms;
+      sample.fec_percentage = snapshot.fec_percentage;
       sample.actual_fps = aggregated.actual_fps;
       sample.actual_bitrate_kbps = aggregated.actual_bitrate_kbps;
       sample.frame_interval_jitter_ms = aggregated.frame_interval_jitter_ms;
@@ -256,6 +258,7 @@ namespace session_history::sampler {
           .idr_requests = info.idr_requests,
           .ref_invalidations = info.invalidate_ref_count,
           .encode_latency_ms = info.encode_latency_ms,
+          .fec_percentage = info.fec_percentage,
         }, ts, host);
       }
     }
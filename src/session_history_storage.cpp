@@ -79,7 +79,8 @@ namespace session_history::storage {
         host_cpu_temp_c REAL DEFAULT -1,
         host_gpu_temp_c REAL DEFAULT -1,
         host_net_rx_bps REAL DEFAULT -1,
-        host_net_tx_bps REAL DEFAULT -1
+        host_net_tx_bps REAL DEFAULT -1,
+        fec_percentage INTEGER DEFAULT -1
       );
 
       CREATE INDEX IF NOT EXISTS idx_samples_session ON samples(session_uuid);
@@ -763,6 +764,11 @@ namespace session_history::storage {
         return false;
       }
     }
+    if (current_schema_version < 8) {
+      if (!add_column("samples", "fec_percentage", "INTEGER DEFAULT -1")) {
+        return false;
+      }
+    }
 
     return exec(db, ("PRAGMA user_version = " + std::to_string(schema_version)).c_str());
   }
@@ -884,8 +890,8 @@ namespace session_history::storage {
       " encode_latency_ms, actual_fps, actual_bitrate_kbps, frame_interval_jitter_ms, "
       " host_cpu_percent, host_gpu_percent, host_gpu_encoder_percent, "
       " host_ram_percent, host_vram_percent, host_cpu_temp_c, host_gpu_temp_c, "
-      " host_net_rx_bps, host_net_tx_bps) "
-      "VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)");
+      " host_net_rx_bps, host_net_tx_bps, fec_percentage) "
+      "VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)");
     if (!stmt) return false;
 
     sqlite3_bind_text(stmt.get(), 1, sample.session_uuid.c_str(), -1, SQLITE_TRANSIENT);
@@ -912,6 +918,7 @@ namespace session_history::storage {
     sqlite3_bind_double(stmt.get(), 22, sample.host_gpu_temp_c);
     sqlite3_bind_double(stmt.get(), 23, sample.host_net_rx_bps);
     sqlite3_bind_double(stmt.get(), 24, sample.host_net_tx_bps);
+    sqlite3_bind_int(stmt.get(), 25, sample.fec_percentage);
 
     if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
       diagnostics::error() << "session_history: sample insert failed for uuid=" << sample.session_uuid
@@ -1070,7 +1077,7 @@ namespace session_history::storage {
         "encode_latency_ms, actual_fps, actual_bitrate_kbps, frame_interval_jitter_ms, "
         "host_cpu_percent, host_gpu_percent, host_gpu_encoder_percent, "
         "host_ram_percent, host_vram_percent, host_cpu_temp_c, host_gpu_temp_c, "
-        "host_net_rx_bps, host_net_tx_bps "
+        "host_net_rx_bps, host_net_tx_bps, fec_percentage "
         "FROM samples WHERE session_uuid = ? ORDER BY timestamp_unix"
         :
         "SELECT session_uuid, timestamp_unix, bytes_sent_total, packets_sent_video, "
@@ -1079,7 +1086,7 @@ namespace session_history::storage {
         "encode_latency_ms, actual_fps, actual_bitrate_kbps, frame_interval_jitter_ms, "
         "host_cpu_percent, host_gpu_percent, host_gpu_encoder_percent, "
         "host_ram_percent, host_vram_percent, host_cpu_temp_c, host_gpu_temp_c, "
-        "host_net_rx_bps, host_net_tx_bps "
+        "host_net_rx_bps, host_net_tx_bps, fec_percentage "
         "FROM ("
         "  SELECT session_uuid, timestamp_unix, bytes_sent_total, packets_sent_video, "
         "  frames_sent, last_frame_index, video_dropped, audio_dropped, "
@@ -1087,7 +1094,7 @@ namespace session_history::storage {
         "  encode_latency_ms, actual_fps, actual_bitrate_kbps, frame_interval_jitter_ms, "
         "  host_cpu_percent, host_gpu_percent, host_gpu_encoder_percent, "
         "  host_ram_percent, host_vram_percent, host_cpu_temp_c, host_gpu_temp_c, "
-        "  host_net_rx_bps, host_net_tx_bps "
+        "  host_net_rx_bps, host_net_tx_bps, fec_percentage "
         "  FROM samples WHERE session_uuid = ? ORDER BY timestamp_unix DESC LIMIT ?"
         ") ORDER BY timestamp_unix");
     if (sample_stmt) {
@@ -1128,6 +1135,7 @@ namespace session_history::storage {
         sample.host_gpu_temp_c = read_optional_real(21, -1);
         sample.host_net_rx_bps = read_optional_real(22, -1);
         sample.host_net_tx_bps = read_optional_real(23, -1);
+        sample.fec_percentage = (std::int32_t) read_optional_real(24, -1);
         detail.samples.push_back(std::move(sample));
       }
     }
@@ -74,7 +74,7 @@ namespace session_history::writer {
     constexpr int DEFAULT_DETAIL_EVENT_LIMIT = 500;
     constexpr int MAX_SAMPLES_PER_SESSION = 7200;
     constexpr int MAX_EVENTS_PER_SESSION = 2000;
-    constexpr int SESSION_HISTORY_SCHEMA_VERSION = 7;
+    constexpr int SESSION_HISTORY_SCHEMA_VERSION = 8;
     constexpr auto DELETE_WAIT_TIMEOUT = std::chrono::seconds(5);
     constexpr std::size_t DEFAULT_MAX_PENDING_CONTROL_COMMANDS = 512;
     constexpr std::size_t DEFAULT_MAX_PENDING_PRIORITY_COMMANDS = 1024;
@@ -7,11 +7,14 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cerrno>
 #include <cmath>
 #include <condition_variable>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <future>
 #include <limits>
 #include <memory>
@@ -35,26 +38,33 @@ extern "C" {
 }
 
 // local includes
+#include "abr_controller.h"
 #include "config.h"
 #include "crypto.h"
 #include "display_device.h"
 #include "display_helper_integration.h"
+#include "fec_controller.h"
 #include "globals.h"
 #include "input.h"
 #include "logging.h"
 #include "network.h"
 #include "nvhttp.h"
+#include "ping_table.h"
 #include "platform/common.h"
 #include "process.h"
+#include "rs_cache.h"
 #include "rtsp.h"
 #include "session_history.h"
 #include "stream.h"
 #include "sync.h"
 #include "system_tray.h"
+#include "thread_pool.h"
 #include "thread_safe.h"
 #include "update.h"
 #include "utility.h"
 #include "uuid.h"
+#include "video_pacing.h"
+#include "video_packetizer.h"
 #include "webrtc_stream.h"
 #ifdef _WIN32
   #include "platform/windows/frame_limiter.h"
@@ -152,6 +162,11 @@ namespace stream {
       }
     }
 
+    std::uint32_t duration_to_stat_us(std::chrono::steady_clock::duration duration) {
+      const auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+      return (std::uint32_t) std::clamp<decltype(duration_us)>(duration_us, 0, std::numeric_limits<std::uint32_t>::max());
+    }
+
     class join_deadline_t {
     public:
       explicit join_deadline_t(std::shared_ptr<std::atomic<const char *>> hung_stage):
@@ -537,6 +552,12 @@ namespace stream {
     std::thread audio_thread;
     std::thread control_thread;
 
+    // Base of the 90 kHz RTP video timestamps, shared by every video send loop
+    std::chrono::steady_clock::time_point video_epoch;
+
+    // The kernel releases video batches at their departure time (SO_TXTIME)
+    bool video_kernel_pacing = false;
+
     asio::io_context io_context;
 
     udp::socket video_sock {io_context};
@@ -582,6 +603,26 @@ namespace stream {
       safe::mail_raw_t::event_t<int> bitrate_events;
 
       std::unique_ptr<platf::deinit_t> qos;
+
+      // Chooses each frame's FEC percentage from the client's loss reports
+      std::unique_ptr<fec_controller_t> fec;
+
+      // Host-side adaptive bitrate, only created when adaptive_bitrate is enabled
+      std::unique_ptr<abr_controller_t> abr;
+
+      // Spreads frames over the frame interval, only created when video_frame_pacing is enabled
+      std::unique_ptr<frame_pacer_t> pacer;
+
+      // When the pacer lets the next frame start. It is the session's own rather than its
+      // broadcast loop's, so in the shared loop other sessions' frames never count as its backlog.
+      std::chrono::steady_clock::time_point pacer_next_frame_start;
+
+      // Dedicated send worker, only started when video_broadcast_per_session is enabled
+      std::shared_ptr<safe::ring_queue_t<video::packet_t>> broadcast_queue;
+      std::thread broadcast_thread;
+
+      // Whether the kernel paces batches to the peer address checked last, with video_kernel_pacing
+      std::optional<std::pair<boost::asio::ip::address, bool>> kernel_pacing;
     } video;
 
     struct {
@@ -598,7 +639,12 @@ namespace stream {
       util::buffer_t<uint8_t *> shards_p;
 
       audio_fec_packet_t fec_packet;
+      int fec_block_packets;  // data packets of the current FEC block that were sent at its first packet's size
+      int fec_block_bytes;  // size of the first packet sent in the current FEC block
       std::unique_ptr<platf::deinit_t> qos;
+
+      // Picks the audio broadcast thread that sends this session's packets
+      std::size_t shard;
     } audio;
 
     struct {
@@ -617,6 +663,9 @@ namespace stream {
       net::peer_t peer;
       std::uint32_t seq;
 
+      // Last time the control thread advanced this session's stream controllers
+      std::chrono::steady_clock::time_point last_tick {std::chrono::steady_clock::now()};
+
       platf::feedback_queue_t feedback_queue;
       safe::mail_raw_t::event_t<video::hdr_info_t> hdr_queue;
     } control;
@@ -644,13 +693,23 @@ namespace stream {
     // Real-time performance counters (updated by broadcast/control threads)
     struct {
       std::atomic<std::uint64_t> frames_sent {0};
+      std::atomic<std::uint64_t> key_frames_sent {0};
       std::atomic<std::uint64_t> packets_sent {0};
       std::atomic<std::uint64_t> bytes_sent {0};
+      std::atomic<std::uint64_t> encoded_bytes {0};  // encoded video payload, excluding headers and parity
       std::atomic<std::uint32_t> idr_requests {0};
       std::atomic<std::uint32_t> invalidate_ref_count {0};
       std::atomic<std::int64_t> client_reported_losses {0};
       std::atomic<std::uint16_t> last_encode_latency_us10 {0};  // in 1/10 ms units
       std::atomic<std::int64_t> last_frame_index {0};
+      std::atomic<std::uint32_t> last_queue_latency_us {0};  // encoder handoff to broadcast pop
+      std::atomic<std::uint32_t> last_send_latency_us {0};  // broadcast pop to last send of the frame
+      std::atomic<std::int32_t> last_fec_percentage {0};  // FEC percentage applied to the last frame
+      std::atomic<std::uint32_t> last_pacer_delay_us {0};  // last frame's wait for the previous frame's pacing
+      std::atomic<std::uint32_t> last_pacing_spread_us {0};  // time the last frame's packets were spread over
+      std::atomic<std::uint64_t> audio_send_syscalls {0};  // send syscalls that carried this session's audio
+      audio::stats_t audio;  // updated by the session's audio capture
+      video::stats_t video;  // updated by the session's video capture
       std::chrono::steady_clock::time_point start_time {std::chrono::steady_clock::now()};
     } stats;
 
@@ -738,6 +797,17 @@ namespace stream {
     }
   }
 
+  /**
+   * @brief Hand a new encoder bitrate to a session's encoder.
+   * @details The caller must hold the control server's session lock.
+   */
+  static void apply_encoder_bitrate(session_t &session, int bitrate_kbps) {
+    // Keep the session metadata (runtime sessions API, history, stats) in sync with the
+    // value the encoder thread will adopt from the event below.
+    session.config.monitor.bitrate = bitrate_kbps;
+    session.video.bitrate_events->raise(bitrate_kbps);
+  }
+
   int set_bitrate_for_sessions(const std::string &client_uuid, int bitrate_kbps) {
     if (bitrate_kbps <= 0) {
       return 0;
@@ -755,11 +825,12 @@ namespace stream {
       if (!client_uuid.empty() && session->device_uuid != client_uuid) {
         continue;
       }
-      // Keep the session metadata (runtime sessions API, history, stats) in sync with the
-      // value the encoder thread will adopt from the event below.
-      session->config.monitor.bitrate = bitrate_kbps;
       session->config.monitor.client_requested_bitrate = bitrate_kbps;
-      session->video.bitrate_events->raise(bitrate_kbps);
+      if (session->video.abr) {
+        // The client's choice becomes the ceiling host-side adaptation works under
+        session->video.abr->set_ceiling(bitrate_kbps);
+      }
+      apply_encoder_bitrate(*session, bitrate_kbps);
       ++updated;
     }
     return updated;
@@ -815,7 +886,33 @@ namespace stream {
       info.client_reported_losses = session->stats.client_reported_losses.load(std::memory_order_relaxed);
       info.encode_latency_ms = session->stats.last_encode_latency_us10.load(std::memory_order_relaxed) / 10.0;
       info.last_frame_index = session->stats.last_frame_index.load(std::memory_order_relaxed);
+      info.video_queue_latency_ms = session->stats.last_queue_latency_us.load(std::memory_order_relaxed) / 1000.0;
+      info.video_send_latency_ms = session->stats.last_send_latency_us.load(std::memory_order_relaxed) / 1000.0;
+      info.fec_percentage = session->stats.last_fec_percentage.load(std::memory_order_relaxed);
+      info.pacing_mode = session->video.pacer ? "frame"s : "rate"s;
+      info.pacing_budget_ms = session->video.pacer ? std::chrono::duration<double, std::milli>(session->video.pacer->budget()).count() : 0.0;
+      info.pacing_spread_ms = session->stats.last_pacing_spread_us.load(std::memory_order_relaxed) / 1000.0;
+      info.pacing_backlog_ms = session->stats.last_pacer_delay_us.load(std::memory_order_relaxed) / 1000.0;
       info.uptime_seconds = std::chrono::duration<double>(now - session->stats.start_time).count();
+      info.audio_send_syscalls = session->stats.audio_send_syscalls.load(std::memory_order_relaxed);
+      info.audio_send_syscalls_per_second = info.uptime_seconds > 0 ? info.audio_send_syscalls / info.uptime_seconds : 0.0;
+      info.audio_capture_latency_ms = session->stats.audio.capture_latency_us.load(std::memory_order_relaxed) / 1000.0;
+      {
+        auto &audio_stats = session->stats.audio;
+        auto per_minute = [&](std::uint64_t value, std::uint64_t frames) {
+          return frames ? value * 60'000.0 / ((double) frames * session->config.audio.packetDuration) : 0.0;
+        };
+        auto active_frames = audio_stats.active_frames.load(std::memory_order_relaxed);
+        auto idle_frames = audio_stats.idle_frames.load(std::memory_order_relaxed);
+        info.audio_active_seconds = active_frames * session->config.audio.packetDuration / 1000.0;
+        info.audio_idle_seconds = idle_frames * session->config.audio.packetDuration / 1000.0;
+        info.audio_active_encode_ms_per_minute = per_minute(audio_stats.active_encode_us.load(std::memory_order_relaxed), active_frames) / 1000.0;
+        info.audio_idle_encode_ms_per_minute = per_minute(audio_stats.idle_encode_us.load(std::memory_order_relaxed), idle_frames) / 1000.0;
+        info.audio_active_bytes_per_minute = per_minute(audio_stats.active_bytes.load(std::memory_order_relaxed), active_frames);
+        info.audio_idle_bytes_per_minute = per_minute(audio_stats.idle_bytes.load(std::memory_order_relaxed), idle_frames);
+      }
+      info.video_static_skipped = session->stats.video.static_skipped.load(std::memory_order_relaxed);
+      info.video_static_refreshes = session->stats.video.static_refreshes.load(std::memory_order_relaxed);
 
       result.push_back(std::move(info));
     }
@@ -1060,25 +1157,63 @@ namespace stream {
       reed_solomon_release(rs);
     }>;
 
+    /**
+     * @brief Process-wide cache of video FEC contexts.
+     * @details 256 entries covers every data shard count of a full block at any FEC percentage.
+     */
+    rs_cache_t &video_rs_cache() {
+      static rs_cache_t cache {
+        256,
+        [](int data_shards, int parity_shards) {
+          return reed_solomon_new(data_shards, parity_shards);
+        },
+        [](reed_solomon *rs) {
+          reed_solomon_release(rs);
+        },
+      };
+      return cache;
+    }
+
+    /**
+     * @brief One FEC block of a video frame, laid out for scatter-gather sends.
+     * @details Each shard is sent as [prefix][header] from the header arena followed by its
+     *          payload. Data shard payloads point into the frame itself wherever possible;
+     *          only parity payloads and encrypted payloads are owned by the block.
+     */
     struct fec_t {
       size_t data_shards;
       size_t nr_shards;
       size_t percentage;
 
-      size_t blocksize;
       size_t prefixsize;
-      util::buffer_t<char> shards;
+      size_t headersize;
+      size_t payloadsize;
       util::buffer_t<char> headers;
-      util::buffer_t<uint8_t *> shards_p;
+      util::buffer_t<char> parity;
+      util::buffer_t<char> ciphertext;
+      util::buffer_t<const char *> payloads;
 
-      std::vector<platf::buffer_descriptor_t> payload_buffers;
+      /**
+       * @brief The complete header sent before a shard's payload: the prefix followed by the shard header.
+       */
+      char *message_header(size_t el) {
+        return &headers[el * message_header_size()];
+      }
 
-      char *data(size_t el) {
-        return (char *) shards_p[el];
+      size_t message_header_size() const {
+        return prefixsize + headersize;
       }
 
       char *prefix(size_t el) {
-        return prefixsize ? &headers[el * prefixsize] : nullptr;
+        return prefixsize ? message_header(el) : nullptr;
+      }
+
+      char *header(size_t el) {
+        return message_header(el) + prefixsize;
+      }
+
+      const char *payload(size_t el) {
+        return payloads[el];
       }
 
       size_t size() const {
@@ -1086,108 +1221,69 @@ namespace stream {
       }
     };
 
-    static fec_t encode(const std::string_view &payload, size_t blocksize, size_t fecpercentage, size_t minparityshards, size_t prefixsize) {
-      auto payload_size = payload.size();
-
-      auto pad = payload_size % blocksize != 0;
-
-      auto aligned_data_shards = payload_size / blocksize;
-      auto data_shards = aligned_data_shards + (pad ? 1 : 0);
-      auto parity_shards = (data_shards * fecpercentage + 99) / 100;
-
-      // increase the FEC percentage for this frame if the parity shard minimum is not met
-      if (parity_shards < minparityshards && fecpercentage != 0) {
-        parity_shards = minparityshards;
-        fecpercentage = (100 * parity_shards) / data_shards;
+    /**
+     * @brief Allocate a block for the given data shard payloads.
+     * @details Shard headers are zeroed and parity payloads are not computed until encode().
+     * @param data_payloads Pointers to the payloadsize bytes of each data shard.
+     */
+    static fec_t make_block(const char *const *data_payloads, size_t data_shards, size_t payloadsize, size_t prefixsize, size_t headersize, size_t fecpercentage, size_t minparityshards) {
+      auto geometry = video_shard_geometry(data_shards, fecpercentage, minparityshards);
+      auto parity_shards = geometry.parity_shards;
+      if (geometry.percentage != fecpercentage) {
+        fecpercentage = geometry.percentage;
 
         BOOST_LOG(verbose) << "Increasing FEC percentage to "sv << fecpercentage << " to meet parity shard minimum"sv << std::endl;
       }
 
       auto nr_shards = data_shards + parity_shards;
 
-      // If we need to store a zero-padded data shard, allocate that first to
-      // to keep the shards in order and reduce buffer fragmentation
-      auto parity_shard_offset = pad ? 1 : 0;
-      util::buffer_t<char> shards {(parity_shard_offset + parity_shards) * blocksize};
-      util::buffer_t<uint8_t *> shards_p {nr_shards};
-      std::vector<platf::buffer_descriptor_t> payload_buffers;
-      payload_buffers.reserve(2);
-
-      // Point into the payload buffer for all except the final padded data shard
-      auto next = std::begin(payload);
-      for (auto x = 0; x < aligned_data_shards; ++x) {
-        shards_p[x] = (uint8_t *) next;
-        next += blocksize;
-      }
-      payload_buffers.emplace_back(std::begin(payload), aligned_data_shards * blocksize);
-
-      // If the last data shard needs to be zero-padded, we must use the shards buffer
-      if (pad) {
-        shards_p[aligned_data_shards] = (uint8_t *) &shards[0];
-
-        // GCC doesn't figure out that std::copy_n() can be replaced with memcpy() here
-        // and ends up compiling a horribly slow element-by-element copy loop, so we
-        // help it by using memcpy()/memset() directly.
-        auto copy_len = std::min<size_t>(blocksize, std::end(payload) - next);
-        std::memcpy(shards_p[aligned_data_shards], next, copy_len);
-        if (copy_len < blocksize) {
-          // Zero any additional space after the end of the payload
-          std::memset(shards_p[aligned_data_shards] + copy_len, 0, blocksize - copy_len);
-        }
-      }
-
-      // Add a payload buffer describing the shard buffer
-      payload_buffers.emplace_back(std::begin(shards), shards.size());
-
-      if (fecpercentage != 0) {
-        // Point into our allocated buffer for the parity shards
-        for (auto x = 0; x < parity_shards; ++x) {
-          shards_p[data_shards + x] = (uint8_t *) &shards[(parity_shard_offset + x) * blocksize];
-        }
-
-        // packets = parity_shards + data_shards
-        rs_t rs {reed_solomon_new((int) data_shards, (int) parity_shards)};
-
-        reed_solomon_encode(rs.get(), shards_p.begin(), (int) nr_shards, (int) blocksize);
+      util::buffer_t<char> parity {parity_shards * payloadsize};
+      util::buffer_t<const char *> payloads {nr_shards};
+      std::copy_n(data_payloads, data_shards, payloads.begin());
+      for (auto x = 0; x < parity_shards; ++x) {
+        payloads[data_shards + x] = &parity[x * payloadsize];
       }
 
       return {
         data_shards,
         nr_shards,
         fecpercentage,
-        blocksize,
         prefixsize,
-        std::move(shards),
-        util::buffer_t<char> {nr_shards * prefixsize},
-        std::move(shards_p),
-        std::move(payload_buffers),
+        headersize,
+        payloadsize,
+        util::buffer_t<char> {nr_shards * (prefixsize + headersize)},
+        std::move(parity),
+        util::buffer_t<char> {},
+        std::move(payloads),
       };
     }
-  }  // namespace fec
 
-  /**
-   * @brief Combines two buffers and inserts new buffers at each slice boundary of the result.
-   * @param insert_size The number of bytes to insert.
-   * @param slice_size The number of bytes between insertions.
-   * @param data1 The first data buffer.
-   * @param data2 The second data buffer.
-   */
-  std::vector<uint8_t> replace(const std::string_view &original, const std::string_view &old, const std::string_view &_new) {
-    std::vector<uint8_t> replaced;
-    replaced.reserve(original.size() + _new.size() - old.size());
+    /**
+     * @brief Compute the parity shards of a block whose data shard headers are filled in.
+     * @details Reed-Solomon coding works on each byte offset of the shards independently, so
+     *          coding the headers and the payloads as two separate passes yields the same parity
+     *          as coding the contiguous [header][payload] shards.
+     */
+    static void encode(fec_t &block) {
+      if (block.nr_shards == block.data_shards) {
+        return;
+      }
 
-    auto begin = std::begin(original);
-    auto end = std::end(original);
-    auto next = std::search(begin, end, std::begin(old), std::end(old));
+      auto rs = video_rs_cache().get((int) block.data_shards, (int) (block.nr_shards - block.data_shards));
 
-    std::copy(begin, next, std::back_inserter(replaced));
-    if (next != end) {
-      std::copy(std::begin(_new), std::end(_new), std::back_inserter(replaced));
-      std::copy(next + old.size(), end, std::back_inserter(replaced));
-    }
+      util::buffer_t<uint8_t *> shards_p {block.nr_shards};
+      for (auto x = 0; x < block.nr_shards; ++x) {
+        shards_p[x] = (uint8_t *) block.header(x);
+      }
+      reed_solomon_encode(rs.get(), shards_p.begin(), (int) block.nr_shards, (int) block.headersize);
 
-    return replaced;
-  }
+      // nanors only writes to the parity shards, so the data payloads can stay read-only
+      for (auto x = 0; x < block.nr_shards; ++x) {
+        shards_p[x] = (uint8_t *) block.payloads[x];
+      }
+      reed_solomon_encode(rs.get(), shards_p.begin(), (int) block.nr_shards, (int) block.payloadsize);
+    }
+  }  // namespace fec
 
   /**
    * @brief Pass gamepad feedback data back to the client.
@@ -1386,6 +1482,13 @@ namespace stream {
       auto lastGoodFrame = *last_good_frame;
 
       saturating_add_relaxed(session->stats.client_reported_losses, static_cast<std::int64_t>(count));
+      session->video.fec->on_loss_report(
+        count,
+        t,
+        lastGoodFrame,
+        session->stats.packets_sent.load(std::memory_order_relaxed),
+        session->stats.last_frame_index.load(std::memory_order_relaxed)
+      );
 
       BOOST_LOG(verbose)
         << "type [IDX_LOSS_STATS]"sv << std::endl
@@ -1400,6 +1503,7 @@ namespace stream {
       BOOST_LOG(debug) << "type [IDX_REQUEST_IDR_FRAME]"sv;
 
       saturating_add_relaxed(session->stats.idr_requests, 1u);
+      session->video.fec->on_recovery_request();
       session->video.idr_events->raise(true);
     });
 
@@ -1420,6 +1524,7 @@ namespace stream {
       }
 
       saturating_add_relaxed(session->stats.invalidate_ref_count, 1u);
+      session->video.fec->on_recovery_request();
 
       BOOST_LOG(debug)
         << "type [IDX_INVALIDATE_REF_FRAMES]"sv << std::endl
@@ -1707,6 +1812,37 @@ namespace stream {
             }
             has_session_awaiting_peer = true;
           } else {
+            auto elapsed = std::min(now - session->control.last_tick, std::chrono::steady_clock::duration {1s});
+            if (elapsed >= 50ms) {
+              session->control.last_tick = now;
+              session->video.fec->tick(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed));
+
+              if (session->video.abr) {
+                // Waits in the shared broadcast loop include other sessions' frames
+                std::optional<std::chrono::microseconds> queue_latency;
+                std::optional<std::chrono::microseconds> pacer_delay;
+                if (session->video.broadcast_queue) {
+                  queue_latency = std::chrono::microseconds {session->stats.last_queue_latency_us.load(std::memory_order_relaxed)};
+                  pacer_delay = std::chrono::microseconds {session->stats.last_pacer_delay_us.load(std::memory_order_relaxed)};
+                }
+
+                auto bitrate = session->video.abr->update({
+                  std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+                  session->stats.client_reported_losses.load(std::memory_order_relaxed),
+                  session->stats.packets_sent.load(std::memory_order_relaxed),
+                  session->stats.encoded_bytes.load(std::memory_order_relaxed),
+                  session->stats.idr_requests.load(std::memory_order_relaxed) + session->stats.invalidate_ref_count.load(std::memory_order_relaxed),
+                  session->stats.key_frames_sent.load(std::memory_order_relaxed),
+                  queue_latency,
+                  pacer_delay,
+                });
+                if (bitrate) {
+                  BOOST_LOG(info) << "Adaptive bitrate: "sv << session->config.monitor.bitrate << " -> "sv << *bitrate << " kbps"sv;
+                  apply_encoder_bitrate(*session, *bitrate);
+                }
+              }
+            }
+
             auto &feedback_queue = session->control.feedback_queue;
             while (feedback_queue->peek()) {
               auto feedback_msg = feedback_queue->pop();
@@ -1775,9 +1911,19 @@ namespace stream {
     server->flush();
   }
 
+  /**
+   * @brief Key a session registers its PING queue under.
+   */
+  static ping_key_t to_ping_key(const av_session_id_t &session_id) {
+    if (auto address = std::get_if<asio::ip::address>(&session_id)) {
+      return ping_key_t::from_address(*address);
+    }
+    return ping_key_t::from_payload(std::get<std::string>(session_id));
+  }
+
   void recvThread(broadcast_ctx_t &ctx) {
-    std::map<av_session_id_t, message_queue_t> peer_to_video_session;
-    std::map<av_session_id_t, message_queue_t> peer_to_audio_session;
+    ping_table_t<message_queue_t> peer_to_video_session;
+    ping_table_t<message_queue_t> peer_to_audio_session;
 
     auto &video_sock = ctx.video_sock;
     auto &audio_sock = ctx.audio_sock;
@@ -1792,6 +1938,14 @@ namespace stream {
     std::array<char, 2048> buf[2];
     std::function<void(const boost::system::error_code, size_t)> recv_func[2];
 
+    // Where the platform supports it, each wakeup drains a socket with batched receives
+    constexpr std::size_t recv_batch_size = 32;
+    std::unique_ptr<platf::batched_receiver_t> receivers[2] {
+      platf::create_batched_receiver(recv_batch_size, buf[0].size()),
+      platf::create_batched_receiver(recv_batch_size, buf[1].size()),
+    };
+    std::function<void(const boost::system::error_code &)> wait_func[2];
+
     platf::set_thread_name("stream::recv");
 
     auto populate_peer_to_session = [&]() {
@@ -1799,34 +1953,45 @@ namespace stream {
         auto message_queue_opt = message_queue_queue->pop();
         TUPLE_3D_REF(socket_type, session_id, message_queue, *message_queue_opt);
 
-        switch (socket_type) {
-          case socket_e::video:
-            if (message_queue) {
-              peer_to_video_session.insert_or_assign(session_id, message_queue);
-            } else {
-              peer_to_video_session.erase(session_id);
-            }
-            break;
-          case socket_e::audio:
-            if (message_queue) {
-              peer_to_audio_session.insert_or_assign(session_id, message_queue);
-            } else {
-              peer_to_audio_session.erase(session_id);
-            }
-            break;
+        auto &peer_to_session = socket_type == socket_e::video ? peer_to_video_session : peer_to_audio_session;
+        if (message_queue) {
+          peer_to_session.insert_or_assign(to_ping_key(session_id), message_queue);
+        } else {
+          peer_to_session.erase(to_ping_key(session_id));
         }
       }
     };
 
-    auto recv_func_init = [&](udp::socket &sock, int buf_elem, std::map<av_session_id_t, message_queue_t> &peer_to_session) {
+    // Looking up the session doesn't allocate, since clients keep pinging long after the
+    // handshake that consumes the messages
+    auto dispatch = [&](int buf_elem, ping_table_t<message_queue_t> &peer_to_session, const udp::endpoint &from, std::string_view data) {
+      auto type_str = buf_elem ? "AUDIO"sv : "VIDEO"sv;
+      BOOST_LOG(verbose) << "Recv: "sv << from.address().to_string() << ':' << from.port() << " :: " << type_str;
+
+      (buf_elem ? ctx.audio_recv_count : ctx.video_recv_count).fetch_add(1, std::memory_order_relaxed);
+
+      message_queue_t *message_queue = nullptr;
+      if (data.size() == 4) {
+        // For legacy PING packets, find the matching session by address.
+        message_queue = peer_to_session.find(ping_key_t::from_address(from.address()));
+      } else if (data.size() >= sizeof(SS_PING)) {
+        auto ping = (PSS_PING) data.data();
+
+        // For new PING packets that include a client identifier, search by payload.
+        message_queue = peer_to_session.find(ping_key_t::from_payload({ping->payload, sizeof(ping->payload)}));
+      }
+
+      if (message_queue) {
+        (*message_queue)->raise(from, std::string {data});
+      }
+    };
+
+    auto recv_func_init = [&](udp::socket &sock, int buf_elem, ping_table_t<message_queue_t> &peer_to_session) {
       recv_func[buf_elem] = [&, buf_elem](const boost::system::error_code &ec, size_t bytes) {
         auto fg = util::fail_guard([&]() {
           sock.async_receive_from(asio::buffer(buf[buf_elem]), peer, 0, recv_func[buf_elem]);
         });
 
-        auto type_str = buf_elem ? "AUDIO"sv : "VIDEO"sv;
-        BOOST_LOG(verbose) << "Recv: "sv << peer.address().to_string() << ':' << peer.port() << " :: " << type_str;
-
         populate_peer_to_session();
 
         // No data, yet no error
@@ -1839,475 +2004,834 @@ namespace stream {
           return;
         }
 
-        (buf_elem ? ctx.audio_recv_count : ctx.video_recv_count).fetch_add(1, std::memory_order_relaxed);
+        dispatch(buf_elem, peer_to_session, peer, {buf[buf_elem].data(), bytes});
+      };
+    };
+
+    auto wait_func_init = [&](udp::socket &sock, int buf_elem, ping_table_t<message_queue_t> &peer_to_session) {
+      wait_func[buf_elem] = [&, buf_elem](const boost::system::error_code &ec) {
+        auto fg = util::fail_guard([&]() {
+          sock.async_wait(udp::socket::wait_read, wait_func[buf_elem]);
+        });
+
+        populate_peer_to_session();
+
+        if (ec) {
+          BOOST_LOG(error) << "Couldn't wait for data on udp socket: "sv << ec.message();
+          return;
+        }
+
+        auto &receiver = *receivers[buf_elem];
 
-        if (bytes == 4) {
-          // For legacy PING packets, find the matching session by address.
-          auto it = peer_to_session.find(peer.address());
-          if (it != std::end(peer_to_session)) {
-            it->second->raise(peer, std::string {buf[buf_elem].data(), bytes});
+        // Bound the rounds so a flood on one socket can't starve the other
+        for (int round = 0; round < 8; ++round) {
+          auto received = receiver.receive(sock.native_handle());
+          if (received < 0) {
+            BOOST_LOG(error) << "Couldn't receive data from udp socket: "sv << std::strerror(errno);
+            return;
           }
-        } else if (bytes >= sizeof(SS_PING)) {
-          auto ping = (PSS_PING) buf[buf_elem].data();
 
-          // For new PING packets that include a client identifier, search by payload.
-          auto it = peer_to_session.find(std::string {ping->payload, sizeof(ping->payload)});
-          if (it != std::end(peer_to_session)) {
-            it->second->raise(peer, std::string {buf[buf_elem].data(), bytes});
+          for (int x = 0; x < received; ++x) {
+            dispatch(buf_elem, peer_to_session, receiver.peer(x), receiver.data(x));
+          }
+
+          if ((std::size_t) received < recv_batch_size) {
+            break;
           }
         }
       };
     };
 
-    recv_func_init(video_sock, 0, peer_to_video_session);
-    recv_func_init(audio_sock, 1, peer_to_audio_session);
+    if (receivers[0] && receivers[1]) {
+      wait_func_init(video_sock, 0, peer_to_video_session);
+      wait_func_init(audio_sock, 1, peer_to_audio_session);
 
-    video_sock.async_receive_from(asio::buffer(buf[0]), peer, 0, recv_func[0]);
-    audio_sock.async_receive_from(asio::buffer(buf[1]), peer, 0, recv_func[1]);
+      video_sock.async_wait(udp::socket::wait_read, wait_func[0]);
+      audio_sock.async_wait(udp::socket::wait_read, wait_func[1]);
+    } else {
+      recv_func_init(video_sock, 0, peer_to_video_session);
+      recv_func_init(audio_sock, 1, peer_to_audio_session);
+
+      video_sock.async_receive_from(asio::buffer(buf[0]), peer, 0, recv_func[0]);
+      audio_sock.async_receive_from(asio::buffer(buf[1]), peer, 0, recv_func[1]);
+    }
 
     while (!broadcast_shutdown_event->peek()) {
       io.run();
     }
   }
 
-  void videoBroadcastThread(udp::socket &sock) {
-    auto shutdown_event = mail::man->event<bool>(mail::broadcast_shutdown);
-    auto packets = mail::man->queue<video::packet_t>(mail::video_packets);
-    auto video_epoch = std::chrono::steady_clock::now();
+  /**
+   * @brief Send state owned by a single video broadcast loop.
+   * @details The shared broadcast thread and every per-session worker own one of these,
+   *          so the pacer position, encryption batch and periodic loggers are never shared
+   *          between loops. Within a loop, the prepare-stage members are only touched by
+   *          the frame being prepared and the send-stage members by the frame being sent,
+   *          which lets the two stages run on different threads when pipelining.
+   */
+  struct video_broadcast_worker_t {
+    video_broadcast_worker_t(std::chrono::steady_clock::time_point video_epoch, bool kernel_pacing):
+        video_epoch {video_epoch},
+        kernel_pacing {kernel_pacing},
+        timer {platf::create_high_precision_timer()},
+        ratecontrol_next_frame_start {std::chrono::steady_clock::now()} {
+    }
 
-    // Video traffic is sent on this thread. The send pacer (pacing_max_bitrate_kbps)
-    // relies on this thread waking on its millisecond sleep deadlines; losing the
-    // scheduler slot to lower-priority work reintroduces the per-frame burst pattern
-    // the pacer exists to prevent. Note critical maps to THREAD_PRIORITY_HIGHEST on
-    // Windows (nice -15 on Linux) — the top of the normal dynamic range, not a
-    // realtime class — the same level video::capture and controlBroadcast already use.
-    platf::set_thread_name("stream::videoBroadcast");
-    platf::adjust_thread_priority(platf::thread_priority_e::critical);
+    std::chrono::steady_clock::time_point video_epoch;
+    bool kernel_pacing;
 
-    logging::min_max_avg_periodic_logger<double> frame_processing_latency_logger(debug, "Frame processing latency", "ms");
-    logging::min_max_avg_periodic_logger<double> frame_capture_interval_logger(debug, "Frame capture interval", "ms");
-    logging::min_max_avg_periodic_logger<double> packet_queue_latency_logger(debug, "Video packet queue latency", "ms");
-    logging::min_max_avg_periodic_logger<double> ratecontrol_sleep_logger(debug, "Network: rate control sleep", "ms");
-    logging::min_max_avg_periodic_logger<double> ratecontrol_late_logger(debug, "Network: rate control late", "ms");
-    logging::min_max_avg_periodic_logger<double> ratecontrol_frame_packets_logger(debug, "Network: frame packets sent", "packets");
-    logging::min_max_avg_periodic_logger<double> ratecontrol_batch_packets_logger(debug, "Network: send_batch packet count", "packets");
+    // Prepare stage
+    std::vector<crypto::cipher::gcm_t::batch_item_t> encrypt_batch;
+    std::optional<std::chrono::steady_clock::time_point> last_frame_timestamp;
 
-    logging::time_delta_periodic_logger frame_send_batch_latency_logger(debug, "Network: each send_batch() latency");
-    logging::time_delta_periodic_logger frame_fec_latency_logger(debug, "Network: each FEC block latency");
-    logging::time_delta_periodic_logger frame_network_latency_logger(debug, "Network: frame's overall network latency");
+    logging::min_max_avg_periodic_logger<double> frame_processing_latency_logger {debug, "Frame processing latency", "ms"};
+    logging::min_max_avg_periodic_logger<double> frame_capture_interval_logger {debug, "Frame capture interval", "ms"};
+    logging::min_max_avg_periodic_logger<double> frame_copied_bytes_logger {debug, "Video bytes copied per frame", "bytes"};
+    logging::time_delta_periodic_logger frame_fec_latency_logger {debug, "Network: each FEC block latency"};
+    logging::time_delta_periodic_logger frame_encrypt_latency_logger {debug, "Network: each FEC block encryption latency"};
+
+    // Send stage
+    std::unique_ptr<platf::high_precision_timer> timer;
+    std::unique_ptr<platf::async_batch_sender_t> async_sender;  // nullptr = synchronous send_batch()
+    std::chrono::steady_clock::time_point ratecontrol_next_frame_start;
+
+    logging::min_max_avg_periodic_logger<double> packet_queue_latency_logger {debug, "Video packet queue latency", "ms"};
+    logging::min_max_avg_periodic_logger<double> ratecontrol_sleep_logger {debug, "Network: rate control sleep", "ms"};
+    logging::min_max_avg_periodic_logger<double> ratecontrol_late_logger {debug, "Network: rate control late", "ms"};
+    logging::min_max_avg_periodic_logger<double> ratecontrol_frame_packets_logger {debug, "Network: frame packets sent", "packets"};
+    logging::min_max_avg_periodic_logger<double> ratecontrol_batch_packets_logger {debug, "Network: send_batch packet count", "packets"};
+
+    logging::time_delta_periodic_logger frame_send_batch_latency_logger {debug, "Network: each send_batch() latency"};
+    logging::time_delta_periodic_logger frame_network_latency_logger {debug, "Network: frame's overall network latency"};
+  };
 
-    crypto::aes_t iv(12);
+  /**
+   * @brief A frame whose shards are fully built: headers filled, FEC computed and encrypted.
+   * @details Owns every buffer its shards point into, so it can be handed from the prepare
+   *          stage to the send stage without copying.
+   */
+  struct prepared_video_frame_t {
+    session_t *session;
+    video::packet_t packet;
+
+    std::chrono::steady_clock::time_point pop_timestamp;
+    std::uint32_t rtp_timestamp;
+    bool is_dupe;
+
+    std::size_t blocksize;
+    video_short_frame_header_t frame_header;
+    payload_layout_t layout;  // data shard payloads, aliasing packet and frame_header where possible
+    std::vector<fec::fec_t> blocks;
+  };
 
-    auto timer = platf::create_high_precision_timer();
-    if (!timer || !*timer) {
-      BOOST_LOG(error) << "Failed to create timer, aborting video broadcast thread";
-      return;
-    }
+  struct queued_video_frame_t {
+    session_t *session;
+    video::packet_t packet;
 
-    auto ratecontrol_next_frame_start = std::chrono::steady_clock::now();
-    std::optional<std::chrono::steady_clock::time_point> last_frame_timestamp;
+    std::chrono::steady_clock::time_point pop_timestamp;
+    std::chrono::steady_clock::time_point dupe_timestamp;  // RTP timestamp source for frames that carry none
+  };
 
-    while (auto packet = packets->pop()) {
-      if (shutdown_event->peek()) {
-        break;
-      }
+  /**
+   * @brief Packetize a frame and build its FEC and encrypted shards.
+   * @details Consumes the session's sequence number and IV counter ranges, so frames of one
+   *          session must be prepared in order.
+   * @param worker Broadcast loop the frame belongs to.
+   * @param frame Frame to prepare.
+   */
+  prepared_video_frame_t prepare_video_frame(video_broadcast_worker_t &worker, queued_video_frame_t frame) {
+    auto session = frame.session;
 
-      frame_network_latency_logger.first_point_now();
+    prepared_video_frame_t prepared {
+      session,
+      std::move(frame.packet),
+      frame.pop_timestamp,
+    };
+    auto &frame_packet = prepared.packet;
 
-      auto session = (session_t *) packet->channel_data;
-      if (!session) {
-        continue;
+    if (frame_packet->frame_timestamp) {
+      if (worker.last_frame_timestamp) {
+        worker.frame_capture_interval_logger.collect_and_log(std::chrono::duration<double, std::milli>(*frame_packet->frame_timestamp - *worker.last_frame_timestamp).count());
       }
-      const auto packet_pop_timestamp = std::chrono::steady_clock::now();
-      packet_queue_latency_logger.collect_and_log(std::chrono::duration<double, std::milli>(packet_pop_timestamp - packet->packet_enqueue_timestamp).count());
-      if (packet->frame_timestamp) {
-        if (last_frame_timestamp) {
-          frame_capture_interval_logger.collect_and_log(std::chrono::duration<double, std::milli>(*packet->frame_timestamp - *last_frame_timestamp).count());
-        }
-        last_frame_timestamp = *packet->frame_timestamp;
+      worker.last_frame_timestamp = *frame_packet->frame_timestamp;
+    }
+
+    auto lowseq = session->video.lowseq;
+
+    std::string_view payload {(char *) frame_packet->data(), frame_packet->data_size()};
+    std::vector<std::string_view> segments {payload};
+
+    // Apply replacements on the packet payload before performing any other operations.
+    // We need to know the final frame size to calculate the last packet size, and we
+    // must avoid matching replacements against the frame header or any other non-video
+    // part of the payload. Replacements only split the segment list, so neither the
+    // frame nor the replacement data is copied here.
+    if (frame_packet->is_idr() && frame_packet->replacements) {
+      for (auto &replacement : *frame_packet->replacements) {
+        replace_in_segments(segments, replacement.old, replacement._new);
       }
+    }
 
-      auto lowseq = session->video.lowseq;
+    std::size_t payload_size = 0;
+    for (auto &segment : segments) {
+      payload_size += segment.size();
+    }
+    saturating_add_relaxed(session->stats.encoded_bytes, (std::uint64_t) payload_size);
 
-      std::string_view payload {(char *) packet->data(), packet->data_size()};
-      std::vector<uint8_t> payload_with_replacements;
+    auto &frame_header = prepared.frame_header;
+    frame_header = {};
+    frame_header.headerType = 0x01;  // Short header type
+    frame_header.frameType = frame_packet->is_idr()                     ? 2 :
+                             frame_packet->after_ref_frame_invalidation ? 5 :
+                                                                          1;
+    frame_header.lastPayloadLen = (payload_size + sizeof(frame_header)) % (session->config.packetsize - sizeof(NV_VIDEO_PACKET));
+    if (frame_header.lastPayloadLen == 0) {
+      frame_header.lastPayloadLen = session->config.packetsize - sizeof(NV_VIDEO_PACKET);
+    }
 
-      // Apply replacements on the packet payload before performing any other operations.
-      // We need to know the final frame size to calculate the last packet size, and we
-      // must avoid matching replacements against the frame header or any other non-video
-      // part of the payload.
-      if (packet->is_idr() && packet->replacements) {
-        for (auto &replacement : *packet->replacements) {
-          auto frame_old = replacement.old;
-          auto frame_new = replacement._new;
+    auto host_processing_timestamp = frame_packet->host_processing_timestamp ? frame_packet->host_processing_timestamp : frame_packet->frame_timestamp;
+    if (host_processing_timestamp) {
+      auto duration_to_latency = [](const std::chrono::steady_clock::duration &duration) {
+        const auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return (uint16_t) std::clamp<decltype(duration_us)>((duration_us + 50) / 100, 0, std::numeric_limits<uint16_t>::max());
+      };
 
-          payload_with_replacements = replace(payload, frame_old, frame_new);
-          payload = {(char *) payload_with_replacements.data(), payload_with_replacements.size()};
-        }
-      }
+      uint16_t latency = duration_to_latency(std::chrono::steady_clock::now() - *host_processing_timestamp);
+      frame_header.frame_processing_latency = latency;
+      worker.frame_processing_latency_logger.collect_and_log(latency / 10.);
+      session->stats.last_encode_latency_us10.store(latency, std::memory_order_relaxed);
+    } else {
+      frame_header.frame_processing_latency = 0;
+      session->stats.last_encode_latency_us10.store(0, std::memory_order_relaxed);
+    }
 
-      video_short_frame_header_t frame_header = {};
-      frame_header.headerType = 0x01;  // Short header type
-      frame_header.frameType = packet->is_idr()                     ? 2 :
-                               packet->after_ref_frame_invalidation ? 5 :
-                                                                      1;
-      frame_header.lastPayloadLen = (payload.size() + sizeof(frame_header)) % (session->config.packetsize - sizeof(NV_VIDEO_PACKET));
-      if (frame_header.lastPayloadLen == 0) {
-        frame_header.lastPayloadLen = session->config.packetsize - sizeof(NV_VIDEO_PACKET);
-      }
+    auto fecPercentage = session->video.fec->percentage();
 
-      auto host_processing_timestamp = packet->host_processing_timestamp ? packet->host_processing_timestamp : packet->frame_timestamp;
-      if (host_processing_timestamp) {
-        auto duration_to_latency = [](const std::chrono::steady_clock::duration &duration) {
-          const auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
-          return (uint16_t) std::clamp<decltype(duration_us)>((duration_us + 50) / 100, 0, std::numeric_limits<uint16_t>::max());
-        };
+    // Each shard is sent as a packet header from the header arena followed by a payload slice
+    // of the frame. Only the shard holding the frame header, shards straddling a replacement
+    // and the zero-padded final shard are copied.
+    auto blocksize = session->config.packetsize + MAX_RTP_HEADER_SIZE;
+    auto payload_blocksize = blocksize - sizeof(video_packet_raw_t);
+    prepared.blocksize = blocksize;
+    segments.insert(std::begin(segments), std::string_view {(char *) &frame_header, sizeof(frame_header)});
+    prepared.layout = layout_shard_payloads(segments, payload_blocksize);
+    worker.frame_copied_bytes_logger.collect_and_log((double) prepared.layout.copied_bytes);
 
-        uint16_t latency = duration_to_latency(std::chrono::steady_clock::now() - *host_processing_timestamp);
-        frame_header.frame_processing_latency = latency;
-        frame_processing_latency_logger.collect_and_log(latency / 10.);
-        session->stats.last_encode_latency_us10.store(latency, std::memory_order_relaxed);
-      } else {
-        frame_header.frame_processing_latency = 0;
-        session->stats.last_encode_latency_us10.store(0, std::memory_order_relaxed);
-      }
+    const auto total_shards = prepared.layout.shards.size();
 
-      auto fecPercentage = config::stream.fec_percentage;
+    // Large frames (IDRs at high FEC percentages) get less parity so they still fit the
+    // protocol's FEC block limit
+    auto frame_percentage = frame_fec_percentage(fecPercentage, total_shards);
+    if (frame_percentage != fecPercentage) {
+      BOOST_LOG(verbose) << "Reducing FEC to "sv << frame_percentage << "% for a "sv << total_shards << " packet frame"sv;
+      fecPercentage = frame_percentage;
+    }
 
-      // Insert space for packet headers
-      auto blocksize = session->config.packetsize + MAX_RTP_HEADER_SIZE;
-      auto payload_blocksize = blocksize - sizeof(video_packet_raw_t);
-      auto payload_new = concat_and_insert(sizeof(video_packet_raw_t), payload_blocksize, std::string_view {(char *) &frame_header, sizeof(frame_header)}, payload);
+    // The max number of data shards per block is found by solving this system of equations for D:
+    // D = 255 - P
+    // P = D * F
+    // which results in the solution:
+    // D = 255 / (1 + F)
+    auto max_data_shards_per_fec_block = fec::max_data_shards_per_block(fecPercentage);
 
-      payload = std::string_view {(char *) payload_new.data(), payload_new.size()};
+    // Compute the number of FEC blocks needed for this frame using the max shards
+    auto fec_blocks_needed = (total_shards + (max_data_shards_per_fec_block - 1)) / max_data_shards_per_fec_block;
 
-      // There are 2 bits for FEC block count for a maximum of 4 FEC blocks
-      constexpr auto MAX_FEC_BLOCKS = 4;
-      constexpr auto MAX_TOTAL_FEC_SHARDS = 255;
+    // Frames over 1020 packets exceed the protocol limit even without FEC, so they are sent
+    // without parity in blocks larger than the FEC limit.
+    if (fec_blocks_needed > MAX_FEC_BLOCKS) {
+      BOOST_LOG(warning) << "Skipping FEC for abnormally large encoded frame (needed "sv << fec_blocks_needed << " FEC blocks)"sv;
+      fecPercentage = 0;
+      fec_blocks_needed = MAX_FEC_BLOCKS;
+    }
+    session->stats.last_fec_percentage.store(fecPercentage, std::memory_order_relaxed);
 
-      // The max number of data shards per block is found by solving this system of equations for D:
-      // D = 255 - P
-      // P = D * F
-      // which results in the solution:
-      // D = 255 / (1 + F)
-      // multiplied by 100 since F is the percentage as an integer:
-      // D = (255 * 100) / (100 + F)
-      auto max_data_shards_per_fec_block = (MAX_TOTAL_FEC_SHARDS * 100) / (100 + fecPercentage);
+    BOOST_LOG(verbose) << "Generating "sv << fec_blocks_needed << " FEC blocks"sv;
 
-      // Compute the number of FEC blocks needed for this frame using the block size and max shards
-      auto max_data_per_fec_block = max_data_shards_per_fec_block * blocksize;
-      auto fec_blocks_needed = (payload.size() + (max_data_per_fec_block - 1)) / max_data_per_fec_block;
+    // Spread the shards evenly over the FEC blocks
+    auto shards_per_block = (total_shards + (fec_blocks_needed - 1)) / fec_blocks_needed;
 
-      // If the number of FEC blocks needed exceeds the protocol limit, turn off FEC for this frame.
-      // For normal FEC percentages, this should only happen for enormous frames (over 800 packets at 20%).
-      if (fec_blocks_needed > MAX_FEC_BLOCKS) {
-        BOOST_LOG(warning) << "Skipping FEC for abnormally large encoded frame (needed "sv << fec_blocks_needed << " FEC blocks)"sv;
-        fecPercentage = 0;
-        fec_blocks_needed = MAX_FEC_BLOCKS;
-      }
+    // If we exceed the 10-bit FEC packet index (which means our frame exceeded 4096 packets),
+    // the frame will be unrecoverable. Log an error for this case.
+    if (shards_per_block >= 1024) {
+      BOOST_LOG(error) << "Encoder produced a frame too large to send! Is the encoder broken? (needed "sv << shards_per_block << " packets)"sv;
+    }
+
+    // RTP video timestamps use a 90 KHz clock and the paced/scheduled frame timestamp.
+    // Raw capture timing is tracked separately for frame_processing_latency.
+    // When a timestamp isn't available (duplicate frames), the timestamp from rate control is used instead.
+    prepared.is_dupe = false;
+    if (!frame_packet->frame_timestamp) {
+      frame_packet->frame_timestamp = frame.dupe_timestamp;
+      prepared.is_dupe = true;
+    }
+    using rtp_tick = std::chrono::duration<uint32_t, std::ratio<1, 90000>>;
+    prepared.rtp_timestamp = std::chrono::round<rtp_tick>(*frame_packet->frame_timestamp - worker.video_epoch).count();
 
-      std::array<std::string_view, MAX_FEC_BLOCKS> fec_blocks;
-      decltype(fec_blocks)::iterator
-        fec_blocks_begin = std::begin(fec_blocks),
-        fec_blocks_end = std::begin(fec_blocks) + fec_blocks_needed;
+    // If video encryption is enabled, we allocate space for the encryption header before each shard
+    auto prefixsize = session->video.cipher ? sizeof(video_packet_enc_prefix_t) : 0;
 
-      BOOST_LOG(verbose) << "Generating "sv << fec_blocks_needed << " FEC blocks"sv;
+    prepared.blocks.reserve(fec_blocks_needed);
+    for (std::size_t blockIndex = 0, first_shard = 0; blockIndex < fec_blocks_needed && first_shard < total_shards; ++blockIndex) {
+      // The last block must extend to the end of the frame
+      auto packets = blockIndex == fec_blocks_needed - 1 ? total_shards - first_shard : std::min(shards_per_block, total_shards - first_shard);
 
-      // Align individual FEC blocks to blocksize
-      auto unaligned_size = payload.size() / fec_blocks_needed;
-      auto aligned_size = ((unaligned_size + (blocksize - 1)) / blocksize) * blocksize;
+      auto shards = fec::make_block(&prepared.layout.shards[first_shard], packets, payload_blocksize, prefixsize, sizeof(video_packet_raw_t), fecPercentage, session->config.minRequiredFecPackets);
+      first_shard += packets;
 
-      // If we exceed the 10-bit FEC packet index (which means our frame exceeded 4096 packets),
-      // the frame will be unrecoverable. Log an error for this case.
-      if (aligned_size / blocksize >= 1024) {
-        BOOST_LOG(error) << "Encoder produced a frame too large to send! Is the encoder broken? (needed "sv << (aligned_size / blocksize) << " packets)"sv;
-      }
+      for (int x = 0; x < packets; ++x) {
+        auto *inspect = (video_packet_raw_t *) shards.header(x);
 
-      // Split the data into aligned FEC blocks
-      for (int x = 0; x < fec_blocks_needed; ++x) {
-        if (x == fec_blocks_needed - 1) {
-          // The last block must extend to the end of the payload
-          fec_blocks[x] = payload.substr(x * aligned_size);
-        } else {
-          // Earlier blocks just extend to the next block offset
-          fec_blocks[x] = payload.substr(x * aligned_size, aligned_size);
+        inspect->packet.frameIndex = (uint32_t) frame_packet->frame_index();
+        inspect->packet.streamPacketIndex = ((uint32_t) lowseq + x) << 8;
+
+        // Match multiFecFlags with Moonlight
+        inspect->packet.multiFecFlags = 0x10;
+        inspect->packet.multiFecBlocks = (blockIndex << 4) | ((fec_blocks_needed - 1) << 6);
+
+        inspect->packet.flags = FLAG_CONTAINS_PIC_DATA;
+        if (x == 0) {
+          inspect->packet.flags |= FLAG_SOF;
+        }
+        if (x == packets - 1) {
+          inspect->packet.flags |= FLAG_EOF;
         }
       }
 
-      try {
-        // Pacing target: legacy default targets ~80% of 1 Gbps (Ethernet). On WiFi
-        // links the legacy value collapses to a no-op pacer (frames get blasted out
-        // faster than the link can absorb, then idle), which amplifies AMPDU-aggregation
-        // jitter on the client. If the operator sets `pacing_max_bitrate_kbps` we honor
-        // it; otherwise keep legacy behaviour.
-        size_t pacing_bps;
-        if (config::stream.pacing_max_bitrate_kbps > 0) {
-          pacing_bps = (size_t) config::stream.pacing_max_bitrate_kbps * 1000ull;
-
-          // Never pace below the session's negotiated bitrate: a cap under the encoder's
-          // output rate makes the sender permanently slower than the encoder, so the packet
-          // queue (and stream latency) grows without bound. Clamp to ~110% of the stream
-          // bitrate, re-evaluated per frame since the ABR endpoint can raise it mid-session.
-          size_t session_floor_bps = (size_t) session->config.monitor.bitrate * 1000ull * 110 / 100;
-          if (pacing_bps < session_floor_bps) {
-            static std::atomic_flag pacing_clamp_warned;
-            if (!pacing_clamp_warned.test_and_set()) {
-              BOOST_LOG(warning) << "pacing_max_bitrate_kbps ("sv << config::stream.pacing_max_bitrate_kbps
-                                 << " kbps) is below the negotiated stream bitrate ("sv << session->config.monitor.bitrate
-                                 << " kbps); clamping the pacer to 110% of the stream bitrate"sv;
-            }
-            pacing_bps = session_floor_bps;
-          }
-        } else {
-          pacing_bps = (size_t) (std::giga::num * 80 / 100);  // 80% of 1 Gbps
-        }
-        //                                          bps    ms    packet      byte
-        size_t ratecontrol_packets_in_1ms = pacing_bps / 1000 / blocksize / 8;
-        if (ratecontrol_packets_in_1ms == 0) {
-          // Floor at one packet/ms so the inner pacing loop never divides by zero
-          // and we still send something on absurdly low bitrate caps.
-          ratecontrol_packets_in_1ms = 1;
+      worker.frame_fec_latency_logger.first_point_now();
+      fec::encode(shards);
+      worker.frame_fec_latency_logger.second_point_now_and_log();
+
+      if (session->video.cipher) {
+        // Data shard payloads alias the encoder's buffer, so they are encrypted into a separate
+        // buffer. Headers and parity payloads belong to the block and are encrypted in place.
+        shards.ciphertext = util::buffer_t<char> {shards.data_shards * payload_blocksize};
+        worker.encrypt_batch.clear();
+      }
+
+      // set FEC info now that we know for sure what our percentage will be for this frame
+      for (auto x = 0; x < shards.size(); ++x) {
+        auto *inspect = (video_packet_raw_t *) shards.header(x);
+
+        inspect->packet.fecInfo =
+          (uint32_t) (x << 12 |
+                      shards.data_shards << 22 |
+                      shards.percentage << 4);
+
+        inspect->rtp.header = 0x80 | FLAG_EXTENSION;
+        inspect->rtp.sequenceNumber = util::endian::big<uint16_t>(lowseq + x);
+        inspect->rtp.timestamp = util::endian::big<uint32_t>(prepared.rtp_timestamp);
+
+        inspect->packet.multiFecBlocks = (blockIndex << 4) | ((fec_blocks_needed - 1) << 6);
+        inspect->packet.frameIndex = (uint32_t) frame_packet->frame_index();
+
+        // Queue this shard for encryption if video encryption is enabled
+        if (session->video.cipher) {
+          auto *payload_cipher = x < shards.data_shards ? &shards.ciphertext[x * payload_blocksize] : (char *) shards.payload(x);
+
+          auto *prefix = (video_packet_enc_prefix_t *) shards.prefix(x);
+          prefix->frameNumber = (std::uint32_t) frame_packet->frame_index();
+          worker.encrypt_batch.push_back({
+            std::string_view {(char *) inspect, sizeof(video_packet_raw_t)},
+            (uint8_t *) inspect,
+            std::string_view {shards.payload(x), payload_blocksize},
+            (uint8_t *) payload_cipher,
+            prefix->tag,
+            prefix->iv,
+          });
+          shards.payloads[x] = payload_cipher;
         }
+      }
 
-        // Send less than 64K in a single batch.
-        // On Windows, batches above 64K seem to bypass SO_SNDBUF regardless of its size,
-        // appear in "Other I/O" and begin waiting for interrupts.
-        // This gives inconsistent performance so we'd rather avoid it.
-        size_t max_batch_size_bytes = 64 * 1024;
-        max_batch_size_bytes = std::min<size_t>(max_batch_size_bytes, (size_t) config::stream.video_max_batch_size_kb * 1024);
+      if (session->video.cipher) {
+        // We use the deterministic IV construction algorithm specified in NIST SP 800-38D
+        // Section 8.2.1. The sequence number is our "invocation" field and the 'V' in the
+        // high bytes is the "fixed" field. Because each client provides their own unique
+        // key, our values in the fixed field need only uniquely identify each independent
+        // use of the client's key with AES-GCM in our code.
+        //
+        // The IV counter is 64 bits long which allows for 2^64 encrypted video packets
+        // to be sent to each client before the IV repeats.
+        worker.frame_encrypt_latency_logger.first_point_now();
+        if (session->video.cipher->encrypt_batch(worker.encrypt_batch.data(), worker.encrypt_batch.size(), session->video.gcm_iv_counter, 'V')) {
+          BOOST_LOG(error) << "Failed to encrypt video frame "sv << frame_packet->frame_index();
+        }
+        worker.frame_encrypt_latency_logger.second_point_now_and_log();
+      }
 
-        size_t send_batch_size = std::max<size_t>(1, max_batch_size_bytes / blocksize);
-        // Also don't exceed 64 packets, which can happen when Moonlight requests
-        // unusually small packet size.
-        // Generic Segmentation Offload on Linux can't do more than 64.
-        send_batch_size = std::min<size_t>(64, send_batch_size);
+      lowseq += shards.size();
+      prepared.blocks.push_back(std::move(shards));
+    }
 
-        // Don't ignore the last ratecontrol group of the previous frame
-        auto ratecontrol_frame_start = std::max(ratecontrol_next_frame_start, std::chrono::steady_clock::now());
+    session->video.lowseq = lowseq;
 
-        size_t ratecontrol_frame_packets_sent = 0;
-        size_t ratecontrol_group_packets_sent = 0;
+    return prepared;
+  }
 
-        auto blockIndex = 0;
-        std::for_each(fec_blocks_begin, fec_blocks_end, [&](std::string_view &current_payload) {
-          auto packets = (current_payload.size() + (blocksize - 1)) / blocksize;
+  prepared_video_frame_t prepare_video_frame_pooled(video_broadcast_worker_t &worker, queued_video_frame_t frame) {
+    // Prepare threads sit on the send path, so they run at the broadcast threads' priority
+    thread_local bool prioritized = false;
+    if (!prioritized) {
+      platf::adjust_thread_priority(platf::thread_priority_e::critical);
+      prioritized = true;
+    }
 
-          for (int x = 0; x < packets; ++x) {
-            auto *inspect = (video_packet_raw_t *) &current_payload[x * blocksize];
+    return prepare_video_frame(worker, std::move(frame));
+  }
 
-            inspect->packet.frameIndex = (uint32_t) packet->frame_index();
-            inspect->packet.streamPacketIndex = ((uint32_t) lowseq + x) << 8;
+  /**
+   * @brief Pace a prepared frame out to its session and update the session counters.
+   * @param worker Broadcast loop the frame belongs to.
+   * @param sock Video socket to send from.
+   * @param frame Frame built by prepare_video_frame().
+   */
+  void send_prepared_video_frame(video_broadcast_worker_t &worker, udp::socket &sock, prepared_video_frame_t &frame) {
+    auto session = frame.session;
+    auto &packet = frame.packet;
+    auto blocksize = frame.blocksize;
+
+    // Pacing target: legacy default targets ~80% of 1 Gbps (Ethernet). On WiFi
+    // links the legacy value collapses to a no-op pacer (frames get blasted out
+    // faster than the link can absorb, then idle), which amplifies AMPDU-aggregation
+    // jitter on the client. If the operator sets `pacing_max_bitrate_kbps` we honor
+    // it; otherwise keep legacy behaviour.
+    size_t pacing_bps;
+    if (config::stream.pacing_max_bitrate_kbps > 0) {
+      pacing_bps = (size_t) config::stream.pacing_max_bitrate_kbps * 1000ull;
+
+      // Never pace below the session's negotiated bitrate: a cap under the encoder's
+      // output rate makes the sender permanently slower than the encoder, so the packet
+      // queue (and stream latency) grows without bound. Clamp to ~110% of the stream
+      // bitrate, re-evaluated per frame since the ABR endpoint can raise it mid-session.
+      size_t session_floor_bps = (size_t) session->config.monitor.bitrate * 1000ull * 110 / 100;
+      if (pacing_bps < session_floor_bps) {
+        static std::atomic_flag pacing_clamp_warned;
+        if (!pacing_clamp_warned.test_and_set()) {
+          BOOST_LOG(warning) << "pacing_max_bitrate_kbps ("sv << config::stream.pacing_max_bitrate_kbps
+                             << " kbps) is below the negotiated stream bitrate ("sv << session->config.monitor.bitrate
+                             << " kbps); clamping the pacer to 110% of the stream bitrate"sv;
+        }
+        pacing_bps = session_floor_bps;
+      }
+    } else {
+      pacing_bps = (size_t) (std::giga::num * 80 / 100);  // 80% of 1 Gbps
+    }
+    size_t ratecontrol_packets_in_1ms = pacing_packets_per_ms(pacing_bps, blocksize);
+
+    size_t frame_packets = 0;
+    for (auto &shards : frame.blocks) {
+      frame_packets += shards.size();
+    }
+
+    // Send less than 64K in a single batch.
+    // On Windows, batches above 64K seem to bypass SO_SNDBUF regardless of its size,
+    // appear in "Other I/O" and begin waiting for interrupts.
+    // This gives inconsistent performance so we'd rather avoid it.
+    size_t max_batch_size_bytes = 64 * 1024;
+    max_batch_size_bytes = std::min<size_t>(max_batch_size_bytes, (size_t) config::stream.video_max_batch_size_kb * 1024);
+
+    size_t send_batch_size = std::max<size_t>(1, max_batch_size_bytes / blocksize);
+    // Also don't exceed 64 packets, which can happen when Moonlight requests
+    // unusually small packet size.
+    // Generic Segmentation Offload on Linux can't do more than 64.
+    send_batch_size = std::min<size_t>(64, send_batch_size);
+
+    // Don't ignore the last ratecontrol group of the previous frame
+    auto &next_frame_start = session->video.pacer ? session->video.pacer_next_frame_start : worker.ratecontrol_next_frame_start;
+    auto frame_ready = std::chrono::steady_clock::now();
+    auto ratecontrol_frame_start = std::max(next_frame_start, frame_ready);
+    auto pacer_delay = std::chrono::duration_cast<std::chrono::microseconds>(ratecontrol_frame_start - frame_ready);
+    session->stats.last_pacer_delay_us.store((std::uint32_t) pacer_delay.count(), std::memory_order_relaxed);
+
+    // Frame pacing spreads the frame over a share of its interval instead of sending it at
+    // pacing_bps. The rate still caps it, and sets how many packets to group between sleeps.
+    std::optional<std::chrono::nanoseconds> frame_spread;
+    if (session->video.pacer) {
+      frame_spread = session->video.pacer->plan(frame_packets, packet->is_idr(), pacer_delay, ratecontrol_packets_in_1ms);
+      ratecontrol_packets_in_1ms = (size_t) std::max<std::int64_t>(1, std::chrono::nanoseconds {1ms} * (std::int64_t) frame_packets / std::max(*frame_spread, 1ns));
+    }
+    auto ratecontrol_due = [&](size_t packets_sent) {
+      if (frame_spread) {
+        return pacing_due(ratecontrol_frame_start, packets_sent, frame_packets, *frame_spread);
+      }
+      return pacing_due(ratecontrol_frame_start, packets_sent, ratecontrol_packets_in_1ms);
+    };
+    session->stats.last_pacing_spread_us.store(
+      duration_to_stat_us(frame_spread ? *frame_spread : std::chrono::nanoseconds {1ms} * (std::int64_t) frame_packets / (std::int64_t) ratecontrol_packets_in_1ms),
+      std::memory_order_relaxed
+    );
 
-            // Match multiFecFlags with Moonlight
-            inspect->packet.multiFecFlags = 0x10;
-            inspect->packet.multiFecBlocks = (blockIndex << 4) | ((fec_blocks_needed - 1) << 6);
+    size_t ratecontrol_frame_packets_sent = 0;
+    size_t ratecontrol_group_packets_sent = 0;
+
+    // SO_TXTIME is only worth relying on when the route to the peer goes through a qdisc that
+    // holds packets until their departure time. Otherwise every frame would leave as a burst.
+    bool kernel_pacing = false;
+    if (worker.kernel_pacing) {
+      auto peer_address = session->video.peer.address();
+      auto &checked = session->video.kernel_pacing;
+      if (!checked || checked->first != peer_address) {
+        checked.emplace(peer_address, platf::socket_txtime_honored(peer_address));
+      }
+      kernel_pacing = checked->second;
+    }
+
+    // Shard payloads are passed as per-block pointers, so no contiguous payload buffers are needed
+    std::vector<platf::buffer_descriptor_t> payload_buffers;
+
+    worker.frame_network_latency_logger.first_point(frame.pop_timestamp);
+    for (auto &shards : frame.blocks) {
+      auto peer_address = session->video.peer.address();
+      auto batch_info = platf::batched_send_info_t {
+        shards.headers.begin(),
+        shards.message_header_size(),
+        payload_buffers,
+        shards.payloadsize,
+        0,
+        0,
+        (uintptr_t) sock.native_handle(),
+        peer_address,
+        session->video.peer.port(),
+        session->localAddress,
+        shards.payloads.begin(),
+      };
 
-            inspect->packet.flags = FLAG_CONTAINS_PIC_DATA;
-            if (x == 0) {
-              inspect->packet.flags |= FLAG_SOF;
+      size_t next_shard_to_send = 0;
+
+      for (auto x = 0; x < shards.size(); ++x) {
+        if (x - next_shard_to_send + 1 >= send_batch_size ||
+            x + 1 == shards.size()) {
+          // Do pacing within the frame.
+          // Also trigger pacing before the first send_batch() of the frame
+          // to account for the last send_batch() of the previous frame.
+          if (kernel_pacing) {
+            // Hand the batch to the kernel now, stamped with the time it may leave.
+            // The qdisc spaces every batch exactly, so there's no need to group them.
+            auto due = ratecontrol_due(ratecontrol_frame_packets_sent);
+            auto now = std::chrono::steady_clock::now();
+            if (now < due) {
+              batch_info.departure_time = due;
+            } else {
+              batch_info.departure_time.reset();
+              worker.ratecontrol_late_logger.collect_and_log(std::chrono::duration<double, std::milli>(now - due).count());
             }
-            if (x == packets - 1) {
-              inspect->packet.flags |= FLAG_EOF;
+          } else if (ratecontrol_group_packets_sent >= ratecontrol_packets_in_1ms ||
+                     ratecontrol_frame_packets_sent == 0) {
+            auto due = ratecontrol_due(ratecontrol_frame_packets_sent);
+
+            auto now = std::chrono::steady_clock::now();
+            if (now < due) {
+              auto sleep_time = due - now;
+              worker.ratecontrol_sleep_logger.collect_and_log(std::chrono::duration<double, std::milli>(sleep_time).count());
+              worker.timer->sleep_until(due);
+            } else {
+              worker.ratecontrol_late_logger.collect_and_log(std::chrono::duration<double, std::milli>(now - due).count());
             }
-          }
 
-          frame_fec_latency_logger.first_point_now();
-          // If video encryption is enabled, we allocate space for the encryption header before each shard
-          auto shards = fec::encode(current_payload, blocksize, fecPercentage, session->config.minRequiredFecPackets, session->video.cipher ? sizeof(video_packet_enc_prefix_t) : 0);
-          frame_fec_latency_logger.second_point_now_and_log();
-
-          auto peer_address = session->video.peer.address();
-          auto batch_info = platf::batched_send_info_t {
-            shards.headers.begin(),
-            shards.prefixsize,
-            shards.payload_buffers,
-            shards.blocksize,
-            0,
-            0,
-            (uintptr_t) sock.native_handle(),
-            peer_address,
-            session->video.peer.port(),
-            session->localAddress,
-          };
+            ratecontrol_group_packets_sent = 0;
+          }
 
-          size_t next_shard_to_send = 0;
+          size_t current_batch_size = x - next_shard_to_send + 1;
+          worker.ratecontrol_batch_packets_logger.collect_and_log((double) current_batch_size);
+          batch_info.block_offset = next_shard_to_send;
+          batch_info.block_count = current_batch_size;
 
-          // RTP video timestamps use a 90 KHz clock and the paced/scheduled frame timestamp.
-          // Raw capture timing is tracked separately for frame_processing_latency.
-          // When a timestamp isn't available (duplicate frames), the timestamp from rate control is used instead.
-          bool frame_is_dupe = false;
-          if (!packet->frame_timestamp) {
-            packet->frame_timestamp = ratecontrol_next_frame_start;
-            frame_is_dupe = true;
+          worker.frame_send_batch_latency_logger.first_point_now();
+          auto queued = worker.async_sender && worker.async_sender->send(batch_info);
+          if (queued && !kernel_pacing) {
+            // With kernel pacing the whole frame is submitted at once after the loop
+            worker.async_sender->submit();
           }
-          using rtp_tick = std::chrono::duration<uint32_t, std::ratio<1, 90000>>;
-          uint32_t timestamp = std::chrono::round<rtp_tick>(*packet->frame_timestamp - video_epoch).count();
-
-          // set FEC info now that we know for sure what our percentage will be for this frame
-          for (auto x = 0; x < shards.size(); ++x) {
-            auto *inspect = (video_packet_raw_t *) shards.data(x);
-
-            inspect->packet.fecInfo =
-              (uint32_t) (x << 12 |
-                          shards.data_shards << 22 |
-                          shards.percentage << 4);
-
-            inspect->rtp.header = 0x80 | FLAG_EXTENSION;
-            inspect->rtp.sequenceNumber = util::endian::big<uint16_t>(lowseq + x);
-            inspect->rtp.timestamp = util::endian::big<uint32_t>(timestamp);
-
-            inspect->packet.multiFecBlocks = (blockIndex << 4) | ((fec_blocks_needed - 1) << 6);
-            inspect->packet.frameIndex = (uint32_t) packet->frame_index();
-
-            // Encrypt this shard if video encryption is enabled
-            if (session->video.cipher) {
-              // We use the deterministic IV construction algorithm specified in NIST SP 800-38D
-              // Section 8.2.1. The sequence number is our "invocation" field and the 'V' in the
-              // high bytes is the "fixed" field. Because each client provides their own unique
-              // key, our values in the fixed field need only uniquely identify each independent
-              // use of the client's key with AES-GCM in our code.
-              //
-              // The IV counter is 64 bits long which allows for 2^64 encrypted video packets
-              // to be sent to each client before the IV repeats.
-              std::copy_n((uint8_t *) &session->video.gcm_iv_counter, sizeof(session->video.gcm_iv_counter), std::begin(iv));
-              iv[11] = 'V';  // Video stream
-              session->video.gcm_iv_counter++;
-
-              // Encrypt the target buffer in place
-              auto *prefix = (video_packet_enc_prefix_t *) shards.prefix(x);
-              prefix->frameNumber = (std::uint32_t) packet->frame_index();
-              std::copy(std::begin(iv), std::end(iv), prefix->iv);
-              session->video.cipher->encrypt(std::string_view {(char *) inspect, (size_t) blocksize}, prefix->tag, (uint8_t *) inspect, &iv);
+
+          // Use a batched send if it's supported on this platform
+          if (!queued && !platf::send_batch(batch_info)) {
+            // Batched send is not available, so send each packet individually
+            BOOST_LOG(verbose) << "Falling back to unbatched send"sv;
+            for (auto y = 0; y < current_batch_size; y++) {
+              auto send_info = platf::send_info_t {
+                shards.message_header(next_shard_to_send + y),
+                shards.message_header_size(),
+                shards.payload(next_shard_to_send + y),
+                shards.payloadsize,
+                (uintptr_t) sock.native_handle(),
+                peer_address,
+                session->video.peer.port(),
+                session->localAddress,
+              };
+
+              platf::send(send_info);
             }
+          }
+          worker.frame_send_batch_latency_logger.second_point_now_and_log();
 
-            if (x - next_shard_to_send + 1 >= send_batch_size ||
-                x + 1 == shards.size()) {
-              // Do pacing within the frame.
-              // Also trigger pacing before the first send_batch() of the frame
-              // to account for the last send_batch() of the previous frame.
-              if (ratecontrol_group_packets_sent >= ratecontrol_packets_in_1ms ||
-                  ratecontrol_frame_packets_sent == 0) {
-                auto due = ratecontrol_frame_start +
-                           std::chrono::duration_cast<std::chrono::nanoseconds>(1ms) *
-                             ratecontrol_frame_packets_sent / ratecontrol_packets_in_1ms;
-
-                auto now = std::chrono::steady_clock::now();
-                if (now < due) {
-                  auto sleep_time = due - now;
-                  ratecontrol_sleep_logger.collect_and_log(std::chrono::duration<double, std::milli>(sleep_time).count());
-                  timer->sleep_for(sleep_time);
-                } else {
-                  ratecontrol_late_logger.collect_and_log(std::chrono::duration<double, std::milli>(now - due).count());
-                }
+          ratecontrol_group_packets_sent += current_batch_size;
+          ratecontrol_frame_packets_sent += current_batch_size;
+          next_shard_to_send = x + 1;
+        }
+      }
 
-                ratecontrol_group_packets_sent = 0;
-              }
+      // remember this in case the next frame comes immediately
+      next_frame_start = ratecontrol_due(ratecontrol_frame_packets_sent);
+      worker.ratecontrol_frame_packets_logger.collect_and_log((double) ratecontrol_frame_packets_sent);
 
-              size_t current_batch_size = x - next_shard_to_send + 1;
-              ratecontrol_batch_packets_logger.collect_and_log((double) current_batch_size);
-              batch_info.block_offset = next_shard_to_send;
-              batch_info.block_count = current_batch_size;
-
-              frame_send_batch_latency_logger.first_point_now();
-              // Use a batched send if it's supported on this platform
-              if (!platf::send_batch(batch_info)) {
-                // Batched send is not available, so send each packet individually
-                BOOST_LOG(verbose) << "Falling back to unbatched send"sv;
-                for (auto y = 0; y < current_batch_size; y++) {
-                  auto send_info = platf::send_info_t {
-                    shards.prefix(next_shard_to_send + y),
-                    shards.prefixsize,
-                    shards.data(next_shard_to_send + y),
-                    shards.blocksize,
-                    (uintptr_t) sock.native_handle(),
-                    peer_address,
-                    session->video.peer.port(),
-                    session->localAddress,
-                  };
-
-                  platf::send(send_info);
-                }
-              }
-              frame_send_batch_latency_logger.second_point_now_and_log();
+      BOOST_LOG(verbose) << "Sent Frame seq ["sv << packet->frame_index() << "] pts ["sv << frame.rtp_timestamp
+                         << "] shards ["sv << shards.size() << "/"sv << shards.percentage << "%]"sv
+                         << (frame.is_dupe ? " Dupe" : "")
+                         << (packet->is_idr() ? " Key" : "")
+                         << (packet->after_ref_frame_invalidation ? " RFI" : "");
+    }
 
-              ratecontrol_group_packets_sent += current_batch_size;
-              ratecontrol_frame_packets_sent += current_batch_size;
-              next_shard_to_send = x + 1;
-            }
+    if (worker.async_sender) {
+      worker.async_sender->submit();
+    }
+
+    worker.frame_network_latency_logger.second_point_now_and_log();
+
+    // Update per-session performance counters
+    session->stats.frames_sent.fetch_add(1, std::memory_order_relaxed);
+    if (packet->is_idr()) {
+      session->stats.key_frames_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    session->stats.packets_sent.fetch_add(ratecontrol_frame_packets_sent, std::memory_order_relaxed);
+    auto bytes_per_packet = blocksize + ((session->config.encryptionFlagsEnabled & SS_ENC_VIDEO) ? sizeof(video_packet_enc_prefix_t) : 0);
+    session->stats.bytes_sent.fetch_add(ratecontrol_frame_packets_sent * bytes_per_packet, std::memory_order_relaxed);
+    session->stats.last_frame_index.store(packet->frame_index(), std::memory_order_relaxed);
+    session->stats.last_send_latency_us.store(duration_to_stat_us(std::chrono::steady_clock::now() - frame.pop_timestamp), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Prepare and send frames until `next` runs dry.
+   * @details When video_fec_pipeline_threads is set, the next queued frame is prepared on a
+   *          prepare thread owned by this loop while the current one is being paced out. Only
+   *          one frame per loop is ever being prepared, which keeps each session's sequence
+   *          numbers and IVs in order, and per-session loops never wait on each other's jobs.
+   * @param worker Broadcast loop state.
+   * @param sock Video socket to send from.
+   * @param next Returns the next frame for this loop; blocks when `wait` is true.
+   */
+  void send_video_frames(video_broadcast_worker_t &worker, udp::socket &sock, const std::function<std::optional<queued_video_frame_t>(bool wait)> &next) {
+    // A loop only ever prepares one frame ahead, so a single thread of its own is enough
+    std::optional<thread_pool_util::ThreadPool> prepare_pool;
+    if (config::stream.video_fec_pipeline_threads > 0) {
+      prepare_pool.emplace(1);
+    }
+    auto pool = prepare_pool ? &*prepare_pool : nullptr;
+
+    if (config::stream.video_io_uring_send && !worker.async_sender) {
+      worker.async_sender = platf::create_async_batch_sender();
+    }
+
+    // Frames the async sender may still be reading, oldest first
+    constexpr std::size_t max_retiring_frames = 4;
+    std::deque<std::pair<std::uint64_t, prepared_video_frame_t>> retiring;
+    auto retire_frames = [&](bool all) {
+      while (!retiring.empty() &&
+             worker.async_sender->completed(retiring.front().first, all || retiring.size() > max_retiring_frames)) {
+        retiring.pop_front();
+      }
+    };
+
+    // Pops the next frame and records its queue latency
+    auto dequeue = [&](bool wait, bool pipelined) {
+      auto frame = next(wait);
+      if (frame) {
+        frame->pop_timestamp = std::chrono::steady_clock::now();
+        const auto queue_latency = frame->pop_timestamp - frame->packet->packet_enqueue_timestamp;
+        worker.packet_queue_latency_logger.collect_and_log(std::chrono::duration<double, std::milli>(queue_latency).count());
+        frame->session->stats.last_queue_latency_us.store(duration_to_stat_us(queue_latency), std::memory_order_relaxed);
+
+        // The pacer position belongs to the send stage, so a pipelined dupe frame
+        // is stamped with its encoder handoff time instead.
+        if (pipelined) {
+          frame->dupe_timestamp = frame->packet->packet_enqueue_timestamp;
+        } else {
+          frame->dupe_timestamp = frame->session->video.pacer ? frame->session->video.pacer_next_frame_start : worker.ratecontrol_next_frame_start;
+        }
+      }
+      return frame;
+    };
+
+    std::future<prepared_video_frame_t> pending;
+    while (true) {
+      std::optional<prepared_video_frame_t> ready;
+      try {
+        if (!pool) {
+          auto frame = dequeue(true, false);
+          if (!frame) {
+            break;
           }
 
-          // remember this in case the next frame comes immediately
-          ratecontrol_next_frame_start = ratecontrol_frame_start +
-                                         std::chrono::duration_cast<std::chrono::nanoseconds>(1ms) *
-                                           ratecontrol_frame_packets_sent / ratecontrol_packets_in_1ms;
-          ratecontrol_frame_packets_logger.collect_and_log((double) ratecontrol_frame_packets_sent);
+          ready = prepare_video_frame(worker, std::move(*frame));
+        } else {
+          if (!pending.valid()) {
+            auto frame = dequeue(true, true);
+            if (!frame) {
+              break;
+            }
 
-          frame_network_latency_logger.second_point_now_and_log();
+            pending = pool->push(prepare_video_frame_pooled, std::ref(worker), std::move(*frame));
+          }
 
-          BOOST_LOG(verbose) << "Sent Frame seq ["sv << packet->frame_index() << "] pts ["sv << timestamp
-                             << "] shards ["sv << shards.size() << "/"sv << shards.percentage << "%]"sv
-                             << (frame_is_dupe ? " Dupe" : "")
-                             << (packet->is_idr() ? " Key" : "")
-                             << (packet->after_ref_frame_invalidation ? " RFI" : "");
+          ready = pending.get();
 
-          ++blockIndex;
-          lowseq += shards.size();
-        });
+          // Start preparing the next frame now so it overlaps this frame's paced send
+          if (auto frame = dequeue(false, true)) {
+            pending = pool->push(prepare_video_frame_pooled, std::ref(worker), std::move(*frame));
+          }
+        }
 
-        session->video.lowseq = lowseq;
+        send_prepared_video_frame(worker, sock, *ready);
 
-        // Update per-session performance counters
-        session->stats.frames_sent.fetch_add(1, std::memory_order_relaxed);
-        session->stats.packets_sent.fetch_add(ratecontrol_frame_packets_sent, std::memory_order_relaxed);
-        auto bytes_per_packet = blocksize + ((session->config.encryptionFlagsEnabled & SS_ENC_VIDEO) ? sizeof(video_packet_enc_prefix_t) : 0);
-        session->stats.bytes_sent.fetch_add(ratecontrol_frame_packets_sent * bytes_per_packet, std::memory_order_relaxed);
-        session->stats.last_frame_index.store(packet->frame_index(), std::memory_order_relaxed);
+        if (worker.async_sender) {
+          // The kernel may still be reading this frame's shards, so keep them until it is done
+          retiring.emplace_back(worker.async_sender->fence(), std::move(*ready));
+          retire_frames(false);
+        }
       } catch (const std::exception &e) {
         BOOST_LOG(error) << "Broadcast video failed "sv << e.what();
+        if (worker.async_sender) {
+          // Part of the frame may already be queued
+          worker.async_sender->completed(worker.async_sender->fence(), true);
+        }
         std::this_thread::sleep_for(100ms);
       }
     }
 
-    shutdown_event->raise(true);
+    // Never leave a prepare job running against this loop's state
+    if (pending.valid()) {
+      pending.wait();
+    }
+
+    if (worker.async_sender) {
+      retire_frames(true);
+    }
   }
 
-  void audioBroadcastThread(udp::socket &sock) {
+  void videoBroadcastThread(broadcast_ctx_t &ctx) {
     auto shutdown_event = mail::man->event<bool>(mail::broadcast_shutdown);
-    auto packets = mail::man->queue<audio::packet_t>(mail::audio_packets);
+    auto packets = video::packet_queue(*mail::man);
 
-    audio_packet_t audio_packet;
-    fec::rs_t rs {reed_solomon_new(RTPA_DATA_SHARDS, RTPA_FEC_SHARDS)};
-    crypto::aes_t iv(16);
+    // Video traffic is sent on this thread. The send pacer (pacing_max_bitrate_kbps)
+    // relies on this thread waking on its millisecond sleep deadlines; losing the
+    // scheduler slot to lower-priority work reintroduces the per-frame burst pattern
+    // the pacer exists to prevent. Note critical maps to THREAD_PRIORITY_HIGHEST on
+    // Windows (nice -15 on Linux) — the top of the normal dynamic range, not a
+    // realtime class — the same level video::capture and controlBroadcast already use.
+    platf::set_thread_name("stream::videoBroadcast");
+    platf::adjust_thread_priority(platf::thread_priority_e::critical);
 
-    // For unknown reasons, the RS parity matrix computed by our RS implementation
-    // doesn't match the one Nvidia uses for audio data. I'm not exactly sure why,
-    // but we can simply replace it with the matrix generated by OpenFEC which
-    // works correctly. This is possible because the data and FEC shard count is
-    // constant and known in advance.
-    const unsigned char parity[] = {0x77, 0x40, 0x38, 0x0e, 0xc7, 0xa7, 0x0d, 0x6c};
-    memcpy(rs.get()->p, parity, sizeof(parity));
+    video_broadcast_worker_t worker {ctx.video_epoch, ctx.video_kernel_pacing};
+    if (!worker.timer || !*worker.timer) {
+      BOOST_LOG(error) << "Failed to create timer, aborting video broadcast thread";
+      return;
+    }
 
-    audio_packet.rtp.header = 0x80;
-    audio_packet.rtp.packetType = 97;
-    audio_packet.rtp.ssrc = 0;
+    send_video_frames(worker, ctx.video_sock, [&](bool wait) -> std::optional<queued_video_frame_t> {
+      while (auto packet = wait ? packets->pop() : packets->pop(0ms)) {
+        if (shutdown_event->peek()) {
+          break;
+        }
 
-    // Audio traffic is sent on this thread
-    platf::set_thread_name("stream::audioBroadcast");
-    platf::adjust_thread_priority(platf::thread_priority_e::high);
+        auto session = (session_t *) packet->channel_data;
+        if (!session) {
+          continue;
+        }
 
-    while (auto packet = packets->pop()) {
-      if (shutdown_event->peek()) {
-        break;
+        // Sessions with a dedicated send worker only get their frames handed off here,
+        // so one session's pacer sleeps never delay another session's frames.
+        if (session->video.broadcast_queue) {
+          session->video.broadcast_queue->raise(std::move(packet));
+          continue;
+        }
+
+        return queued_video_frame_t {session, std::move(packet), {}, {}};
       }
 
-      TUPLE_2D_REF(channel_data, packet_data, *packet);
-      auto session = (session_t *) channel_data;
-      if (!session) {
-        continue;
+      return std::nullopt;
+    });
+
+    shutdown_event->raise(true);
+  }
+
+  void videoSessionBroadcastThread(session_t *session, std::shared_ptr<safe::ring_queue_t<video::packet_t>> packets) {
+    // Same priority rationale as videoBroadcastThread: this worker owns the pacer for its session.
+    platf::set_thread_name("stream::videoSessionBroadcast");
+    platf::adjust_thread_priority(platf::thread_priority_e::critical);
+
+    auto &ctx = *session->broadcast_ref;
+    video_broadcast_worker_t worker {ctx.video_epoch, ctx.video_kernel_pacing};
+    if (!worker.timer || !*worker.timer) {
+      BOOST_LOG(error) << "Failed to create timer, aborting video broadcast worker"sv;
+      packets->stop();
+      session::stop(*session);
+      return;
+    }
+
+    send_video_frames(worker, ctx.video_sock, [&](bool wait) -> std::optional<queued_video_frame_t> {
+      if (auto packet = wait ? packets->pop() : packets->pop(0ms)) {
+        return queued_video_frame_t {session, std::move(packet), {}, {}};
       }
 
-      auto sequenceNumber = session->audio.sequenceNumber;
-      auto timestamp = session->audio.timestamp;
+      return std::nullopt;
+    });
+  }
+
+  /**
+   * @brief Audio send state for one broadcast thread.
+   * @details Packets are queued with add() and sent together by flush(), so the parity that
+   *          completes an FEC block leaves with its last data packet, and packets other sessions
+   *          queued meanwhile share the same sendmmsg() call.
+   *
+   *          Packets keep the sequence numbers the encoder gave them, which is what its comfort
+   *          packets are aligned to. Packets dropped on the way here leave gaps the client
+   *          conceals like network loss. The blocks they were in, and blocks where sound cut
+   *          comfort packets short, are sent without parity.
+   */
+  struct audio_broadcast_worker_t {
+    // The encoder only starts comfort packets at FEC block boundaries
+    static_assert(audio::FEC_BLOCK_FRAMES == RTPA_DATA_SHARDS);
+
+    // Each session can have a whole FEC block in a batch before its shards are reused
+    static constexpr std::size_t max_batch_messages = 64;
+
+    explicit audio_broadcast_worker_t(udp::socket &sock):
+        sock {sock},
+        rs {reed_solomon_new(RTPA_DATA_SHARDS, RTPA_FEC_SHARDS)},
+        iv(16) {
+      // For unknown reasons, the RS parity matrix computed by our RS implementation
+      // doesn't match the one Nvidia uses for audio data. I'm not exactly sure why,
+      // but we can simply replace it with the matrix generated by OpenFEC which
+      // works correctly. This is possible because the data and FEC shard count is
+      // constant and known in advance.
+      const unsigned char parity[] = {0x77, 0x40, 0x38, 0x0e, 0xc7, 0xa7, 0x0d, 0x6c};
+      memcpy(rs.get()->p, parity, sizeof(parity));
+
+      // Messages point into these, so they must never reallocate
+      data_headers.reserve(max_batch_messages);
+      fec_headers.reserve(max_batch_messages);
+      peer_addresses.reserve(max_batch_messages);
+      messages.reserve(max_batch_messages);
+    }
+
+    /**
+     * @brief Encode a packet and queue it, along with the parity it completes.
+     * @return false if the packet couldn't be encoded.
+     */
+    bool add(session_t *session, std::uint16_t sequenceNumber, const audio::buffer_t &packet_data) {
+      auto batched = std::find_if(std::begin(sessions), std::end(sessions), [session](auto &entry) {
+        return entry.first == session;
+      });
+
+      // A session's shards are reused by its next FEC block, and parity needs room
+      if ((batched != std::end(sessions) && (std::uint16_t) (sequenceNumber - batched->second) >= RTPA_DATA_SHARDS) ||
+          messages.size() + 1 + RTPA_FEC_SHARDS > max_batch_messages) {
+        flush();
+        batched = std::end(sessions);
+      }
+
+      // Numbers the queues dropped are skipped, along with their share of the timeline
+      std::uint16_t skipped = sequenceNumber - session->audio.sequenceNumber;
+      std::uint32_t timestamp = session->audio.timestamp + skipped * session->config.audio.packetDuration;
 
       *(std::uint32_t *) iv.data() = util::endian::big<std::uint32_t>(session->audio.avRiKeyId + sequenceNumber);
 
@@ -2316,64 +2840,195 @@ namespace stream {
       auto bytes = encode_audio(session->config.encryptionFlagsEnabled & SS_ENC_AUDIO, packet_data, shards_p[sequenceNumber % RTPA_DATA_SHARDS], iv, session->audio.cipher);
       if (bytes < 0) {
         BOOST_LOG(error) << "Couldn't encode audio packet"sv;
-        break;
+        return false;
+      }
+
+      // Parity needs every data shard of the block at one size. A shard the queues dropped would be
+      // rebuilt from stale data, and sound interrupting comfort packets changes the size mid-block.
+      if (skipped >= sequenceNumber % RTPA_DATA_SHARDS) {
+        session->audio.fec_block_packets = 0;
+        session->audio.fec_block_bytes = bytes;
       }
 
       BOOST_LOG(verbose) << "Audio [seq "sv << sequenceNumber << ", pts "sv << timestamp << "] ::  send..."sv;
 
+      auto &audio_packet = data_headers.emplace_back();
+      audio_packet.rtp.header = 0x80;
+      audio_packet.rtp.packetType = 97;
       audio_packet.rtp.sequenceNumber = util::endian::big(sequenceNumber);
       audio_packet.rtp.timestamp = util::endian::big(timestamp);
+      audio_packet.rtp.ssrc = 0;
+
+      session->audio.sequenceNumber = sequenceNumber + 1;
+      session->audio.timestamp = timestamp + session->config.audio.packetDuration;
+      if (bytes == session->audio.fec_block_bytes) {
+        ++session->audio.fec_block_packets;
+      }
+
+      auto &peer_address = peer_addresses.emplace_back(session->audio.peer.address());
+      messages.push_back(platf::send_info_t {
+        (const char *) &audio_packet,
+        sizeof(audio_packet),
+        (const char *) shards_p[sequenceNumber % RTPA_DATA_SHARDS],
+        (size_t) bytes,
+        (uintptr_t) sock.native_handle(),
+        peer_address,
+        session->audio.peer.port(),
+        session->localAddress,
+      });
 
-      session->audio.sequenceNumber++;
-      session->audio.timestamp += session->config.audio.packetDuration;
+      if (batched == std::end(sessions)) {
+        sessions.emplace_back(session, sequenceNumber);
+      }
 
-      auto peer_address = session->audio.peer.address();
-      try {
-        auto send_info = platf::send_info_t {
-          (const char *) &audio_packet,
-          sizeof(audio_packet),
-          (const char *) shards_p[sequenceNumber % RTPA_DATA_SHARDS],
-          (size_t) bytes,
-          (uintptr_t) sock.native_handle(),
-          peer_address,
-          session->audio.peer.port(),
-          session->localAddress,
-        };
-        platf::send(send_info);
+      auto &fec_packet = session->audio.fec_packet;
+      // initialize the FEC header at the beginning of the FEC block
+      if (sequenceNumber % RTPA_DATA_SHARDS == 0) {
+        fec_packet.fecHeader.baseSequenceNumber = util::endian::big(sequenceNumber);
+        fec_packet.fecHeader.baseTimestamp = util::endian::big(timestamp);
+      }
 
-        auto &fec_packet = session->audio.fec_packet;
-        // initialize the FEC header at the beginning of the FEC block
-        if (sequenceNumber % RTPA_DATA_SHARDS == 0) {
-          fec_packet.fecHeader.baseSequenceNumber = util::endian::big(sequenceNumber);
-          fec_packet.fecHeader.baseTimestamp = util::endian::big(timestamp);
+      // generate parity shards at the end of the FEC block
+      if ((sequenceNumber + 1) % RTPA_DATA_SHARDS == 0 && session->audio.fec_block_packets == RTPA_DATA_SHARDS) {
+        reed_solomon_encode(rs.get(), shards_p.begin(), RTPA_TOTAL_SHARDS, bytes);
+
+        for (auto x = 0; x < RTPA_FEC_SHARDS; ++x) {
+          // Every parity packet in the batch needs its own header
+          auto &fec_header = fec_headers.emplace_back(fec_packet);
+          fec_header.rtp.sequenceNumber = util::endian::big<std::uint16_t>(sequenceNumber + x + 1);
+          fec_header.fecHeader.fecShardIndex = x;
+
+          messages.push_back(platf::send_info_t {
+            (const char *) &fec_header,
+            sizeof(fec_header),
+            (const char *) shards_p[RTPA_DATA_SHARDS + x],
+            (size_t) bytes,
+            (uintptr_t) sock.native_handle(),
+            peer_address,
+            session->audio.peer.port(),
+            session->localAddress,
+          });
+          BOOST_LOG(verbose) << "Audio FEC ["sv << (sequenceNumber & ~(RTPA_DATA_SHARDS - 1)) << ' ' << x << "] ::  send..."sv;
         }
+      }
 
-        // generate parity shards at the end of the FEC block
-        if ((sequenceNumber + 1) % RTPA_DATA_SHARDS == 0) {
-          reed_solomon_encode(rs.get(), shards_p.begin(), RTPA_TOTAL_SHARDS, bytes);
-
-          for (auto x = 0; x < RTPA_FEC_SHARDS; ++x) {
-            fec_packet.rtp.sequenceNumber = util::endian::big<std::uint16_t>(sequenceNumber + x + 1);
-            fec_packet.fecHeader.fecShardIndex = x;
-
-            auto send_info = platf::send_info_t {
-              (const char *) &fec_packet,
-              sizeof(fec_packet),
-              (const char *) shards_p[RTPA_DATA_SHARDS + x],
-              (size_t) bytes,
-              (uintptr_t) sock.native_handle(),
-              peer_address,
-              session->audio.peer.port(),
-              session->localAddress,
-            };
-            platf::send(send_info);
-            BOOST_LOG(verbose) << "Audio FEC ["sv << (sequenceNumber & ~(RTPA_DATA_SHARDS - 1)) << ' ' << x << "] ::  send..."sv;
+      return true;
+    }
+
+    /**
+     * @brief Send every queued packet.
+     */
+    void flush() {
+      if (messages.empty()) {
+        return;
+      }
+
+      try {
+        auto syscalls = platf::send_messages(messages.data(), messages.size());
+        if (syscalls > 0) {
+          for (auto &[session, first_sequence] : sessions) {
+            session->stats.audio_send_syscalls.fetch_add(syscalls, std::memory_order_relaxed);
           }
         }
       } catch (const std::exception &e) {
         BOOST_LOG(error) << "Broadcast audio failed "sv << e.what();
         std::this_thread::sleep_for(100ms);
       }
+
+      messages.clear();
+      data_headers.clear();
+      fec_headers.clear();
+      peer_addresses.clear();
+      sessions.clear();
+    }
+
+    udp::socket &sock;
+    fec::rs_t rs;
+    crypto::aes_t iv;
+
+    std::vector<audio_packet_t> data_headers;
+    std::vector<audio_fec_packet_t> fec_headers;
+    std::vector<boost::asio::ip::address> peer_addresses;
+    std::vector<platf::send_info_t> messages;
+    std::vector<std::pair<session_t *, std::uint16_t>> sessions;  // sessions in the batch and the first sequence number each has in it
+  };
+
+  /**
+   * @brief Send audio packets from a queue until it stops or a packet can't be encoded.
+   * @details Whatever else is already queued joins the packet popped, so packets that arrive
+   *          together leave together.
+   */
+  void send_audio_packets(udp::socket &sock, safe::ring_queue_t<audio::packet_t> &packets) {
+    auto shutdown_event = mail::man->event<bool>(mail::broadcast_shutdown);
+
+    audio_broadcast_worker_t worker {sock};
+    while (auto packet = packets.pop()) {
+      do {
+        if (shutdown_event->peek()) {
+          return;
+        }
+
+        TUPLE_3D_REF(channel_data, sequence_number, packet_data, *packet);
+        auto session = (session_t *) channel_data;
+        if (session && !worker.add(session, sequence_number, *packet_data)) {
+          worker.flush();
+          shutdown_event->raise(true);
+          return;
+        }
+      } while (packets.peek() && (packet = packets.pop()));
+
+      worker.flush();
+    }
+  }
+
+  void audioBroadcastThread(udp::socket &sock) {
+    auto shutdown_event = mail::man->event<bool>(mail::broadcast_shutdown);
+    auto packets = audio::packet_queue(*mail::man);
+
+    // Audio traffic is sent on this thread
+    platf::set_thread_name("stream::audioBroadcast");
+    platf::adjust_thread_priority(platf::thread_priority_e::high);
+
+    auto thread_count = (std::size_t) std::max(config::stream.audio_broadcast_threads, 1);
+    if (thread_count == 1) {
+      send_audio_packets(sock, *packets);
+      shutdown_event->raise(true);
+      return;
+    }
+
+    // Sessions keep the shard they were given at launch, so each one's packets stay in order
+    std::vector<std::unique_ptr<safe::ring_queue_t<audio::packet_t>>> shard_queues;
+    std::vector<std::thread> shard_threads;
+    for (std::size_t x = 0; x < thread_count; ++x) {
+      auto &queue = *shard_queues.emplace_back(std::make_unique<safe::ring_queue_t<audio::packet_t>>(32, safe::drop_e::oldest));
+      shard_threads.emplace_back([&sock, &queue]() {
+        platf::set_thread_name("stream::audioShard");
+        platf::adjust_thread_priority(platf::thread_priority_e::high);
+        send_audio_packets(sock, queue);
+      });
+    }
+
+    while (auto packet = packets->pop()) {
+      if (shutdown_event->peek()) {
+        break;
+      }
+
+      auto session = (session_t *) std::get<0>(*packet);
+      if (!session) {
+        continue;
+      }
+
+      shard_queues[session->audio.shard % thread_count]->raise(std::move(*packet));
+    }
+
+    for (auto &queue : shard_queues) {
+      queue->stop();
+      if (auto dropped = queue->dropped()) {
+        BOOST_LOG(warning) << "Audio shard dropped "sv << dropped << " packets its thread couldn't keep up with"sv;
+      }
+    }
+    for (auto &thread : shard_threads) {
+      thread.join();
     }
 
     shutdown_event->raise(true);
@@ -2387,8 +3042,8 @@ namespace stream {
 
     // Reset the packet queues which were stopped in end_broadcast.
     // If not reset, the broadcast threads will exit immediately when pop() returns null.
-    auto video_packets = mail::man->queue<video::packet_t>(mail::video_packets);
-    auto audio_packets = mail::man->queue<audio::packet_t>(mail::audio_packets);
+    auto video_packets = video::packet_queue(*mail::man);
+    auto audio_packets = audio::packet_queue(*mail::man);
     video_packets->reset();
     audio_packets->reset();
 
@@ -2436,6 +3091,14 @@ namespace stream {
       return -1;
     }
 
+    ctx.video_kernel_pacing = false;
+    if (config::stream.video_kernel_pacing) {
+      ctx.video_kernel_pacing = platf::enable_socket_txtime(ctx.video_sock.native_handle());
+      if (!ctx.video_kernel_pacing) {
+        BOOST_LOG(warning) << "Kernel video pacing is unavailable, falling back to timer pacing"sv;
+      }
+    }
+
     ctx.audio_sock.open(protocol, ec);
     if (ec) {
       BOOST_LOG(fatal) << "Couldn't open socket for Audio server: "sv << ec.message();
@@ -2456,7 +3119,8 @@ namespace stream {
     // After calling stop(), restart() must be called before run() will work again.
     ctx.io_context.restart();
 
-    ctx.video_thread = std::thread {videoBroadcastThread, std::ref(ctx.video_sock)};
+    ctx.video_epoch = std::chrono::steady_clock::now();
+    ctx.video_thread = std::thread {videoBroadcastThread, std::ref(ctx)};
     ctx.audio_thread = std::thread {audioBroadcastThread, std::ref(ctx.audio_sock)};
     ctx.control_thread = std::thread {controlBroadcastThread, &ctx.control_server};
 
@@ -2470,13 +3134,18 @@ namespace stream {
 
     broadcast_shutdown_event->raise(true);
 
-    auto video_packets = mail::man->queue<video::packet_t>(mail::video_packets);
-    auto audio_packets = mail::man->queue<audio::packet_t>(mail::audio_packets);
+    auto video_packets = video::packet_queue(*mail::man);
+    auto audio_packets = audio::packet_queue(*mail::man);
 
     // Minimize delay stopping video/audio threads
     video_packets->stop();
     audio_packets->stop();
 
+    if (video_packets->dropped() || audio_packets->dropped()) {
+      BOOST_LOG(warning) << "Broadcast fell behind encoding and dropped "sv << video_packets->dropped()
+                         << " video frames and "sv << audio_packets->dropped() << " audio packets"sv;
+    }
+
     ctx.message_queue_queue->stop();
     ctx.io_context.stop();
 
@@ -2586,6 +3255,26 @@ namespace stream {
     auto address = session->video.peer.address();
     session->video.qos = platf::enable_socket_qos(ref->video_sock.native_handle(), address, session->video.peer.port(), platf::qos_data_type_e::video, session->config.videoQosType != 0);
 
+    // Prebuild the FEC contexts this session's frames are expected to need so the
+    // first frames don't pay for the coding matrix inversions on the send path.
+    fec::video_rs_cache().warm(fec::expected_video_geometries(
+      session->config.packetsize + MAX_RTP_HEADER_SIZE,
+      session->video.fec->percentage(),
+      session->config.minRequiredFecPackets,
+      session->config.monitor.bitrate,
+      session->stream_fps
+    ));
+
+    if (config::stream.video_broadcast_per_session) {
+      // Must be in place before capture starts so the shared broadcast thread
+      // routes every frame of this session to its worker.
+      auto broadcast_queue = std::make_shared<safe::ring_queue_t<video::packet_t>>(32, safe::drop_e::keep_keyframes, [](const video::packet_t &packet) {
+        return packet->is_idr();
+      });
+      session->video.broadcast_thread = std::thread {videoSessionBroadcastThread, session, broadcast_queue};
+      session->video.broadcast_queue = std::move(broadcast_queue);
+    }
+
 #ifdef _WIN32
     if (session->display_helper_gate.valid()) {
       BOOST_LOG(debug) << "Display helper: waiting for apply/validation gate before starting capture.";
@@ -2616,7 +3305,7 @@ namespace stream {
 #endif
 
     BOOST_LOG(debug) << "Start capturing Video"sv;
-    video::capture(session->mail, session->config.monitor, session);
+    video::capture(session->mail, session->config.monitor, session, &session->stats.video);
   }
 
   void audioThread(session_t *session) {
@@ -2638,7 +3327,7 @@ namespace stream {
     session->audio.qos = platf::enable_socket_qos(ref->audio_sock.native_handle(), address, session->audio.peer.port(), platf::qos_data_type_e::audio, session->config.audioQosType != 0);
 
     BOOST_LOG(debug) << "Start capturing Audio"sv;
-    audio::capture(session->mail, session->config.audio, session);
+    audio::capture(session->mail, session->config.audio, session, &session->stats.audio);
   }
 
   namespace session {
@@ -2912,6 +3601,15 @@ namespace stream {
 
         BOOST_LOG(debug) << "Waiting for video to end..."sv;
         session.videoThread.join();
+        if (session.video.broadcast_thread.joinable()) {
+          hung_stage->store("video broadcast worker");
+          BOOST_LOG(debug) << "Waiting for video broadcast worker to end..."sv;
+          session.video.broadcast_queue->stop();
+          session.video.broadcast_thread.join();
+          if (auto dropped = session.video.broadcast_queue->dropped()) {
+            BOOST_LOG(warning) << "Video broadcast worker fell behind and dropped "sv << dropped << " frames"sv;
+          }
+        }
         hung_stage->store("audio thread");
         BOOST_LOG(debug) << "Waiting for audio to end..."sv;
         session.audioThread.join();
@@ -3250,6 +3948,30 @@ namespace stream {
       session->video.bitrate_events = mail->event<int>(mail::dynamic_bitrate);
       session->video.lowseq = 0;
       session->video.ping_payload = launch_session.av_ping_payload;
+      if (config::stream.adaptive_fec) {
+        session->video.fec = std::make_unique<fec_controller_t>(
+          config::stream.fec_percentage,
+          config::stream.adaptive_fec_min_percentage,
+          config::stream.adaptive_fec_max_percentage
+        );
+      } else {
+        session->video.fec = std::make_unique<fec_controller_t>(
+          config::stream.fec_percentage,
+          config::stream.fec_percentage,
+          config::stream.fec_percentage
+        );
+      }
+      if (config::stream.adaptive_bitrate) {
+        session->video.abr = std::make_unique<abr_controller_t>(
+          session->config.monitor.bitrate,
+          config::stream.adaptive_bitrate_min_kbps,
+          session->stream_fps
+        );
+      }
+      if (config::stream.video_frame_pacing) {
+        session->video.pacer = std::make_unique<frame_pacer_t>(session->stream_fps, config::stream.video_frame_pacing_percent);
+        session->video.pacer_next_frame_start = std::chrono::steady_clock::now();
+      }
       if (config.encryptionFlagsEnabled & SS_ENC_VIDEO) {
         BOOST_LOG(info) << "Video encryption enabled"sv;
         session->video.cipher = crypto::cipher::gcm_t {
@@ -3290,6 +4012,11 @@ namespace stream {
       session->audio.avRiKeyId = util::endian::big(*(std::uint32_t *) launch_session.iv.data());
       session->audio.sequenceNumber = 0;
       session->audio.timestamp = 0;
+      session->audio.fec_block_packets = 0;
+      session->audio.fec_block_bytes = 0;
+
+      static std::atomic<std::size_t> next_audio_shard {0};
+      session->audio.shard = next_audio_shard.fetch_add(1, std::memory_order_relaxed);
 
       session->control.peer = nullptr;
       session->state.store(state_e::STOPPED, std::memory_order_relaxed);
@@ -155,6 +155,24 @@ namespace stream {
     std::int64_t client_reported_losses;
     double encode_latency_ms;  // last frame encode latency in ms
     std::int64_t last_frame_index;
+    double video_queue_latency_ms;  // last frame's wait between encoder handoff and its broadcast loop
+    double video_send_latency_ms;  // last frame's packetize, FEC, encrypt and paced send time
+    int fec_percentage;  // FEC percentage applied to the last frame
+    std::string pacing_mode;  // "frame" with video_frame_pacing, otherwise "rate"
+    double pacing_budget_ms;  // share of the frame interval a frame is spread over, 0 in rate mode
+    double pacing_spread_ms;  // time the last frame's packets were spread over
+    double pacing_backlog_ms;  // last frame's wait for the previous frame to be paced out
+    std::uint64_t audio_send_syscalls;  // send syscalls that carried this session's audio
+    double audio_send_syscalls_per_second;  // audio_send_syscalls averaged over the uptime
+    double audio_capture_latency_ms;  // last audio frame's capture to the start of its encode
+    double audio_active_seconds;  // audio streamed while the host made sound
+    double audio_idle_seconds;  // audio streamed while the host was digitally silent
+    double audio_active_encode_ms_per_minute;  // encoder time per minute of audio with sound
+    double audio_idle_encode_ms_per_minute;  // encoder time per minute of silence
+    double audio_active_bytes_per_minute;  // encoded audio per minute with sound
+    double audio_idle_bytes_per_minute;  // encoded audio per minute of silence
+    std::uint64_t video_static_skipped;  // captured frames skipped because nothing changed
+    std::uint64_t video_static_refreshes;  // unchanged frames encoded anyway for the minimum FPS
     double uptime_seconds;
   };
 
@@ -5,10 +5,13 @@
 #pragma once
 
 // standard includes
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <type_traits>
@@ -17,6 +20,7 @@
 
 // local includes
 #include "move_by_copy.h"
+#include "timer_wheel.h"
 #include "utility.h"
 
 namespace task_pool_util {
@@ -44,6 +48,17 @@ namespace task_pool_util {
     }
   };
 
+  /**
+   * @brief Tasks to run now and tasks to run at a deadline.
+   * @details Tasks to run now go into one queue per worker. A worker runs its own queue in order
+   *          and steals from the back of the others' when it runs dry, so a burst pushed from
+   *          one thread spreads over every worker without a shared lock. Tasks pushed by a
+   *          worker go to its own queue; others are spread over the queues in turn. With a
+   *          single queue every task runs in the order it was pushed.
+   *
+   *          Delayed tasks live in a timer wheel, so pushing, delaying and cancelling them no
+   *          longer searches every pending timer.
+   */
   class TaskPool {
   public:
     typedef std::unique_ptr<_ImplBase> __task;
@@ -64,20 +79,32 @@ namespace task_pool_util {
     };
 
   protected:
-    std::deque<__task> _tasks;
-    std::vector<std::pair<__time_point, __task>> _timer_tasks;
-    std::mutex _task_mutex;
+    struct worker_queue_t {
+      std::mutex lock;
+      std::deque<__task> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue_t>> _queues;
+    std::atomic<std::size_t> _next_queue {0};
+
+    timer_wheel_t<task_id_t, __task> _timer_tasks;
+    std::mutex _task_mutex;  // Guards _timer_tasks
+
+    // The queue of the worker running on this thread, if any
+    static inline thread_local std::pair<const TaskPool *, std::size_t> _current {nullptr, 0};
 
   public:
-    TaskPool() = default;
+    explicit TaskPool(std::size_t queues = 1) {
+      resize(queues);
+    }
 
     TaskPool(TaskPool &&other) noexcept:
-        _tasks {std::move(other._tasks)},
+        _queues {std::move(other._queues)},
         _timer_tasks {std::move(other._timer_tasks)} {
     }
 
     TaskPool &operator=(TaskPool &&other) noexcept {
-      std::swap(_tasks, other._tasks);
+      std::swap(_queues, other._queues);
       std::swap(_timer_tasks, other._timer_tasks);
 
       return *this;
@@ -98,8 +125,9 @@ namespace task_pool_util {
 
       auto future = task.get_future();
 
-      std::lock_guard<std::mutex> lg(_task_mutex);
-      _tasks.emplace_back(toRunnable(std::move(task)));
+      auto &queue = *_queues[push_queue()];
+      std::lock_guard<std::mutex> lg(queue.lock);
+      queue.tasks.emplace_back(toRunnable(std::move(task)));
 
       return future;
     }
@@ -107,14 +135,8 @@ namespace task_pool_util {
     void pushDelayed(std::pair<__time_point, __task> &&task) {
       std::lock_guard lg(_task_mutex);
 
-      auto it = _timer_tasks.cbegin();
-      for (; it < _timer_tasks.cend(); ++it) {
-        if (std::get<0>(*it) < task.first) {
-          break;
-        }
-      }
-
-      _timer_tasks.emplace(it, task.first, std::move(task.second));
+      auto task_id = task.second.get();
+      _timer_tasks.insert(task_id, task.first, std::move(task.second));
     }
 
     /**
@@ -158,99 +180,102 @@ namespace task_pool_util {
     void delay(task_id_t task_id, std::chrono::duration<X, Y> duration) {
       std::lock_guard<std::mutex> lg(_task_mutex);
 
-      auto it = _timer_tasks.begin();
-      for (; it < _timer_tasks.cend(); ++it) {
-        const __task &task = std::get<1>(*it);
-
-        if (&*task == task_id) {
-          std::get<0>(*it) = std::chrono::steady_clock::now() + duration;
-
-          break;
-        }
-      }
-
-      if (it == _timer_tasks.cend()) {
-        return;
-      }
-
-      // smaller time goes to the back
-      auto prev = it - 1;
-      while (it > _timer_tasks.cbegin()) {
-        if (std::get<0>(*it) > std::get<0>(*prev)) {
-          std::swap(*it, *prev);
-        }
-
-        --prev;
-        --it;
-      }
+      _timer_tasks.reschedule(task_id, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
     }
 
     bool cancel(task_id_t task_id) {
       std::lock_guard lg(_task_mutex);
 
-      auto it = _timer_tasks.begin();
-      for (; it < _timer_tasks.cend(); ++it) {
-        const __task &task = std::get<1>(*it);
-
-        if (&*task == task_id) {
-          _timer_tasks.erase(it);
-
-          return true;
-        }
-      }
-
-      return false;
+      return (bool) _timer_tasks.erase(task_id);
     }
 
     std::optional<std::pair<__time_point, __task>> pop(task_id_t task_id) {
       std::lock_guard lg(_task_mutex);
 
-      auto pos = std::find_if(std::begin(_timer_tasks), std::end(_timer_tasks), [&task_id](const auto &t) {
-        return t.second.get() == task_id;
-      });
-
-      if (pos == std::end(_timer_tasks)) {
-        return std::nullopt;
-      }
-
-      return std::move(*pos);
+      return _timer_tasks.erase(task_id);
     }
 
-    std::optional<__task> pop() {
-      std::lock_guard lg(_task_mutex);
+    /**
+     * @brief Take a task for the worker that owns queue, stealing from the other queues when it's empty.
+     */
+    std::optional<__task> popFor(std::size_t queue) {
+      {
+        auto &own = *_queues[queue % _queues.size()];
+        std::lock_guard lg(own.lock);
+        if (!own.tasks.empty()) {
+          __task task = std::move(own.tasks.front());
+          own.tasks.pop_front();
+          return task;
+        }
+      }
 
-      if (!_tasks.empty()) {
-        __task task = std::move(_tasks.front());
-        _tasks.pop_front();
-        return task;
+      for (std::size_t x = 1; x < _queues.size(); ++x) {
+        auto &victim = *_queues[(queue + x) % _queues.size()];
+        std::lock_guard lg(victim.lock);
+        if (!victim.tasks.empty()) {
+          __task task = std::move(victim.tasks.back());
+          victim.tasks.pop_back();
+          return task;
+        }
       }
 
-      if (!_timer_tasks.empty() && std::get<0>(_timer_tasks.back()) <= std::chrono::steady_clock::now()) {
-        __task task = std::move(std::get<1>(_timer_tasks.back()));
-        _timer_tasks.pop_back();
-        return task;
+      std::lock_guard lg(_task_mutex);
+      if (auto task = _timer_tasks.pop(std::chrono::steady_clock::now())) {
+        return std::move(task->second);
       }
 
       return std::nullopt;
     }
 
+    std::optional<__task> pop() {
+      return popFor(_current.first == this ? _current.second : 0);
+    }
+
     bool ready() {
+      for (auto &queue : _queues) {
+        std::lock_guard lg(queue->lock);
+        if (!queue->tasks.empty()) {
+          return true;
+        }
+      }
+
       std::lock_guard<std::mutex> lg(_task_mutex);
 
-      return !_tasks.empty() || (!_timer_tasks.empty() && std::get<0>(_timer_tasks.back()) <= std::chrono::steady_clock::now());
+      return _timer_tasks.ready(std::chrono::steady_clock::now());
     }
 
     std::optional<__time_point> next() {
       std::lock_guard<std::mutex> lg(_task_mutex);
 
-      if (_timer_tasks.empty()) {
-        return std::nullopt;
+      return _timer_tasks.next();
+    }
+
+  protected:
+    /**
+     * @brief Make room for more workers. Only call before workers start.
+     */
+    void resize(std::size_t queues) {
+      while (_queues.size() < std::max<std::size_t>(queues, 1)) {
+        _queues.emplace_back(std::make_unique<worker_queue_t>());
       }
+    }
 
-      return std::get<0>(_timer_tasks.back());
+    /**
+     * @brief Mark the calling thread as the worker that owns queue.
+     */
+    void bind_worker(std::size_t queue) const {
+      _current = {this, queue};
     }
 
   private:
+    std::size_t push_queue() {
+      if (_current.first == this) {
+        return _current.second;
+      }
+
+      return _next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+    }
+
     template<class Function>
     std::unique_ptr<_ImplBase> toRunnable(Function &&f) {
       return std::make_unique<_Impl<Function>>(std::forward<Function &&>(f));
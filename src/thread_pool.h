@@ -6,6 +6,8 @@
 
 // standard includes
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 // local includes
@@ -27,6 +29,7 @@ namespace thread_pool_util {
     std::mutex _lock;
 
     std::atomic_bool _continue;
+    std::atomic_int _sleeping {0};  // Workers that may be waiting on _cv
 
   public:
     ThreadPool():
@@ -34,11 +37,8 @@ namespace thread_pool_util {
     }
 
     explicit ThreadPool(int threads):
-        _thread(threads),
-        _continue {true} {
-      for (auto &t : _thread) {
-        t = std::thread(&ThreadPool::_main, this);
-      }
+        _continue {false} {
+      start(threads);
     }
 
     ~ThreadPool() noexcept {
@@ -52,36 +52,36 @@ namespace thread_pool_util {
 
     template<class Function, class... Args>
     auto push(Function &&newTask, Args &&...args) {
-      std::lock_guard lg(_lock);
       auto future = TaskPool::push(std::forward<Function>(newTask), std::forward<Args>(args)...);
 
-      _cv.notify_one();
+      wake(false);
       return future;
     }
 
     void pushDelayed(std::pair<__time_point, __task> &&task) {
-      std::lock_guard lg(_lock);
-
       TaskPool::pushDelayed(std::move(task));
+
+      wake(true);
     }
 
     template<class Function, class X, class Y, class... Args>
     auto pushDelayed(Function &&newTask, std::chrono::duration<X, Y> duration, Args &&...args) {
-      std::lock_guard lg(_lock);
       auto future = TaskPool::pushDelayed(std::forward<Function>(newTask), duration, std::forward<Args>(args)...);
 
       // Update all timers for wait_until
-      _cv.notify_all();
+      wake(true);
       return future;
     }
 
     void start(int threads) {
+      resize((std::size_t) threads);
+
       _continue.store(true, std::memory_order_release);
 
       _thread.resize(threads);
 
-      for (auto &t : _thread) {
-        t = std::thread(&ThreadPool::_main, this);
+      for (std::size_t x = 0; x < _thread.size(); ++x) {
+        _thread[x] = std::thread(&ThreadPool::_main, this, x);
       }
     }
 
@@ -98,15 +98,42 @@ namespace thread_pool_util {
       }
     }
 
+  private:
+    /**
+     * @param all Whether every sleeping worker needs to see a new deadline, or one worker a new task.
+     */
+    void wake(bool all) {
+      // Pairs with the fence in _main: either a worker sees the task, or this sees the worker
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!_sleeping.load(std::memory_order_relaxed)) {
+        return;
+      }
+
+      std::lock_guard lg(_lock);
+      if (all) {
+        _cv.notify_all();
+      } else {
+        _cv.notify_one();
+      }
+    }
+
   public:
-    void _main() {
+    void _main(std::size_t queue) {
       platf::set_thread_name("TaskPool::worker");
+      bind_worker(queue);
+
       while (_continue.load(std::memory_order_acquire)) {
-        if (auto task = this->pop()) {
+        if (auto task = this->popFor(queue)) {
           (*task)->run();
         } else {
           std::unique_lock uniq_lock(_lock);
 
+          _sleeping.fetch_add(1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          auto fg = util::fail_guard([this]() {
+            _sleeping.fetch_sub(1, std::memory_order_relaxed);
+          });
+
           if (ready()) {
             continue;
           }
@@ -124,7 +151,7 @@ namespace thread_pool_util {
       }
 
       // Execute remaining tasks
-      while (auto task = this->pop()) {
+      while (auto task = this->popFor(queue)) {
         (*task)->run();
       }
     }
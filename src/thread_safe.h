@@ -5,12 +5,18 @@
 #pragma once
 
 // standard includes
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 // local includes
@@ -350,6 +356,226 @@ namespace safe {
     std::vector<T> _queue;
   };
 
+  /**
+   * @brief What a full ring_queue_t does with a new value.
+   */
+  enum class drop_e {
+    oldest,  ///< Evict the oldest queued value to make room
+    newest,  ///< Refuse the new value
+    keep_keyframes,  ///< Refuse the new value, unless it is a keyframe, which evicts the oldest
+  };
+
+  /**
+   * @brief Bounded lock-free queue with the pop()/peek()/stop() semantics of queue_t.
+   * @details Any number of threads may raise() while one thread pops. Slots carry sequence
+   *          numbers, so producers claim a slot with a single CAS and never wait on each other
+   *          or on the consumer. The consumer only takes a lock when it has to sleep, and
+   *          producers only take it to wake a sleeping consumer.
+   *
+   *          Unlike queue_t, a full queue never throws away everything queued: one value is
+   *          dropped according to the policy and counted in dropped().
+   */
+  template<class T>
+  class ring_queue_t {
+  public:
+    using status_t = util::optional_t<T>;
+    using keyframe_f = bool (*)(const T &);
+
+    /**
+     * @param capacity Rounded up to a power of two.
+     * @param policy What to drop when full.
+     * @param is_keyframe Identifies the values drop_e::keep_keyframes keeps.
+     */
+    explicit ring_queue_t(std::uint32_t capacity = 32, drop_e policy = drop_e::oldest, keyframe_f is_keyframe = nullptr):
+        _cells(std::bit_ceil(std::max<std::uint32_t>(capacity, 2))),
+        _mask {_cells.size() - 1},
+        _policy {policy},
+        _is_keyframe {is_keyframe} {
+      for (std::size_t x = 0; x < _cells.size(); ++x) {
+        _cells[x].sequence.store(x, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * @return true if the value was queued.
+     */
+    template<class... Args>
+    bool raise(Args &&...args) {
+      if (!running()) {
+        return false;
+      }
+
+      T value(std::forward<Args>(args)...);
+      while (!try_push(value)) {
+        auto evict = _policy == drop_e::oldest ||
+                     (_policy == drop_e::keep_keyframes && _is_keyframe && _is_keyframe(value));
+        if (!evict) {
+          _dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+
+        // The consumer may have emptied a slot since, in which case there's nothing to evict
+        if (try_pop()) {
+          _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+
+      // Pairs with the fence in wait_pop(): either the consumer sees the value, or this sees the waiter
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (_waiters.load(std::memory_order_relaxed)) {
+        std::lock_guard lg {_lock};
+        _cv.notify_all();
+      }
+
+      return true;
+    }
+
+    bool peek() {
+      auto head = _head.load(std::memory_order_acquire);
+      return running() && _cells[head & _mask].sequence.load(std::memory_order_acquire) == head + 1;
+    }
+
+    template<class Rep, class Period>
+    status_t pop(std::chrono::duration<Rep, Period> delay) {
+      return wait_pop(std::chrono::steady_clock::now() + delay);
+    }
+
+    status_t pop() {
+      return wait_pop(std::nullopt);
+    }
+
+    void stop() {
+      std::lock_guard lg {_lock};
+
+      _continue.store(false, std::memory_order_release);
+
+      _cv.notify_all();
+    }
+
+    /**
+     * @brief Empty the queue, clear dropped() and accept values again.
+     */
+    void reset() {
+      std::lock_guard lg {_lock};
+
+      while (try_pop()) {}
+      _dropped.store(0, std::memory_order_relaxed);
+      _continue.store(true, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool running() const {
+      return _continue.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return Values refused or evicted since the queue was made or last reset.
+     */
+    [[nodiscard]] std::uint64_t dropped() const {
+      return _dropped.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct cell_t {
+      // Equal to the position when free to write, position + 1 once written
+      std::atomic<std::size_t> sequence;
+      std::optional<T> value;
+    };
+
+    bool try_push(T &value) {
+      auto pos = _tail.load(std::memory_order_relaxed);
+      while (true) {
+        auto &cell = _cells[pos & _mask];
+        auto diff = (std::intptr_t) cell.sequence.load(std::memory_order_acquire) - (std::intptr_t) pos;
+        if (diff == 0) {
+          if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            cell.value.emplace(std::move(value));
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false;
+        } else {
+          pos = _tail.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    std::optional<T> try_pop() {
+      auto pos = _head.load(std::memory_order_relaxed);
+      while (true) {
+        auto &cell = _cells[pos & _mask];
+        auto diff = (std::intptr_t) cell.sequence.load(std::memory_order_acquire) - (std::intptr_t) (pos + 1);
+        if (diff == 0) {
+          if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            std::optional<T> value {std::move(cell.value)};
+            cell.value.reset();
+            cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+            return value;
+          }
+        } else if (diff < 0) {
+          return std::nullopt;
+        } else {
+          pos = _head.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    status_t wait_pop(std::optional<std::chrono::steady_clock::time_point> deadline) {
+      if (!running()) {
+        return util::false_v<status_t>;
+      }
+
+      if (auto value = try_pop()) {
+        return status_t {std::move(*value)};
+      }
+
+      if (deadline && *deadline <= std::chrono::steady_clock::now()) {
+        return util::false_v<status_t>;
+      }
+
+      std::unique_lock ul {_lock};
+      _waiters.fetch_add(1, std::memory_order_relaxed);
+      auto fg = util::fail_guard([this]() {
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
+      });
+
+      while (true) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!running()) {
+          return util::false_v<status_t>;
+        }
+
+        if (auto value = try_pop()) {
+          return status_t {std::move(*value)};
+        }
+
+        if (!deadline) {
+          _cv.wait(ul);
+        } else if (_cv.wait_until(ul, *deadline) == std::cv_status::timeout) {
+          if (auto value = running() ? try_pop() : std::nullopt) {
+            return status_t {std::move(*value)};
+          }
+
+          return util::false_v<status_t>;
+        }
+      }
+    }
+
+    std::vector<cell_t> _cells;
+    const std::size_t _mask;
+    const drop_e _policy;
+    const keyframe_f _is_keyframe;
+
+    alignas(64) std::atomic<std::size_t> _tail {0};
+    alignas(64) std::atomic<std::size_t> _head {0};
+    alignas(64) std::atomic<std::uint64_t> _dropped {0};
+    std::atomic<bool> _continue {true};
+    std::atomic<int> _waiters {0};
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+  };
+
   template<class T>
   class shared_t {
   public:
@@ -501,14 +727,30 @@ namespace safe {
     return std::reinterpret_pointer_cast<typename T::element_type>(wp.lock());
   }
 
+  /**
+   * @brief A fixed mail slot and the post it carries.
+   * @details Channels are looked up by index, so a lookup never compares or allocates strings,
+   *          and asking for the wrong post type fails to compile.
+   */
+  template<class Post>
+  struct channel_t {
+    std::size_t index;  ///< Below mail_raw_t::max_channels, unique among channels
+    std::string_view name;
+  };
+
   class mail_raw_t: public std::enable_shared_from_this<mail_raw_t> {
   public:
+    static constexpr std::size_t max_channels = 16;
+
     template<class T>
     using event_t = std::shared_ptr<post_t<event_t<T>>>;
 
     template<class T>
     using queue_t = std::shared_ptr<post_t<queue_t<T>>>;
 
+    template<class T>
+    using ring_queue_t = std::shared_ptr<post_t<ring_queue_t<T>>>;
+
     template<class T>
     event_t<T> event(const std::string_view &id) {
       std::lock_guard lg {mutex};
@@ -547,9 +789,40 @@ namespace safe {
       return post;
     }
 
+    /**
+     * @brief Look up a channel's event, making it if nobody holds it.
+     */
+    template<class T>
+    event_t<T> event(const channel_t<safe::event_t<T>> &channel) {
+      return resolve(channel);
+    }
+
+    /**
+     * @brief Look up a channel's queue, making it if nobody holds it.
+     */
+    template<class T>
+    queue_t<T> queue(const channel_t<safe::queue_t<T>> &channel) {
+      return resolve(channel);
+    }
+
+    /**
+     * @brief Look up a channel's ring queue, making it with args if nobody holds it.
+     */
+    template<class T, class... Args>
+    ring_queue_t<T> ring(const channel_t<safe::ring_queue_t<T>> &channel, Args &&...args) {
+      return resolve(channel, std::forward<Args>(args)...);
+    }
+
     void cleanup() {
       std::lock_guard lg {mutex};
 
+      // Expired slots would otherwise keep their post's memory allocated
+      for (auto &slot : channels) {
+        if (slot.expired()) {
+          slot.reset();
+        }
+      }
+
       for (auto it = std::begin(id_to_post); it != std::end(id_to_post); ++it) {
         auto &weak = it->second;
 
@@ -564,6 +837,23 @@ namespace safe {
     std::mutex mutex;
 
     std::map<std::string, std::weak_ptr<void>, std::less<>> id_to_post;
+    std::array<std::weak_ptr<void>, max_channels> channels;
+
+  private:
+    template<class Post, class... Args>
+    std::shared_ptr<post_t<Post>> resolve(const channel_t<Post> &channel, Args &&...args) {
+      std::lock_guard lg {mutex};
+
+      auto &slot = channels[channel.index];
+      if (auto post = std::static_pointer_cast<post_t<Post>>(slot.lock())) {
+        return post;
+      }
+
+      auto post = std::make_shared<post_t<Post>>(shared_from_this(), std::forward<Args>(args)...);
+      slot = post;
+
+      return post;
+    }
   };
 
   inline void cleanup(mail_raw_t *mail) {
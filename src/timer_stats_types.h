@@ -0,0 +1,48 @@
+/**
+ * @file src/timer_stats_types.h
+ * @brief Platform-neutral high-precision timer statistics.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace platf {
+  /**
+   * @brief Distribution of how late high-precision timer wakeups were.
+   */
+  struct timer_overshoot_histogram_t {
+    // Inclusive upper bound of each bucket; the final bucket holds everything above the last bound
+    static constexpr std::array<std::chrono::microseconds, 10> bucket_limits {
+      std::chrono::microseconds {1},
+      std::chrono::microseconds {2},
+      std::chrono::microseconds {5},
+      std::chrono::microseconds {10},
+      std::chrono::microseconds {20},
+      std::chrono::microseconds {50},
+      std::chrono::microseconds {100},
+      std::chrono::microseconds {200},
+      std::chrono::microseconds {500},
+      std::chrono::microseconds {1000},
+    };
+    static constexpr std::size_t bucket_count = bucket_limits.size() + 1;
+
+    std::array<std::uint64_t, bucket_count> counts {};
+    std::uint64_t samples = 0;
+    std::chrono::nanoseconds total_overshoot {0};
+    std::chrono::nanoseconds max_overshoot {0};
+
+    /**
+     * @brief Index of the bucket an overshoot falls into.
+     */
+    static constexpr std::size_t bucket_for(std::chrono::nanoseconds overshoot) {
+      std::size_t bucket = 0;
+      while (bucket < bucket_limits.size() && overshoot > bucket_limits[bucket]) {
+        ++bucket;
+      }
+      return bucket;
+    }
+  };
+}  // namespace platf
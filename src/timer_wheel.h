@@ -0,0 +1,322 @@
+/**
+ * @file src/timer_wheel.h
+ * @brief Declarations for the hierarchical timer wheel behind delayed tasks.
+ */
+#pragma once
+
+// standard includes
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace task_pool_util {
+  /**
+   * @brief Values that become due at a deadline, found by key in O(1).
+   * @details Four levels of 64 slots with a 1 ms tick cover about 4.6 hours; later deadlines
+   *          wait in the last slot and are placed again once it comes around. A value sits in
+   *          the slot of the level whose span holds its distance from now, and moves down a
+   *          level each time that slot's range begins, so insert, erase and reschedule never
+   *          search. Advancing skips whole revolutions of empty levels.
+   *
+   *          A value is only due once its exact deadline has passed. Not thread-safe.
+   */
+  template<class Key, class T>
+  class timer_wheel_t {
+  public:
+    using clock = std::chrono::steady_clock;
+    using time_point = clock::time_point;
+
+    static constexpr auto tick = std::chrono::milliseconds(1);
+
+    /**
+     * @param now The time the wheel starts at.
+     */
+    explicit timer_wheel_t(time_point now = clock::now()):
+        _epoch {now} {
+    }
+
+    /**
+     * @brief Add a value, replacing any with the same key.
+     */
+    void insert(const Key &key, time_point deadline, T &&value) {
+      erase(key);
+
+      _due.push_back(entry_t {key, deadline, std::move(value)});
+      auto entry = std::prev(_due.end());
+      _index.emplace(key, entry);
+      place(entry);
+    }
+
+    /**
+     * @return The value, or std::nullopt if the key isn't in the wheel.
+     */
+    std::optional<std::pair<time_point, T>> erase(const Key &key) {
+      auto it = _index.find(key);
+      if (it == std::end(_index)) {
+        return std::nullopt;
+      }
+
+      auto entry = it->second;
+      _index.erase(it);
+
+      std::optional<std::pair<time_point, T>> result {std::in_place, entry->deadline, std::move(entry->value)};
+      auto level = entry->level;
+      auto slot = entry->slot;
+      list_of(*entry).erase(entry);
+      update_bit(level, slot);
+
+      return result;
+    }
+
+    /**
+     * @return false if the key isn't in the wheel.
+     */
+    bool reschedule(const Key &key, time_point deadline) {
+      auto it = _index.find(key);
+      if (it == std::end(_index)) {
+        return false;
+      }
+
+      auto entry = it->second;
+      entry->deadline = deadline;
+      place(entry);
+
+      return true;
+    }
+
+    /**
+     * @brief Take a value whose deadline has passed, in the order their ticks came due.
+     */
+    std::optional<std::pair<time_point, T>> pop(time_point now) {
+      advance(now);
+
+      for (auto entry = _due.begin(); entry != _due.end(); ++entry) {
+        if (entry->deadline > now) {
+          continue;
+        }
+
+        std::optional<std::pair<time_point, T>> result {std::in_place, entry->deadline, std::move(entry->value)};
+        _index.erase(entry->key);
+        _due.erase(entry);
+        return result;
+      }
+
+      return std::nullopt;
+    }
+
+    /**
+     * @return Whether pop(now) would return a value.
+     */
+    bool ready(time_point now) {
+      advance(now);
+
+      for (auto &entry : _due) {
+        if (entry.deadline <= now) {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    /**
+     * @return A time at or before the earliest deadline, or std::nullopt when empty.
+     */
+    std::optional<time_point> next() const {
+      if (_index.empty()) {
+        return std::nullopt;
+      }
+
+      auto earliest = time_point::max();
+      for (auto &entry : _due) {
+        earliest = std::min(earliest, entry.deadline);
+      }
+
+      // Ticks at level 0 are ordered, so the first occupied slot holds the earliest deadline
+      if (_bits[0]) {
+        auto ahead = std::countr_zero(std::rotr(_bits[0], (int) (_now & slot_mask)));
+        for (auto &entry : _slots[0][(_now + ahead) & slot_mask]) {
+          earliest = std::min(earliest, entry.deadline);
+        }
+      }
+
+      // Higher slots are placed again once the tick their range begins at is reached,
+      // which never comes after their deadlines
+      for (std::size_t level = 1; level < levels; ++level) {
+        if (!_bits[level]) {
+          continue;
+        }
+
+        auto shift = level * slot_bits;
+        auto rotated = std::rotr(_bits[level], (int) ((_now >> shift) & slot_mask));
+
+        // The current slot was emptied when its range began, so it holds the next revolution
+        auto ahead = (tick_t) std::countr_zero(rotated & ~1ull);
+        if (rotated & 1) {
+          ahead = std::min<tick_t>(ahead, slots);
+        }
+
+        auto begins = ((_now >> shift) + ahead) << shift;
+        earliest = std::min(earliest, time_of(begins - 1));
+      }
+
+      return earliest;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+      return _index.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+      return _index.empty();
+    }
+
+  private:
+    using tick_t = std::uint64_t;
+
+    static constexpr std::size_t slot_bits = 6;
+    static constexpr std::size_t slots = 1 << slot_bits;
+    static constexpr tick_t slot_mask = slots - 1;
+    static constexpr std::size_t levels = 4;
+
+    struct entry_t {
+      Key key;
+      time_point deadline;
+      T value;
+      int level = -1;  // -1 while due
+      std::size_t slot = 0;
+    };
+
+    using list_t = std::list<entry_t>;
+    using iterator_t = typename list_t::iterator;
+
+    tick_t tick_of(time_point deadline) const {
+      if (deadline <= _epoch) {
+        return 0;
+      }
+
+      // Round up, so nothing in a tick is due before the tick is processed
+      auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - _epoch).count();
+      constexpr auto per_tick = std::chrono::duration_cast<std::chrono::nanoseconds>(tick).count();
+      return (tick_t) ((elapsed + per_tick - 1) / per_tick);
+    }
+
+    time_point time_of(tick_t ticks) const {
+      return _epoch + ticks * tick;
+    }
+
+    list_t &list_of(const entry_t &entry) {
+      return entry.level < 0 ? _due : _slots[entry.level][entry.slot];
+    }
+
+    void update_bit(int level, std::size_t slot) {
+      if (level < 0) {
+        return;
+      }
+
+      if (_slots[level][slot].empty()) {
+        _bits[level] &= ~(1ull << slot);
+      } else {
+        _bits[level] |= 1ull << slot;
+      }
+    }
+
+    /**
+     * @brief Move an entry from the list it's in to where its deadline belongs.
+     */
+    void place(iterator_t entry) {
+      auto &from = list_of(*entry);
+      auto from_level = entry->level;
+      auto from_slot = entry->slot;
+
+      auto deadline = tick_of(entry->deadline);
+      if (deadline <= _now) {
+        entry->level = -1;
+      } else {
+        auto delta = deadline - _now;
+
+        std::size_t level = 0;
+        while (level + 1 < levels && delta >= (tick_t {1} << ((level + 1) * slot_bits))) {
+          ++level;
+        }
+
+        // Too far for the wheel: wait in the slot that comes around last
+        if (delta >= (tick_t {1} << (levels * slot_bits))) {
+          deadline = _now + (tick_t {1} << (levels * slot_bits)) - 1;
+        }
+
+        entry->level = (int) level;
+        entry->slot = (std::size_t) ((deadline >> (level * slot_bits)) & slot_mask);
+      }
+
+      auto &to = list_of(*entry);
+      to.splice(to.end(), from, entry);
+      update_bit(from_level, from_slot);
+      update_bit(entry->level, entry->slot);
+    }
+
+    /**
+     * @brief Process every tick up to now.
+     */
+    void advance(time_point now) {
+      // Including the tick now is in, whose values pop() and ready() check against their deadlines
+      auto target = tick_of(now);
+
+      while (_now < target) {
+        if (_index.empty() || !(_bits[0] | _bits[1] | _bits[2] | _bits[3])) {
+          _now = target;
+          return;
+        }
+
+        // Nothing changes before the next range boundary of the lowest occupied level
+        std::size_t lowest = 0;
+        while (!_bits[lowest]) {
+          ++lowest;
+        }
+        if (lowest > 0) {
+          auto boundary = ((_now >> (lowest * slot_bits)) + 1) << (lowest * slot_bits);
+          if (boundary > target) {
+            _now = target;
+            return;
+          }
+          _now = boundary - 1;
+        }
+
+        ++_now;
+
+        // Higher levels first, so their values can fall through to the slots processed next
+        for (auto level = levels - 1; level > 0; --level) {
+          auto shift = level * slot_bits;
+          if (_now & ((tick_t {1} << shift) - 1)) {
+            continue;
+          }
+
+          auto &list = _slots[level][(_now >> shift) & slot_mask];
+          while (!list.empty()) {
+            place(list.begin());
+          }
+        }
+
+        auto &list = _slots[0][_now & slot_mask];
+        while (!list.empty()) {
+          place(list.begin());
+        }
+      }
+    }
+
+    time_point _epoch;
+    tick_t _now = 0;  // Last tick processed
+
+    std::array<std::array<list_t, slots>, levels> _slots;
+    std::array<std::uint64_t, levels> _bits {};
+    list_t _due;
+
+    std::unordered_map<Key, iterator_t> _index;
+  };
+}  // namespace task_pool_util
@@ -47,6 +47,8 @@ extern "C" {
 #include "process.h"
 #include "sync.h"
 #include "video.h"
+#include "video_change.h"
+#include "video_convert.h"
 #include "video_encoder_probe_policy.h"
 #include "webrtc_stream.h"
 
@@ -931,9 +933,59 @@ namespace video {
   util::Either<avcodec_buffer_t, int> vulkan_init_avcodec_hardware_input_buffer(platf::avcodec_encode_device_t *);
 #endif
 
+  /**
+   * @brief Map a software frame format to the direct converter's, when it has one.
+   */
+  std::optional<video::convert::format_e> direct_convert_format(AVPixelFormat format) {
+    switch (format) {
+      case AV_PIX_FMT_YUV420P:
+        return video::convert::format_e::yuv420p;
+      case AV_PIX_FMT_YUV420P10:
+        return video::convert::format_e::yuv420p10;
+      case AV_PIX_FMT_YUV444P:
+        return video::convert::format_e::yuv444p;
+      case AV_PIX_FMT_YUV444P10:
+        return video::convert::format_e::yuv444p10;
+      case AV_PIX_FMT_NV12:
+        return video::convert::format_e::nv12;
+      case AV_PIX_FMT_P010:
+        return video::convert::format_e::p010;
+      default:
+        return std::nullopt;
+    }
+  }
+
   class avcodec_software_encode_device_t: public platf::avcodec_encode_device_t {
   public:
     int convert(platf::img_t &img) override {
+      // Without scaling or padding, convert straight into the frame
+      if (converter && img.width == sw_frame->width && img.height == sw_frame->height) {
+        video::convert::image_t out {
+          {sw_frame->data[0], sw_frame->data[1], sw_frame->data[2]},
+          {sw_frame->linesize[0], sw_frame->linesize[1], sw_frame->linesize[2]},
+        };
+
+        // When the frame still holds the previous image of the capture, only damaged tiles need converting
+        auto follows = last_capture_sequence && img.capture_sequence == last_capture_sequence + 1;
+        if (follows && img.damage) {
+          damage_rects.clear();
+          for (const auto &rect : *img.damage) {
+            damage_rects.push_back({rect.x, rect.y, rect.width, rect.height});
+          }
+          converter->convert(img.data, img.row_pitch, out, damage_rects);
+          mark_damage(img.damage);
+        } else {
+          converter->convert(img.data, img.row_pitch, out);
+          mark_damage(std::nullopt);
+        }
+        last_capture_sequence = img.capture_sequence;
+
+        return transfer_to_hw_frame();
+      }
+
+      last_capture_sequence = 0;
+      mark_damage(std::nullopt);
+
       // If we need to add aspect ratio padding, we need to scale into an intermediate output buffer
       bool requires_padding = (sw_frame->width != sws_output_frame->width || sw_frame->height != sws_output_frame->height);
 
@@ -965,6 +1017,45 @@ namespace video {
         }
       }
 
+      return transfer_to_hw_frame();
+    }
+
+    void skip(const platf::img_t &img) override {
+      // The frame still holds the same pixels, so damage of the next image applies to it
+      if (last_capture_sequence && img.capture_sequence) {
+        last_capture_sequence = img.capture_sequence;
+      }
+    }
+
+    /**
+     * @brief Ask the encoder to favor the regions that changed, when enabled.
+     */
+    void mark_damage(const platf::damage_t &damage) {
+      av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+      if (!config::video.sw.damage_roi || !damage || damage->empty()) {
+        return;
+      }
+
+      auto side_data = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST, damage->size() * sizeof(AVRegionOfInterest));
+      if (!side_data) {
+        return;
+      }
+
+      auto regions = (AVRegionOfInterest *) side_data->data;
+      for (const auto &rect : *damage) {
+        regions->self_size = sizeof(AVRegionOfInterest);
+        regions->top = std::clamp(rect.y, 0, frame->height);
+        regions->bottom = std::clamp(rect.y + rect.height, 0, frame->height);
+        regions->left = std::clamp(rect.x, 0, frame->width);
+        regions->right = std::clamp(rect.x + rect.width, 0, frame->width);
+
+        // A little under 3 QP better than the rest of the frame in libx264
+        regions->qoffset = av_make_q(-1, 10);
+        ++regions;
+      }
+    }
+
+    int transfer_to_hw_frame() {
       // If frame is not a software frame, it means we still need to transfer from main memory
       // to vram memory
       if (frame->hw_frames_ctx) {
@@ -999,6 +1090,20 @@ namespace video {
     void apply_colorspace() override {
       auto avcodec_colorspace = avcodec_colorspace_from_sunshine_colorspace(colorspace);
       sws_setColorspaceDetails(sws.get(), sws_getCoefficients(SWS_CS_DEFAULT), 0, sws_getCoefficients(avcodec_colorspace.software_format), avcodec_colorspace.range - 1, 0, 1 << 16, 1 << 16);
+
+      if (!direct_format) {
+        return;
+      }
+
+      auto colors = video::color_vectors_from_colorspace(colorspace, false);
+      video::convert::matrix_t matrix;
+      std::copy_n(colors->color_vec_y, 4, matrix.y);
+      std::copy_n(colors->color_vec_u, 4, matrix.u);
+      std::copy_n(colors->color_vec_v, 4, matrix.v);
+
+      converter = std::make_unique<video::convert::converter_t>(*direct_format, sws_input_frame->width, sws_input_frame->height, matrix, std::max(config::video.min_threads, 1));
+      last_capture_sequence = 0;
+      BOOST_LOG(debug) << "Converting frames with "sv << video::convert::isa_name(converter->isa()) << " on "sv << converter->threads() << " threads"sv;
     }
 
     /**
@@ -1049,6 +1154,13 @@ namespace video {
       offsetW = (frame->width - out_width) / 2;
       offsetH = (frame->height - out_height) / 2;
 
+      // swscale is still needed whenever the image is scaled or padded
+      direct_format.reset();
+      converter.reset();
+      if (in_width == frame->width && in_height == frame->height) {
+        direct_format = direct_convert_format(format);
+      }
+
       sws.reset(sws_alloc_context());
       if (!sws) {
         return -1;
@@ -1090,6 +1202,14 @@ namespace video {
     avcodec_frame_t sws_output_frame;
     sws_t sws;
 
+    // Converts unscaled frames instead of swscale, once the colorspace is known
+    std::optional<video::convert::format_e> direct_format;
+    std::unique_ptr<video::convert::converter_t> converter;
+
+    // capture_sequence of the image the frame holds, or 0 when it's unknown
+    std::uint64_t last_capture_sequence = 0;
+    std::vector<video::convert::rect_t> damage_rects;
+
     // Offset of input image to output frame in pixels
     int offsetW;
     int offsetH;
@@ -1111,12 +1231,58 @@ namespace video {
     FIXED_GOP_SIZE = 1 << 12,  ///< Use fixed small GOP size (encoder doesn't support on-demand IDR frames)
   };
 
+  // Packets an encode session keeps for reuse, as many as the packet queue holds
+  constexpr std::size_t packet_pool_size = 32;
+
+  /**
+   * @brief Payload buffers for the packets of an avcodec encoder, recycled instead of allocated.
+   * @details Installed as the codec context's get_encode_buffer(), which encoders with
+   *          AV_CODEC_CAP_DR1 call for every packet. Buffers come from an AVBufferPool that is
+   *          replaced whenever the frame sizes drift away from its buffer size, and a frame too
+   *          large for it gets a buffer of its own.
+   */
+  struct avcodec_payload_pool_t {
+    ~avcodec_payload_pool_t() {
+      // Buffers still in flight keep the pool alive until they're released
+      av_buffer_pool_uninit(&pool);
+    }
+
+    static int get_encode_buffer(AVCodecContext *ctx, AVPacket *packet, int flags) {
+      auto payloads = static_cast<avcodec_payload_pool_t *>(ctx->opaque);
+      auto size = (std::size_t) packet->size + AV_INPUT_BUFFER_PADDING_SIZE;
+      auto wanted = payloads->sizer.pool_buffer_size(size, payloads->buffer_size);
+      if (wanted != payloads->buffer_size) {
+        av_buffer_pool_uninit(&payloads->pool);
+        payloads->pool = av_buffer_pool_init(wanted, nullptr);
+        payloads->buffer_size = payloads->pool ? wanted : 0;
+      }
+
+      if (size > payloads->buffer_size) {
+        return avcodec_default_get_encode_buffer(ctx, packet, flags);
+      }
+
+      packet->buf = av_buffer_pool_get(payloads->pool);
+      if (!packet->buf) {
+        return AVERROR(ENOMEM);
+      }
+      packet->data = packet->buf->data;
+      std::memset(packet->data + packet->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+      return 0;
+    }
+
+    AVBufferPool *pool = nullptr;
+    std::size_t buffer_size = 0;
+    payload_sizer_t sizer;
+  };
+
   class avcodec_encode_session_t: public encode_session_t {
   public:
     avcodec_encode_session_t() = default;
 
-    avcodec_encode_session_t(avcodec_ctx_t &&avcodec_ctx, std::unique_ptr<platf::avcodec_encode_device_t> encode_device, int inject):
+    avcodec_encode_session_t(avcodec_ctx_t &&avcodec_ctx, std::unique_ptr<avcodec_payload_pool_t> payloads, std::unique_ptr<platf::avcodec_encode_device_t> encode_device, int inject):
         avcodec_ctx {std::move(avcodec_ctx)},
+        payloads {std::move(payloads)},
         device {std::move(encode_device)},
         inject {inject} {
     }
@@ -1138,6 +1304,8 @@ namespace video {
     avcodec_encode_session_t &operator=(avcodec_encode_session_t &&other) {
       device = std::move(other.device);
       avcodec_ctx = std::move(other.avcodec_ctx);
+      payloads = std::move(other.payloads);
+      packet_pool = std::move(other.packet_pool);
       replacements = std::move(other.replacements);
       sps = std::move(other.sps);
       vps = std::move(other.vps);
@@ -1154,6 +1322,12 @@ namespace video {
       return device->convert(img);
     }
 
+    void skip(const platf::img_t &img) override {
+      if (device) {
+        device->skip(img);
+      }
+    }
+
     void request_idr_frame() override {
       if (device && device->frame) {
         auto &frame = device->frame;
@@ -1217,8 +1391,13 @@ namespace video {
     }
 
     avcodec_ctx_t avcodec_ctx;
+
+    // Outlives avcodec_ctx, which the destructor frees first
+    std::unique_ptr<avcodec_payload_pool_t> payloads;
     std::unique_ptr<platf::avcodec_encode_device_t> device;
 
+    std::shared_ptr<packet_pool_t<packet_raw_avcodec>> packet_pool = packet_pool_t<packet_raw_avcodec>::make(packet_pool_size);
+
     std::vector<packet_raw_t::replace_t> replacements;
 
     cbs::nal_t sps;
@@ -1275,16 +1454,18 @@ namespace video {
       device->nvenc->set_hdr_metadata(metadata);
     }
 
-    nvenc::nvenc_encoded_frame encode_frame(uint64_t frame_index) {
+    nvenc::nvenc_encoded_frame encode_frame(uint64_t frame_index, std::vector<uint8_t> &&buffer) {
       if (!device || !device->nvenc) {
         return {};
       }
 
-      auto result = device->nvenc->encode_frame(frame_index, force_idr);
+      auto result = device->nvenc->encode_frame(frame_index, force_idr, std::move(buffer));
       force_idr = false;
       return result;
     }
 
+    std::shared_ptr<packet_pool_t<packet_raw_generic>> packet_pool = packet_pool_t<packet_raw_generic>::make(packet_pool_size);
+
   private:
     std::unique_ptr<platf::nvenc_encode_device_t> device;
     bool force_idr = false;
@@ -1475,6 +1656,8 @@ namespace video {
       }
     }
 
+    std::shared_ptr<packet_pool_t<packet_raw_generic>> packet_pool = packet_pool_t<packet_raw_generic>::make(packet_pool_size);
+
   private:
     std::unique_ptr<platf::amf_encode_device_t> device;
     bool force_idr = false;
@@ -1514,7 +1697,7 @@ namespace video {
   struct sync_session_ctx_t {
     safe::signal_t *join_event;
     safe::mail_raw_t::event_t<bool> shutdown_event;
-    safe::mail_raw_t::queue_t<packet_t> packets;
+    packet_queue_t packets;
     safe::mail_raw_t::event_t<bool> idr_events;
     safe::mail_raw_t::event_t<hdr_info_t> hdr_events;
     safe::mail_raw_t::event_t<input::touch_port_t> touch_port_events;
@@ -3044,10 +3227,18 @@ namespace video {
     }
   }
 
+  packet_queue_t packet_queue(safe::mail_raw_t &mail) {
+    constexpr safe::channel_t<safe::ring_queue_t<packet_t>> video_packets {(std::size_t) mail::id_e::video_packets, "video_packets"};
+
+    return mail.ring(video_packets, 32, safe::drop_e::keep_keyframes, [](const packet_t &packet) {
+      return packet->is_idr();
+    });
+  }
+
   int encode_avcodec(
     int64_t frame_nr,
     avcodec_encode_session_t &session,
-    safe::mail_raw_t::queue_t<packet_t> &packets,
+    packet_queue_t &packets,
     void *channel_data,
     std::optional<std::chrono::steady_clock::time_point> frame_timestamp,
     std::optional<std::chrono::steady_clock::time_point> capture_timestamp,
@@ -3070,9 +3261,13 @@ namespace video {
       return -1;
     }
 
+    // Damage hints only describe the image they were converted with, not repeats of it
+    av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+
     while (ret >= 0) {
-      auto packet = std::make_unique<packet_raw_avcodec>();
-      auto av_packet = packet.get()->av_packet;
+      auto avcodec_packet = session.packet_pool->acquire();
+      packet_t packet {avcodec_packet};
+      auto av_packet = avcodec_packet->av_packet;
 
       ret = avcodec_receive_packet(ctx.get(), av_packet);
       if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
@@ -3135,13 +3330,18 @@ namespace video {
   int encode_nvenc(
     int64_t frame_nr,
     nvenc_encode_session_t &session,
-    safe::mail_raw_t::queue_t<packet_t> &packets,
+    packet_queue_t &packets,
     void *channel_data,
     std::optional<std::chrono::steady_clock::time_point> frame_timestamp,
     std::optional<std::chrono::steady_clock::time_point> capture_timestamp,
     std::optional<std::chrono::steady_clock::time_point> host_processing_timestamp
   ) {
-    auto encoded_frame = session.encode_frame(frame_nr);
+    // The bitstream is copied into the payload the packet was last recycled with
+    auto generic_packet = session.packet_pool->acquire();
+    packet_t packet {generic_packet};
+    session.packet_pool->sizer.reserve(generic_packet->frame_data);
+
+    auto encoded_frame = session.encode_frame(frame_nr, std::move(generic_packet->frame_data));
     if (encoded_frame.data.empty()) {
       BOOST_LOG(error) << "NvENC returned empty packet";
       return -1;
@@ -3151,7 +3351,9 @@ namespace video {
       BOOST_LOG(error) << "NvENC frame index mismatch " << frame_nr << " " << encoded_frame.frame_index;
     }
 
-    auto packet = std::make_unique<packet_raw_generic>(std::move(encoded_frame.data), encoded_frame.frame_index, encoded_frame.idr);
+    generic_packet->frame_data = std::move(encoded_frame.data);
+    generic_packet->index = encoded_frame.frame_index;
+    generic_packet->idr = encoded_frame.idr;
     packet->channel_data = channel_data;
     packet->after_ref_frame_invalidation = encoded_frame.after_ref_frame_invalidation;
     packet->frame_timestamp = frame_timestamp;
@@ -3170,7 +3372,7 @@ namespace video {
     int64_t submitted_frame_nr,
     amf_encode_session_t &session,
     std::vector<amf::amf_encoded_frame> &encoded_frames,
-    safe::mail_raw_t::queue_t<packet_t> &packets,
+    packet_queue_t &packets,
     void *channel_data
   ) {
     for (auto &encoded_frame : encoded_frames) {
@@ -3189,7 +3391,11 @@ namespace video {
       // including earlier frames drained in the same catch-up batch.
       const auto ts = session.take_frame_timestamps(encoded_frame.frame_index);
 
-      auto packet = std::make_unique<packet_raw_generic>(std::move(encoded_frame.data), encoded_frame.frame_index, encoded_frame.idr);
+      auto generic_packet = session.packet_pool->acquire();
+      packet_t packet {generic_packet};
+      generic_packet->frame_data = std::move(encoded_frame.data);
+      generic_packet->index = encoded_frame.frame_index;
+      generic_packet->idr = encoded_frame.idr;
       packet->channel_data = channel_data;
       packet->after_ref_frame_invalidation = encoded_frame.after_ref_frame_invalidation;
       packet->frame_timestamp = ts.frame_timestamp;
@@ -3206,7 +3412,7 @@ namespace video {
   int encode_amf(
     int64_t frame_nr,
     amf_encode_session_t &session,
-    safe::mail_raw_t::queue_t<packet_t> &packets,
+    packet_queue_t &packets,
     void *channel_data,
     std::optional<std::chrono::steady_clock::time_point> frame_timestamp,
     std::optional<std::chrono::steady_clock::time_point> capture_timestamp,
@@ -3239,7 +3445,7 @@ namespace video {
   int encode(
     int64_t frame_nr,
     encode_session_t &session,
-    safe::mail_raw_t::queue_t<packet_t> &packets,
+    packet_queue_t &packets,
     void *channel_data,
     std::optional<std::chrono::steady_clock::time_point> frame_timestamp,
     std::optional<std::chrono::steady_clock::time_point> capture_timestamp,
@@ -3552,6 +3758,7 @@ namespace video {
     // fallback options, we may need to allow more retries
     // to try applying each set.
     avcodec_ctx_t ctx;
+    auto payloads = std::make_unique<avcodec_payload_pool_t>();
     for (int retries = 0; retries < 2; retries++) {
 #ifdef _WIN32
       std::optional<amf_main10_compatibility_override_t> amf_main10_compatibility_override;
@@ -3814,6 +4021,10 @@ namespace video {
         }
       }
 
+      // Encoders that support it write packets into recycled buffers
+      ctx->opaque = payloads.get();
+      ctx->get_encode_buffer = avcodec_payload_pool_t::get_encode_buffer;
+
       // Allow the encoding device a final opportunity to set/unset or override any options
       encode_device->init_codec_options(ctx.get(), &options);
 
@@ -3909,6 +4120,7 @@ namespace video {
 
     auto session = std::make_unique<avcodec_encode_session_t>(
       std::move(ctx),
+      std::move(payloads),
       std::move(encode_device_final),
 
       // 0 ==> don't inject, 1 ==> inject for h264, 2 ==> inject for hevc
@@ -4455,6 +4667,7 @@ namespace video {
     const encoder_t &encoder,
     hdr_latch_t *hdr_latch,
     void *channel_data,
+    stats_t *stats,
     std::chrono::steady_clock::time_point initialization_deadline,
     initialization_cancel_t initialization_cancelled,
     std::optional<hdr_info_raw_t> &last_hdr_info,
@@ -4679,7 +4892,7 @@ namespace video {
     BOOST_LOG(info) << "Minimum FPS target set to ~"sv << (minimum_fps_target / 2000) << "fps ("sv << max_frametime * 2 << ")"sv;
     BOOST_LOG(info) << "Encoding Frame threshold: "sv << encode_frame_threshold;
 
-    auto packets = mail::man->queue<packet_t>(mail::video_packets);
+    auto packets = packet_queue(*mail::man);
     auto idr_events = mail->event<bool>(mail::idr);
     auto hdr_event = mail->event<hdr_info_t>(mail::hdr);
     auto invalidate_ref_frames_events = mail->event<std::pair<int64_t, int64_t>>(mail::invalidate_ref_frames);
@@ -4774,9 +4987,19 @@ namespace video {
       uint64_t gate_skipped = 0;
       uint64_t encoded = 0;
       uint64_t dropped_submissions = 0;
+      uint64_t static_skipped = 0;
+      uint64_t static_refreshes = 0;
       std::chrono::steady_clock::time_point last_log = std::chrono::steady_clock::now();
     } loop_stats;
 
+    // Images with the same pixels as the last one encoded are neither converted nor encoded,
+    // until the minimum FPS target is due and the frame that already holds them is encoded again
+    std::optional<change::detector_t> change_detector;
+    if (config::video.sw.static_frame_skip && session_encoder == &software) {
+      change_detector.emplace();
+    }
+    std::chrono::steady_clock::time_point last_encode;
+
     while (true) {
       if (auto now = std::chrono::steady_clock::now(); now - loop_stats.last_log >= 10s) {
         BOOST_LOG(debug) << "Encode loop [" << channel_data << "] " << config.width << 'x' << config.height
@@ -4786,6 +5009,8 @@ namespace video {
                          << " gate_skipped=" << loop_stats.gate_skipped
                          << " encoded=" << loop_stats.encoded
                          << " dropped_submissions=" << loop_stats.dropped_submissions
+                         << " static_skipped=" << loop_stats.static_skipped
+                         << " static_refreshes=" << loop_stats.static_refreshes
                          << " frame_nr=" << frame_nr;
         loop_stats = {};
         loop_stats.last_log = now;
@@ -4845,6 +5070,8 @@ namespace video {
       std::optional<std::chrono::steady_clock::time_point> capture_timestamp;
       std::optional<std::chrono::steady_clock::time_point> host_processing_timestamp;
       bool placeholder_input = bootstrap_state.current_input_placeholder;
+      bool compared = false;
+      bool unchanged = false;
 
       // Encode at a minimum FPS to avoid image quality issues with static content
       if (!requested_idr_frame || images->peek()) {
@@ -4927,6 +5154,23 @@ namespace video {
           } else {
             ++loop_stats.popped_real;
           }
+          if (change_detector) {
+            compared = !placeholder_input && img->data && img->pixel_pitch == 4;
+            if (compared) {
+              unchanged = change_detector->compare(img->data, img->row_pitch, img->width, img->height) == 0;
+            } else {
+              change_detector->reset();
+            }
+          }
+          if (unchanged && !requested_idr_frame && std::chrono::steady_clock::now() - last_encode < max_frametime) {
+            session->skip(*img);
+            ++loop_stats.static_skipped;
+            if (stats) {
+              ++stats->static_skipped;
+            }
+            continue;
+          }
+
           if (!placeholder_input && bootstrap_state.current_input_placeholder) {
             session->request_idr_frame();
           }
@@ -4935,7 +5179,13 @@ namespace video {
             frame_timestamp = capture_timestamp;
             host_processing_timestamp = img->host_processing_timestamp;
           }
-          if (session->convert(*img)) {
+          if (unchanged) {
+            session->skip(*img);
+            ++loop_stats.static_refreshes;
+            if (stats) {
+              ++stats->static_refreshes;
+            }
+          } else if (session->convert(*img)) {
             BOOST_LOG(error) << "Could not convert image"sv;
             native_amf_runtime_failed = native_amf_session;
             break;
@@ -4995,6 +5245,10 @@ namespace video {
         break;
       }
       ++loop_stats.encoded;
+      last_encode = std::chrono::steady_clock::now();
+      if (compared) {
+        change_detector->accept();
+      }
 
       // A dropped submission leaves a hole in the wire frameIndex sequence, which
       // the client reads as loss. Reusing the index instead is NOT safe: several
@@ -5536,7 +5790,8 @@ namespace video {
   void capture_async(
     safe::mail_t mail,
     config_t &config,
-    void *channel_data
+    void *channel_data,
+    stats_t *stats
   ) {
     auto shutdown_event = mail->event<bool>(mail::shutdown);
 
@@ -5669,6 +5924,7 @@ namespace video {
         session_encoder,
         &hdr_latch,
         channel_data,
+        stats,
         initialization_deadline,
         initialization_cancelled,
         last_hdr_info,
@@ -5731,7 +5987,8 @@ namespace video {
   void capture(
     safe::mail_t mail,
     config_t config,
-    void *channel_data
+    void *channel_data,
+    stats_t *stats
   ) {
     // Snapshot the encoder pointer to avoid races with concurrent probe_encoders() calls
     auto *encoder = chosen_encoder;
@@ -5744,14 +6001,14 @@ namespace video {
 
     idr_events->raise(true);
     if (encoder->flags & PARALLEL_ENCODING) {
-      capture_async(std::move(mail), config, channel_data);
+      capture_async(std::move(mail), config, channel_data, stats);
     } else {
       safe::signal_t join_event;
       auto ref = capture_thread_sync.ref();
       ref->encode_session_ctx_queue.raise(sync_session_ctx_t {
         &join_event,
         mail->event<bool>(mail::shutdown),
-        mail::man->queue<packet_t>(mail::video_packets),
+        packet_queue(*mail::man),
         std::move(idr_events),
         mail->event<hdr_info_t>(mail::hdr),
         mail->event<input::touch_port_t>(mail::touch_port),
@@ -5847,7 +6104,7 @@ namespace video {
 
         // Use a probe-local mail/queue to avoid stale packets from previous encoder sessions.
         auto probe_mail = std::make_shared<safe::mail_raw_t>();
-        auto packets = probe_mail->queue<packet_t>(mail::video_packets);
+        auto packets = packet_queue(*probe_mail);
 
         // Bound the whole codec probe by both submissions and wall time. An AMF driver
         // stalled in INPUT_FULL can make a single encode() call take hundreds of
@@ -10,9 +10,12 @@
 #include "video_policy.h"
 #include "thread_safe.h"
 #include "video_colorspace.h"
+#include "video_packet_pool.h"
 
 // standard includes
 #include <array>
+#include <atomic>
+#include <cstdint>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -260,6 +263,13 @@ namespace video {
 
     virtual int convert(platf::img_t &img) = 0;
 
+    /**
+     * @brief Note an image that wasn't converted because it has the same pixels as the last one.
+     * @param img The skipped image.
+     */
+    virtual void skip(const platf::img_t &) {
+    }
+
     virtual void request_idr_frame() = 0;
 
     virtual void request_normal_frame() = 0;
@@ -306,41 +316,7 @@ namespace video {
   extern encoder_t videotoolbox;
 #endif
 
-  struct packet_raw_t {
-    virtual ~packet_raw_t() = default;
-
-    virtual bool is_idr() = 0;
-
-    virtual int64_t frame_index() = 0;
-
-    virtual uint8_t *data() = 0;
-
-    virtual size_t data_size() = 0;
-
-    struct replace_t {
-      std::string_view old;
-      std::string_view _new;
-
-      KITTY_DEFAULT_CONSTR_MOVE(replace_t)
-
-      replace_t(std::string_view old, std::string_view _new) noexcept:
-          old {std::move(old)},
-          _new {std::move(_new)} {
-      }
-    };
-
-    std::vector<replace_t> *replacements = nullptr;
-    void *channel_data = nullptr;
-    bool after_ref_frame_invalidation = false;
-    // Pacing/scheduled timestamp used for transport timing.
-    std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
-    // Raw capture/QPC-derived timestamp before pacing adjustments.
-    std::optional<std::chrono::steady_clock::time_point> capture_timestamp;
-    std::optional<std::chrono::steady_clock::time_point> host_processing_timestamp;
-    std::chrono::steady_clock::time_point packet_enqueue_timestamp = std::chrono::steady_clock::now();
-  };
-
-  struct packet_raw_avcodec: packet_raw_t {
+  struct packet_raw_avcodec: pooled_packet_t<packet_raw_avcodec> {
     packet_raw_avcodec() {
       av_packet = av_packet_alloc();
     }
@@ -349,6 +325,11 @@ namespace video {
       av_packet_free(&this->av_packet);
     }
 
+    void clear_payload() {
+      // The payload goes back to whatever the encoder allocated it from
+      av_packet_unref(av_packet);
+    }
+
     bool is_idr() override {
       return av_packet->flags & AV_PKT_FLAG_KEY;
     }
@@ -368,35 +349,14 @@ namespace video {
     AVPacket *av_packet;
   };
 
-  struct packet_raw_generic: packet_raw_t {
-    packet_raw_generic(std::vector<uint8_t> &&frame_data, int64_t frame_index, bool idr):
-        frame_data {std::move(frame_data)},
-        index {frame_index},
-        idr {idr} {
-    }
+  using packet_queue_t = safe::mail_raw_t::ring_queue_t<packet_t>;
 
-    bool is_idr() override {
-      return idr;
-    }
-
-    int64_t frame_index() override {
-      return index;
-    }
-
-    uint8_t *data() override {
-      return frame_data.data();
-    }
-
-    size_t data_size() override {
-      return frame_data.size();
-    }
-
-    std::vector<uint8_t> frame_data;
-    int64_t index;
-    bool idr;
-  };
-
-  using packet_t = std::unique_ptr<packet_raw_t>;
+  /**
+   * @brief The queue encoded frames are raised on.
+   * @details When the broadcast falls behind, new frames are refused until an IDR frame
+   *          arrives, which makes room by evicting the oldest.
+   */
+  packet_queue_t packet_queue(safe::mail_raw_t &mail);
 
   struct hdr_info_raw_t {
     explicit hdr_info_raw_t(bool enabled):
@@ -444,10 +404,19 @@ namespace video {
   bool clear_pending_virtual_display_adapter_hint(encoder_probe_adapter_hint_lease_t lease);
 #endif
 
+  /**
+   * @brief Counters a capture reports while it runs.
+   */
+  struct stats_t {
+    std::atomic<std::uint64_t> static_skipped {0};  ///< Unchanged frames that were neither converted nor encoded
+    std::atomic<std::uint64_t> static_refreshes {0};  ///< Unchanged frames encoded to keep up the minimum FPS
+  };
+
   void capture(
     safe::mail_t mail,
     config_t config,
-    void *channel_data
+    void *channel_data,
+    stats_t *stats = nullptr
   );
 
   bool validate_encoder(
@@ -0,0 +1,296 @@
+/**
+ * @file src/video_change.cpp
+ * @brief Definitions for detecting captured images that didn't change.
+ */
+// standard includes
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define SUNSHINE_CHANGE_X86
+#endif
+
+// local includes
+#include "video_change.h"
+
+namespace video::change {
+  namespace {
+    // Each stripe of 32 bytes (8 pixels) is accumulated into four 64-bit lanes like xxh3
+    // does, with a key that advances every stripe so that moving pixels along a row changes
+    // the hash. The lanes are scrambled after every row, so moving rows changes it too.
+    constexpr int stripe_bytes = 32;
+    constexpr std::uint64_t color_mask = 0x00ffffff00ffffffull;
+    constexpr std::uint64_t prime32_1 = 0x9e3779b1ull;
+    constexpr std::uint64_t prime64_1 = 0x9e3779b185ebca87ull;
+
+    constexpr std::uint64_t initial[4] {
+      0xc2b2ae3d27d4eb4full,
+      0x9e3779b185ebca87ull,
+      0x165667b19e3779f9ull,
+      0x85ebca77c2b2ae63ull,
+    };
+
+    constexpr std::uint64_t secret[4] {
+      0xbe4ba423396cfeb8ull,
+      0x1cad21f72c81017cull,
+      0xdb979083e96dd4deull,
+      0x1f67b3b7a4a44072ull,
+    };
+
+    constexpr std::uint64_t scramble_key[4] {
+      0x78e5c0cc4ee679cbull,
+      0x2172ffcc7dd05a82ull,
+      0x8e2443f7744608b8ull,
+      0x4c263a81e69035e0ull,
+    };
+
+    std::uint64_t avalanche(std::uint64_t h) {
+      h ^= h >> 37;
+      h *= 0x165667919e3779f9ull;
+      return h ^ (h >> 32);
+    }
+
+    std::uint64_t finish(const std::uint64_t (&acc)[4], int width, int height) {
+      auto h = (std::uint64_t) width * prime64_1 ^ (std::uint64_t) height;
+      for (auto lane : acc) {
+        h = avalanche(h ^ lane);
+      }
+      return h;
+    }
+
+    /**
+     * @brief Copy the pixels after the last whole stripe of a row into a stripe of zeros.
+     */
+    void pad_tail(const std::uint8_t *row, int stripes, int tail, std::uint8_t (&out)[stripe_bytes]) {
+      std::memset(out, 0, sizeof(out));
+      std::memcpy(out, row + stripes * stripe_bytes, tail * 4);
+    }
+
+    void none_stripe(const std::uint8_t *src, const std::uint64_t (&key)[4], std::uint64_t (&acc)[4]) {
+      for (int i = 0; i < 4; ++i) {
+        std::uint64_t data;
+        std::memcpy(&data, src + i * 8, 8);
+        data &= color_mask;
+
+        auto keyed = data ^ key[i];
+        acc[i ^ 1] += data;
+        acc[i] += (keyed & 0xffffffff) * (keyed >> 32);
+      }
+    }
+
+    std::uint64_t none_hash(const std::uint8_t *bgr0, int row_pitch, int width, int height) {
+      std::uint64_t acc[4] {initial[0], initial[1], initial[2], initial[3]};
+      const int stripes = width / 8;
+      const int tail = width % 8;
+
+      for (int y = 0; y < height; ++y) {
+        auto row = bgr0 + (std::ptrdiff_t) y * row_pitch;
+        std::uint64_t key[4] {secret[0], secret[1], secret[2], secret[3]};
+
+        for (int s = 0; s < stripes; ++s) {
+          none_stripe(row + s * stripe_bytes, key, acc);
+          for (auto &k : key) {
+            k += prime64_1;
+          }
+        }
+
+        if (tail) {
+          std::uint8_t padded[stripe_bytes];
+          pad_tail(row, stripes, tail, padded);
+          none_stripe(padded, key, acc);
+        }
+
+        for (int i = 0; i < 4; ++i) {
+          acc[i] ^= acc[i] >> 47;
+          acc[i] ^= scramble_key[i];
+          acc[i] *= prime32_1;
+        }
+      }
+
+      return finish(acc, width, height);
+    }
+
+#ifdef SUNSHINE_CHANGE_X86
+  #define SSE41 __attribute__((target("sse4.1")))
+  #define AVX2 __attribute__((target("avx2")))
+
+    SSE41 inline void sse_stripe(const std::uint8_t *src, __m128i key0, __m128i key1, __m128i &acc0, __m128i &acc1) {
+      const auto mask = _mm_set1_epi64x((long long) color_mask);
+
+      auto data0 = _mm_and_si128(_mm_loadu_si128((const __m128i *) src), mask);
+      auto data1 = _mm_and_si128(_mm_loadu_si128((const __m128i *) (src + 16)), mask);
+      auto keyed0 = _mm_xor_si128(data0, key0);
+      auto keyed1 = _mm_xor_si128(data1, key1);
+
+      // Lanes i and i ^ 1 are the two halves of each register
+      acc0 = _mm_add_epi64(acc0, _mm_shuffle_epi32(data0, _MM_SHUFFLE(1, 0, 3, 2)));
+      acc1 = _mm_add_epi64(acc1, _mm_shuffle_epi32(data1, _MM_SHUFFLE(1, 0, 3, 2)));
+      acc0 = _mm_add_epi64(acc0, _mm_mul_epu32(keyed0, _mm_srli_epi64(keyed0, 32)));
+      acc1 = _mm_add_epi64(acc1, _mm_mul_epu32(keyed1, _mm_srli_epi64(keyed1, 32)));
+    }
+
+    SSE41 inline __m128i sse_scramble(__m128i acc, __m128i key) {
+      const auto prime = _mm_set1_epi64x((long long) prime32_1);
+
+      acc = _mm_xor_si128(acc, _mm_srli_epi64(acc, 47));
+      acc = _mm_xor_si128(acc, key);
+      auto low = _mm_mul_epu32(acc, prime);
+      auto high = _mm_mul_epu32(_mm_srli_epi64(acc, 32), prime);
+      return _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+    }
+
+    SSE41 std::uint64_t sse_hash(const std::uint8_t *bgr0, int row_pitch, int width, int height) {
+      auto acc0 = _mm_loadu_si128((const __m128i *) initial);
+      auto acc1 = _mm_loadu_si128((const __m128i *) (initial + 2));
+      const auto secret0 = _mm_loadu_si128((const __m128i *) secret);
+      const auto secret1 = _mm_loadu_si128((const __m128i *) (secret + 2));
+      const auto scramble0 = _mm_loadu_si128((const __m128i *) scramble_key);
+      const auto scramble1 = _mm_loadu_si128((const __m128i *) (scramble_key + 2));
+      const auto step = _mm_set1_epi64x((long long) prime64_1);
+      const int stripes = width / 8;
+      const int tail = width % 8;
+
+      for (int y = 0; y < height; ++y) {
+        auto row = bgr0 + (std::ptrdiff_t) y * row_pitch;
+        auto key0 = secret0;
+        auto key1 = secret1;
+
+        for (int s = 0; s < stripes; ++s) {
+          sse_stripe(row + s * stripe_bytes, key0, key1, acc0, acc1);
+          key0 = _mm_add_epi64(key0, step);
+          key1 = _mm_add_epi64(key1, step);
+        }
+
+        if (tail) {
+          std::uint8_t padded[stripe_bytes];
+          pad_tail(row, stripes, tail, padded);
+          sse_stripe(padded, key0, key1, acc0, acc1);
+        }
+
+        acc0 = sse_scramble(acc0, scramble0);
+        acc1 = sse_scramble(acc1, scramble1);
+      }
+
+      std::uint64_t acc[4];
+      _mm_storeu_si128((__m128i *) acc, acc0);
+      _mm_storeu_si128((__m128i *) (acc + 2), acc1);
+      return finish(acc, width, height);
+    }
+
+    AVX2 inline void avx_stripe(const std::uint8_t *src, __m256i key, __m256i &acc) {
+      const auto mask = _mm256_set1_epi64x((long long) color_mask);
+
+      auto data = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) src), mask);
+      auto keyed = _mm256_xor_si256(data, key);
+
+      acc = _mm256_add_epi64(acc, _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+      acc = _mm256_add_epi64(acc, _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32)));
+    }
+
+    AVX2 std::uint64_t avx_hash(const std::uint8_t *bgr0, int row_pitch, int width, int height) {
+      auto acc = _mm256_loadu_si256((const __m256i *) initial);
+      const auto secrets = _mm256_loadu_si256((const __m256i *) secret);
+      const auto scramble = _mm256_loadu_si256((const __m256i *) scramble_key);
+      const auto step = _mm256_set1_epi64x((long long) prime64_1);
+      const auto prime = _mm256_set1_epi64x((long long) prime32_1);
+      const int stripes = width / 8;
+      const int tail = width % 8;
+
+      for (int y = 0; y < height; ++y) {
+        auto row = bgr0 + (std::ptrdiff_t) y * row_pitch;
+        auto key = secrets;
+
+        for (int s = 0; s < stripes; ++s) {
+          avx_stripe(row + s * stripe_bytes, key, acc);
+          key = _mm256_add_epi64(key, step);
+        }
+
+        if (tail) {
+          std::uint8_t padded[stripe_bytes];
+          pad_tail(row, stripes, tail, padded);
+          avx_stripe(padded, key, acc);
+        }
+
+        acc = _mm256_xor_si256(acc, _mm256_srli_epi64(acc, 47));
+        acc = _mm256_xor_si256(acc, scramble);
+        auto low = _mm256_mul_epu32(acc, prime);
+        auto high = _mm256_mul_epu32(_mm256_srli_epi64(acc, 32), prime);
+        acc = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+      }
+
+      std::uint64_t lanes[4];
+      _mm256_storeu_si256((__m256i *) lanes, acc);
+      return finish(lanes, width, height);
+    }
+
+  #undef SSE41
+  #undef AVX2
+#endif
+
+    using hash_f = std::uint64_t (*)(const std::uint8_t *bgr0, int row_pitch, int width, int height);
+
+    // NEON has no 64-bit lane multiply for the scramble, so ARM hashes with the portable code
+    hash_f hash_for(convert::isa_e isa) {
+      switch (isa) {
+#ifdef SUNSHINE_CHANGE_X86
+        case convert::isa_e::sse41:
+          return sse_hash;
+        case convert::isa_e::avx2:
+          return avx_hash;
+#endif
+        default:
+          return none_hash;
+      }
+    }
+  }  // namespace
+
+  std::uint64_t hash(const std::uint8_t *bgr0, int row_pitch, int width, int height, convert::isa_e isa) {
+    return hash_for(isa)(bgr0, row_pitch, width, height);
+  }
+
+  detector_t::detector_t(convert::isa_e isa):
+      isa {isa} {
+  }
+
+  int detector_t::compare(const std::uint8_t *bgr0, int row_pitch, int width, int height) {
+    if (width != this->width || height != this->height) {
+      this->width = width;
+      this->height = height;
+      tiles_x = (width + tile_size - 1) / tile_size;
+      tiles_y = (height + tile_size - 1) / tile_size;
+      current.resize(tile_count());
+      reference.clear();
+    }
+
+    auto hash_tile = hash_for(isa);
+    for (int ty = 0; ty < tiles_y; ++ty) {
+      auto rows = std::min(tile_size, height - ty * tile_size);
+      auto row = bgr0 + (std::ptrdiff_t) ty * tile_size * row_pitch;
+
+      for (int tx = 0; tx < tiles_x; ++tx) {
+        auto columns = std::min(tile_size, width - tx * tile_size);
+        current[ty * tiles_x + tx] = hash_tile(row + tx * tile_size * 4, row_pitch, columns, rows);
+      }
+    }
+
+    if (reference.size() != current.size()) {
+      return tile_count();
+    }
+
+    int changed = 0;
+    for (std::size_t x = 0; x < current.size(); ++x) {
+      changed += current[x] != reference[x];
+    }
+
+    return changed;
+  }
+
+  void detector_t::accept() {
+    reference = current;
+  }
+
+  void detector_t::reset() {
+    reference.clear();
+  }
+}  // namespace video::change
@@ -0,0 +1,81 @@
+/**
+ * @file src/video_change.h
+ * @brief Declarations for detecting captured images that didn't change.
+ */
+#pragma once
+
+// standard includes
+#include <cstdint>
+#include <vector>
+
+// local includes
+#include "video_convert.h"
+
+namespace video::change {
+  /**
+   * @brief Hash BGR0 pixels, ignoring the unused fourth byte.
+   * @details An xxh3-style hash, which is the same for every instruction set.
+   * @param bgr0 Top-left pixel.
+   * @param row_pitch Bytes between rows.
+   * @param width Width in pixels.
+   * @param height Height in pixels.
+   * @param isa Instruction set to use, which must be supported.
+   */
+  std::uint64_t hash(const std::uint8_t *bgr0, int row_pitch, int width, int height, convert::isa_e isa = convert::best_isa());
+
+  /**
+   * @brief Tells whether a BGR0 image differs from the last one accepted, by hashing it in tiles.
+   */
+  class detector_t {
+  public:
+    /**
+     * @param isa Instruction set to hash with, which must be supported.
+     */
+    explicit detector_t(convert::isa_e isa = convert::best_isa());
+
+    /**
+     * @brief Hash an image and compare it with the reference.
+     * @param bgr0 Top-left pixel.
+     * @param row_pitch Bytes between rows.
+     * @param width Width in pixels.
+     * @param height Height in pixels.
+     * @return The number of tiles that differ, or every tile without a reference of the same size.
+     */
+    int compare(const std::uint8_t *bgr0, int row_pitch, int width, int height);
+
+    /**
+     * @brief Make the image last compared the reference.
+     */
+    void accept();
+
+    /**
+     * @brief Forget the reference, so the next image compares as changed.
+     */
+    void reset();
+
+    /**
+     * @brief Width and height of the tiles that are hashed.
+     */
+    static constexpr int tile_size = 64;
+
+    int tile_count() const {
+      return tiles_x * tiles_y;
+    }
+
+    /**
+     * @return Hashes of the tiles of the image last compared, row by row.
+     */
+    const std::vector<std::uint64_t> &hashes() const {
+      return current;
+    }
+
+  private:
+    convert::isa_e isa;
+    int width = 0;
+    int height = 0;
+    int tiles_x = 0;
+    int tiles_y = 0;
+    std::vector<std::uint64_t> current;
+    std::vector<std::uint64_t> reference;
+  };
+}  // namespace video::change
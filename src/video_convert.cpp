@@ -0,0 +1,768 @@
+/**
+ * @file src/video_convert.cpp
+ * @brief Definitions for the unscaled BGR0 to YUV conversion used by the software encoder.
+ */
+// standard includes
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define SUNSHINE_CONVERT_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #include <arm_neon.h>
+  #define SUNSHINE_CONVERT_NEON
+#endif
+
+// local includes
+#include "video_convert.h"
+
+namespace video::convert {
+  namespace {
+    // Fractional bits of the fixed-point coefficients. Chroma of 4:2:0 is computed from the
+    // sum of four pixels, so it's scaled down by two more bits.
+    constexpr int precision = 13;
+
+    struct layout_t {
+      bool wide;  // 16-bit samples
+      bool subsampled;  // 4:2:0
+      bool interleaved;  // chroma in one plane, U first
+      int shift;  // left shift of 16-bit samples
+      int max;  // largest sample value
+    };
+
+    layout_t layout_of(format_e format) {
+      switch (format) {
+        case format_e::yuv420p:
+          return {false, true, false, 0, 255};
+        case format_e::yuv420p10:
+          return {true, true, false, 0, 1023};
+        case format_e::yuv444p:
+          return {false, false, false, 0, 255};
+        case format_e::yuv444p10:
+          return {true, false, false, 0, 1023};
+        case format_e::nv12:
+          return {false, true, true, 0, 255};
+        case format_e::p010:
+          return {true, true, true, 6, 1023};
+      }
+
+      return {};
+    }
+
+    coef_t fixed(const float (&row)[4]) {
+      // Input is 8-bit rather than UNORM
+      auto scale = (double) (1 << precision) / 255.0;
+      return {
+        (std::int16_t) std::lround(row[2] * scale),
+        (std::int16_t) std::lround(row[1] * scale),
+        (std::int16_t) std::lround(row[0] * scale),
+        (std::int32_t) std::lround(row[3] * (1 << precision)),
+      };
+    }
+
+    /**
+     * @brief What the row kernels need besides the rows themselves.
+     */
+    struct params_t {
+      coef_t u;
+      coef_t v;
+      int max;
+      int shift;
+    };
+
+    // The kernels return how many pixels (or chroma samples) they converted, and the
+    // scalar code below converts the rest. Chroma kernels write interleaved chroma to u
+    // when v is nullptr.
+    using luma8_f = int (*)(const std::uint8_t *src, int width, const coef_t &coef, std::uint8_t *dst);
+    using luma16_f = int (*)(const std::uint8_t *src, int width, const coef_t &coef, int max, int shift, std::uint16_t *dst);
+    using chroma8_f = int (*)(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint8_t *u, std::uint8_t *v);
+    using chroma16_f = int (*)(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint16_t *u, std::uint16_t *v);
+
+    struct kernels_t {
+      luma8_f luma8;
+      luma16_f luma16;
+      chroma8_f chroma8;
+      chroma16_f chroma16;
+    };
+
+    int dot(const coef_t &c, const std::uint8_t *pixel) {
+      return (pixel[0] * c.b + pixel[1] * c.g + pixel[2] * c.r + c.offset) >> precision;
+    }
+
+    int dot4(const coef_t &c, int b, int g, int r) {
+      return (b * c.b + g * c.g + r * c.r + (c.offset << 2)) >> (precision + 2);
+    }
+
+    template<class T>
+    void store(T *dst, int x, int value, int max, int shift) {
+      value = std::clamp(value, 0, max);
+      if constexpr (sizeof(T) == 1) {
+        dst[x] = (T) value;
+      } else {
+        dst[x] = (T) (value << shift);
+      }
+    }
+
+    template<class T>
+    void luma_tail(const std::uint8_t *src, int from, int width, const coef_t &coef, int max, int shift, T *dst) {
+      for (int x = from; x < width; ++x) {
+        store(dst, x, dot(coef, src + x * 4), max, shift);
+      }
+    }
+
+    template<class T>
+    void chroma_tail(const std::uint8_t *src0, const std::uint8_t *src1, int from, int width, const params_t &params, T *u, T *v) {
+      for (int c = from; c < (width + 1) / 2; ++c) {
+        // An odd last column pairs with itself
+        auto a = src0 + c * 8;
+        auto b = src1 + c * 8;
+        auto next = 2 * c + 1 < width ? 4 : 0;
+
+        int sum[3];
+        for (int ch = 0; ch < 3; ++ch) {
+          sum[ch] = a[ch] + a[next + ch] + b[ch] + b[next + ch];
+        }
+
+        auto cu = dot4(params.u, sum[0], sum[1], sum[2]);
+        auto cv = dot4(params.v, sum[0], sum[1], sum[2]);
+        if (v) {
+          store(u, c, cu, params.max, params.shift);
+          store(v, c, cv, params.max, params.shift);
+        } else {
+          store(u, 2 * c, cu, params.max, params.shift);
+          store(u, 2 * c + 1, cv, params.max, params.shift);
+        }
+      }
+    }
+
+    int none_luma8(const std::uint8_t *, int, const coef_t &, std::uint8_t *) {
+      return 0;
+    }
+
+    int none_luma16(const std::uint8_t *, int, const coef_t &, int, int, std::uint16_t *) {
+      return 0;
+    }
+
+    int none_chroma8(const std::uint8_t *, const std::uint8_t *, int, const params_t &, std::uint8_t *, std::uint8_t *) {
+      return 0;
+    }
+
+    int none_chroma16(const std::uint8_t *, const std::uint8_t *, int, const params_t &, std::uint16_t *, std::uint16_t *) {
+      return 0;
+    }
+
+#ifdef SUNSHINE_CONVERT_X86
+  #define SSE41 __attribute__((target("sse4.1")))
+  #define AVX2 __attribute__((target("avx2")))
+
+    // BGR0 pixels widened to 16 bits multiply-add against {b, g, r, 0} into two partial sums
+    // per pixel, which hadd puts together.
+
+    SSE41 __m128i sse_coef(const coef_t &c) {
+      return _mm_setr_epi16(c.b, c.g, c.r, 0, c.b, c.g, c.r, 0);
+    }
+
+    // Four pixels, each in 16-bit lanes, two per register
+    template<int shift>
+    SSE41 __m128i sse_dot(__m128i lo, __m128i hi, __m128i coef, __m128i offset) {
+      auto sum = _mm_hadd_epi32(_mm_madd_epi16(lo, coef), _mm_madd_epi16(hi, coef));
+      return _mm_srai_epi32(_mm_add_epi32(sum, offset), shift);
+    }
+
+    SSE41 __m128i sse_luma(const std::uint8_t *src, __m128i coef, __m128i offset) {
+      const auto zero = _mm_setzero_si128();
+      auto pixels = _mm_loadu_si128((const __m128i *) src);
+      return sse_dot<precision>(_mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero), coef, offset);
+    }
+
+    SSE41 int sse_luma8(const std::uint8_t *src, int width, const coef_t &c, std::uint8_t *dst) {
+      const auto coef = sse_coef(c);
+      const auto offset = _mm_set1_epi32(c.offset);
+
+      int x = 0;
+      for (; x + 16 <= width; x += 16) {
+        auto p0 = _mm_packs_epi32(sse_luma(src + x * 4, coef, offset), sse_luma(src + x * 4 + 16, coef, offset));
+        auto p1 = _mm_packs_epi32(sse_luma(src + x * 4 + 32, coef, offset), sse_luma(src + x * 4 + 48, coef, offset));
+        _mm_storeu_si128((__m128i *) (dst + x), _mm_packus_epi16(p0, p1));
+      }
+
+      return x;
+    }
+
+    SSE41 int sse_luma16(const std::uint8_t *src, int width, const coef_t &c, int max, int shift, std::uint16_t *dst) {
+      const auto coef = sse_coef(c);
+      const auto offset = _mm_set1_epi32(c.offset);
+      const auto limit = _mm_set1_epi16((short) max);
+      const auto count = _mm_cvtsi32_si128(shift);
+
+      int x = 0;
+      for (; x + 8 <= width; x += 8) {
+        auto p = _mm_packus_epi32(sse_luma(src + x * 4, coef, offset), sse_luma(src + x * 4 + 16, coef, offset));
+        _mm_storeu_si128((__m128i *) (dst + x), _mm_sll_epi16(_mm_min_epu16(p, limit), count));
+      }
+
+      return x;
+    }
+
+    // Sums of the 2x2 blocks under four pixels of two rows, as two blocks in 16-bit lanes
+    SSE41 __m128i sse_blocks(const std::uint8_t *src0, const std::uint8_t *src1) {
+      const auto zero = _mm_setzero_si128();
+      auto a = _mm_loadu_si128((const __m128i *) src0);
+      auto b = _mm_loadu_si128((const __m128i *) src1);
+      auto lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+      auto hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+      return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+    }
+
+    // Eight chroma samples of each plane from sixteen pixels of two rows
+    SSE41 void sse_chroma(const std::uint8_t *src0, const std::uint8_t *src1, const params_t &params, __m128i (&u)[2], __m128i (&v)[2]) {
+      const auto coef_u = sse_coef(params.u);
+      const auto coef_v = sse_coef(params.v);
+      const auto offset_u = _mm_set1_epi32(params.u.offset << 2);
+      const auto offset_v = _mm_set1_epi32(params.v.offset << 2);
+
+      for (int half = 0; half < 2; ++half) {
+        auto b0 = sse_blocks(src0 + half * 32, src1 + half * 32);
+        auto b1 = sse_blocks(src0 + half * 32 + 16, src1 + half * 32 + 16);
+        u[half] = sse_dot<precision + 2>(b0, b1, coef_u, offset_u);
+        v[half] = sse_dot<precision + 2>(b0, b1, coef_v, offset_v);
+      }
+    }
+
+    SSE41 int sse_chroma8(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint8_t *u, std::uint8_t *v) {
+      int c = 0;
+      for (; c + 8 <= pairs; c += 8) {
+        __m128i cu[2], cv[2];
+        sse_chroma(src0 + c * 8, src1 + c * 8, params, cu, cv);
+
+        auto u16 = _mm_packs_epi32(cu[0], cu[1]);
+        auto v16 = _mm_packs_epi32(cv[0], cv[1]);
+        if (v) {
+          auto uv = _mm_packus_epi16(u16, v16);
+          _mm_storel_epi64((__m128i *) (u + c), uv);
+          _mm_storel_epi64((__m128i *) (v + c), _mm_srli_si128(uv, 8));
+        } else {
+          auto uv = _mm_packus_epi16(_mm_unpacklo_epi16(u16, v16), _mm_unpackhi_epi16(u16, v16));
+          _mm_storeu_si128((__m128i *) (u + c * 2), uv);
+        }
+      }
+
+      return c;
+    }
+
+    SSE41 int sse_chroma16(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint16_t *u, std::uint16_t *v) {
+      const auto limit = _mm_set1_epi16((short) params.max);
+      const auto count = _mm_cvtsi32_si128(params.shift);
+
+      int c = 0;
+      for (; c + 8 <= pairs; c += 8) {
+        __m128i cu[2], cv[2];
+        sse_chroma(src0 + c * 8, src1 + c * 8, params, cu, cv);
+
+        auto u16 = _mm_sll_epi16(_mm_min_epu16(_mm_packus_epi32(cu[0], cu[1]), limit), count);
+        auto v16 = _mm_sll_epi16(_mm_min_epu16(_mm_packus_epi32(cv[0], cv[1]), limit), count);
+        if (v) {
+          _mm_storeu_si128((__m128i *) (u + c), u16);
+          _mm_storeu_si128((__m128i *) (v + c), v16);
+        } else {
+          _mm_storeu_si128((__m128i *) (u + c * 2), _mm_unpacklo_epi16(u16, v16));
+          _mm_storeu_si128((__m128i *) (u + c * 2 + 8), _mm_unpackhi_epi16(u16, v16));
+        }
+      }
+
+      return c;
+    }
+
+    // The 256-bit unpacks work within 128-bit lanes, so eight pixels come out as
+    // {p0 p1 | p4 p5} and {p2 p3 | p6 p7}, and hadd puts them back in order.
+
+    AVX2 __m256i avx_coef(const coef_t &c) {
+      return _mm256_setr_epi16(c.b, c.g, c.r, 0, c.b, c.g, c.r, 0, c.b, c.g, c.r, 0, c.b, c.g, c.r, 0);
+    }
+
+    template<int shift>
+    AVX2 __m256i avx_dot(__m256i lo, __m256i hi, __m256i coef, __m256i offset) {
+      auto sum = _mm256_hadd_epi32(_mm256_madd_epi16(lo, coef), _mm256_madd_epi16(hi, coef));
+      return _mm256_srai_epi32(_mm256_add_epi32(sum, offset), shift);
+    }
+
+    AVX2 __m256i avx_luma(const std::uint8_t *src, __m256i coef, __m256i offset) {
+      const auto zero = _mm256_setzero_si256();
+      auto pixels = _mm256_loadu_si256((const __m256i *) src);
+      return avx_dot<precision>(_mm256_unpacklo_epi8(pixels, zero), _mm256_unpackhi_epi8(pixels, zero), coef, offset);
+    }
+
+    AVX2 int avx_luma8(const std::uint8_t *src, int width, const coef_t &c, std::uint8_t *dst) {
+      const auto coef = avx_coef(c);
+      const auto offset = _mm256_set1_epi32(c.offset);
+
+      // Packing interleaves the lanes as {p0-3 p8-11 p16-19 p24-27 | p4-7 ...}
+      const auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+      int x = 0;
+      for (; x + 32 <= width; x += 32) {
+        auto p0 = _mm256_packs_epi32(avx_luma(src + x * 4, coef, offset), avx_luma(src + x * 4 + 32, coef, offset));
+        auto p1 = _mm256_packs_epi32(avx_luma(src + x * 4 + 64, coef, offset), avx_luma(src + x * 4 + 96, coef, offset));
+        auto packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(p0, p1), order);
+        _mm256_storeu_si256((__m256i *) (dst + x), packed);
+      }
+
+      return x;
+    }
+
+    AVX2 int avx_luma16(const std::uint8_t *src, int width, const coef_t &c, int max, int shift, std::uint16_t *dst) {
+      const auto coef = avx_coef(c);
+      const auto offset = _mm256_set1_epi32(c.offset);
+      const auto limit = _mm256_set1_epi16((short) max);
+      const auto count = _mm_cvtsi32_si128(shift);
+
+      int x = 0;
+      for (; x + 16 <= width; x += 16) {
+        auto p = _mm256_packus_epi32(avx_luma(src + x * 4, coef, offset), avx_luma(src + x * 4 + 32, coef, offset));
+        p = _mm256_permute4x64_epi64(_mm256_min_epu16(p, limit), 0xD8);
+        _mm256_storeu_si256((__m256i *) (dst + x), _mm256_sll_epi16(p, count));
+      }
+
+      return x;
+    }
+
+    // Sums of the 2x2 blocks under eight pixels of two rows, as {b0 b1 | b2 b3}
+    AVX2 __m256i avx_blocks(const std::uint8_t *src0, const std::uint8_t *src1) {
+      const auto zero = _mm256_setzero_si256();
+      auto a = _mm256_loadu_si256((const __m256i *) src0);
+      auto b = _mm256_loadu_si256((const __m256i *) src1);
+      auto lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+      auto hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+      return _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+    }
+
+    // Eight chroma samples of each plane from sixteen pixels of two rows
+    AVX2 void avx_chroma(const std::uint8_t *src0, const std::uint8_t *src1, const params_t &params, __m256i &u, __m256i &v) {
+      const auto coef_u = avx_coef(params.u);
+      const auto coef_v = avx_coef(params.v);
+      const auto offset_u = _mm256_set1_epi32(params.u.offset << 2);
+      const auto offset_v = _mm256_set1_epi32(params.v.offset << 2);
+
+      // The dot product comes out as {c0 c1 c4 c5 | c2 c3 c6 c7}
+      const auto order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+
+      auto b0 = avx_blocks(src0, src1);
+      auto b1 = avx_blocks(src0 + 32, src1 + 32);
+      u = _mm256_permutevar8x32_epi32(avx_dot<precision + 2>(b0, b1, coef_u, offset_u), order);
+      v = _mm256_permutevar8x32_epi32(avx_dot<precision + 2>(b0, b1, coef_v, offset_v), order);
+    }
+
+    AVX2 int avx_chroma8(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint8_t *u, std::uint8_t *v) {
+      // {u0-3 v0-3 | u4-7 v4-7} in 16 bits to u0 v0 u1 v1 ... within each lane
+      const auto interleave = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+      const auto planar = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+      int c = 0;
+      for (; c + 8 <= pairs; c += 8) {
+        __m256i cu, cv;
+        avx_chroma(src0 + c * 8, src1 + c * 8, params, cu, cv);
+
+        auto uv16 = _mm256_packs_epi32(cu, cv);
+        if (v) {
+          auto uv = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_packus_epi16(uv16, uv16), planar));
+          _mm_storel_epi64((__m128i *) (u + c), uv);
+          _mm_storel_epi64((__m128i *) (v + c), _mm_srli_si128(uv, 8));
+        } else {
+          auto uv = _mm256_packus_epi16(_mm256_shuffle_epi8(uv16, interleave), uv16);
+          _mm_storeu_si128((__m128i *) (u + c * 2), _mm256_castsi256_si128(_mm256_permute4x64_epi64(uv, 0x08)));
+        }
+      }
+
+      return c;
+    }
+
+    AVX2 int avx_chroma16(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint16_t *u, std::uint16_t *v) {
+      const auto interleave = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+      const auto limit = _mm256_set1_epi16((short) params.max);
+      const auto count = _mm_cvtsi32_si128(params.shift);
+
+      int c = 0;
+      for (; c + 8 <= pairs; c += 8) {
+        __m256i cu, cv;
+        avx_chroma(src0 + c * 8, src1 + c * 8, params, cu, cv);
+
+        // {u0-3 v0-3 | u4-7 v4-7}
+        auto uv = _mm256_sll_epi16(_mm256_min_epu16(_mm256_packus_epi32(cu, cv), limit), count);
+        if (v) {
+          uv = _mm256_permute4x64_epi64(uv, 0xD8);
+          _mm_storeu_si128((__m128i *) (u + c), _mm256_castsi256_si128(uv));
+          _mm_storeu_si128((__m128i *) (v + c), _mm256_extracti128_si256(uv, 1));
+        } else {
+          _mm256_storeu_si256((__m256i *) (u + c * 2), _mm256_shuffle_epi8(uv, interleave));
+        }
+      }
+
+      return c;
+    }
+
+  #undef SSE41
+  #undef AVX2
+#endif
+
+#ifdef SUNSHINE_CONVERT_NEON
+    // vld4 splits BGR0 into channels, so eight pixels are dot products of whole registers
+
+    int32x4_t neon_dot(int16x4_t b, int16x4_t g, int16x4_t r, const coef_t &c, int32x4_t offset) {
+      auto sum = vmlal_n_s16(offset, b, c.b);
+      sum = vmlal_n_s16(sum, g, c.g);
+      return vmlal_n_s16(sum, r, c.r);
+    }
+
+    // Eight samples saturated to 16 bits
+    template<int shift>
+    uint16x8_t neon_dot8(uint16x8_t b, uint16x8_t g, uint16x8_t r, const coef_t &c, int32x4_t offset) {
+      auto sb = vreinterpretq_s16_u16(b);
+      auto sg = vreinterpretq_s16_u16(g);
+      auto sr = vreinterpretq_s16_u16(r);
+      auto lo = vshrq_n_s32(neon_dot(vget_low_s16(sb), vget_low_s16(sg), vget_low_s16(sr), c, offset), shift);
+      auto hi = vshrq_n_s32(neon_dot(vget_high_s16(sb), vget_high_s16(sg), vget_high_s16(sr), c, offset), shift);
+      return vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi));
+    }
+
+    uint16x8_t neon_luma(const std::uint8_t *src, const coef_t &c, int32x4_t offset) {
+      auto pixels = vld4_u8(src);
+      return neon_dot8<precision>(vmovl_u8(pixels.val[0]), vmovl_u8(pixels.val[1]), vmovl_u8(pixels.val[2]), c, offset);
+    }
+
+    int neon_luma8(const std::uint8_t *src, int width, const coef_t &c, std::uint8_t *dst) {
+      const auto offset = vdupq_n_s32(c.offset);
+
+      int x = 0;
+      for (; x + 8 <= width; x += 8) {
+        vst1_u8(dst + x, vqmovn_u16(neon_luma(src + x * 4, c, offset)));
+      }
+
+      return x;
+    }
+
+    int neon_luma16(const std::uint8_t *src, int width, const coef_t &c, int max, int shift, std::uint16_t *dst) {
+      const auto offset = vdupq_n_s32(c.offset);
+      const auto limit = vdupq_n_u16((std::uint16_t) max);
+      const auto count = vdupq_n_s16((std::int16_t) shift);
+
+      int x = 0;
+      for (; x + 8 <= width; x += 8) {
+        vst1q_u16(dst + x, vshlq_u16(vminq_u16(neon_luma(src + x * 4, c, offset), limit), count));
+      }
+
+      return x;
+    }
+
+    // Eight chroma samples of each plane from sixteen pixels of two rows
+    void neon_chroma(const std::uint8_t *src0, const std::uint8_t *src1, const params_t &params, uint16x8_t &u, uint16x8_t &v) {
+      auto a = vld4q_u8(src0);
+      auto b = vld4q_u8(src1);
+
+      // Pairwise sums across each row, accumulated over both
+      auto sb = vpadalq_u8(vpaddlq_u8(a.val[0]), b.val[0]);
+      auto sg = vpadalq_u8(vpaddlq_u8(a.val[1]), b.val[1]);
+      auto sr = vpadalq_u8(vpaddlq_u8(a.val[2]), b.val[2]);
+
+      u = neon_dot8<precision + 2>(sb, sg, sr, params.u, vdupq_n_s32(params.u.offset << 2));
+      v = neon_dot8<precision + 2>(sb, sg, sr, params.v, vdupq_n_s32(params.v.offset << 2));
+    }
+
+    int neon_chroma8(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint8_t *u, std::uint8_t *v) {
+      int c = 0;
+      for (; c + 8 <= pairs; c += 8) {
+        uint16x8_t cu, cv;
+        neon_chroma(src0 + c * 8, src1 + c * 8, params, cu, cv);
+
+        if (v) {
+          vst1_u8(u + c, vqmovn_u16(cu));
+          vst1_u8(v + c, vqmovn_u16(cv));
+        } else {
+          vst2_u8(u + c * 2, uint8x8x2_t {{vqmovn_u16(cu), vqmovn_u16(cv)}});
+        }
+      }
+
+      return c;
+    }
+
+    int neon_chroma16(const std::uint8_t *src0, const std::uint8_t *src1, int pairs, const params_t &params, std::uint16_t *u, std::uint16_t *v) {
+      const auto limit = vdupq_n_u16((std::uint16_t) params.max);
+      const auto count = vdupq_n_s16((std::int16_t) params.shift);
+
+      int c = 0;
+      for (; c + 8 <= pairs; c += 8) {
+        uint16x8_t cu, cv;
+        neon_chroma(src0 + c * 8, src1 + c * 8, params, cu, cv);
+
+        cu = vshlq_u16(vminq_u16(cu, limit), count);
+        cv = vshlq_u16(vminq_u16(cv, limit), count);
+        if (v) {
+          vst1q_u16(u + c, cu);
+          vst1q_u16(v + c, cv);
+        } else {
+          vst2q_u16(u + c * 2, uint16x8x2_t {{cu, cv}});
+        }
+      }
+
+      return c;
+    }
+#endif
+
+    kernels_t kernels_for(isa_e isa) {
+      switch (isa) {
+#ifdef SUNSHINE_CONVERT_X86
+        case isa_e::sse41:
+          return {sse_luma8, sse_luma16, sse_chroma8, sse_chroma16};
+        case isa_e::avx2:
+          return {avx_luma8, avx_luma16, avx_chroma8, avx_chroma16};
+#endif
+#ifdef SUNSHINE_CONVERT_NEON
+        case isa_e::neon:
+          return {neon_luma8, neon_luma16, neon_chroma8, neon_chroma16};
+#endif
+        default:
+          return {none_luma8, none_luma16, none_chroma8, none_chroma16};
+      }
+    }
+  }  // namespace
+
+  bool isa_supported(isa_e isa) {
+    switch (isa) {
+      case isa_e::scalar:
+        return true;
+#ifdef SUNSHINE_CONVERT_X86
+      case isa_e::sse41:
+        return __builtin_cpu_supports("sse4.1");
+      case isa_e::avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef SUNSHINE_CONVERT_NEON
+      case isa_e::neon:
+        return true;
+#endif
+      default:
+        return false;
+    }
+  }
+
+  isa_e best_isa() {
+    for (auto isa : {isa_e::avx2, isa_e::sse41, isa_e::neon}) {
+      if (isa_supported(isa)) {
+        return isa;
+      }
+    }
+
+    return isa_e::scalar;
+  }
+
+  const char *isa_name(isa_e isa) {
+    switch (isa) {
+      case isa_e::scalar:
+        return "scalar";
+      case isa_e::sse41:
+        return "SSE4.1";
+      case isa_e::avx2:
+        return "AVX2";
+      case isa_e::neon:
+        return "NEON";
+    }
+
+    return "unknown";
+  }
+
+  converter_t::converter_t(format_e format, int width, int height, const matrix_t &matrix, int threads, isa_e isa):
+      format {format},
+      width {width},
+      height {height},
+      _isa {isa},
+      y {fixed(matrix.y)},
+      u {fixed(matrix.u)},
+      v {fixed(matrix.v)} {
+    // Bands of at least 16 rows, so small images don't wake threads for nothing
+    auto pairs = (height + 1) / 2;
+    auto bands = std::clamp(std::min(threads, pairs / 8), 1, 64);
+
+    band_rows.resize(bands + 1);
+    for (int band = 0; band <= bands; ++band) {
+      band_rows[band] = std::min(pairs * band / bands * 2, height);
+    }
+
+    tiles_x = (width + tile_size - 1) / tile_size;
+    tiles_y = (height + tile_size - 1) / tile_size;
+    dirty.resize((std::size_t) tiles_x * tiles_y);
+    spans.reserve(dirty.size());
+    span_index.resize(tiles_y + 1);
+
+    for (int band = 1; band < bands; ++band) {
+      workers.emplace_back(&converter_t::worker_main, this, band);
+    }
+  }
+
+  converter_t::~converter_t() {
+    stopping.store(true, std::memory_order_release);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  void converter_t::convert(const std::uint8_t *bgr0, int row_pitch, const image_t &out) {
+    job_bgr0 = bgr0;
+    job_row_pitch = row_pitch;
+    job_out = out;
+
+    spans.clear();
+    for (int row = 0; row < tiles_y; ++row) {
+      span_index[row] = row;
+      spans.push_back({0, width});
+    }
+    span_index[tiles_y] = tiles_y;
+
+    run(true);
+  }
+
+  int converter_t::convert(const std::uint8_t *bgr0, int row_pitch, const image_t &out, const std::vector<rect_t> &damage) {
+    std::fill(dirty.begin(), dirty.end(), 0);
+    for (const auto &rect : damage) {
+      auto x0 = std::clamp(rect.x, 0, width);
+      auto y0 = std::clamp(rect.y, 0, height);
+      auto x1 = std::clamp(rect.x + rect.width, 0, width);
+      auto y1 = std::clamp(rect.y + rect.height, 0, height);
+      if (x0 >= x1 || y0 >= y1) {
+        continue;
+      }
+
+      for (auto row = y0 / tile_size; row <= (y1 - 1) / tile_size; ++row) {
+        std::fill_n(dirty.begin() + row * tiles_x + x0 / tile_size, (x1 - 1) / tile_size - x0 / tile_size + 1, 1);
+      }
+    }
+
+    // Neighbouring dirty tiles are converted together
+    int tiles = 0;
+    spans.clear();
+    for (int row = 0; row < tiles_y; ++row) {
+      span_index[row] = (int) spans.size();
+
+      auto flags = dirty.data() + row * tiles_x;
+      for (int column = 0; column < tiles_x;) {
+        if (!flags[column]) {
+          ++column;
+          continue;
+        }
+
+        auto begin = column;
+        while (column < tiles_x && flags[column]) {
+          ++column;
+        }
+
+        tiles += column - begin;
+        spans.push_back({begin * tile_size, std::min(column * tile_size, width)});
+      }
+    }
+    span_index[tiles_y] = (int) spans.size();
+
+    if (!tiles) {
+      return 0;
+    }
+
+    job_bgr0 = bgr0;
+    job_row_pitch = row_pitch;
+    job_out = out;
+
+    // A few tiles aren't worth waking the workers for
+    run(tiles >= 32);
+
+    return tiles;
+  }
+
+  void converter_t::run(bool parallel) {
+    if (!parallel || workers.empty()) {
+      for (int band = 0; band + 1 < (int) band_rows.size(); ++band) {
+        convert_band(band);
+      }
+      return;
+    }
+
+    pending.store((int) workers.size(), std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    convert_band(0);
+
+    for (auto remaining = pending.load(std::memory_order_acquire); remaining; remaining = pending.load(std::memory_order_acquire)) {
+      pending.wait(remaining, std::memory_order_acquire);
+    }
+  }
+
+  void converter_t::worker_main(int band) {
+    std::uint32_t seen = 0;
+    while (true) {
+      generation.wait(seen, std::memory_order_acquire);
+      seen = generation.load(std::memory_order_acquire);
+      if (stopping.load(std::memory_order_acquire)) {
+        return;
+      }
+
+      convert_band(band);
+
+      if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        pending.notify_one();
+      }
+    }
+  }
+
+  void converter_t::convert_band(int band) {
+    const auto layout = layout_of(format);
+    const auto kernels = kernels_for(_isa);
+    const params_t params {u, v, layout.max, layout.shift};
+    const auto &out = job_out;
+
+    const int sample = layout.wide ? 2 : 1;
+
+    for (int row = band_rows[band]; row < band_rows[band + 1]; ++row) {
+      auto tile_row = row / tile_size;
+      for (auto span = span_index[tile_row]; span < span_index[tile_row + 1]; ++span) {
+        // Spans start on an even column, so 4:2:0 chroma isn't split either
+        auto x = spans[span].begin;
+        auto count = spans[span].end - x;
+        auto src = job_bgr0 + (std::ptrdiff_t) row * job_row_pitch + x * 4;
+
+        auto luma = [&](const coef_t &coef, int plane, int line) {
+          auto dst = out.data[plane] + (std::ptrdiff_t) line * out.linesize[plane] + x * sample;
+          if (layout.wide) {
+            auto wide = (std::uint16_t *) dst;
+            luma_tail(src, kernels.luma16(src, count, coef, layout.max, layout.shift, wide), count, coef, layout.max, layout.shift, wide);
+          } else {
+            luma_tail(src, kernels.luma8(src, count, coef, dst), count, coef, layout.max, layout.shift, dst);
+          }
+        };
+
+        luma(y, 0, row);
+
+        if (!layout.subsampled) {
+          luma(u, 1, row);
+          luma(v, 2, row);
+          continue;
+        }
+
+        if (row % 2) {
+          continue;
+        }
+
+        // An odd last row pairs with itself
+        auto next = row + 1 < height ? src + job_row_pitch : src;
+        auto line = row / 2;
+        auto dst_u = out.data[1] + (std::ptrdiff_t) line * out.linesize[1] + x / 2 * (layout.interleaved ? 2 : 1) * sample;
+        auto dst_v = layout.interleaved ? nullptr : out.data[2] + (std::ptrdiff_t) line * out.linesize[2] + x / 2 * sample;
+        if (layout.wide) {
+          auto wide_u = (std::uint16_t *) dst_u;
+          auto wide_v = (std::uint16_t *) dst_v;
+          chroma_tail(src, next, kernels.chroma16(src, next, count / 2, params, wide_u, wide_v), count, params, wide_u, wide_v);
+        } else {
+          chroma_tail(src, next, kernels.chroma8(src, next, count / 2, params, dst_u, dst_v), count, params, dst_u, dst_v);
+        }
+      }
+    }
+  }
+}  // namespace video::convert
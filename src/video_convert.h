@@ -0,0 +1,177 @@
+/**
+ * @file src/video_convert.h
+ * @brief Declarations for the unscaled BGR0 to YUV conversion used by the software encoder.
+ */
+#pragma once
+
+// standard includes
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace video::convert {
+  enum class format_e {
+    yuv420p,  ///< 8-bit planar 4:2:0
+    yuv420p10,  ///< 10-bit planar 4:2:0, in the low bits of 16-bit samples
+    yuv444p,  ///< 8-bit planar 4:4:4
+    yuv444p10,  ///< 10-bit planar 4:4:4, in the low bits of 16-bit samples
+    nv12,  ///< 8-bit 4:2:0 with interleaved chroma
+    p010,  ///< 10-bit 4:2:0 with interleaved chroma, in the high bits of 16-bit samples
+  };
+
+  enum class isa_e {
+    scalar,  ///< Portable C++
+    sse41,  ///< SSE4.1
+    avx2,  ///< AVX2
+    neon,  ///< NEON
+  };
+
+  /**
+   * @return The fastest instruction set this CPU supports.
+   */
+  isa_e best_isa();
+
+  /**
+   * @return Whether this build and CPU can convert with the instruction set.
+   */
+  bool isa_supported(isa_e isa);
+
+  const char *isa_name(isa_e isa);
+
+  /**
+   * @brief Rows of RGB to YUV coefficients: red, green, blue and an offset.
+   * @details These are color_t vectors from color_vectors_from_colorspace() with UINT output,
+   *          which take UNORM RGB and already add 0.5 for rounding.
+   */
+  struct matrix_t {
+    float y[4];
+    float u[4];
+    float v[4];
+  };
+
+  /**
+   * @brief One row of a matrix_t in fixed point, for 8-bit BGR input.
+   */
+  struct coef_t {
+    std::int16_t b;
+    std::int16_t g;
+    std::int16_t r;
+    std::int32_t offset;
+  };
+
+  struct image_t {
+    std::uint8_t *data[3];
+    int linesize[3];
+  };
+
+  /**
+   * @brief A region of the input that changed, in pixels.
+   */
+  struct rect_t {
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+
+  /**
+   * @brief Converts BGR0 images to YUV of the same size in horizontal bands across threads.
+   * @details The matrix is applied in 13-bit fixed point, and 4:2:0 chroma is the average of
+   *          each 2x2 block. Every instruction set produces exactly the same samples.
+   */
+  class converter_t {
+  public:
+    /**
+     * @param format The output format.
+     * @param width Width of the input and output images.
+     * @param height Height of the input and output images.
+     * @param matrix Coefficients for the output bit depth and range.
+     * @param threads Threads to convert on, including the caller's.
+     * @param isa Instruction set to use, which must be supported.
+     */
+    converter_t(format_e format, int width, int height, const matrix_t &matrix, int threads, isa_e isa = best_isa());
+    ~converter_t();
+
+    converter_t(const converter_t &) = delete;
+    converter_t &operator=(const converter_t &) = delete;
+
+    /**
+     * @brief Convert one image. Must always be called from the same thread.
+     * @param bgr0 Top-left pixel of the input.
+     * @param row_pitch Bytes between rows of the input.
+     * @param out Planes of the output.
+     */
+    void convert(const std::uint8_t *bgr0, int row_pitch, const image_t &out);
+
+    /**
+     * @brief Convert only the tiles of an image that damaged rectangles touch.
+     * @details The rest of the output is left alone, so it must still hold the previous image.
+     *          Rectangles are clipped to the image, and may overlap.
+     * @param bgr0 Top-left pixel of the input.
+     * @param row_pitch Bytes between rows of the input.
+     * @param out Planes of the output.
+     * @param damage Regions that changed since the previous image.
+     * @return The number of tiles converted.
+     */
+    int convert(const std::uint8_t *bgr0, int row_pitch, const image_t &out, const std::vector<rect_t> &damage);
+
+    int threads() const {
+      return static_cast<int>(workers.size()) + 1;
+    }
+
+    isa_e isa() const {
+      return _isa;
+    }
+
+    /**
+     * @brief Width and height of the tiles that damage is rounded out to.
+     */
+    static constexpr int tile_size = 64;
+
+    int tile_count() const {
+      return tiles_x * tiles_y;
+    }
+
+  private:
+    /**
+     * @brief Columns [begin, end) of a row of tiles to convert.
+     */
+    struct span_t {
+      int begin;
+      int end;
+    };
+
+    void run(bool parallel);
+    void convert_band(int band);
+    void worker_main(int band);
+
+    format_e format;
+    int width;
+    int height;
+    isa_e _isa;
+    coef_t y;
+    coef_t u;
+    coef_t v;
+
+    // Each band is an even number of rows, so no 4:2:0 chroma row is split
+    std::vector<int> band_rows;
+
+    int tiles_x;
+    int tiles_y;
+    std::vector<std::uint8_t> dirty;
+
+    // The spans of tile row t are spans[span_index[t]] up to spans[span_index[t + 1]]
+    std::vector<span_t> spans;
+    std::vector<int> span_index;
+
+    std::vector<std::thread> workers;
+    const std::uint8_t *job_bgr0 = nullptr;
+    int job_row_pitch = 0;
+    image_t job_out {};
+    std::atomic<std::uint32_t> generation {0};
+    std::atomic<int> pending {0};
+    std::atomic<bool> stopping {false};
+  };
+}  // namespace video::convert
@@ -0,0 +1,79 @@
+/**
+ * @file src/video_pacing.cpp
+ * @brief Rate control schedule for paced video sends.
+ */
+#include "video_pacing.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace stream {
+  using namespace std::literals;
+
+  namespace {
+    // Weight of the newest frame in the average frame size
+    constexpr double AVERAGE_WEIGHT = 1.0 / 8;
+
+    // Frames repaying a backlog still spread over at least this share of their budget
+    constexpr int MIN_SPREAD_DIVISOR = 4;
+  }  // namespace
+
+  std::size_t pacing_packets_per_ms(std::size_t pacing_bps, std::size_t blocksize) {
+    if (blocksize == 0) {
+      return 1;
+    }
+
+    //                      bps    ms    packet      byte
+    auto packets_per_ms = pacing_bps / 1000 / blocksize / 8;
+
+    // Floor at one packet/ms so the pacing loop never divides by zero
+    // and we still send something on absurdly low bitrate caps.
+    return packets_per_ms ? packets_per_ms : 1;
+  }
+
+  std::chrono::steady_clock::time_point pacing_due(std::chrono::steady_clock::time_point frame_start, std::size_t packets_sent, std::size_t packets_per_ms) {
+    return frame_start + std::chrono::duration_cast<std::chrono::nanoseconds>(1ms) * packets_sent / packets_per_ms;
+  }
+
+  std::chrono::steady_clock::time_point pacing_due(std::chrono::steady_clock::time_point frame_start, std::size_t packets_sent, std::size_t frame_packets, std::chrono::nanoseconds spread) {
+    if (frame_packets == 0) {
+      return frame_start;
+    }
+    return frame_start + spread * packets_sent / frame_packets;
+  }
+
+  frame_pacer_t::frame_pacer_t(int fps, int budget_percent):
+      interval_ {std::chrono::nanoseconds {1s} / std::max(fps, 1)},
+      budget_ {std::chrono::nanoseconds {1s} * std::clamp(budget_percent, 1, 100) / (100 * std::max(fps, 1))} {
+  }
+
+  std::chrono::nanoseconds frame_pacer_t::plan(std::size_t frame_packets, bool idr, std::chrono::nanoseconds backlog, std::size_t max_packets_per_ms) {
+    auto spread = budget_;
+
+    if (idr) {
+      // Spread a key frame at the rate of the frames around it, within the borrowing limit
+      const auto limit = budget_ + interval_ * MAX_BORROW_FRAMES;
+      if (average_packets_ > 0) {
+        auto scaled = std::chrono::duration_cast<std::chrono::nanoseconds>(budget_ * (frame_packets / average_packets_));
+        spread = std::clamp(scaled, budget_, limit);
+      } else {
+        spread = limit;
+      }
+    } else if (average_packets_ > 0) {
+      average_packets_ += (frame_packets - average_packets_) * AVERAGE_WEIGHT;
+    } else {
+      average_packets_ = (double) frame_packets;
+    }
+
+    // Frames that queued behind a borrowing frame give the time back
+    spread = std::max(spread - std::max(backlog, 0ns), budget_ / MIN_SPREAD_DIVISOR);
+
+    // Never faster than the rate cap
+    auto shortest = std::chrono::nanoseconds {1ms} * (std::int64_t) frame_packets / (std::int64_t) std::max<std::size_t>(max_packets_per_ms, 1);
+    return std::max(spread, shortest);
+  }
+
+  std::chrono::nanoseconds frame_pacer_t::budget() const {
+    return budget_;
+  }
+}  // namespace stream
@@ -0,0 +1,75 @@
+/**
+ * @file src/video_pacing.h
+ * @brief Rate control schedule for paced video sends.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace stream {
+  /**
+   * @brief Packets the pacer releases per millisecond.
+   * @param pacing_bps The pacing rate in bits per second.
+   * @param blocksize The size of each packet in bytes.
+   * @return The packet budget per millisecond, never less than one.
+   */
+  std::size_t pacing_packets_per_ms(std::size_t pacing_bps, std::size_t blocksize);
+
+  /**
+   * @brief Time at which a packet may leave so a frame goes out at the pacing rate.
+   * @param frame_start When the first packet of the frame may leave.
+   * @param packets_sent Packets of the frame sent before this one.
+   * @param packets_per_ms The budget from pacing_packets_per_ms().
+   */
+  std::chrono::steady_clock::time_point pacing_due(std::chrono::steady_clock::time_point frame_start, std::size_t packets_sent, std::size_t packets_per_ms);
+
+  /**
+   * @brief Time at which a packet may leave so a frame is spread evenly over `spread`.
+   * @param frame_start When the first packet of the frame may leave.
+   * @param packets_sent Packets of the frame sent before this one.
+   * @param frame_packets Packets in the whole frame.
+   * @param spread Time the frame's packets are spread over, from frame_pacer_t::plan().
+   */
+  std::chrono::steady_clock::time_point pacing_due(std::chrono::steady_clock::time_point frame_start, std::size_t packets_sent, std::size_t frame_packets, std::chrono::nanoseconds spread);
+
+  /**
+   * @brief Spreads each frame of a session over a share of its frame interval.
+   * @details Rate pacing sends every frame at one fixed rate, so large frames still leave as
+   *          bursts and small ones leave the link idle for most of the interval. This pacer
+   *          sizes the spread to the frame instead. Key frames, which are many times larger
+   *          than the frames around them, may borrow up to MAX_BORROW_FRAMES further intervals;
+   *          the frames queued behind them repay the backlog by using less of their own budget.
+   *          Used only from the session's broadcast thread.
+   */
+  class frame_pacer_t {
+  public:
+    // Frame intervals a key frame may spread over beyond its own budget
+    static constexpr int MAX_BORROW_FRAMES = 2;
+
+    /**
+     * @param fps Frame rate of the stream.
+     * @param budget_percent Share of the frame interval each frame is spread over.
+     */
+    frame_pacer_t(int fps, int budget_percent);
+
+    /**
+     * @brief Choose how long the next frame's packets are spread over.
+     * @param frame_packets Packets in the frame, including parity.
+     * @param idr Whether the frame is a key frame.
+     * @param backlog How long the frame already waited for the previous frame to be paced out.
+     * @param max_packets_per_ms Highest rate the frame may be sent at, from pacing_packets_per_ms().
+     */
+    std::chrono::nanoseconds plan(std::size_t frame_packets, bool idr, std::chrono::nanoseconds backlog, std::size_t max_packets_per_ms);
+
+    /**
+     * @brief The spread of a frame that borrows nothing and repays nothing.
+     */
+    std::chrono::nanoseconds budget() const;
+
+  private:
+    std::chrono::nanoseconds interval_;
+    std::chrono::nanoseconds budget_;
+    double average_packets_ = 0;  // moving average of the packets in frames other than key frames
+  };
+}  // namespace stream
@@ -0,0 +1,312 @@
+/**
+ * @file src/video_packet_pool.h
+ * @brief Encoded video packets, recycled from the broadcast back to the encode session that made them.
+ */
+#pragma once
+
+// standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// local includes
+#include "utility.h"
+
+namespace video {
+  /**
+   * @brief Follows the sizes of encoded frames to decide how large payload buffers should be.
+   * @details Keeps a moving average and a slowly decaying peak of recent frames, where a frame
+   *          counts as at most four times the average. Buffers are made as large as the peak, so
+   *          typical frames fit without growing them, and buffers many times the average, left
+   *          over from a rare large frame such as an IDR frame, are freed instead of kept.
+   */
+  class payload_sizer_t {
+  public:
+    /**
+     * @brief Buffer sizes are rounded up to a multiple of this.
+     */
+    static constexpr std::size_t granularity = 4096;
+
+    /**
+     * @brief Buffers up to this size are never too large to keep.
+     */
+    static constexpr std::size_t min_kept = 256 * 1024;
+
+    void observe(std::size_t size) {
+      auto current = average.load(std::memory_order_relaxed);
+      if (current) {
+        size = std::min(size, current * 4);
+      }
+      average.store(current ? current - current / 8 + size / 8 : size, std::memory_order_relaxed);
+
+      auto top = peak.load(std::memory_order_relaxed);
+      peak.store(std::max(size, top - top / 1024), std::memory_order_relaxed);
+    }
+
+    std::size_t average_size() const {
+      return average.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return The capacity to give a buffer before it's filled.
+     */
+    std::size_t reserve_size() const {
+      auto size = std::max<std::size_t>(peak.load(std::memory_order_relaxed), 1);
+      return (size + granularity - 1) / granularity * granularity;
+    }
+
+    /**
+     * @return Whether a buffer of this capacity should be freed rather than kept for reuse.
+     */
+    bool oversized(std::size_t capacity) const {
+      return capacity > std::max(average_size() * 8, min_kept);
+    }
+
+    /**
+     * @brief Observe a payload about to be taken from a pool of buffers that all have one size.
+     * @param size Size of the payload.
+     * @param buffer_size Size of the pool's buffers, or 0 without a pool.
+     * @return The size the pool's buffers should have, which is buffer_size unless the pool
+     *         should be replaced.
+     */
+    std::size_t pool_buffer_size(std::size_t size, std::size_t buffer_size) {
+      observe(size);
+
+      auto wanted = reserve_size();
+      if (!buffer_size || wanted > buffer_size || oversized(buffer_size)) {
+        return wanted;
+      }
+      return buffer_size;
+    }
+
+    /**
+     * @brief Make room for a typical frame in a payload before it's filled.
+     */
+    void reserve(std::vector<std::uint8_t> &payload) const {
+      if (auto size = reserve_size(); payload.capacity() < size) {
+        payload.reserve(size);
+      }
+    }
+
+    /**
+     * @brief Empty a payload that was filled, keeping its capacity unless that's oversized().
+     */
+    void recycle(std::vector<std::uint8_t> &payload) {
+      if (oversized(payload.capacity())) {
+        std::vector<std::uint8_t>().swap(payload);
+      }
+      observe(payload.size());
+      payload.clear();
+    }
+
+  private:
+    std::atomic<std::size_t> average {0};
+    std::atomic<std::size_t> peak {0};
+  };
+
+  /**
+   * @brief Packets that are recycled once the broadcast is done with them, instead of freed.
+   * @details The encode thread acquires packets, and they may be recycled on any thread. T must
+   *          be default constructible and have a std::shared_ptr<packet_pool_t<T>> named pool,
+   *          which acquire() sets and T moves out before handing itself to recycle(). Up to limit
+   *          packets are kept, which should cover every packet in flight at once; beyond that
+   *          they are allocated and freed as usual.
+   */
+  template<class T>
+  class packet_pool_t: public std::enable_shared_from_this<packet_pool_t<T>> {
+    struct private_t {};
+
+  public:
+    packet_pool_t(private_t, std::size_t limit) {
+      spare.reserve(limit);
+    }
+
+    ~packet_pool_t() {
+      for (auto object : spare) {
+        delete object;
+      }
+    }
+
+    packet_pool_t(const packet_pool_t &) = delete;
+    packet_pool_t &operator=(const packet_pool_t &) = delete;
+
+    /**
+     * @param limit Number of packets to keep for reuse.
+     */
+    static std::shared_ptr<packet_pool_t> make(std::size_t limit) {
+      return std::make_shared<packet_pool_t>(private_t {}, limit);
+    }
+
+    /**
+     * @brief Take a packet, which is the caller's until it's recycled.
+     * @details Packets come back with whatever payload they were recycled with.
+     */
+    T *acquire() {
+      T *object = nullptr;
+      {
+        std::lock_guard lg {mutex};
+        if (!spare.empty()) {
+          object = spare.back();
+          spare.pop_back();
+        }
+      }
+
+      if (!object) {
+        object = new T {};
+      }
+      object->pool = this->shared_from_this();
+      return object;
+    }
+
+    /**
+     * @brief Take back a packet from acquire().
+     */
+    void recycle(T *object) {
+      {
+        std::lock_guard lg {mutex};
+        if (spare.size() < spare.capacity()) {
+          spare.push_back(object);
+          return;
+        }
+      }
+
+      delete object;
+    }
+
+    /**
+     * @brief Sizes of the payloads of the packets.
+     */
+    payload_sizer_t sizer;
+
+  private:
+    std::mutex mutex;
+    std::vector<T *> spare;
+  };
+
+  struct packet_raw_t {
+    virtual ~packet_raw_t() = default;
+
+    /**
+     * @brief Called when the packet_t that owns the packet lets go of it.
+     */
+    virtual void release() {
+      delete this;
+    }
+
+    virtual bool is_idr() = 0;
+
+    virtual int64_t frame_index() = 0;
+
+    virtual uint8_t *data() = 0;
+
+    virtual size_t data_size() = 0;
+
+    struct replace_t {
+      std::string_view old;
+      std::string_view _new;
+
+      KITTY_DEFAULT_CONSTR_MOVE(replace_t)
+
+      replace_t(std::string_view old, std::string_view _new) noexcept:
+          old {std::move(old)},
+          _new {std::move(_new)} {
+      }
+    };
+
+    std::vector<replace_t> *replacements = nullptr;
+    void *channel_data = nullptr;
+    bool after_ref_frame_invalidation = false;
+    // Pacing/scheduled timestamp used for transport timing.
+    std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
+    // Raw capture/QPC-derived timestamp before pacing adjustments.
+    std::optional<std::chrono::steady_clock::time_point> capture_timestamp;
+    std::optional<std::chrono::steady_clock::time_point> host_processing_timestamp;
+    std::chrono::steady_clock::time_point packet_enqueue_timestamp = std::chrono::steady_clock::now();
+
+  protected:
+    /**
+     * @brief Forget what the encoder attached to the packet, before it's reused for another frame.
+     */
+    void reset_metadata() {
+      replacements = nullptr;
+      channel_data = nullptr;
+      after_ref_frame_invalidation = false;
+      frame_timestamp.reset();
+      capture_timestamp.reset();
+      host_processing_timestamp.reset();
+    }
+  };
+
+  /**
+   * @brief A packet that goes back to the packet_pool_t it was acquired from when released.
+   * @details T derives from pooled_packet_t<T> and has a clear_payload(), which empties the
+   *          payload before the packet is reused. Packets made without a pool are deleted.
+   */
+  template<class T>
+  struct pooled_packet_t: packet_raw_t {
+    void release() override {
+      if (!pool) {
+        delete this;
+        return;
+      }
+
+      auto object = static_cast<T *>(this);
+      object->clear_payload();
+      reset_metadata();
+
+      auto owner = std::move(pool);
+      owner->recycle(object);
+    }
+
+    std::shared_ptr<packet_pool_t<T>> pool;
+  };
+
+  struct packet_raw_generic: pooled_packet_t<packet_raw_generic> {
+    packet_raw_generic() = default;
+
+    packet_raw_generic(std::vector<uint8_t> &&frame_data, int64_t frame_index, bool idr):
+        frame_data {std::move(frame_data)},
+        index {frame_index},
+        idr {idr} {
+    }
+
+    void clear_payload() {
+      pool->sizer.recycle(frame_data);
+    }
+
+    bool is_idr() override {
+      return idr;
+    }
+
+    int64_t frame_index() override {
+      return index;
+    }
+
+    uint8_t *data() override {
+      return frame_data.data();
+    }
+
+    size_t data_size() override {
+      return frame_data.size();
+    }
+
+    std::vector<uint8_t> frame_data;
+    int64_t index = 0;
+    bool idr = false;
+  };
+
+  struct packet_deleter_t {
+    void operator()(packet_raw_t *packet) const {
+      packet->release();
+    }
+  };
+
+  using packet_t = std::unique_ptr<packet_raw_t, packet_deleter_t>;
+}  // namespace video
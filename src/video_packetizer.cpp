@@ -0,0 +1,118 @@
+/**
+ * @file src/video_packetizer.cpp
+ * @brief Scatter-gather layout of encoded video frames into fixed-size shard payloads.
+ */
+#include "video_packetizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace stream {
+  bool replace_in_segments(std::vector<std::string_view> &segments, std::string_view old, std::string_view _new) {
+    for (auto it = std::begin(segments); it != std::end(segments); ++it) {
+      auto pos = it->find(old);
+      if (pos == std::string_view::npos) {
+        continue;
+      }
+
+      auto before = it->substr(0, pos);
+      auto after = it->substr(pos + old.size());
+
+      *it = before;
+      it = segments.insert(it + 1, _new);
+      segments.insert(it + 1, after);
+      return true;
+    }
+
+    return false;
+  }
+
+  payload_layout_t layout_shard_payloads(const std::vector<std::string_view> &segments, std::size_t payload_size) {
+    payload_layout_t layout;
+    if (payload_size == 0) {
+      return layout;
+    }
+
+    std::size_t total = 0;
+    for (auto &segment : segments) {
+      total += segment.size();
+    }
+
+    const auto shard_count = (total + payload_size - 1) / payload_size;
+    layout.shards.resize(shard_count);
+
+    // Walks the segment list alongside the shards, skipping empty segments
+    auto segment = std::begin(segments);
+    std::size_t segment_offset = 0;
+    auto skip_empty = [&]() {
+      while (segment != std::end(segments) && segment_offset == segment->size()) {
+        ++segment;
+        segment_offset = 0;
+      }
+    };
+
+    // First pass: alias every shard that lies within a single segment
+    std::size_t copied_shards = 0;
+    for (std::size_t x = 0; x < shard_count; ++x) {
+      skip_empty();
+
+      auto remaining = segment->size() - segment_offset;
+      if (remaining >= payload_size) {
+        layout.shards[x] = segment->data() + segment_offset;
+        segment_offset += payload_size;
+        continue;
+      }
+
+      // Straddles a boundary or is the final short shard; filled in by the second pass
+      layout.shards[x] = nullptr;
+      ++copied_shards;
+
+      auto needed = payload_size;
+      while (segment != std::end(segments) && needed > 0) {
+        auto take = std::min(needed, segment->size() - segment_offset);
+        needed -= take;
+        segment_offset += take;
+        skip_empty();
+      }
+    }
+
+    if (copied_shards == 0) {
+      return layout;
+    }
+
+    // Second pass: gather the remaining shards into scratch. The scratch buffer is sized
+    // up front so the pointers handed out above and below stay valid.
+    layout.scratch.resize(copied_shards * payload_size);
+    auto *next_scratch = layout.scratch.data();
+
+    segment = std::begin(segments);
+    segment_offset = 0;
+    for (std::size_t x = 0; x < shard_count; ++x) {
+      skip_empty();
+
+      if (layout.shards[x]) {
+        segment_offset += payload_size;
+        continue;
+      }
+
+      layout.shards[x] = next_scratch;
+      auto *out = next_scratch;
+      auto needed = payload_size;
+      while (segment != std::end(segments) && needed > 0) {
+        auto take = std::min(needed, segment->size() - segment_offset);
+        std::memcpy(out, segment->data() + segment_offset, take);
+        out += take;
+        needed -= take;
+        segment_offset += take;
+        layout.copied_bytes += take;
+        skip_empty();
+      }
+
+      // Zero-pad the final shard
+      std::memset(out, 0, needed);
+      next_scratch += payload_size;
+    }
+
+    return layout;
+  }
+}  // namespace stream
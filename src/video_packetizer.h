@@ -0,0 +1,37 @@
+/**
+ * @file src/video_packetizer.h
+ * @brief Scatter-gather layout of encoded video frames into fixed-size shard payloads.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace stream {
+  /**
+   * @brief Shard payloads of a frame, mostly aliasing the frame's own buffers.
+   */
+  struct payload_layout_t {
+    std::vector<const char *> shards;  // one pointer per data shard, each to payload_size bytes
+    std::vector<char> scratch;  // backing storage for shards that could not alias a segment
+    std::size_t copied_bytes = 0;  // bytes memcpy'd into scratch, excluding zero padding
+  };
+
+  /**
+   * @brief Apply a payload replacement to a frame described as a list of segments.
+   * @details Matches the first occurrence of `old` that lies within a single segment and splits
+   *          that segment around `_new`, so neither the frame nor the replacement is copied.
+   *          `_new` must outlive the segment list.
+   * @return true if `old` was found.
+   */
+  bool replace_in_segments(std::vector<std::string_view> &segments, std::string_view old, std::string_view _new);
+
+  /**
+   * @brief Split the concatenation of `segments` into shards of `payload_size` bytes.
+   * @details Shards that lie entirely within one segment point straight into it. Only shards
+   *          that straddle a segment boundary, and the zero-padded final shard, are copied.
+   *          The returned pointers are valid as long as the segments and the layout are.
+   */
+  payload_layout_t layout_shard_payloads(const std::vector<std::string_view> &segments, std::size_t payload_size);
+}  // namespace stream
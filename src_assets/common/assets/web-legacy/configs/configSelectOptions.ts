@@ -196,6 +196,7 @@ export function getConfigSelectOptions(
           { label: 'wlroots', value: 'wlr' },
           { label: 'KMS', value: 'kms' },
           { label: 'X11', value: 'x11' },
+          { label: 'Synthetic', value: 'synthetic' },
         );
       }
       return ensureIncludesCurrentValue(options, ctx.currentValue);
@@ -330,6 +330,8 @@ const defaultGroups = [
     options: {
       sw_preset: 'superfast',
       sw_tune: 'zerolatency',
+      sw_damage_roi: 'disabled',
+      sw_static_frame_skip: 'enabled',
     },
   },
 ] as const satisfies ReadonlyArray<{
@@ -16,6 +16,15 @@ export interface HostStatsSnapshot {
   vram_percent: number;
   net_rx_bps?: number;
   net_tx_bps?: number;
+  timer_overshoot?: TimerOvershootHistogram;
+}
+
+/** Mirrors `platf::timer_overshoot_histogram_t`; `le_us` is null for the overflow bucket. */
+export interface TimerOvershootHistogram {
+  samples: number;
+  mean_us: number;
+  max_us: number;
+  buckets: { le_us: number | null; count: number }[];
 }
 
 export interface HostInfo {
@@ -29,6 +29,22 @@ export interface RTSPSession {
   invalidate_ref_count: number;
   client_reported_losses: number;
   encode_latency_ms: number;
+  fec_percentage: number;
+  pacing_mode: string;
+  pacing_budget_ms: number;
+  pacing_spread_ms: number;
+  pacing_backlog_ms: number;
+  audio_send_syscalls: number;
+  audio_send_syscalls_per_second: number;
+  audio_capture_latency_ms: number;
+  audio_active_seconds: number;
+  audio_idle_seconds: number;
+  audio_active_encode_ms_per_minute: number;
+  audio_idle_encode_ms_per_minute: number;
+  audio_active_bytes_per_minute: number;
+  audio_idle_bytes_per_minute: number;
+  video_static_skipped: number;
+  video_static_refreshes: number;
   last_frame_index: number;
   uptime_seconds: number;
 }
@@ -112,6 +128,7 @@ export interface SessionSample {
   idr_requests: number;
   ref_invalidations: number;
   encode_latency_ms: number;
+  fec_percentage: number;
   actual_fps: number;
   actual_bitrate_kbps: number;
   frame_interval_jitter_ms: number;
@@ -0,0 +1,49 @@
+// Replaces the global allocation functions with malloc and free, counting every
+// allocation.  Each new form is replaced along with the deletes that free it.
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+  std::atomic<std::uint64_t> allocations {0};
+
+  void *allocate(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1)) {
+      return p;
+    }
+    throw std::bad_alloc {};
+  }
+}  // namespace
+
+namespace test_utils {
+  std::uint64_t allocation_count() {
+    return allocations.load(std::memory_order_relaxed);
+  }
+}  // namespace test_utils
+
+void *operator new(std::size_t size) {
+  return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+  return allocate(size);
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+  std::free(p);
+}
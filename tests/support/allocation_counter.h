@@ -0,0 +1,17 @@
+/**
+ * @file tests/support/allocation_counter.h
+ * @brief Counts heap allocations, for tests showing a path makes none.
+ *
+ * Link tests/support/allocation_counter.cpp into the component, which
+ * replaces the global operator new and delete for the whole test binary.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace test_utils {
+  /**
+   * @return Allocations made through operator new or new[] so far, on any thread.
+   */
+  std::uint64_t allocation_count();
+}  // namespace test_utils
@@ -0,0 +1,117 @@
+/**
+ * @file tests/unit/platform/linux/test_hybrid_timer.cpp
+ * @brief Test src/platform/linux/hybrid_timer.cpp.
+ */
+#include "../../../tests_common.h"
+
+#include <src/platform/linux/hybrid_timer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+TEST(TimerOvershootHistogramTests, BucketsByUpperBound) {
+  using histogram_t = platf::timer_overshoot_histogram_t;
+
+  EXPECT_EQ(histogram_t::bucket_for(0ns), 0u);
+  EXPECT_EQ(histogram_t::bucket_for(1us), 0u);
+  EXPECT_EQ(histogram_t::bucket_for(1001ns), 1u);
+  EXPECT_EQ(histogram_t::bucket_for(50us), 5u);
+  EXPECT_EQ(histogram_t::bucket_for(1ms), histogram_t::bucket_limits.size() - 1);
+  EXPECT_EQ(histogram_t::bucket_for(5ms), histogram_t::bucket_limits.size());
+}
+
+TEST(TimerOvershootHistogramTests, RecorderAccumulatesSamples) {
+  platf::overshoot_recorder_t recorder;
+  recorder.record(500ns);
+  recorder.record(30us);
+  recorder.record(2ms);
+  recorder.record(-1us);
+
+  auto histogram = recorder.snapshot();
+  EXPECT_EQ(histogram.samples, 4u);
+  EXPECT_EQ(histogram.counts[0], 2u);
+  EXPECT_EQ(histogram.counts[5], 1u);
+  EXPECT_EQ(histogram.counts.back(), 1u);
+  EXPECT_EQ(histogram.max_overshoot, 2ms);
+  EXPECT_EQ(histogram.total_overshoot, 2ms + 30us + 500ns);
+}
+
+TEST(HybridTimerTests, NeverWakesBeforeDeadline) {
+  platf::overshoot_recorder_t recorder;
+  platf::hybrid_timer_t timer {100us, &recorder};
+
+  for (int x = 0; x < 50; ++x) {
+    auto deadline = std::chrono::steady_clock::now() + 200us;
+    timer.sleep_until(deadline);
+    EXPECT_GE(std::chrono::steady_clock::now(), deadline);
+  }
+
+  EXPECT_EQ(recorder.snapshot().samples, 50u);
+}
+
+TEST(HybridTimerTests, PastDeadlineReturnsImmediately) {
+  platf::overshoot_recorder_t recorder;
+  platf::hybrid_timer_t timer {100us, &recorder};
+
+  auto start = std::chrono::steady_clock::now();
+  timer.sleep_until(start - 1ms);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1ms);
+  EXPECT_EQ(recorder.snapshot().samples, 0u);
+}
+
+TEST(HybridTimerTests, ZeroBudgetOnlySleeps) {
+  platf::hybrid_timer_t timer {0us, nullptr};
+
+  for (int x = 0; x < 20; ++x) {
+    auto deadline = std::chrono::steady_clock::now() + 500us;
+    timer.sleep_until(deadline);
+    EXPECT_GE(std::chrono::steady_clock::now(), deadline);
+  }
+
+  // Preempted wakeups are clamped so one stall can't inflate the spin for later sleeps
+  EXPECT_LE(timer.wake_latency(), 1ms);
+}
+
+TEST(HybridTimerTests, DISABLED_OvershootBenchmark) {
+  constexpr int iterations = 2000;
+  constexpr auto interval = 250us;
+
+  auto measure = [&](auto &&sleep_until) {
+    std::vector<double> overshoot_us;
+    overshoot_us.reserve(iterations);
+    for (int x = 0; x < iterations; ++x) {
+      auto deadline = std::chrono::steady_clock::now() + interval;
+      sleep_until(deadline);
+      overshoot_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - deadline).count());
+    }
+    std::sort(std::begin(overshoot_us), std::end(overshoot_us));
+    return overshoot_us;
+  };
+
+  auto report = [](const char *name, const std::vector<double> &overshoot_us) {
+    std::cout << name << ": mean " << std::accumulate(std::begin(overshoot_us), std::end(overshoot_us), 0.0) / overshoot_us.size()
+              << "us, p50 " << overshoot_us[overshoot_us.size() / 2]
+              << "us, p99 " << overshoot_us[overshoot_us.size() * 99 / 100]
+              << "us, max " << overshoot_us.back() << "us" << std::endl;
+  };
+
+  report("std::this_thread::sleep_until", measure([](auto deadline) {
+           std::this_thread::sleep_until(deadline);
+         }));
+
+  platf::hybrid_timer_t sleep_only {0us, nullptr};
+  report("hybrid timer, 0us spin", measure([&](auto deadline) {
+           sleep_only.sleep_until(deadline);
+         }));
+
+  platf::hybrid_timer_t hybrid {100us, nullptr};
+  report("hybrid timer, 100us spin", measure([&](auto deadline) {
+           hybrid.sleep_until(deadline);
+         }));
+}
@@ -0,0 +1,199 @@
+/**
+ * @file tests/unit/platform/linux/test_recv_batch.cpp
+ * @brief Test src/platform/linux/recv_batch.cpp receives over loopback.
+ */
+#include "../../../tests_common.h"
+
+#include <src/ping_table.h>
+#include <src/platform/linux/recv_batch.h>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+  struct socket_t {
+    int fd = -1;
+
+    socket_t():
+        fd {socket(AF_INET, SOCK_DGRAM, 0)} {
+    }
+
+    ~socket_t() {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  };
+
+  sockaddr_in bind_loopback(const socket_t &sock) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    EXPECT_EQ(bind(sock.fd, (sockaddr *) &addr, sizeof(addr)), 0);
+
+    socklen_t len = sizeof(addr);
+    EXPECT_EQ(getsockname(sock.fd, (sockaddr *) &addr, &len), 0);
+    return addr;
+  }
+
+  void send_to(const socket_t &sock, const sockaddr_in &target, std::string_view data) {
+    ASSERT_EQ(sendto(sock.fd, data.data(), data.size(), 0, (const sockaddr *) &target, sizeof(target)), (ssize_t) data.size());
+  }
+
+  // Matches the SS_PING layout: a 16 byte session payload followed by a sequence number
+  std::string ping(int session, std::uint32_t sequence) {
+    auto id = std::to_string(session);
+    auto data = std::string(16 - id.size(), '0') + id;
+    data.append((const char *) &sequence, sizeof(sequence));
+    return data;
+  }
+}  // namespace
+
+TEST(RecvBatchTest, ReceivesQueuedDatagramsInOneCall) {
+  socket_t receiver;
+  socket_t senders[2];
+  auto target = bind_loopback(receiver);
+  sockaddr_in sender_addresses[2] = {bind_loopback(senders[0]), bind_loopback(senders[1])};
+
+  for (std::uint32_t i = 0; i < 10; ++i) {
+    send_to(senders[i % 2], target, ping((int) i, i));
+  }
+
+  platf::recv_batch::receiver_t batch {16, 2048};
+  ASSERT_EQ(batch.receive(receiver.fd), 10);
+  for (std::size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(batch.data(i), ping((int) i, (std::uint32_t) i));
+
+    ASSERT_EQ(batch.address_size(i), sizeof(sockaddr_in));
+    auto from = (const sockaddr_in *) batch.address(i);
+    EXPECT_EQ(from->sin_port, sender_addresses[i % 2].sin_port);
+  }
+
+  EXPECT_EQ(batch.receive(receiver.fd), 0);
+}
+
+TEST(RecvBatchTest, DrainsMoreDatagramsThanOneBatch) {
+  socket_t receiver;
+  socket_t sender;
+  auto target = bind_loopback(receiver);
+
+  for (std::uint32_t i = 0; i < 20; ++i) {
+    send_to(sender, target, ping(1, i));
+  }
+
+  platf::recv_batch::receiver_t batch {8, 2048};
+  EXPECT_EQ(batch.receive(receiver.fd), 8);
+  EXPECT_EQ(batch.data(0), ping(1, 0));
+  EXPECT_EQ(batch.receive(receiver.fd), 8);
+  EXPECT_EQ(batch.data(0), ping(1, 8));
+  EXPECT_EQ(batch.receive(receiver.fd), 4);
+  EXPECT_EQ(batch.data(3), ping(1, 19));
+  EXPECT_EQ(batch.receive(receiver.fd), 0);
+}
+
+TEST(RecvBatchTest, TruncatesLongDatagrams) {
+  socket_t receiver;
+  socket_t sender;
+  auto target = bind_loopback(receiver);
+
+  send_to(sender, target, std::string(100, 'x'));
+  send_to(sender, target, "PING"sv);
+
+  platf::recv_batch::receiver_t batch {4, 32};
+  ASSERT_EQ(batch.receive(receiver.fd), 2);
+  EXPECT_EQ(batch.data(0), std::string(32, 'x'));
+  EXPECT_EQ(batch.data(1), "PING"sv);
+}
+
+TEST(RecvBatchBenchmark, DISABLED_LoopbackPingsFromManySessions) {
+  constexpr int sessions = 256;
+  constexpr int rounds = 400;  // every session pings once per round
+  constexpr std::size_t batch_size = 32;
+  constexpr std::uint64_t datagrams = (std::uint64_t) sessions * rounds;
+
+  socket_t receiver;
+  auto target = bind_loopback(receiver);
+  int rcvbuf = 8 * 1024 * 1024;
+  setsockopt(receiver.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+  std::vector<socket_t> senders(sessions);
+  for (auto &sender : senders) {
+    bind_loopback(sender);
+  }
+
+  // Only a few sessions are mid-handshake, the rest keep pinging for the whole stream
+  std::map<std::string, int> by_string;
+  stream::ping_table_t<int> by_key;
+  for (int session = 0; session < 8; ++session) {
+    by_string.emplace(ping(session, 0).substr(0, 16), session);
+    by_key.insert_or_assign(stream::ping_key_t::from_payload(ping(session, 0)), session);
+  }
+
+  // Time only the receive side; each round is sent before it is drained
+  auto run = [&](const char *name, auto &&drain) {
+    std::chrono::steady_clock::duration spent {};
+    std::uint64_t syscalls = 0;
+    std::uint64_t matched = 0;
+    for (int round = 0; round < rounds; ++round) {
+      for (int session = 0; session < sessions; ++session) {
+        send_to(senders[session], target, ping(session, (std::uint32_t) round));
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      std::uint64_t received = 0;
+      while (received < sessions) {
+        auto [count, hits] = drain();
+        received += count;
+        matched += hits;
+        ++syscalls;
+      }
+      spent += std::chrono::steady_clock::now() - start;
+    }
+
+    EXPECT_EQ(matched, 8u * rounds);
+    std::cout << name << ": " << std::chrono::duration<double, std::nano>(spent).count() / datagrams << " ns per datagram, "
+              << (double) syscalls / datagrams << " syscalls per datagram" << std::endl;
+  };
+
+  // The original path: one receive per datagram, a std::string key and a std::map lookup
+  run("recvfrom + std::map", [&]() {
+    std::array<char, 2048> buf;
+    sockaddr_in6 from;
+    socklen_t from_len = sizeof(from);
+    auto bytes = recvfrom(receiver.fd, buf.data(), buf.size(), 0, (sockaddr *) &from, &from_len);
+    std::uint64_t hits = 0;
+    if (bytes >= 20) {
+      auto it = by_string.find(std::string {buf.data(), 16});
+      if (it != by_string.end()) {
+        std::string message {buf.data(), (std::size_t) bytes};
+        hits += !message.empty();
+      }
+    }
+    return std::pair<std::uint64_t, std::uint64_t> {bytes > 0 ? 1 : 0, hits};
+  });
+
+  platf::recv_batch::receiver_t batch {batch_size, 2048};
+  run("recvmmsg + ping_table_t", [&]() {
+    auto received = batch.receive(receiver.fd);
+    std::uint64_t hits = 0;
+    for (int x = 0; x < received; ++x) {
+      auto data = batch.data(x);
+      if (data.size() >= 20 && by_key.find(stream::ping_key_t::from_payload(data.substr(0, 16)))) {
+        std::string message {data};
+        hits += !message.empty();
+      }
+    }
+    return std::pair<std::uint64_t, std::uint64_t> {(std::uint64_t) std::max(received, 0), hits};
+  });
+}
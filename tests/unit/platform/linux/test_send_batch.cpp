@@ -0,0 +1,148 @@
+/**
+ * @file tests/unit/platform/linux/test_send_batch.cpp
+ * @brief Test src/platform/linux/send_batch.cpp sends over loopback.
+ */
+#include "../../../tests_common.h"
+
+#include <src/platform/linux/send_batch.h>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+namespace {
+  struct socket_t {
+    int fd = -1;
+
+    socket_t():
+        fd {socket(AF_INET, SOCK_DGRAM, 0)} {
+    }
+
+    ~socket_t() {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  };
+
+  sockaddr_in bind_loopback(const socket_t &sock) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    EXPECT_EQ(bind(sock.fd, (sockaddr *) &addr, sizeof(addr)), 0);
+
+    socklen_t len = sizeof(addr);
+    EXPECT_EQ(getsockname(sock.fd, (sockaddr *) &addr, &len), 0);
+    return addr;
+  }
+
+  // Messages for a batch, each to its own destination
+  struct batch_t {
+    void add(const sockaddr_in &target, std::string data) {
+      targets.push_back(target);
+      payloads.push_back(std::move(data));
+    }
+
+    std::vector<mmsghdr> build() {
+      iovs.resize(payloads.size());
+      std::vector<mmsghdr> msgs(payloads.size());
+      for (std::size_t x = 0; x < payloads.size(); ++x) {
+        iovs[x] = {payloads[x].data(), payloads[x].size()};
+        msgs[x].msg_hdr.msg_name = &targets[x];
+        msgs[x].msg_hdr.msg_namelen = sizeof(targets[x]);
+        msgs[x].msg_hdr.msg_iov = &iovs[x];
+        msgs[x].msg_hdr.msg_iovlen = 1;
+      }
+      return msgs;
+    }
+
+    std::vector<sockaddr_in> targets;
+    std::vector<std::string> payloads;
+    std::vector<iovec> iovs;
+  };
+
+  std::vector<std::string> receive_all(const socket_t &sock) {
+    std::vector<std::string> received;
+    char buffer[256];
+    while (true) {
+      auto bytes = recv(sock.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+      if (bytes < 0) {
+        return received;
+      }
+      received.emplace_back(buffer, bytes);
+    }
+  }
+
+  // Sending to the broadcast address without SO_BROADCAST fails with EACCES
+  sockaddr_in broadcast_target(const sockaddr_in &target) {
+    auto unreachable = target;
+    unreachable.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+    return unreachable;
+  }
+}  // namespace
+
+TEST(SendBatchTests, SendsEveryMessage) {
+  socket_t sender;
+  socket_t receiver;
+  auto target = bind_loopback(receiver);
+
+  batch_t batch;
+  for (int x = 0; x < 20; ++x) {
+    batch.add(target, "packet " + std::to_string(x));
+  }
+  auto msgs = batch.build();
+
+  auto result = platf::send_batch::send(sender.fd, msgs.data(), msgs.size());
+  EXPECT_EQ(result.syscalls, 1);
+  EXPECT_EQ(result.failed, 0u);
+  EXPECT_EQ(receive_all(receiver), batch.payloads);
+}
+
+TEST(SendBatchTests, FailingDestinationIsSkipped) {
+  socket_t sender;
+  socket_t receiver;
+  auto target = bind_loopback(receiver);
+  auto unreachable = broadcast_target(target);
+
+  // Another session's peer fails in the middle of the batch
+  batch_t batch;
+  std::vector<std::string> expected;
+  for (int x = 0; x < 10; ++x) {
+    auto data = "packet " + std::to_string(x);
+    if (x == 4) {
+      batch.add(unreachable, data);
+    } else {
+      batch.add(target, data);
+      expected.push_back(data);
+    }
+  }
+  auto msgs = batch.build();
+
+  auto result = platf::send_batch::send(sender.fd, msgs.data(), msgs.size());
+  EXPECT_EQ(result.syscalls, 3);
+  EXPECT_EQ(result.failed, 1u);
+  EXPECT_EQ(result.error, EACCES);
+  EXPECT_EQ(receive_all(receiver), expected);
+}
+
+TEST(SendBatchTests, FailuresAtEitherEndAreSkipped) {
+  socket_t sender;
+  socket_t receiver;
+  auto target = bind_loopback(receiver);
+  auto unreachable = broadcast_target(target);
+
+  batch_t batch;
+  batch.add(unreachable, "first");
+  batch.add(unreachable, "second");
+  batch.add(target, "third");
+  batch.add(unreachable, "last");
+  auto msgs = batch.build();
+
+  auto result = platf::send_batch::send(sender.fd, msgs.data(), msgs.size());
+  EXPECT_GE(result.syscalls, 0);
+  EXPECT_EQ(result.failed, 3u);
+  EXPECT_EQ(receive_all(receiver), std::vector<std::string> {"third"});
+}
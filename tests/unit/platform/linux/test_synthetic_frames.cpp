@@ -0,0 +1,201 @@
+/**
+ * @file tests/unit/platform/linux/test_synthetic_frames.cpp
+ * @brief Test src/platform/linux/synthetic_frames.cpp
+ */
+#include "../../../tests_common.h"
+
+#include <src/platform/linux/synthetic_frames.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace platf::synthetic;
+
+namespace {
+  constexpr pattern_e patterns[] {
+    pattern_e::scrolling_text,
+    pattern_e::gradient,
+    pattern_e::motion,
+    pattern_e::static_desktop,
+  };
+
+  const char *name_of(pattern_e pattern) {
+    switch (pattern) {
+      case pattern_e::scrolling_text:
+        return "scrolling_text";
+      case pattern_e::gradient:
+        return "gradient";
+      case pattern_e::motion:
+        return "motion";
+      case pattern_e::static_desktop:
+        return "static";
+    }
+    return "";
+  }
+
+  struct frame_t {
+    int width;
+    int height;
+    std::vector<std::uint32_t> pixels;
+
+    frame_t(int width, int height):
+        width {width},
+        height {height},
+        pixels((std::size_t) width * height) {
+    }
+
+    std::uint8_t *data() {
+      return (std::uint8_t *) pixels.data();
+    }
+
+    int row_pitch() const {
+      return width * 4;
+    }
+  };
+
+  frame_t render(const frame_source_t &source, std::uint64_t number, int width, int height) {
+    frame_t frame {width, height};
+    source.render(number, frame.data(), frame.row_pitch());
+    return frame;
+  }
+
+  double changed(const frame_t &a, const frame_t &b) {
+    std::size_t count = 0;
+    for (std::size_t x = 0; x < a.pixels.size(); ++x) {
+      count += a.pixels[x] != b.pixels[x];
+    }
+    return (double) count / a.pixels.size();
+  }
+}  // namespace
+
+TEST(SyntheticFramesTests, PatternsAreNamedLikeTheConfigOption) {
+  for (auto pattern : patterns) {
+    EXPECT_EQ(pattern_from_view(name_of(pattern)), pattern);
+  }
+  EXPECT_FALSE(pattern_from_view("static_desktop"));
+  EXPECT_FALSE(pattern_from_view(""));
+}
+
+TEST(SyntheticFramesTests, FramesAreDeterministic) {
+  for (auto pattern : patterns) {
+    frame_source_t first {pattern, 640, 360};
+    frame_source_t second {pattern, 640, 360};
+
+    for (std::uint64_t number : {0, 1, 59, 1000}) {
+      EXPECT_EQ(render(first, number, 640, 360).pixels, render(second, number, 640, 360).pixels) << name_of(pattern) << " frame " << number;
+    }
+  }
+}
+
+TEST(SyntheticFramesTests, MovingPatternsChangeEveryFrame) {
+  for (auto pattern : {pattern_e::scrolling_text, pattern_e::gradient, pattern_e::motion}) {
+    frame_source_t source {pattern, 640, 360};
+    for (std::uint64_t number = 0; number < 10; ++number) {
+      EXPECT_GT(changed(render(source, number, 640, 360), render(source, number + 1, 640, 360)), 0.02) << name_of(pattern) << " frame " << number;
+    }
+  }
+
+  frame_source_t motion {pattern_e::motion, 640, 360};
+  EXPECT_GT(changed(render(motion, 0, 640, 360), render(motion, 1, 640, 360)), 0.9);
+}
+
+TEST(SyntheticFramesTests, StaticDesktopOnlyBlinksTheCaret) {
+  frame_source_t source {pattern_e::static_desktop, 1280, 720};
+
+  auto on = render(source, 0, 1280, 720);
+  EXPECT_EQ(render(source, 29, 1280, 720).pixels, on.pixels);
+
+  auto off = render(source, 30, 1280, 720);
+  auto difference = changed(on, off);
+  EXPECT_GT(difference, 0.0);
+  EXPECT_LT(difference, 0.001);
+
+  EXPECT_EQ(render(source, 60, 1280, 720).pixels, on.pixels);
+}
+
+TEST(SyntheticFramesTests, DamageCoversEveryChange) {
+  constexpr int width = 640;
+  constexpr int height = 360;
+
+  for (auto pattern : patterns) {
+    frame_source_t source {pattern, width, height};
+    EXPECT_FALSE(source.damage(0)) << name_of(pattern);
+
+    for (std::uint64_t number = 1; number <= 61; ++number) {
+      auto damage = source.damage(number);
+      if (!damage) {
+        continue;
+      }
+
+      auto previous = render(source, number - 1, width, height);
+      auto current = render(source, number, width, height);
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          if (previous.pixels[y * width + x] == current.pixels[y * width + x]) {
+            continue;
+          }
+
+          EXPECT_TRUE(std::any_of(damage->begin(), damage->end(), [&](const rect_t &rect) {
+            return x >= rect.x && x < rect.x + rect.width && y >= rect.y && y < rect.y + rect.height;
+          })) << name_of(pattern) << " frame " << number << " pixel " << x << ',' << y;
+        }
+      }
+    }
+  }
+
+  frame_source_t desktop {pattern_e::static_desktop, width, height};
+  EXPECT_EQ(desktop.damage(1)->size(), 0);
+  EXPECT_EQ(desktop.damage(30)->size(), 1);
+}
+
+TEST(SyntheticFramesTests, RowPitchPaddingIsUntouched) {
+  constexpr int width = 100;
+  constexpr int height = 50;
+  constexpr int row_pitch = width * 4 + 64;
+
+  for (auto pattern : patterns) {
+    frame_source_t source {pattern, width, height};
+    std::vector<std::uint8_t> padded(row_pitch * height, 0xab);
+    source.render(7, padded.data(), row_pitch);
+
+    auto packed = render(source, 7, width, height);
+    for (int y = 0; y < height; ++y) {
+      auto row = padded.data() + y * row_pitch;
+      EXPECT_EQ(std::memcmp(row, packed.data() + y * width * 4, width * 4), 0) << name_of(pattern) << " row " << y;
+      EXPECT_TRUE(std::all_of(row + width * 4, row + row_pitch, [](auto byte) {
+        return byte == 0xab;
+      })) << name_of(pattern) << " row " << y;
+    }
+  }
+}
+
+TEST(SyntheticFramesTests, OddAndTinySizes) {
+  for (auto pattern : patterns) {
+    for (auto [width, height] : {std::pair {1, 1}, std::pair {7, 3}, std::pair {1366, 769}}) {
+      frame_source_t source {pattern, width, height};
+      auto frame = render(source, 123, width, height);
+      EXPECT_EQ(frame.pixels.size(), (std::size_t) width * height);
+    }
+  }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(SyntheticFramesTests, DISABLED_RenderTimeBenchmark) {
+  for (auto pattern : patterns) {
+    frame_source_t source {pattern, 1920, 1080};
+    frame_t frame {1920, 1080};
+
+    constexpr int frames = 200;
+    auto start = std::chrono::steady_clock::now();
+    for (int number = 0; number < frames; ++number) {
+      source.render(number, frame.data(), frame.row_pitch());
+    }
+    auto us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    std::cout << name_of(pattern) << " 1920x1080: " << us << " us/frame" << std::endl;
+    EXPECT_GT(us, 0.0);
+  }
+}
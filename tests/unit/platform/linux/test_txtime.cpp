@@ -0,0 +1,179 @@
+/**
+ * @file tests/unit/platform/linux/test_txtime.cpp
+ * @brief Test src/platform/linux/txtime.cpp kernel-paced sends over loopback.
+ */
+#include "../../../tests_common.h"
+
+#include <src/platform/linux/txtime.h>
+#include <src/video_pacing.h>
+
+#include <arpa/inet.h>
+#include <linux/pkt_sched.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+  constexpr std::size_t blocksize = 1416;
+
+  struct socket_t {
+    int fd = -1;
+
+    socket_t():
+        fd {socket(AF_INET, SOCK_DGRAM, 0)} {
+    }
+
+    ~socket_t() {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  };
+
+  class TxtimeLoopbackTest: public testing::Test {
+  protected:
+    void SetUp() override {
+      ASSERT_GE(sender.fd, 0);
+      ASSERT_GE(receiver.fd, 0);
+
+      sockaddr_in addr = {};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      ASSERT_EQ(bind(receiver.fd, (sockaddr *) &addr, sizeof(addr)), 0);
+
+      socklen_t len = sizeof(target);
+      ASSERT_EQ(getsockname(receiver.fd, (sockaddr *) &target, &len), 0);
+
+      if (!platf::txtime::enable(sender.fd)) {
+        GTEST_SKIP() << "SO_TXTIME is not supported by this kernel";
+      }
+    }
+
+    void send_at(std::chrono::steady_clock::time_point departure) {
+      std::array<char, blocksize> payload {};
+      iovec iov {payload.data(), payload.size()};
+
+      alignas(cmsghdr) char control[platf::txtime::cmsg_space] = {};
+      msghdr msg = {};
+      msg.msg_name = &target;
+      msg.msg_namelen = sizeof(target);
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+
+      platf::txtime::fill_cmsg(CMSG_FIRSTHDR(&msg), departure);
+      ASSERT_EQ(sendmsg(sender.fd, &msg, 0), (ssize_t) payload.size());
+    }
+
+    std::chrono::steady_clock::time_point receive() {
+      pollfd pfd {receiver.fd, POLLIN, 0};
+      if (poll(&pfd, 1, 1000) != 1) {
+        return {};
+      }
+
+      std::array<char, blocksize> buffer;
+      recv(receiver.fd, buffer.data(), buffer.size(), 0);
+      return std::chrono::steady_clock::now();
+    }
+
+    socket_t sender;
+    socket_t receiver;
+    sockaddr_in target = {};
+  };
+}  // namespace
+
+TEST(VideoPacingTests, ScheduleSpacesPacketsAtConfiguredRate) {
+  // 100 Mbps of 1416 byte packets is 8 packets per millisecond
+  auto packets_per_ms = stream::pacing_packets_per_ms(100'000'000, blocksize);
+  EXPECT_EQ(packets_per_ms, 8u);
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(stream::pacing_due(start, 0, packets_per_ms), start);
+  EXPECT_EQ(stream::pacing_due(start, 8, packets_per_ms) - start, 1ms);
+  EXPECT_EQ(stream::pacing_due(start, 20, packets_per_ms) - start, 2500us);
+}
+
+TEST(VideoPacingTests, BudgetNeverDropsToZero) {
+  EXPECT_EQ(stream::pacing_packets_per_ms(1000, blocksize), 1u);
+  EXPECT_EQ(stream::pacing_packets_per_ms(100'000'000, 0), 1u);
+}
+
+TEST(TxtimeQdiscTests, PacingRootQdiscsHonorDepartureTimes) {
+  using platf::txtime::honors_departure_times;
+
+  EXPECT_TRUE(honors_departure_times({{0x80010000, TC_H_ROOT, "fq"}}));
+  EXPECT_TRUE(honors_departure_times({{0x80010000, TC_H_ROOT, "etf"}}));
+  EXPECT_FALSE(honors_departure_times({{0, TC_H_ROOT, "fq_codel"}}));
+  EXPECT_FALSE(honors_departure_times({{0, TC_H_ROOT, "pfifo_fast"}}));
+  EXPECT_FALSE(honors_departure_times({{0, TC_H_ROOT, "noqueue"}}));
+  EXPECT_FALSE(honors_departure_times({}));
+
+  // An ingress or clsact qdisc doesn't change how packets leave
+  EXPECT_TRUE(honors_departure_times({{0x80010000, TC_H_ROOT, "fq"}, {0xffff0000, TC_H_INGRESS, "clsact"}}));
+}
+
+TEST(TxtimeQdiscTests, MultiqueueRootsNeedEveryQueueToPace) {
+  using platf::txtime::honors_departure_times;
+
+  // As the kernel attaches them by default, mq 0: root with a qdisc per queue under it
+  EXPECT_TRUE(honors_departure_times({{0, TC_H_ROOT, "mq"}, {0, 1, "fq"}, {0, 2, "fq"}}));
+  EXPECT_FALSE(honors_departure_times({{0, TC_H_ROOT, "mq"}, {0, 1, "fq"}, {0, 2, "fq_codel"}}));
+  EXPECT_FALSE(honors_departure_times({{0, TC_H_ROOT, "mq"}}));
+
+  EXPECT_TRUE(honors_departure_times({{0x00010000, TC_H_ROOT, "mqprio"}, {0, 0x00010001, "etf"}, {0xffff0000, TC_H_INGRESS, "ingress"}}));
+}
+
+TEST_F(TxtimeLoopbackTest, EgressMatchesWhetherDeparturesAreHeld) {
+  auto egress = platf::txtime::egress((const sockaddr *) &target);
+  if (!egress) {
+    GTEST_SKIP() << "rtnetlink isn't available";
+  }
+  EXPECT_EQ(egress->interface, "lo");
+
+  auto probe_sent = std::chrono::steady_clock::now();
+  send_at(probe_sent + 50ms);
+  auto probe_received = receive();
+  EXPECT_EQ(egress->honors_departure_times, probe_received - probe_sent >= 25ms);
+}
+
+TEST_F(TxtimeLoopbackTest, DepartureSpacingMatchesConfiguredRate) {
+  // Only a qdisc such as fq holds stamped packets; lo defaults to noqueue
+  auto probe_sent = std::chrono::steady_clock::now();
+  send_at(probe_sent + 50ms);
+  auto probe_received = receive();
+  if (probe_received - probe_sent < 25ms) {
+    GTEST_SKIP() << "The loopback qdisc ignores departure times; attach fq to lo to run this test";
+  }
+
+  // Two packets per millisecond with four packet batches is one batch every 2 ms
+  constexpr std::size_t batch_packets = 4;
+  constexpr int batches = 20;
+  auto packets_per_ms = stream::pacing_packets_per_ms(2 * blocksize * 8 * 1000, blocksize);
+  ASSERT_EQ(packets_per_ms, 2u);
+
+  // Hand every batch to the kernel up front, as the broadcast thread does
+  auto frame_start = std::chrono::steady_clock::now() + 5ms;
+  for (int batch = 0; batch < batches; ++batch) {
+    send_at(stream::pacing_due(frame_start, batch * batch_packets, packets_per_ms));
+  }
+
+  std::vector<std::chrono::steady_clock::time_point> arrivals;
+  for (int batch = 0; batch < batches; ++batch) {
+    auto arrival = receive();
+    ASSERT_NE(arrival, std::chrono::steady_clock::time_point {});
+    arrivals.push_back(arrival);
+  }
+
+  EXPECT_GE(arrivals.front(), frame_start - 500us);
+
+  const auto expected_spacing = std::chrono::duration<double, std::milli>(2ms).count();
+  const auto average_spacing = std::chrono::duration<double, std::milli>(arrivals.back() - arrivals.front()).count() / (batches - 1);
+  EXPECT_NEAR(average_spacing, expected_spacing, expected_spacing * 0.25);
+}
@@ -0,0 +1,350 @@
+/**
+ * @file tests/unit/platform/linux/test_uring_send.cpp
+ * @brief Test src/platform/linux/uring_send.cpp sends over loopback.
+ */
+#include "../../../tests_common.h"
+
+#include <src/platform/linux/uring_send.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifndef UDP_SEGMENT
+  #define UDP_SEGMENT 103
+#endif
+
+namespace {
+  constexpr std::size_t segment_size = 1416;
+
+  struct socket_t {
+    int fd = -1;
+
+    socket_t():
+        fd {socket(AF_INET, SOCK_DGRAM, 0)} {
+    }
+
+    ~socket_t() {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  };
+
+  class UringSendTest: public testing::TestWithParam<bool> {
+  protected:
+    void SetUp() override {
+      ASSERT_GE(sender_socket.fd, 0);
+      ASSERT_GE(receiver.fd, 0);
+
+      sockaddr_in addr = {};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      ASSERT_EQ(bind(receiver.fd, (sockaddr *) &addr, sizeof(addr)), 0);
+
+      socklen_t len = sizeof(target);
+      ASSERT_EQ(getsockname(receiver.fd, (sockaddr *) &target, &len), 0);
+
+      int rcvbuf = 8 * 1024 * 1024;
+      setsockopt(receiver.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+      sender = platf::uring::sender_t::create(64, GetParam());
+      if (!sender) {
+        GTEST_SKIP() << "io_uring is not available";
+      }
+    }
+
+    // Fill a message with `segments` datagrams of `segment_size` bytes, sent as one GSO send
+    void fill(platf::uring::message_t *message, const std::vector<char> &data, std::size_t segments) {
+      std::memcpy(&message->address, &target, sizeof(target));
+      message->msg.msg_name = &message->address;
+      message->msg.msg_namelen = sizeof(target);
+      message->iovs[0].iov_base = (void *) data.data();
+      message->iovs[0].iov_len = segments * segment_size;
+      message->msg.msg_iov = message->iovs;
+      message->msg.msg_iovlen = 1;
+
+      if (segments > 1) {
+        message->msg.msg_control = message->control;
+        message->msg.msg_controllen = CMSG_SPACE(sizeof(std::uint16_t));
+        auto cm = CMSG_FIRSTHDR(&message->msg);
+        cm->cmsg_level = SOL_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+        std::uint16_t size = segment_size;
+        std::memcpy(CMSG_DATA(cm), &size, sizeof(size));
+      }
+    }
+
+    std::vector<char> receive() {
+      pollfd pfd {receiver.fd, POLLIN, 0};
+      if (poll(&pfd, 1, 1000) != 1) {
+        return {};
+      }
+
+      std::vector<char> buffer(65536);
+      auto bytes = recv(receiver.fd, buffer.data(), buffer.size(), 0);
+      buffer.resize(bytes > 0 ? bytes : 0);
+      return buffer;
+    }
+
+    socket_t sender_socket;
+    socket_t receiver;
+    sockaddr_in target = {};
+    std::unique_ptr<platf::uring::sender_t> sender;
+  };
+
+  std::vector<char> pattern(std::size_t size, int seed) {
+    std::vector<char> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      data[i] = (char) ((i * 13 + seed) & 0xFF);
+    }
+    return data;
+  }
+}  // namespace
+
+TEST_P(UringSendTest, DeliversQueuedMessagesInOrder) {
+  constexpr int messages = 8;
+
+  std::vector<std::vector<char>> payloads;
+  for (int x = 0; x < messages; ++x) {
+    payloads.push_back(pattern(segment_size, x));
+    auto message = sender->prepare();
+    ASSERT_NE(message, nullptr);
+    fill(message, payloads.back(), 1);
+    sender->queue(message, sender_socket.fd);
+  }
+
+  // Nothing reaches the kernel until the batch is submitted, and then with one syscall
+  EXPECT_EQ(sender->stats().enters, 0u);
+  ASSERT_TRUE(sender->submit());
+  EXPECT_EQ(sender->stats().enters, 1u);
+
+  ASSERT_TRUE(sender->completed(sender->fence(), true));
+  EXPECT_FALSE(sender->take_error());
+  EXPECT_EQ(sender->stats().sent, (std::uint64_t) messages);
+
+  for (int x = 0; x < messages; ++x) {
+    EXPECT_EQ(receive(), payloads[x]) << x;
+  }
+}
+
+TEST_P(UringSendTest, SegmentsGsoSends) {
+  constexpr std::size_t segments = 4;
+  auto data = pattern(segments * segment_size, 7);
+
+  auto message = sender->prepare();
+  ASSERT_NE(message, nullptr);
+  fill(message, data, segments);
+  sender->queue(message, sender_socket.fd);
+  ASSERT_TRUE(sender->completed(sender->fence(), true));
+  if (sender->take_error()) {
+    GTEST_SKIP() << "UDP GSO is not supported by this kernel";
+  }
+
+  for (std::size_t x = 0; x < segments; ++x) {
+    auto datagram = receive();
+    ASSERT_EQ(datagram.size(), segment_size) << x;
+    EXPECT_EQ(0, std::memcmp(datagram.data(), data.data() + x * segment_size, segment_size)) << x;
+  }
+}
+
+TEST_P(UringSendTest, SendsLargeContiguousMessagesZeroCopy) {
+  constexpr std::size_t segments = 32;
+  auto data = pattern(segments * segment_size, 9);
+
+  auto message = sender->prepare();
+  ASSERT_NE(message, nullptr);
+  fill(message, data, segments);
+  sender->queue(message, sender_socket.fd);
+  ASSERT_TRUE(sender->completed(sender->fence(), true));
+  if (sender->take_error()) {
+    GTEST_SKIP() << "UDP GSO is not supported by this kernel";
+  }
+
+  EXPECT_EQ(sender->stats().zerocopy, sender->zerocopy() ? 1u : 0u);
+  for (std::size_t x = 0; x < segments; ++x) {
+    auto datagram = receive();
+    ASSERT_EQ(datagram.size(), segment_size) << x;
+    EXPECT_EQ(0, std::memcmp(datagram.data(), data.data() + x * segment_size, segment_size)) << x;
+  }
+}
+
+TEST_P(UringSendTest, CopiesScatterGatherMessages) {
+  // A header and a payload per segment, as video shards are sent
+  constexpr std::size_t segments = 20;
+  constexpr std::size_t header_size = 16;
+  auto headers = pattern(segments * header_size, 1);
+  auto payloads = pattern(segments * (segment_size - header_size), 2);
+
+  auto message = sender->prepare();
+  ASSERT_NE(message, nullptr);
+  std::vector<char> unused;
+  fill(message, unused, segments);
+  for (std::size_t x = 0; x < segments; ++x) {
+    message->iovs[x * 2] = {headers.data() + x * header_size, header_size};
+    message->iovs[x * 2 + 1] = {payloads.data() + x * (segment_size - header_size), segment_size - header_size};
+  }
+  message->msg.msg_iovlen = segments * 2;
+
+  EXPECT_FALSE(platf::uring::zerocopy_eligible(message->msg));
+  sender->queue(message, sender_socket.fd);
+  ASSERT_TRUE(sender->completed(sender->fence(), true));
+  if (sender->take_error()) {
+    GTEST_SKIP() << "UDP GSO is not supported by this kernel";
+  }
+
+  EXPECT_EQ(sender->stats().zerocopy, 0u);
+  for (std::size_t x = 0; x < segments; ++x) {
+    auto datagram = receive();
+    ASSERT_EQ(datagram.size(), segment_size) << x;
+    EXPECT_EQ(0, std::memcmp(datagram.data(), headers.data() + x * header_size, header_size)) << x;
+    EXPECT_EQ(0, std::memcmp(datagram.data() + header_size, payloads.data() + x * (segment_size - header_size), segment_size - header_size)) << x;
+  }
+}
+
+TEST_P(UringSendTest, FenceCoversOnlyEarlierMessages) {
+  auto data = pattern(segment_size, 1);
+
+  auto first = sender->prepare();
+  fill(first, data, 1);
+  sender->queue(first, sender_socket.fd);
+  auto first_fence = sender->fence();
+
+  ASSERT_TRUE(sender->completed(first_fence, true));
+
+  auto second = sender->prepare();
+  fill(second, data, 1);
+  sender->queue(second, sender_socket.fd);
+
+  // The earlier fence stays complete while later messages are outstanding
+  EXPECT_TRUE(sender->completed(first_fence, false));
+  EXPECT_TRUE(sender->completed(sender->fence(), true));
+}
+
+TEST_P(UringSendTest, CompletesEveryMessageOnNonBlockingSocket) {
+  int sndbuf = 4096;
+  setsockopt(sender_socket.fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  fcntl(sender_socket.fd, F_SETFL, fcntl(sender_socket.fd, F_GETFL) | O_NONBLOCK);
+
+  // More messages than slots, so prepare() has to wait on completions as well
+  constexpr int messages = 512;
+  auto data = pattern(segment_size, 3);
+  for (int x = 0; x < messages; ++x) {
+    auto message = sender->prepare();
+    ASSERT_NE(message, nullptr);
+    fill(message, data, 1);
+    sender->queue(message, sender_socket.fd);
+    if (x % 16 == 15) {
+      ASSERT_TRUE(sender->submit());
+    }
+  }
+
+  ASSERT_TRUE(sender->completed(sender->fence(), true));
+  EXPECT_FALSE(sender->take_error());
+  EXPECT_EQ(sender->stats().sent, (std::uint64_t) messages);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, UringSendTest, testing::Bool(), [](const testing::TestParamInfo<bool> &info) {
+  return info.param ? "ZeroCopy" : "Copy";
+});
+
+TEST(UringSendBenchmark, DISABLED_LoopbackCpuPerGbit) {
+  constexpr std::size_t segments = 45;  // a 64 KB GSO send, as the video path batches them
+  constexpr std::size_t sends_per_frame = 8;
+  constexpr int frames = 4000;
+  const double gbits = (double) segments * segment_size * sends_per_frame * frames * 8 / 1e9;
+
+  socket_t receiver;
+  sockaddr_in target = {};
+  target.sin_family = AF_INET;
+  target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  ASSERT_EQ(bind(receiver.fd, (sockaddr *) &target, sizeof(target)), 0);
+  socklen_t len = sizeof(target);
+  ASSERT_EQ(getsockname(receiver.fd, (sockaddr *) &target, &len), 0);
+
+  auto data = pattern(segments * segment_size, 0);
+
+  auto cpu_seconds = []() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+  };
+
+  auto report = [&](const char *name, double cpu, std::uint64_t syscalls) {
+    std::cout << name << ": " << cpu / gbits * 1000 << " ms CPU per Gbit, "
+              << (double) syscalls / (frames * sends_per_frame) << " syscalls per 64 KB send" << std::endl;
+  };
+
+  {
+    socket_t sender;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(std::uint16_t))] = {};
+    iovec iov {data.data(), data.size()};
+    msghdr msg = {};
+    msg.msg_name = &target;
+    msg.msg_namelen = sizeof(target);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+    std::uint16_t size = segment_size;
+    std::memcpy(CMSG_DATA(cm), &size, sizeof(size));
+
+    auto start = cpu_seconds();
+    for (int frame = 0; frame < frames; ++frame) {
+      for (std::size_t x = 0; x < sends_per_frame; ++x) {
+        sendmsg(sender.fd, &msg, 0);
+      }
+    }
+    report("sendmsg (GSO)", cpu_seconds() - start, frames * sends_per_frame);
+  }
+
+  for (bool zerocopy : {false, true}) {
+    socket_t sender;
+    auto uring = platf::uring::sender_t::create(64, zerocopy);
+    if (!uring) {
+      GTEST_SKIP() << "io_uring is not available";
+    }
+
+    auto start = cpu_seconds();
+    for (int frame = 0; frame < frames; ++frame) {
+      for (std::size_t x = 0; x < sends_per_frame; ++x) {
+        auto message = uring->prepare();
+        std::memcpy(&message->address, &target, sizeof(target));
+        message->msg.msg_name = &message->address;
+        message->msg.msg_namelen = sizeof(target);
+        message->iovs[0] = {data.data(), data.size()};
+        message->msg.msg_iov = message->iovs;
+        message->msg.msg_iovlen = 1;
+        message->msg.msg_control = message->control;
+        message->msg.msg_controllen = CMSG_SPACE(sizeof(std::uint16_t));
+        auto cm = CMSG_FIRSTHDR(&message->msg);
+        cm->cmsg_level = SOL_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+        std::uint16_t size = segment_size;
+        std::memcpy(CMSG_DATA(cm), &size, sizeof(size));
+        uring->queue(message, sender.fd);
+      }
+
+      // One submission per frame, as with kernel pacing
+      uring->submit();
+      uring->completed(uring->fence(), false);
+    }
+    uring->completed(uring->fence(), true);
+    report(uring->zerocopy() ? "io_uring SENDMSG_ZC" : "io_uring SENDMSG", cpu_seconds() - start, uring->stats().enters);
+  }
+}
@@ -0,0 +1,286 @@
+/**
+ * @file tests/unit/test_abr_controller.cpp
+ * @brief Test src/abr_controller.*
+ */
+
+#include "../tests_common.h"
+#include "src/abr_controller.h"
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+  constexpr auto sample_interval = 100ms;
+  constexpr std::uint64_t packet_size = 1400;
+
+  struct conditions_t {
+    double loss_percent = 0;
+    double utilization = 1.0;
+    std::chrono::microseconds queue_latency {0};
+    std::chrono::microseconds pacer_delay {0};
+    bool shared_loop = false;  // the broadcast loop is shared, so its delays aren't reported
+  };
+
+  // Plays the host side of a session: every 100 ms the encoder produces its budget,
+  // the packets go out and the client reports whatever the trace says was lost
+  struct session_t {
+    stream::abr_controller_t &controller;
+    std::uint64_t packets_sent = 0;
+    std::uint64_t encoded_bytes = 0;
+    std::int64_t lost_packets = 0;
+    std::uint32_t recovery_requests = 0;
+    std::uint64_t key_frames = 0;
+    std::vector<int> changes {};
+
+    void sample(const conditions_t &conditions) {
+      auto bytes = (std::uint64_t) (controller.bitrate() * 1000.0 / 8 * std::chrono::duration<double>(sample_interval).count() * conditions.utilization);
+      auto packets = bytes / packet_size + 1;
+      encoded_bytes += bytes;
+      packets_sent += packets;
+      lost_packets += (std::int64_t) (packets * conditions.loss_percent / 100);
+
+      auto changed = controller.update({
+        sample_interval,
+        lost_packets,
+        packets_sent,
+        encoded_bytes,
+        recovery_requests,
+        key_frames,
+        conditions.shared_loop ? std::nullopt : std::make_optional(conditions.queue_latency),
+        conditions.shared_loop ? std::nullopt : std::make_optional(conditions.pacer_delay),
+      });
+      if (changed) {
+        EXPECT_EQ(*changed, controller.bitrate());
+        changes.push_back(*changed);
+      }
+    }
+
+    void run(std::chrono::milliseconds duration, const conditions_t &conditions = {}) {
+      for (auto t = 0ms; t < duration; t += sample_interval) {
+        sample(conditions);
+      }
+    }
+
+    // Seeds the totals and runs two clean windows, so the next sample starts a window
+    void settle() {
+      run(1100ms);
+    }
+
+    // Runs a link that loses packets whenever the bitrate exceeds its capacity
+    void run_link(std::chrono::milliseconds duration, int capacity_kbps) {
+      for (auto t = 0ms; t < duration; t += sample_interval) {
+        conditions_t conditions;
+        if (controller.bitrate() > capacity_kbps) {
+          conditions.loss_percent = 100.0 * (controller.bitrate() - capacity_kbps) / controller.bitrate();
+        }
+        sample(conditions);
+      }
+    }
+  };
+}  // namespace
+
+TEST(AbrControllerTests, CleanLinkStaysAtCeiling) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.run(10s);
+  EXPECT_EQ(controller.bitrate(), 20000);
+  EXPECT_TRUE(session.changes.empty());
+}
+
+TEST(AbrControllerTests, LossCutsBitrateWithCooldown) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.settle();
+  session.run(600ms, {.loss_percent = 5});
+  ASSERT_EQ(session.changes.size(), 1u);
+  EXPECT_EQ(controller.bitrate(), 17000);
+
+  // The encoder gets time to settle before the next cut
+  session.run(500ms, {.loss_percent = 5});
+  EXPECT_EQ(controller.bitrate(), 17000);
+  session.run(500ms, {.loss_percent = 5});
+  EXPECT_EQ(controller.bitrate(), 14450);
+}
+
+TEST(AbrControllerTests, HeavyLossCutsHarder) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.settle();
+  session.run(600ms, {.loss_percent = 25});
+  EXPECT_EQ(controller.bitrate(), 14000);
+}
+
+TEST(AbrControllerTests, BitrateStaysAboveFloor) {
+  stream::abr_controller_t controller {20000, 5000, 60};
+  session_t session {controller};
+
+  session.run(30s, {.loss_percent = 25});
+  EXPECT_EQ(controller.bitrate(), 5000);
+}
+
+TEST(AbrControllerTests, QueueingDelaysCountAsCongestion) {
+  // At 60 fps a frame interval is about 16.7 ms
+  {
+    stream::abr_controller_t controller {20000, 2000, 60};
+    session_t session {controller};
+    session.run(100ms);
+    session.run(1s, {.pacer_delay = 4ms});
+    EXPECT_EQ(controller.bitrate(), 20000);
+    session.run(600ms, {.pacer_delay = 10ms});
+    EXPECT_EQ(controller.bitrate(), 17000);
+  }
+  {
+    stream::abr_controller_t controller {20000, 2000, 60};
+    session_t session {controller};
+    session.run(100ms);
+    session.run(1s, {.queue_latency = 8ms});
+    EXPECT_EQ(controller.bitrate(), 20000);
+    session.run(600ms, {.queue_latency = 20ms});
+    EXPECT_EQ(controller.bitrate(), 17000);
+  }
+}
+
+TEST(AbrControllerTests, KeyFrameDelaysAreNotCongestion) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+  session.settle();
+
+  // Every second a key frame is spread over three frame intervals, and the frames behind it wait
+  for (int x = 0; x < 10; ++x) {
+    session.key_frames += 1;
+    session.run(200ms, {.queue_latency = 20ms, .pacer_delay = 33ms});
+    session.run(800ms);
+  }
+  EXPECT_EQ(controller.bitrate(), 20000);
+
+  // The same delays without a key frame behind them are congestion
+  session.run(200ms, {.queue_latency = 20ms, .pacer_delay = 33ms});
+  session.run(800ms);
+  EXPECT_LT(controller.bitrate(), 20000);
+}
+
+TEST(AbrControllerTests, SharedBroadcastLoopDelaysAreIgnored) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  // Another session's frames hold up the shared loop
+  session.settle();
+  session.run(5s, {.queue_latency = 40ms, .pacer_delay = 30ms, .shared_loop = true});
+  EXPECT_EQ(controller.bitrate(), 20000);
+
+  // Loss still counts
+  session.run(600ms, {.loss_percent = 5, .shared_loop = true});
+  EXPECT_EQ(controller.bitrate(), 17000);
+}
+
+TEST(AbrControllerTests, RepeatedRecoveryRequestsCountAsCongestion) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.settle();
+  session.recovery_requests += 1;
+  session.run(500ms);
+  EXPECT_EQ(controller.bitrate(), 20000);
+
+  session.recovery_requests += 2;
+  session.run(500ms);
+  EXPECT_EQ(controller.bitrate(), 17000);
+}
+
+TEST(AbrControllerTests, IncreasesAfterHoldInSmallSteps) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.settle();
+  session.run(1500ms, {.loss_percent = 25});
+  ASSERT_LT(controller.bitrate(), 12000);
+  session.changes.clear();
+
+  const auto reduced = controller.bitrate();
+  session.run(2500ms);
+  EXPECT_EQ(controller.bitrate(), reduced);
+
+  session.run(60s);
+  EXPECT_EQ(controller.bitrate(), 20000);
+  auto previous = reduced;
+  for (auto bitrate : session.changes) {
+    EXPECT_GT(bitrate, previous);
+    EXPECT_LE(bitrate - previous, 1000);
+    previous = bitrate;
+  }
+}
+
+TEST(AbrControllerTests, IdleEncoderDoesNotEarnIncreases) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.settle();
+  session.run(600ms, {.loss_percent = 5});
+  ASSERT_EQ(controller.bitrate(), 17000);
+
+  session.run(20s, {.utilization = 0.3});
+  EXPECT_EQ(controller.bitrate(), 17000);
+
+  session.run(5s);
+  EXPECT_GT(controller.bitrate(), 17000);
+}
+
+TEST(AbrControllerTests, StepsShrinkNearCongestedBitrate) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.settle();
+  session.run(600ms, {.loss_percent = 5});
+  ASSERT_EQ(controller.bitrate(), 17000);
+  session.changes.clear();
+
+  // 18000 is 90% of the 20000 that congested, so steps past it are a quarter
+  session.run(10s);
+  ASSERT_GE(session.changes.size(), 3u);
+  EXPECT_EQ(session.changes[0], 18000);
+  EXPECT_EQ(session.changes[1], 18250);
+  EXPECT_EQ(session.changes[2], 18500);
+}
+
+TEST(AbrControllerTests, NewCeilingRestartsController) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  session.settle();
+  session.run(600ms, {.loss_percent = 25});
+  ASSERT_EQ(controller.bitrate(), 14000);
+
+  controller.set_ceiling(10000);
+  EXPECT_EQ(controller.bitrate(), 14000);
+  session.run(100ms);
+  EXPECT_EQ(controller.bitrate(), 10000);
+
+  session.run(10s);
+  EXPECT_EQ(controller.bitrate(), 10000);
+}
+
+TEST(AbrControllerTests, LossTraceSettlesBelowCapacity) {
+  stream::abr_controller_t controller {20000, 2000, 60};
+  session_t session {controller};
+
+  // A link that carries 15000 kbps drops whatever exceeds it
+  session.run_link(60s, 15000);
+  const auto settling = session.changes.size();
+  ASSERT_GT(settling, 0u);
+
+  // Once probing has failed a few times the hold grows and the bitrate stops oscillating
+  session.run_link(60s, 15000);
+  EXPECT_LE(session.changes.size() - settling, 8u);
+  EXPECT_LE(controller.bitrate(), 16000);
+  EXPECT_GE(controller.bitrate(), 12000);
+
+  // When the link improves the bitrate climbs back to the ceiling
+  session.run_link(120s, 30000);
+  EXPECT_EQ(controller.bitrate(), 20000);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file tests/unit/test_audio_encoder.cpp
+ * @brief Test src/audio_encoder.cpp
+ */
+
+#include "../tests_common.h"
+#include "src/audio_encoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // Same order as platf::speaker
+  constexpr unsigned char speaker_map[] {0, 1, 2, 3, 4, 5, 6, 7};
+
+  constexpr int frame_size = 240;  // 5 ms
+
+  struct layout_t {
+    const char *name;
+    int channels;
+    int streams;
+    int coupled_streams;
+    int bitrate;
+  };
+
+  // audio::stream_configs
+  const layout_t layouts[] {
+    {"stereo", 2, 1, 1, 96000},
+    {"stereo HQ", 2, 1, 1, 512000},
+    {"5.1", 6, 4, 2, 256000},
+    {"5.1 HQ", 6, 6, 0, 1536000},
+    {"7.1", 8, 5, 3, 450000},
+    {"7.1 HQ", 8, 8, 0, 2048000},
+  };
+
+  audio::encoder_params_t params_for(const layout_t &layout) {
+    return {48000, layout.channels, layout.streams, layout.coupled_streams, speaker_map, layout.bitrate, frame_size};
+  }
+
+  std::unique_ptr<audio::multistream_encoder_t> make(const layout_t &layout, int threads) {
+    std::string note;
+    return audio::multistream_encoder_t::make(params_for(layout), threads, {}, note);
+  }
+
+  // Music-like content: a chord per channel, changing loudness, with bursts of silence
+  void fill(std::vector<float> &pcm, int channels, int frame) {
+    static std::uint32_t seed = 7;
+    for (int x = 0; x < frame_size; ++x) {
+      auto t = (float) (frame * frame_size + x) / 48000.0f;
+      for (int c = 0; c < channels; ++c) {
+        seed = seed * 1664525 + 1013904223;
+        auto noise = (float) (seed >> 8) / (float) (1 << 24) - 0.5f;
+        auto level = (frame / 50) % 4 == 3 ? 0.0f : 0.3f + 0.2f * std::sin(t * 3.0f);
+        pcm[x * channels + c] = level * (std::sin(2.0f * 3.14159265f * (110.0f * (c + 2)) * t) + 0.1f * noise);
+      }
+    }
+  }
+
+  double encode_time_us(const layout_t &layout, int threads, int &actual_threads) {
+    auto encoder = make(layout, threads);
+    actual_threads = encoder->threads();
+
+    std::vector<float> pcm(frame_size * layout.channels);
+    std::vector<unsigned char> packet(1400);
+    constexpr int frames = 4000;
+
+    std::chrono::nanoseconds total {0};
+    for (int frame = 0; frame < frames; ++frame) {
+      fill(pcm, layout.channels, frame);
+      auto start = std::chrono::steady_clock::now();
+      encoder->encode(pcm.data(), packet.data(), (std::int32_t) packet.size());
+      total += std::chrono::steady_clock::now() - start;
+    }
+
+    return std::chrono::duration<double, std::micro>(total).count() / frames;
+  }
+}  // namespace
+
+TEST(AudioEncoderTests, ParallelPacketsMatchSingleThread) {
+  for (const auto &layout : layouts) {
+    for (int threads : {2, 3, 4}) {
+      std::string note;
+      auto parallel = audio::multistream_encoder_t::make(params_for(layout), threads, {}, note);
+      auto single = make(layout, 1);
+      ASSERT_TRUE(parallel && single);
+
+      if (layout.streams > 2) {
+        EXPECT_GT(parallel->threads(), 1) << layout.name << ": " << note;
+      } else {
+        EXPECT_EQ(parallel->threads(), 1) << layout.name;
+      }
+
+      std::vector<float> pcm(frame_size * layout.channels);
+      std::vector<unsigned char> expected(1400);
+      std::vector<unsigned char> actual(1400);
+      for (int frame = 0; frame < 400; ++frame) {
+        fill(pcm, layout.channels, frame);
+
+        // Comfort packets switch to VBR for one frame
+        bool vbr = frame % 97 == 0;
+        single->set_vbr(vbr);
+        parallel->set_vbr(vbr);
+
+        auto expected_bytes = single->encode(pcm.data(), expected.data(), (std::int32_t) expected.size());
+        auto actual_bytes = parallel->encode(pcm.data(), actual.data(), (std::int32_t) actual.size());
+        ASSERT_GT(expected_bytes, 0);
+        ASSERT_EQ(actual_bytes, expected_bytes) << layout.name << " frame " << frame;
+        ASSERT_TRUE(std::equal(expected.begin(), expected.begin() + expected_bytes, actual.begin())) << layout.name << " frame " << frame;
+      }
+    }
+  }
+}
+
+TEST(AudioEncoderTests, WorkersAreInitialized) {
+  std::atomic<int> started {0};
+  std::string note;
+  auto encoder = audio::multistream_encoder_t::make(params_for(layouts[5]), 4, [&started](int) {
+    started.fetch_add(1);
+  }, note);
+  ASSERT_TRUE(encoder);
+
+  ASSERT_EQ(encoder->threads(), 4) << note;
+  EXPECT_EQ(started.load(), 3);
+}
+
+TEST(AudioEncoderTests, OverBudgetFallsBackToSingleThread) {
+  const auto &layout = layouts[5];
+  auto encoder = make(layout, 4);
+  ASSERT_TRUE(encoder);
+  ASSERT_GT(encoder->threads(), 1);
+
+  // 7.1 HQ takes about 1280 bytes a frame, so in 400 the later streams outgrow what's left
+  std::vector<float> pcm(frame_size * layout.channels);
+  std::vector<unsigned char> packet(400);
+  for (int frame = 0; frame < 10; ++frame) {
+    fill(pcm, layout.channels, frame);
+    auto bytes = encoder->encode(pcm.data(), packet.data(), (std::int32_t) packet.size());
+    ASSERT_GT(bytes, 0) << "frame " << frame;
+    ASSERT_LE(bytes, (int) packet.size()) << "frame " << frame;
+  }
+  EXPECT_EQ(encoder->threads(), 1);
+
+  packet.resize(1400);
+  fill(pcm, layout.channels, 10);
+  EXPECT_GT(encoder->encode(pcm.data(), packet.data(), (std::int32_t) packet.size()), 0);
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(AudioEncoderTests, DISABLED_FrameTimeBenchmark) {
+  for (const auto &layout : layouts) {
+    for (int threads : {1, 2, 4}) {
+      int actual_threads;
+      auto us = encode_time_us(layout, threads, actual_threads);
+      std::cout << layout.name << " (" << layout.streams << " streams, " << layout.bitrate / 1000 << " kbps), "
+                << actual_threads << (actual_threads == 1 ? " thread: " : " threads: ") << us << " us/frame" << std::endl;
+      EXPECT_GT(us, 0.0);
+    }
+  }
+}
@@ -0,0 +1,180 @@
+/**
+ * @file tests/unit/test_audio_pool.cpp
+ * @brief Test src/audio_pool.h
+ */
+
+#include "../support/allocation_counter.h"
+#include "../tests_common.h"
+#include "src/audio_pool.h"
+#include "src/thread_safe.h"
+#include "src/utility.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+  using buffer_t = util::buffer_t<std::uint8_t>;
+  using sample_pool_t = audio::buffer_pool_t<std::vector<float>>;
+  using packet_pool_t = audio::buffer_pool_t<buffer_t>;
+  using packet_t = std::pair<void *, packet_pool_t::handle_t>;
+}  // namespace
+
+TEST(AudioPoolTests, BuffersAreRecycled) {
+  auto pool = sample_pool_t::make(2, std::vector<float>(480));
+
+  float *first;
+  {
+    auto buffer = pool->acquire();
+    ASSERT_TRUE(buffer.pooled());
+    EXPECT_EQ(buffer->size(), 480u);
+    (*buffer)[0] = 1.0f;
+    first = buffer->data();
+  }
+
+  // The buffer just released is the next one handed out, contents intact
+  auto again = pool->acquire();
+  EXPECT_EQ(again->data(), first);
+  EXPECT_EQ((*again)[0], 1.0f);
+}
+
+TEST(AudioPoolTests, ExhaustedPoolSpillsToHeap) {
+  auto pool = sample_pool_t::make(2, std::vector<float>(480));
+
+  auto a = pool->acquire();
+  auto b = pool->acquire();
+  auto c = pool->acquire();
+  EXPECT_TRUE(a.pooled());
+  EXPECT_TRUE(b.pooled());
+  ASSERT_TRUE(c);
+  EXPECT_FALSE(c.pooled());
+  EXPECT_EQ(c->size(), 480u);
+
+  b = {};
+  EXPECT_TRUE(pool->acquire().pooled());
+}
+
+TEST(AudioPoolTests, HandlesKeepPoolAlive) {
+  auto pool = packet_pool_t::make(4, buffer_t {1400});
+  auto handle = pool->acquire();
+  pool.reset();
+
+  handle->fake_resize(10);
+  EXPECT_EQ(handle->size(), 10u);
+}
+
+TEST(AudioPoolTests, RingIsFifoAndRefusesWhenFull) {
+  audio::spsc_ring_t<int> ring {2};
+
+  int value = 1;
+  EXPECT_TRUE(ring.push(std::move(value)));
+  value = 2;
+  EXPECT_TRUE(ring.push(std::move(value)));
+  value = 3;
+  EXPECT_FALSE(ring.push(std::move(value)));
+
+  EXPECT_EQ(ring.pop(), 1);
+  value = 3;
+  EXPECT_TRUE(ring.push(std::move(value)));
+  EXPECT_EQ(ring.pop(), 2);
+  EXPECT_EQ(ring.pop(), 3);
+}
+
+TEST(AudioPoolTests, StoppedRingDrainsThenEnds) {
+  audio::spsc_ring_t<int> ring {4};
+
+  int value = 1;
+  ring.push(std::move(value));
+  ring.stop();
+  value = 2;
+  EXPECT_FALSE(ring.push(std::move(value)));
+
+  EXPECT_EQ(ring.pop(), 1);
+  EXPECT_EQ(ring.pop(), std::nullopt);
+}
+
+TEST(AudioPoolTests, StopWakesWaitingConsumer) {
+  audio::spsc_ring_t<int> ring {4};
+
+  std::thread consumer {[&ring]() {
+    EXPECT_EQ(ring.pop(), std::nullopt);
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ring.stop();
+  consumer.join();
+}
+
+TEST(AudioPoolTests, SteadyStateAudioPathDoesNotAllocate) {
+  // Mirrors audio::capture -> audio::encodeThread -> stream::audioBroadcastThread
+  constexpr int warmup_frames = 500;
+  constexpr int measured_frames = 5000;
+  constexpr int total_frames = warmup_frames + measured_frames;
+
+  auto samples = std::make_shared<audio::spsc_ring_t<sample_pool_t::handle_t>>(30);
+  safe::ring_queue_t<packet_t> packets {32, safe::drop_e::oldest};
+
+  std::atomic<int> popped_samples {0};
+  std::atomic<int> queued_packets {0};
+  std::atomic<bool> spilled {false};
+
+  std::thread capture {[&]() {
+    auto pool = sample_pool_t::make(32, std::vector<float>(240 * 2));
+    for (int frame = 0; frame < total_frames; ++frame) {
+      auto buffer = pool->acquire();
+      if (!buffer.pooled()) {
+        spilled = true;
+      }
+      (*buffer)[0] = (float) frame;
+
+      // Keep every frame for the test; production drops the frame instead
+      while (!samples->push(std::move(buffer))) {
+        std::this_thread::yield();
+      }
+    }
+    samples->stop();
+  }};
+
+  std::thread encode {[&]() {
+    auto pool = packet_pool_t::make(64, buffer_t {1400});
+    while (auto sample = samples->pop()) {
+      auto packet = pool->acquire();
+      if (!packet.pooled()) {
+        spilled = true;
+      }
+      packet->fake_resize(1400);
+      std::memcpy(packet->begin(), (*sample)->data(), sizeof(float));
+      packet->fake_resize(sizeof(float));
+      ++popped_samples;
+
+      // Wait for the broadcast side so no packet is lost to a full queue
+      while (queued_packets.load() >= 16) {
+        std::this_thread::yield();
+      }
+      ++queued_packets;
+      packets.raise(nullptr, std::move(packet));
+    }
+  }};
+
+  std::uint64_t before = 0;
+  float last = -1;
+  for (int frame = 0; frame < total_frames; ++frame) {
+    if (frame == warmup_frames) {
+      before = test_utils::allocation_count();
+    }
+    auto packet = packets.pop();
+    --queued_packets;
+    float value;
+    std::memcpy(&value, packet->second->begin(), sizeof(value));
+    EXPECT_EQ(value, last + 1);
+    last = value;
+  }
+  const auto after = test_utils::allocation_count();
+
+  capture.join();
+  encode.join();
+
+  EXPECT_EQ(after - before, 0u);
+  EXPECT_FALSE(spilled);
+  EXPECT_EQ(popped_samples.load(), total_frames);
+}
@@ -0,0 +1,180 @@
+/**
+ * @file tests/unit/test_audio_silence.cpp
+ * @brief Test src/audio_silence.cpp
+ */
+
+#include "../tests_common.h"
+#include "src/audio_silence.h"
+#include "src/thread_safe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace audio::silence;
+
+TEST(AudioSilenceTests, PeakFindsLoudestSampleAnywhere) {
+  // Odd lengths exercise the vector loop and the scalar tail together
+  for (std::size_t count : {0u, 1u, 7u, 8u, 9u, 240u, 1923u}) {
+    for (std::size_t at = 0; at < count; at += std::max<std::size_t>(count / 5, 1)) {
+      std::vector<float> samples(count, 0.001f);
+      samples[at] = -0.5f;
+      EXPECT_FLOAT_EQ(peak(samples.data(), samples.size()), 0.5f) << count << ' ' << at;
+    }
+  }
+
+  EXPECT_EQ(peak(nullptr, 0), 0.0f);
+}
+
+TEST(AudioSilenceTests, PeakIgnoresNaN) {
+  std::vector<float> samples(64, 0.25f);
+  samples[3] = std::numeric_limits<float>::quiet_NaN();
+  samples[63] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_FLOAT_EQ(peak(samples.data(), samples.size()), 0.25f);
+}
+
+TEST(AudioSilenceTests, OnlyDigitalSilenceIsSilent) {
+  std::vector<float> samples(480, 0.0f);
+  EXPECT_TRUE(is_silent(samples.data(), samples.size()));
+
+  // Below half a 16-bit step still rounds to zero
+  samples[100] = SILENCE_PEAK / 2;
+  EXPECT_TRUE(is_silent(samples.data(), samples.size()));
+
+  // A single 16-bit step is sound
+  samples[100] = 1.0f / 32768;
+  EXPECT_FALSE(is_silent(samples.data(), samples.size()));
+}
+
+TEST(AudioSilenceTests, ComfortStartsOnBlockAfterHangover) {
+  gate_t gate {4, 6};
+
+  std::vector<bool> comfort;
+  std::vector<bool> entered;
+  for (std::uint16_t x = 0; x < 16; ++x) {
+    comfort.push_back(gate.comfort(x, true));
+    entered.push_back(gate.entered());
+  }
+
+  // 6 silent frames are needed, so the block starting at frame 8 is the first
+  for (int x = 0; x < 16; ++x) {
+    EXPECT_EQ(comfort[x], x >= 8) << x;
+    EXPECT_EQ(entered[x], x == 8) << x;
+  }
+}
+
+TEST(AudioSilenceTests, ComfortOnlyStartsOnBlockBoundaries) {
+  gate_t gate {4, 0};
+
+  // Silence in the middle of an encoded block doesn't start comfort packets
+  EXPECT_FALSE(gate.comfort(0, false));
+  EXPECT_FALSE(gate.comfort(1, true));
+  EXPECT_FALSE(gate.comfort(2, true));
+  EXPECT_FALSE(gate.comfort(3, true));
+
+  EXPECT_TRUE(gate.comfort(4, true));
+  EXPECT_TRUE(gate.entered());
+  EXPECT_TRUE(gate.comfort(5, true));
+  EXPECT_FALSE(gate.entered());
+}
+
+TEST(AudioSilenceTests, SoundEndsComfortMidBlock) {
+  gate_t gate {4, 0};
+
+  EXPECT_TRUE(gate.comfort(0, true));
+  EXPECT_TRUE(gate.comfort(1, true));
+
+  // The onset is encoded, along with the silence after it until the next block
+  EXPECT_FALSE(gate.comfort(2, false));
+  EXPECT_FALSE(gate.comfort(3, true));
+
+  EXPECT_TRUE(gate.comfort(4, true));
+  EXPECT_TRUE(gate.entered());
+}
+
+TEST(AudioSilenceTests, SoundRestartsHangover) {
+  gate_t gate {4, 4};
+
+  std::uint16_t sequence = 0;
+  for (int x = 0; x < 7; ++x) {
+    gate.comfort(sequence++, true);
+  }
+  gate.comfort(sequence++, false);
+
+  // Frame 8 follows a single sound frame, so it is encoded
+  EXPECT_FALSE(gate.comfort(sequence++, true));
+  for (int x = 0; x < 3; ++x) {
+    EXPECT_FALSE(gate.comfort(sequence++, true));
+  }
+
+  // Frame 12 follows 4 silent frames
+  EXPECT_TRUE(gate.comfort(sequence++, true));
+}
+
+TEST(AudioSilenceTests, BlocksFollowSequenceNumbersAcrossWraparound) {
+  gate_t gate {4, 0};
+
+  // 65536 is a whole number of blocks, so wrapping around doesn't move them
+  std::uint16_t sequence = 65534;
+  EXPECT_FALSE(gate.comfort(sequence++, false));
+  EXPECT_FALSE(gate.comfort(sequence++, true));
+  EXPECT_TRUE(gate.comfort(sequence++, true));
+  EXPECT_TRUE(gate.entered());
+  EXPECT_EQ(sequence, 1);
+}
+
+TEST(AudioSilenceTests, DroppedPacketsLeaveBlocksWhole) {
+  // Clients size each FEC block from its first packet, so a block mixing comfort and encoded
+  // packets disables their audio FEC. Pretend comfort packets are 1 byte and encoded ones 2.
+  using packet_t = std::pair<std::uint16_t, int>;
+
+  gate_t gate {4, 2};
+  safe::ring_queue_t<packet_t> queue {8, safe::drop_e::oldest};
+
+  // Silence starts at frame 10, and the broadcast stalls for 9 frames just before comfort
+  // packets start at frame 12, so the queue drops frame 5
+  std::uint16_t sequence = 0;
+  std::vector<packet_t> sent;
+  for (int x = 0; x < 24; ++x) {
+    queue.raise(sequence, gate.comfort(sequence, x >= 10) ? 1 : 2);
+    ++sequence;
+
+    if (x < 5 || x > 12) {
+      while (queue.peek()) {
+        sent.push_back(*queue.pop());
+      }
+    }
+  }
+  ASSERT_EQ(queue.dropped(), 1u);
+  ASSERT_EQ(sent.size(), 23u);
+  EXPECT_EQ(sent[5].first, 6);
+
+  auto mixed_blocks = [](const std::vector<packet_t> &packets, auto sequence_of) {
+    std::map<int, std::set<int>> block_sizes;
+    for (std::size_t x = 0; x < packets.size(); ++x) {
+      block_sizes[sequence_of(x) / 4].insert(packets[x].second);
+    }
+    return std::count_if(block_sizes.begin(), block_sizes.end(), [](auto &block) {
+      return block.second.size() > 1;
+    });
+  };
+
+  // Sent with the numbers they were encoded with, every block keeps one size
+  EXPECT_EQ(mixed_blocks(sent, [&](std::size_t x) {
+              return (int) sent[x].first;
+            }),
+            0);
+
+  // Numbered as they reach the broadcast, the packets after the drop shift into the block before
+  EXPECT_GT(mixed_blocks(sent, [](std::size_t x) {
+              return (int) x;
+            }),
+            0);
+
+  EXPECT_EQ(sent.front().second, 2);
+  EXPECT_EQ(sent.back().second, 1);
+}
@@ -0,0 +1,175 @@
+/**
+ * @file tests/unit/test_crypto.cpp
+ * @brief Test src/crypto.*
+ */
+
+#include "../tests_common.h"
+#include "src/crypto.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+  // Video shards are 1392 bytes at the default packet size, sent after a 32 byte header
+  constexpr std::size_t header_size = 32;
+  constexpr std::size_t payload_size = 1392;
+
+  crypto::aes_t test_key() {
+    crypto::aes_t key(16);
+    for (std::size_t i = 0; i < key.size(); ++i) {
+      key[i] = (std::uint8_t) (i * 7 + 1);
+    }
+    return key;
+  }
+
+  std::string test_plaintext(std::size_t size, int seed) {
+    std::string plaintext(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+      plaintext[i] = (char) ((i * 31 + seed) & 0xFF);
+    }
+    return plaintext;
+  }
+
+  struct shard_buffers_t {
+    std::string header;
+    std::string payload;
+    std::vector<std::uint8_t> payload_cipher;
+    std::array<std::uint8_t, crypto::cipher::tag_size> tag {};
+    std::array<std::uint8_t, 12> iv {};
+  };
+
+  std::vector<shard_buffers_t> make_shards(std::size_t count) {
+    std::vector<shard_buffers_t> shards(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      shards[i].header = test_plaintext(header_size, (int) i);
+      shards[i].payload = test_plaintext(payload_size, (int) i + 100);
+      shards[i].payload_cipher.resize(payload_size);
+    }
+    return shards;
+  }
+
+  std::vector<crypto::cipher::gcm_t::batch_item_t> make_batch(std::vector<shard_buffers_t> &shards) {
+    std::vector<crypto::cipher::gcm_t::batch_item_t> batch;
+    for (auto &shard : shards) {
+      batch.push_back({
+        shard.header,
+        (std::uint8_t *) shard.header.data(),
+        shard.payload,
+        shard.payload_cipher.data(),
+        shard.tag.data(),
+        shard.iv.data(),
+      });
+    }
+    return batch;
+  }
+}  // namespace
+
+TEST(GcmBatchTests, MatchesSingleMessageEncryption) {
+  auto shards = make_shards(8);
+  auto batch = make_batch(shards);
+
+  crypto::cipher::gcm_t batch_cipher {test_key(), false};
+  std::uint64_t counter = 41;
+  ASSERT_EQ(batch_cipher.encrypt_batch(batch.data(), batch.size(), counter, 'V'), 0);
+  EXPECT_EQ(counter, 49u);
+
+  crypto::cipher::gcm_t single_cipher {test_key(), false};
+  for (std::size_t i = 0; i < shards.size(); ++i) {
+    crypto::aes_t iv(12);
+    std::uint64_t expected_counter = 41 + i;
+    std::memcpy(iv.data(), &expected_counter, sizeof(expected_counter));
+    iv[11] = 'V';
+    EXPECT_TRUE(std::equal(std::begin(iv), std::end(iv), std::begin(shards[i].iv))) << i;
+
+    auto plaintext = test_plaintext(header_size, (int) i) + test_plaintext(payload_size, (int) i + 100);
+    std::vector<std::uint8_t> cipher(plaintext.size());
+    std::array<std::uint8_t, crypto::cipher::tag_size> tag {};
+    ASSERT_EQ(single_cipher.encrypt(plaintext, tag.data(), cipher.data(), &iv), (int) plaintext.size());
+
+    EXPECT_EQ(0, std::memcmp(cipher.data(), shards[i].header.data(), header_size)) << i;
+    EXPECT_EQ(0, std::memcmp(cipher.data() + header_size, shards[i].payload_cipher.data(), payload_size)) << i;
+    EXPECT_EQ(tag, shards[i].tag) << i;
+  }
+}
+
+TEST(GcmBatchTests, BatchDecryptsWithReportedIv) {
+  auto shards = make_shards(3);
+  auto batch = make_batch(shards);
+
+  crypto::cipher::gcm_t cipher {test_key(), false};
+  std::uint64_t counter = 0;
+  ASSERT_EQ(cipher.encrypt_batch(batch.data(), batch.size(), counter, 'V'), 0);
+
+  for (std::size_t i = 0; i < shards.size(); ++i) {
+    std::string tagged_cipher {(char *) shards[i].tag.data(), shards[i].tag.size()};
+    tagged_cipher += shards[i].header;
+    tagged_cipher.append((char *) shards[i].payload_cipher.data(), payload_size);
+
+    crypto::aes_t iv {std::begin(shards[i].iv), std::end(shards[i].iv)};
+    std::vector<std::uint8_t> plaintext;
+    ASSERT_EQ(cipher.decrypt(tagged_cipher, plaintext, &iv), 0) << i;
+
+    auto expected = test_plaintext(header_size, (int) i) + test_plaintext(payload_size, (int) i + 100);
+    EXPECT_EQ(std::string((char *) plaintext.data(), plaintext.size()), expected) << i;
+  }
+}
+
+TEST(GcmBatchTests, EncryptsInPlace) {
+  auto shards = make_shards(2);
+  auto in_place = make_shards(2);
+  auto batch = make_batch(shards);
+  auto in_place_batch = make_batch(in_place);
+  for (auto &item : in_place_batch) {
+    item.body_cipher = (std::uint8_t *) item.body.data();
+  }
+
+  crypto::cipher::gcm_t cipher {test_key(), false};
+  std::uint64_t counter = 0;
+  ASSERT_EQ(cipher.encrypt_batch(batch.data(), batch.size(), counter, 'V'), 0);
+  counter = 0;
+  ASSERT_EQ(cipher.encrypt_batch(in_place_batch.data(), in_place_batch.size(), counter, 'V'), 0);
+
+  for (std::size_t i = 0; i < shards.size(); ++i) {
+    EXPECT_EQ(0, std::memcmp(in_place[i].payload.data(), shards[i].payload_cipher.data(), payload_size)) << i;
+    EXPECT_EQ(in_place[i].tag, shards[i].tag) << i;
+  }
+}
+
+TEST(GcmBatchTests, DISABLED_ShardThroughputBenchmark) {
+  constexpr std::size_t shards_per_frame = 64;
+  constexpr int frames = 2000;
+
+  auto shards = make_shards(shards_per_frame);
+  auto batch = make_batch(shards);
+
+  crypto::cipher::gcm_t single_cipher {test_key(), false};
+  crypto::aes_t iv(12);
+  std::uint64_t counter = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (auto &item : batch) {
+      std::memcpy(iv.data(), &counter, sizeof(counter));
+      iv[11] = 'V';
+      ++counter;
+      single_cipher.encrypt(item.head, item.head_cipher, item.body, item.body_cipher, item.tag, &iv);
+    }
+  }
+  std::chrono::duration<double> single_elapsed = std::chrono::steady_clock::now() - start;
+
+  crypto::cipher::gcm_t batch_cipher {test_key(), false};
+  counter = 0;
+  start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    batch_cipher.encrypt_batch(batch.data(), batch.size(), counter, 'V');
+  }
+  std::chrono::duration<double> batch_elapsed = std::chrono::steady_clock::now() - start;
+
+  const double total_shards = (double) shards_per_frame * frames;
+  std::cout << "AES-GCM " << payload_size << " byte shards: "
+            << total_shards / single_elapsed.count() << " shards/s per call, "
+            << total_shards / batch_elapsed.count() << " shards/s batched" << std::endl;
+  EXPECT_GT(batch_elapsed.count(), 0.0);
+}
@@ -0,0 +1,192 @@
+/**
+ * @file tests/unit/test_fec_controller.cpp
+ * @brief Test src/fec_controller.*
+ */
+
+#include "../tests_common.h"
+#include "src/fec_controller.h"
+#include "src/rs_cache.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std::literals;
+
+namespace {
+  constexpr auto report_interval = 50ms;
+  constexpr std::uint64_t packets_per_report = 200;
+  constexpr std::int64_t frames_per_report = 3;
+
+  // Plays the client side of IDX_LOSS_STATS: a report every 50 ms, after which the
+  // client has either completed every frame sent so far or none of the new ones
+  struct client_t {
+    stream::fec_controller_t &controller;
+    std::uint64_t packets_sent = 0;
+    std::int64_t frame = 0;
+    std::int64_t good_frame = 0;
+
+    void report(std::int64_t lost, bool frames_complete = true) {
+      packets_sent += packets_per_report;
+      frame += frames_per_report;
+      if (frames_complete) {
+        good_frame = frame;
+      }
+      controller.on_loss_report(lost, report_interval, good_frame, packets_sent, frame);
+    }
+
+    void clean_for(std::chrono::milliseconds duration) {
+      for (auto t = 0ms; t < duration; t += report_interval) {
+        report(0);
+      }
+    }
+  };
+}  // namespace
+
+TEST(FecControllerTests, EqualBoundsKeepPercentageFixed) {
+  stream::fec_controller_t controller {20, 20, 20};
+  client_t client {controller};
+
+  client.report(40);
+  controller.on_recovery_request();
+  client.report(40);
+  EXPECT_EQ(controller.percentage(), 20);
+}
+
+TEST(FecControllerTests, InitialPercentageIsClampedToBounds) {
+  EXPECT_EQ((stream::fec_controller_t {80, 10, 50}.percentage()), 50);
+  EXPECT_EQ((stream::fec_controller_t {5, 10, 50}.percentage()), 10);
+  EXPECT_EQ((stream::fec_controller_t {20, 30, 10}.percentage()), 30);
+}
+
+TEST(FecControllerTests, LossRaisesParityOnTheNextReport) {
+  stream::fec_controller_t controller {10, 10, 60};
+  client_t client {controller};
+
+  client.clean_for(1s);
+  EXPECT_EQ(controller.percentage(), 10);
+
+  // 10 of 200 packets is about 5% loss, which needs more than 15 extra points
+  client.report(10);
+  EXPECT_GE(controller.percentage(), 25);
+  EXPECT_LE(controller.percentage(), 30);
+  EXPECT_EQ(controller.percentage() % 5, 0);
+}
+
+TEST(FecControllerTests, ParityHoldsThenFallsBackOnCleanLinks) {
+  stream::fec_controller_t controller {10, 10, 60};
+  client_t client {controller};
+
+  client.report(10);
+  const auto raised = controller.percentage();
+  ASSERT_GT(raised, 10);
+
+  client.clean_for(1900ms);
+  EXPECT_EQ(controller.percentage(), raised);
+
+  client.clean_for(1s);
+  EXPECT_LT(controller.percentage(), raised);
+  EXPECT_GT(controller.percentage(), 10);
+
+  client.clean_for(5s);
+  EXPECT_EQ(controller.percentage(), 10);
+}
+
+TEST(FecControllerTests, RecoveryRequestsAddParity) {
+  stream::fec_controller_t controller {10, 10, 60};
+  client_t client {controller};
+
+  controller.on_recovery_request();
+  controller.on_recovery_request();
+  client.report(0);
+  EXPECT_EQ(controller.percentage(), 20);
+
+  controller.on_recovery_request();
+  client.report(0);
+  EXPECT_EQ(controller.percentage(), 30);
+}
+
+TEST(FecControllerTests, StalledFramesAddParityOnce) {
+  stream::fec_controller_t controller {10, 10, 60};
+  client_t client {controller};
+
+  client.report(0);
+  client.report(0, false);
+  client.report(0, false);
+  client.report(0, false);
+  EXPECT_EQ(controller.percentage(), 20);
+
+  client.report(0);
+  EXPECT_EQ(controller.percentage(), 20);
+}
+
+TEST(FecControllerTests, TicksDriveControllerWithoutLossReports) {
+  stream::fec_controller_t controller {10, 10, 60};
+  client_t client {controller};
+
+  // Ticks defer to loss reports while they keep arriving
+  controller.on_recovery_request();
+  controller.tick(100ms);
+  EXPECT_EQ(controller.percentage(), 10);
+  client.report(0);
+  EXPECT_EQ(controller.percentage(), 20);
+
+  controller.on_recovery_request();
+  for (int i = 0; i < 3; ++i) {
+    controller.tick(100ms);
+  }
+  EXPECT_EQ(controller.percentage(), 30);
+
+  for (int i = 0; i < 100; ++i) {
+    controller.tick(100ms);
+  }
+  EXPECT_EQ(controller.percentage(), 10);
+}
+
+TEST(FecControllerTests, LossTraceStaysWithinBounds) {
+  stream::fec_controller_t controller {20, 15, 40};
+  client_t client {controller};
+
+  // Clean, a burst of heavy loss with key frame requests, then clean again
+  int highest = 0;
+  int lowest = 255;
+  auto track = [&]() {
+    highest = std::max(highest, controller.percentage());
+    lowest = std::min(lowest, controller.percentage());
+  };
+  for (int i = 0; i < 40; ++i) {
+    client.report(0);
+    track();
+  }
+  for (int i = 0; i < 40; ++i) {
+    if (i % 4 == 0) {
+      controller.on_recovery_request();
+    }
+    client.report(60, i % 2 == 0);
+    track();
+  }
+  EXPECT_EQ(controller.percentage(), 40);
+  for (int i = 0; i < 200; ++i) {
+    client.report(0);
+    track();
+  }
+
+  EXPECT_EQ(highest, 40);
+  EXPECT_EQ(lowest, 15);
+  EXPECT_EQ(controller.percentage(), 15);
+}
+
+TEST(FecControllerTests, FramePercentageFitsProtocolLimit) {
+  EXPECT_EQ(stream::frame_fec_percentage(20, 0), 20);
+  EXPECT_EQ(stream::frame_fec_percentage(20, 100), 20);
+  EXPECT_EQ(stream::frame_fec_percentage(255, 400), 155);
+
+  // Reduced frames get the most parity that still fits in 4 blocks
+  for (std::size_t shards : {700u, 850u, 900u, 1000u, 1020u}) {
+    auto percentage = stream::frame_fec_percentage(50, shards);
+    EXPECT_LT(percentage, 50) << shards;
+    EXPECT_GE(fec::max_data_shards_per_block(percentage) * stream::MAX_FEC_BLOCKS, shards) << shards;
+    EXPECT_LT(fec::max_data_shards_per_block(percentage + 1) * stream::MAX_FEC_BLOCKS, shards) << shards;
+  }
+
+  EXPECT_EQ(stream::frame_fec_percentage(20, 1021), 0);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file tests/unit/test_ping_table.cpp
+ * @brief Test src/ping_table.h
+ */
+
+#include "../tests_common.h"
+#include "src/ping_table.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace {
+  std::string payload(int i) {
+    auto hex = std::to_string(i);
+    return std::string(16 - hex.size(), '0') + hex;
+  }
+}  // namespace
+
+TEST(PingTableTests, FindsPayloadsAndAddresses) {
+  stream::ping_table_t<int> table;
+
+  table.insert_or_assign(stream::ping_key_t::from_payload("0123456789abcdef"), 1);
+  table.insert_or_assign(stream::ping_key_t::from_address(boost::asio::ip::make_address("192.168.1.20")), 2);
+  EXPECT_EQ(table.size(), 2u);
+
+  auto found = table.find(stream::ping_key_t::from_payload("0123456789abcdef"));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(*found, 1);
+
+  found = table.find(stream::ping_key_t::from_address(boost::asio::ip::make_address("192.168.1.20")));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(*found, 2);
+
+  EXPECT_EQ(table.find(stream::ping_key_t::from_payload("0123456789abcdee")), nullptr);
+  EXPECT_EQ(table.find(stream::ping_key_t::from_address(boost::asio::ip::make_address("192.168.1.21"))), nullptr);
+}
+
+TEST(PingTableTests, MappedAddressesMatchTheirIpv4Form) {
+  stream::ping_table_t<int> table;
+
+  table.insert_or_assign(stream::ping_key_t::from_address(boost::asio::ip::make_address("10.0.0.5")), 1);
+  EXPECT_NE(table.find(stream::ping_key_t::from_address(boost::asio::ip::make_address("::ffff:10.0.0.5"))), nullptr);
+}
+
+TEST(PingTableTests, PayloadsAndAddressesDoNotCollide) {
+  stream::ping_table_t<int> table;
+
+  // The same 16 bytes as a payload and as an IPv6 address are different keys
+  auto address = boost::asio::ip::make_address("3031:3233:3435:3637:3839:6162:6364:6566");
+  table.insert_or_assign(stream::ping_key_t::from_address(address), 1);
+  EXPECT_EQ(table.find(stream::ping_key_t::from_payload("0123456789abcdef")), nullptr);
+}
+
+TEST(PingTableTests, AssignReplacesValue) {
+  stream::ping_table_t<int> table;
+
+  table.insert_or_assign(stream::ping_key_t::from_payload(payload(1)), 1);
+  table.insert_or_assign(stream::ping_key_t::from_payload(payload(1)), 5);
+  EXPECT_EQ(table.size(), 1u);
+  EXPECT_EQ(*table.find(stream::ping_key_t::from_payload(payload(1))), 5);
+}
+
+TEST(PingTableTests, MatchesReferenceMapThroughChurn) {
+  stream::ping_table_t<int> table;
+  std::unordered_map<std::string, int> reference;
+
+  // Sessions come and go, so removals have to keep every other probe chain intact
+  for (int round = 0; round < 2000; ++round) {
+    auto key = payload((round * 7919) % 300);
+    if (round % 3 == 2) {
+      table.erase(stream::ping_key_t::from_payload(key));
+      reference.erase(key);
+    } else {
+      table.insert_or_assign(stream::ping_key_t::from_payload(key), round);
+      reference.insert_or_assign(key, round);
+    }
+  }
+
+  EXPECT_EQ(table.size(), reference.size());
+  for (int i = 0; i < 300; ++i) {
+    auto found = table.find(stream::ping_key_t::from_payload(payload(i)));
+    auto expected = reference.find(payload(i));
+    if (expected == reference.end()) {
+      EXPECT_EQ(found, nullptr) << i;
+    } else {
+      ASSERT_NE(found, nullptr) << i;
+      EXPECT_EQ(*found, expected->second) << i;
+    }
+  }
+}
+
+TEST(PingTableTests, EraseMissingKeyIsHarmless) {
+  stream::ping_table_t<int> table;
+
+  table.insert_or_assign(stream::ping_key_t::from_payload(payload(1)), 1);
+  table.erase(stream::ping_key_t::from_payload(payload(2)));
+  EXPECT_EQ(table.size(), 1u);
+  EXPECT_NE(table.find(stream::ping_key_t::from_payload(payload(1))), nullptr);
+}
@@ -0,0 +1,187 @@
+/**
+ * @file tests/unit/test_rs_cache.cpp
+ * @brief Test src/rs_cache.*
+ */
+
+#include "../tests_common.h"
+#include "src/rs_cache.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+  std::atomic<int> created {0};
+  std::atomic<int> released {0};
+
+  struct fake_rs_t {
+    int data_shards;
+    int parity_shards;
+  };
+
+  reed_solomon *fake_new(int data_shards, int parity_shards) {
+    if (data_shards <= 0 || parity_shards <= 0) {
+      return nullptr;
+    }
+    ++created;
+    return reinterpret_cast<reed_solomon *>(new fake_rs_t {data_shards, parity_shards});
+  }
+
+  void fake_release(reed_solomon *rs) {
+    ++released;
+    delete reinterpret_cast<fake_rs_t *>(rs);
+  }
+
+  class RsCacheTest: public ::testing::Test {
+  protected:
+    void SetUp() override {
+      created = 0;
+      released = 0;
+    }
+  };
+}  // namespace
+
+TEST_F(RsCacheTest, ReusesContextForSameGeometry) {
+  fec::rs_cache_t cache {8, fake_new, fake_release};
+
+  auto first = cache.get(10, 2);
+  auto second = cache.get(10, 2);
+
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(created, 1);
+  EXPECT_EQ(cache.hits(), 1u);
+  EXPECT_EQ(cache.misses(), 1u);
+}
+
+TEST_F(RsCacheTest, KeysOnBothDataAndParity) {
+  fec::rs_cache_t cache {8, fake_new, fake_release};
+
+  auto a = cache.get(10, 2);
+  auto b = cache.get(10, 3);
+  auto c = cache.get(11, 2);
+
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(cache.size(), 3u);
+}
+
+TEST_F(RsCacheTest, EvictsLeastRecentlyUsed) {
+  fec::rs_cache_t cache {2, fake_new, fake_release};
+
+  cache.get(1, 1);
+  cache.get(2, 1);
+  cache.get(1, 1);  // refresh (1, 1)
+  cache.get(3, 1);  // evicts (2, 1)
+
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_EQ(released, 1);
+
+  cache.get(1, 1);
+  EXPECT_EQ(created, 3);
+  cache.get(2, 1);
+  EXPECT_EQ(created, 4);
+}
+
+TEST_F(RsCacheTest, FullCacheFindsEveryGeometryItHolds) {
+  fec::rs_cache_t cache {256, fake_new, fake_release};
+
+  for (int data_shards = 1; data_shards <= 300; ++data_shards) {
+    cache.get(data_shards, 1 + data_shards % 3);
+  }
+  EXPECT_EQ(cache.size(), 256u);
+  EXPECT_EQ(released, 300 - 256);
+
+  // The 256 most recent geometries are all hits, the evicted ones are rebuilt
+  for (int data_shards = 45; data_shards <= 300; ++data_shards) {
+    cache.get(data_shards, 1 + data_shards % 3);
+  }
+  EXPECT_EQ(cache.hits(), 256u);
+  cache.get(1, 2);
+  EXPECT_EQ(created, 301);
+  EXPECT_EQ(cache.size(), 256u);
+}
+
+TEST_F(RsCacheTest, EvictedContextOutlivesCacheEntryWhileInUse) {
+  fec::rs_cache_t cache {1, fake_new, fake_release};
+
+  auto held = cache.get(4, 1);
+  cache.get(5, 1);
+
+  EXPECT_EQ(released, 0);
+  EXPECT_EQ(reinterpret_cast<fake_rs_t *>(held.get())->data_shards, 4);
+  held.reset();
+  EXPECT_EQ(released, 1);
+}
+
+TEST_F(RsCacheTest, RejectedGeometryIsNotCached) {
+  fec::rs_cache_t cache {4, fake_new, fake_release};
+
+  EXPECT_EQ(cache.get(0, 1), nullptr);
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(RsCacheTest, ConcurrentLookupsShareOneContext) {
+  fec::rs_cache_t cache {16, fake_new, fake_release};
+  auto expected = cache.get(20, 4);
+
+  std::vector<std::thread> threads;
+  std::atomic<int> mismatches {0};
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 1000; ++i) {
+        if (cache.get(20, 4) != expected) {
+          ++mismatches;
+        }
+        cache.get(1 + i % 8, 1);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(mismatches, 0);
+  EXPECT_LE(cache.size(), 16u);
+}
+
+TEST(RsCacheGeometryTest, AppliesParityMinimum) {
+  auto geometry = fec::video_shard_geometry(4, 20, 2);
+  EXPECT_EQ(geometry.parity_shards, 2u);
+  EXPECT_EQ(geometry.percentage, 50u);
+
+  geometry = fec::video_shard_geometry(100, 20, 2);
+  EXPECT_EQ(geometry.parity_shards, 20u);
+  EXPECT_EQ(geometry.percentage, 20u);
+
+  geometry = fec::video_shard_geometry(4, 0, 2);
+  EXPECT_EQ(geometry.parity_shards, 0u);
+}
+
+TEST(RsCacheGeometryTest, MaxDataShardsFitProtocolLimit) {
+  for (std::size_t percentage = 1; percentage <= 255; ++percentage) {
+    auto data_shards = fec::max_data_shards_per_block(percentage);
+    auto geometry = fec::video_shard_geometry(data_shards, percentage, 0);
+    EXPECT_LE(geometry.data_shards + geometry.parity_shards, 255u) << percentage;
+  }
+}
+
+TEST(RsCacheGeometryTest, ExpectedGeometriesCoverTypicalAndFullBlocks) {
+  // 20 Mbps at 60 fps is ~41.7 KB per frame, ~30 shards of 1416 bytes
+  auto geometries = fec::expected_video_geometries(1416, 20, 2, 20000, 60);
+  ASSERT_FALSE(geometries.empty());
+
+  auto contains = [&](std::size_t data_shards) {
+    for (auto &geometry : geometries) {
+      if (geometry.data_shards == data_shards) {
+        return true;
+      }
+    }
+    return false;
+  };
+  EXPECT_TRUE(contains(30));
+  EXPECT_TRUE(contains(fec::max_data_shards_per_block(20)));
+  EXPECT_LE(geometries.size(), 33u);
+
+  EXPECT_TRUE(fec::expected_video_geometries(1416, 0, 2, 20000, 60).empty());
+}
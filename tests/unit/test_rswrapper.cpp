@@ -8,6 +8,12 @@ extern "C" {
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <src/rs_cache.h>
+
 TEST(ReedSolomonWrapperTests, InitTest) {
   reed_solomon_init();
 
@@ -34,3 +40,72 @@ TEST(ReedSolomonWrapperTests, EncodeTest) {
 
   reed_solomon_release(rs);
 }
+
+namespace {
+  /**
+   * @brief Average time to FEC-encode one frame split the way the video stream splits it.
+   * @param cached Reuse contexts from an rs_cache_t instead of building one per block.
+   */
+  double fec_frame_time_us(std::size_t frame_bytes, bool cached) {
+    constexpr std::size_t blocksize = 1416;  // 1400-byte packets plus the max RTP header
+    constexpr std::size_t fec_percentage = 20;
+    constexpr int iterations = 200;
+
+    fec::rs_cache_t cache {256, reed_solomon_new, reed_solomon_release};
+
+    const auto total_shards = (frame_bytes + blocksize - 1) / blocksize;
+    const auto max_block = fec::max_data_shards_per_block(fec_percentage);
+    const auto blocks = (total_shards + max_block - 1) / max_block;
+    const auto data_per_block = (total_shards + blocks - 1) / blocks;
+    const auto geometry = fec::video_shard_geometry(data_per_block, fec_percentage, 2);
+
+    std::vector<uint8_t> storage((geometry.data_shards + geometry.parity_shards) * blocksize, 0x5A);
+    std::vector<uint8_t *> shards;
+    for (std::size_t x = 0; x < geometry.data_shards + geometry.parity_shards; ++x) {
+      shards.push_back(&storage[x * blocksize]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      for (std::size_t block = 0; block < blocks; ++block) {
+        const auto nr_shards = (int) (geometry.data_shards + geometry.parity_shards);
+        if (cached) {
+          auto rs = cache.get((int) geometry.data_shards, (int) geometry.parity_shards);
+          reed_solomon_encode(rs.get(), shards.data(), nr_shards, (int) blocksize);
+        } else {
+          auto rs = reed_solomon_new((int) geometry.data_shards, (int) geometry.parity_shards);
+          reed_solomon_encode(rs, shards.data(), nr_shards, (int) blocksize);
+          reed_solomon_release(rs);
+        }
+      }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+  }
+}  // namespace
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(ReedSolomonWrapperTests, DISABLED_CachedContextFrameBenchmark) {
+  reed_solomon_init();
+
+  struct frame_case_t {
+    const char *name;
+    std::size_t frame_bytes;
+  };
+
+  // Average frames at 20 Mbps 1080p60 and 80 Mbps 4K60, and IDR-sized frames for each
+  const frame_case_t cases[] = {
+    {"1080p P-frame", 20'000'000 / 8 / 60},
+    {"1080p IDR", 250'000},
+    {"4K P-frame", 80'000'000 / 8 / 60},
+    {"4K IDR", 1'000'000},
+  };
+
+  for (const auto &frame : cases) {
+    const auto uncached = fec_frame_time_us(frame.frame_bytes, false);
+    const auto cached = fec_frame_time_us(frame.frame_bytes, true);
+    std::cout << frame.name << " (" << frame.frame_bytes << " bytes): "
+              << uncached << " us/frame uncached, " << cached << " us/frame cached" << std::endl;
+    EXPECT_GT(uncached, 0.0);
+  }
+}
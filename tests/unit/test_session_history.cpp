@@ -11,7 +11,7 @@
 #include <string>
 
 namespace {
-  constexpr int schema_version = 7;
+  constexpr int schema_version = 8;
 
   bool exec_sql(sqlite3 *db, const char *sql) {
     return sqlite3_exec(db, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
@@ -347,6 +347,7 @@ TEST(SessionHistoryStorage, SampleRoundTripPreservesMetricsAndHostTelemetry) {
   const std::string uuid = "sample-metrics";
   auto row = sample(uuid, 5.0, 42);
   row.encode_latency_ms = 7.5;
+  row.fec_percentage = 35;
   row.actual_bitrate_kbps = 12345.0;
   row.host_cpu_percent = 12.5;
   row.host_gpu_temp_c = 78.25;
@@ -357,6 +358,7 @@ TEST(SessionHistoryStorage, SampleRoundTripPreservesMetricsAndHostTelemetry) {
   ASSERT_EQ(detail->samples.size(), 1u);
   EXPECT_EQ(detail->samples[0].frames_sent, 42u);
   EXPECT_DOUBLE_EQ(detail->samples[0].encode_latency_ms, 7.5);
+  EXPECT_EQ(detail->samples[0].fec_percentage, 35);
   EXPECT_DOUBLE_EQ(detail->samples[0].actual_bitrate_kbps, 12345.0);
   EXPECT_DOUBLE_EQ(detail->samples[0].host_cpu_percent, 12.5);
   EXPECT_DOUBLE_EQ(detail->samples[0].host_gpu_temp_c, 78.25);
@@ -470,6 +472,7 @@ TEST(SessionHistoryStorage, LegacyChildTablesAreRebuiltWithDeleteCascade) {
   ASSERT_TRUE(session_history::storage::apply_schema_and_migrations(db.get(), schema_version));
   EXPECT_TRUE(foreign_key_has_delete_cascade(db.get(), "samples"));
   EXPECT_TRUE(foreign_key_has_delete_cascade(db.get(), "events"));
+  EXPECT_TRUE(column_exists(db.get(), "samples", "fec_percentage"));
 }
 
 TEST(SessionHistoryStorage, PruningCascadesChildrenForExpiredSessions) {
@@ -0,0 +1,308 @@
+/**
+ * @file tests/unit/test_task_pool.cpp
+ * @brief Test src/task_pool.h and src/timer_wheel.h
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/task_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+  using wheel_t = task_pool_util::timer_wheel_t<int, int>;
+  using wheel_clock_t = wheel_t::clock;
+
+  // Runs a TaskPool the way thread_pool_util::ThreadPool does, without its platform dependencies
+  class test_pool_t: public task_pool_util::TaskPool {
+  public:
+    explicit test_pool_t(std::size_t workers):
+        TaskPool(workers) {
+      for (std::size_t x = 0; x < workers; ++x) {
+        threads.emplace_back([this, x]() {
+          bind_worker(x);
+          while (running) {
+            if (auto task = popFor(x)) {
+              (*task)->run();
+            } else {
+              std::this_thread::yield();
+            }
+          }
+        });
+      }
+    }
+
+    ~test_pool_t() {
+      running = false;
+      for (auto &thread : threads) {
+        thread.join();
+      }
+    }
+
+  private:
+    std::atomic<bool> running {true};
+    std::vector<std::thread> threads;
+  };
+}  // namespace
+
+TEST(TimerWheelTests, ValueIsDueAtItsDeadline) {
+  auto start = wheel_clock_t::now();
+  wheel_t wheel {start};
+
+  wheel.insert(1, start + 5500us, 10);
+  EXPECT_FALSE(wheel.pop(start + 5ms));
+  EXPECT_FALSE(wheel.ready(start + 5499us));
+  EXPECT_TRUE(wheel.ready(start + 5500us));
+
+  auto value = wheel.pop(start + 6ms);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(value->second, 10);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTests, EraseAndRescheduleFindValueByKey) {
+  auto start = wheel_clock_t::now();
+  wheel_t wheel {start};
+
+  wheel.insert(1, start + 1s, 10);
+  wheel.insert(2, start + 2s, 20);
+  wheel.insert(3, start + 3h, 30);
+
+  EXPECT_TRUE(wheel.reschedule(3, start + 1ms));
+  EXPECT_FALSE(wheel.reschedule(4, start));
+
+  auto erased = wheel.erase(1);
+  ASSERT_TRUE(erased);
+  EXPECT_EQ(erased->second, 10);
+  EXPECT_FALSE(wheel.erase(1));
+
+  auto value = wheel.pop(start + 1ms);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(value->second, 30);
+  EXPECT_FALSE(wheel.pop(start + 1999ms));
+  EXPECT_EQ(wheel.size(), 1u);
+}
+
+TEST(TimerWheelTests, DeadlinesBeyondTheWheelStillFire) {
+  auto start = wheel_clock_t::now();
+  wheel_t wheel {start};
+
+  // Past the 4.6 hour span of the top level
+  wheel.insert(1, start + 26h, 1);
+  EXPECT_FALSE(wheel.pop(start + 25h));
+  EXPECT_FALSE(wheel.pop(start + 26h - 1ms));
+  EXPECT_TRUE(wheel.pop(start + 26h));
+}
+
+class TimerWheelRandomTests: public testing::TestWithParam<unsigned> {};
+
+TEST_P(TimerWheelRandomTests, MatchesReference) {
+  auto start = wheel_clock_t::now();
+  wheel_t wheel {start};
+  std::map<int, wheel_clock_t::time_point> reference;
+
+  std::mt19937 random {GetParam()};
+  auto now = start;
+  auto pick_delay = [&]() -> wheel_clock_t::duration {
+    switch (random() % 4) {
+      case 0:
+        return std::chrono::microseconds(random() % 3000);
+      case 1:
+        return std::chrono::milliseconds(random() % 500);
+      case 2:
+        return std::chrono::milliseconds(random() % 600000);
+      default:
+        return std::chrono::seconds(random() % 40000);
+    }
+  };
+
+  for (int step = 0; step < 20000; ++step) {
+    auto key = (int) (random() % 200);
+    switch (random() % 5) {
+      case 0:
+      case 1:
+        {
+          auto deadline = now + pick_delay();
+          wheel.insert(key, deadline, int {key});
+          reference[key] = deadline;
+          break;
+        }
+      case 2:
+        EXPECT_EQ((bool) wheel.erase(key), reference.erase(key) == 1);
+        break;
+      case 3:
+        {
+          auto deadline = now + pick_delay();
+          auto found = reference.count(key) == 1;
+          EXPECT_EQ(wheel.reschedule(key, deadline), found);
+          if (found) {
+            reference[key] = deadline;
+          }
+          break;
+        }
+      default:
+        {
+          // Never sleep past the earliest deadline, or a timer would fire late
+          auto next = wheel.next();
+          ASSERT_EQ(next.has_value(), !reference.empty());
+          if (next) {
+            auto earliest = std::min_element(reference.begin(), reference.end(), [](auto &a, auto &b) {
+              return a.second < b.second;
+            });
+            ASSERT_LE(*next, std::max(earliest->second, now)) << step;
+            now = std::max(now, *next) + pick_delay() / 8;
+          }
+
+          while (auto value = wheel.pop(now)) {
+            ASSERT_EQ(reference.count(value->second), 1u) << step;
+            EXPECT_EQ(value->first, reference[value->second]);
+            EXPECT_LE(value->first, now);
+            reference.erase(value->second);
+          }
+
+          for (auto &[id, deadline] : reference) {
+            ASSERT_GT(deadline, now) << "key " << id << " is due but wasn't popped at step " << step;
+          }
+        }
+    }
+    ASSERT_EQ(wheel.size(), reference.size());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Seeds, TimerWheelRandomTests, testing::Values(1u, 1234u, 98765u));
+
+TEST(TaskPoolTests, SingleQueueRunsTasksInOrder) {
+  task_pool_util::TaskPool pool;
+
+  std::vector<int> order;
+  auto first = pool.push([&order]() {
+    order.push_back(1);
+    return 1;
+  });
+  pool.push([&order](int value) {
+    order.push_back(value);
+  },
+            2);
+  auto third = pool.push([&order]() {
+    order.push_back(3);
+    return 3;
+  });
+
+  while (auto task = pool.pop()) {
+    (*task)->run();
+  }
+
+  EXPECT_EQ(order, (std::vector<int> {1, 2, 3}));
+  EXPECT_EQ(first.get(), 1);
+  EXPECT_EQ(third.get(), 3);
+}
+
+TEST(TaskPoolTests, WorkerStealsFromOtherQueues) {
+  task_pool_util::TaskPool pool {4};
+
+  int ran = 0;
+  for (int x = 0; x < 8; ++x) {
+    pool.push([&ran]() {
+      ++ran;
+    });
+  }
+
+  // External pushes are spread over the queues, and queue 0 takes every one of them
+  while (auto task = pool.popFor(0)) {
+    (*task)->run();
+  }
+  EXPECT_EQ(ran, 8);
+  EXPECT_FALSE(pool.ready());
+}
+
+TEST(TaskPoolTests, DelayedTasksCanBeDelayedAndCancelled) {
+  task_pool_util::TaskPool pool;
+
+  auto soon = pool.pushDelayed([]() {
+    return 5;
+  },
+                               0ms);
+  auto later = pool.pushDelayed([]() {}, 1h);
+  auto moved = pool.pushDelayed([]() {}, 1h);
+
+  ASSERT_TRUE(pool.next());
+  EXPECT_LE(*pool.next(), std::chrono::steady_clock::now());
+
+  pool.delay(moved.task_id, 0ms);
+  EXPECT_TRUE(pool.cancel(later.task_id));
+  EXPECT_FALSE(pool.cancel(later.task_id));
+
+  int ran = 0;
+  while (auto task = pool.pop()) {
+    (*task)->run();
+    ++ran;
+  }
+  EXPECT_EQ(ran, 2);
+  EXPECT_EQ(soon.future.get(), 5);
+  EXPECT_FALSE(pool.next());
+}
+
+TEST(TaskPoolTests, TasksRunBeforeDueTimers) {
+  task_pool_util::TaskPool pool;
+
+  std::vector<int> order;
+  pool.pushDelayed([&order]() {
+    order.push_back(1);
+  },
+                   0ms);
+  pool.push([&order]() {
+    order.push_back(2);
+  });
+
+  while (auto task = pool.pop()) {
+    (*task)->run();
+  }
+  EXPECT_EQ(order, (std::vector<int> {2, 1}));
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(TaskPoolTests, DISABLED_InputBurstLatencyBenchmark) {
+  // A client flushing a burst of mouse/keyboard packets, each injected as its own task
+  constexpr int bursts = 200;
+  constexpr int burst_size = 64;
+
+  for (std::size_t workers : {1u, 2u, 4u}) {
+    test_pool_t pool {workers};
+    std::vector<std::chrono::nanoseconds> latencies(bursts * burst_size);
+    std::atomic<int> done {0};
+
+    for (int burst = 0; burst < bursts; ++burst) {
+      for (int x = 0; x < burst_size; ++x) {
+        auto index = burst * burst_size + x;
+        pool.push([&latencies, &done, index, pushed = std::chrono::steady_clock::now()]() {
+          // Stands in for the few microseconds a platform input call takes
+          auto until = std::chrono::steady_clock::now() + 5us;
+          while (std::chrono::steady_clock::now() < until) {}
+          latencies[index] = std::chrono::steady_clock::now() - pushed;
+          done.fetch_add(1, std::memory_order_release);
+        });
+      }
+
+      while (done.load(std::memory_order_acquire) < (burst + 1) * burst_size) {
+        std::this_thread::yield();
+      }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+      return std::chrono::duration<double, std::micro>(latencies[(std::size_t) (p * (latencies.size() - 1))]).count();
+    };
+    std::cout << workers << (workers == 1 ? " worker" : " workers") << ": p50 " << percentile(0.5) << " us, p99 "
+              << percentile(0.99) << " us, max " << percentile(1.0) << " us" << std::endl;
+    EXPECT_GT(percentile(1.0), 0.0);
+  }
+}
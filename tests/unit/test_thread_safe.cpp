@@ -7,6 +7,12 @@
 
 #include "src/thread_safe.h"
 
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
 TEST(MailRegistryTests, QueueLookupReplacesExpiredPost) {
   constexpr auto id = "stale_queue";
   auto mail = std::make_shared<safe::mail_raw_t>();
@@ -38,3 +44,262 @@ TEST(MailRegistryTests, EventLookupReplacesExpiredPost) {
   ASSERT_NE(replacement, nullptr);
   EXPECT_FALSE(std::weak_ptr<void> {replacement}.expired());
 }
+
+TEST(MailChannelTests, ChannelLookupSharesPost) {
+  constexpr safe::channel_t<safe::event_t<int>> channel {3, "channel"};
+  auto mail = std::make_shared<safe::mail_raw_t>();
+
+  auto first = mail->event(channel);
+  auto second = mail->event<int>(channel);
+  EXPECT_EQ(first, second);
+
+  // String ids live apart from channels
+  EXPECT_NE(std::shared_ptr<void> {mail->event<int>(channel.name)}, std::shared_ptr<void> {first});
+}
+
+TEST(MailChannelTests, ChannelLookupReplacesExpiredPost) {
+  constexpr safe::channel_t<safe::queue_t<int>> channel {0, "queue"};
+  auto mail = std::make_shared<safe::mail_raw_t>();
+
+  auto original = mail->queue(channel);
+  original->raise(1);
+  std::weak_ptr<void> stale = original;
+  original.reset();
+  ASSERT_TRUE(stale.expired());
+
+  // Cleanup released the expired slot, so nothing keeps the old post's memory
+  EXPECT_TRUE(mail->channels[0].expired());
+  EXPECT_EQ(mail->channels[0].use_count(), 0);
+
+  auto replacement = mail->queue(channel);
+  ASSERT_NE(replacement, nullptr);
+  EXPECT_FALSE(replacement->peek());
+}
+
+TEST(MailChannelTests, RingChannelUsesArgumentsOnce) {
+  constexpr safe::channel_t<safe::ring_queue_t<int>> channel {safe::mail_raw_t::max_channels - 1, "ring"};
+  auto mail = std::make_shared<safe::mail_raw_t>();
+
+  auto ring = mail->ring(channel, 2, safe::drop_e::newest);
+  auto same = mail->ring(channel, 64, safe::drop_e::oldest);
+  ASSERT_EQ(ring, same);
+
+  EXPECT_TRUE(same->raise(1));
+  EXPECT_TRUE(same->raise(2));
+  EXPECT_FALSE(same->raise(3));
+}
+
+namespace {
+  struct frame_t {
+    int index;
+    bool keyframe;
+  };
+
+  bool is_keyframe(const frame_t &frame) {
+    return frame.keyframe;
+  }
+
+  template<class Queue>
+  std::vector<int> drain(Queue &queue) {
+    std::vector<int> values;
+    while (queue.peek()) {
+      values.push_back(*queue.pop());
+    }
+    return values;
+  }
+
+  // Producers each raise items values, then a sentinel stops the consumer; returns ns per value raised
+  template<class Queue>
+  double contended_ns_per_item(Queue &queue, int producers, int items, int &received) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int x = 0; x < producers; ++x) {
+      threads.emplace_back([&queue, items]() {
+        for (int value = 0; value < items; ++value) {
+          queue.raise(value);
+        }
+      });
+    }
+
+    std::thread consumer {[&queue, &received]() {
+      while (auto value = queue.pop()) {
+        if (*value < 0) {
+          break;
+        }
+        ++received;
+      }
+    }};
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    // The newest value survives a full queue under both implementations
+    queue.raise(-1);
+    consumer.join();
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ((double) producers * items);
+  }
+}  // namespace
+
+TEST(RingQueueTests, PopsInOrder) {
+  safe::ring_queue_t<int> queue {8};
+  for (int x = 0; x < 5; ++x) {
+    EXPECT_TRUE(queue.raise(x));
+  }
+
+  EXPECT_EQ(drain(queue), (std::vector<int> {0, 1, 2, 3, 4}));
+  EXPECT_EQ(queue.dropped(), 0u);
+}
+
+TEST(RingQueueTests, DropOldestKeepsNewest) {
+  safe::ring_queue_t<int> queue {4, safe::drop_e::oldest};
+  for (int x = 0; x < 10; ++x) {
+    EXPECT_TRUE(queue.raise(x));
+  }
+
+  EXPECT_EQ(drain(queue), (std::vector<int> {6, 7, 8, 9}));
+  EXPECT_EQ(queue.dropped(), 6u);
+}
+
+TEST(RingQueueTests, DropNewestKeepsOldest) {
+  safe::ring_queue_t<int> queue {4, safe::drop_e::newest};
+  for (int x = 0; x < 10; ++x) {
+    EXPECT_EQ(queue.raise(x), x < 4);
+  }
+
+  EXPECT_EQ(drain(queue), (std::vector<int> {0, 1, 2, 3}));
+  EXPECT_EQ(queue.dropped(), 6u);
+}
+
+TEST(RingQueueTests, KeyframesEvictOldest) {
+  safe::ring_queue_t<frame_t> queue {4, safe::drop_e::keep_keyframes, is_keyframe};
+  for (int x = 0; x < 6; ++x) {
+    queue.raise(frame_t {x, false});
+  }
+  EXPECT_TRUE(queue.raise(frame_t {6, true}));
+  EXPECT_FALSE(queue.raise(frame_t {7, false}));
+
+  std::vector<int> indexes;
+  while (queue.peek()) {
+    indexes.push_back(queue.pop()->index);
+  }
+
+  // 4 and 5 were refused, 0 was evicted for the keyframe, 7 was refused
+  EXPECT_EQ(indexes, (std::vector<int> {1, 2, 3, 6}));
+  EXPECT_EQ(queue.dropped(), 4u);
+}
+
+TEST(RingQueueTests, CapacityRoundsUpToPowerOfTwo) {
+  safe::ring_queue_t<int> queue {30, safe::drop_e::newest};
+  int accepted = 0;
+  while (queue.raise(accepted)) {
+    ++accepted;
+  }
+
+  EXPECT_EQ(accepted, 32);
+}
+
+TEST(RingQueueTests, StopWakesConsumerAndRefusesValues) {
+  safe::ring_queue_t<int> queue;
+  std::thread consumer {[&queue]() {
+    EXPECT_FALSE(queue.pop());
+  }};
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  queue.stop();
+  consumer.join();
+
+  EXPECT_FALSE(queue.running());
+  EXPECT_FALSE(queue.raise(1));
+  EXPECT_FALSE(queue.peek());
+}
+
+TEST(RingQueueTests, ResetEmptiesAndRestarts) {
+  safe::ring_queue_t<int> queue {2, safe::drop_e::oldest};
+  queue.raise(1);
+  queue.raise(2);
+  queue.raise(3);
+  queue.stop();
+  queue.reset();
+
+  EXPECT_TRUE(queue.running());
+  EXPECT_FALSE(queue.peek());
+  EXPECT_EQ(queue.dropped(), 0u);
+
+  queue.raise(4);
+  EXPECT_EQ(drain(queue), (std::vector<int> {4}));
+}
+
+TEST(RingQueueTests, TimedPopWaitsForValue) {
+  safe::ring_queue_t<int> queue;
+  EXPECT_FALSE(queue.pop(std::chrono::milliseconds(0)));
+  EXPECT_FALSE(queue.pop(std::chrono::milliseconds(5)));
+
+  std::thread producer {[&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.raise(42);
+  }};
+
+  auto value = queue.pop(std::chrono::seconds(5));
+  producer.join();
+  ASSERT_TRUE(value);
+  EXPECT_EQ(*value, 42);
+}
+
+TEST(RingQueueTests, ConcurrentProducersLoseNothingUncounted) {
+  constexpr int producers = 4;
+  constexpr int items = 20000;
+  safe::ring_queue_t<std::unique_ptr<int>> queue {16, safe::drop_e::newest};
+
+  std::vector<std::thread> threads;
+  for (int x = 0; x < producers; ++x) {
+    threads.emplace_back([&queue, x]() {
+      for (int value = 0; value < items; ++value) {
+        queue.raise(std::make_unique<int>(x * items + value));
+      }
+    });
+  }
+
+  // Each producer's values arrive in the order it raised them
+  std::vector<int> last(producers, -1);
+  std::uint64_t received = 0;
+  std::thread consumer {[&]() {
+    while (auto value = queue.pop()) {
+      auto producer = *value / items;
+      EXPECT_GT(*value, last[producer]);
+      last[producer] = *value;
+      ++received;
+    }
+  }};
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  while (queue.peek()) {
+    std::this_thread::yield();
+  }
+  queue.stop();
+  consumer.join();
+
+  EXPECT_EQ(received + queue.dropped(), (std::uint64_t) producers * items);
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(RingQueueTests, DISABLED_ContentionBenchmark) {
+  constexpr int items = 200000;
+  for (int producers : {1, 2, 4, 8}) {
+    int mutex_received = 0;
+    safe::queue_t<int> mutex_queue {32};
+    auto mutex_ns = contended_ns_per_item(mutex_queue, producers, items, mutex_received);
+
+    int ring_received = 0;
+    safe::ring_queue_t<int> ring_queue {32, safe::drop_e::oldest};
+    auto ring_ns = contended_ns_per_item(ring_queue, producers, items, ring_received);
+
+    std::cout << producers << " producers, " << producers * items << " raised: queue_t " << mutex_ns << " ns/raise, "
+              << mutex_received << " received; ring_queue_t " << ring_ns << " ns/raise, " << ring_received << " received, "
+              << ring_queue.dropped() << " dropped" << std::endl;
+    EXPECT_GT(ring_received, 0);
+  }
+}
@@ -0,0 +1,194 @@
+/**
+ * @file tests/unit/test_video_change.cpp
+ * @brief Test src/video_change.cpp
+ */
+#include "../tests_common.h"
+
+#include <src/video_change.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace video::change;
+using video::convert::isa_e;
+
+namespace {
+  constexpr isa_e isas[] {isa_e::sse41, isa_e::avx2, isa_e::neon};
+
+  std::vector<std::uint8_t> random_image(int row_pitch, int height, unsigned seed) {
+    std::mt19937 rng {seed};
+    std::uniform_int_distribution<int> byte {0, 255};
+
+    std::vector<std::uint8_t> bgr0(row_pitch * height);
+    for (auto &value : bgr0) {
+      value = (std::uint8_t) byte(rng);
+    }
+    return bgr0;
+  }
+
+  int compare(detector_t &detector, const std::vector<std::uint8_t> &bgr0, int width, int height) {
+    return detector.compare(bgr0.data(), width * 4, width, height);
+  }
+}  // namespace
+
+TEST(VideoChangeTests, IdenticalImagesAreUnchanged) {
+  constexpr int width = 333;
+  constexpr int height = 201;
+  auto bgr0 = random_image(width * 4, height, 1);
+
+  detector_t detector;
+  EXPECT_EQ(compare(detector, bgr0, width, height), 24);
+  EXPECT_EQ(detector.tile_count(), 24);
+
+  // Without accept() there's still no reference
+  EXPECT_EQ(compare(detector, bgr0, width, height), 24);
+  detector.accept();
+
+  auto copy = bgr0;
+  EXPECT_EQ(compare(detector, copy, width, height), 0);
+  EXPECT_EQ(compare(detector, copy, width, height), 0);
+
+  detector.reset();
+  EXPECT_EQ(compare(detector, copy, width, height), 24);
+}
+
+TEST(VideoChangeTests, EveryPixelChangeIsDetected) {
+  constexpr int width = 83;
+  constexpr int height = 70;
+  constexpr int tile = detector_t::tile_size;
+  auto bgr0 = random_image(width * 4, height, 2);
+
+  detector_t detector;
+  compare(detector, bgr0, width, height);
+  detector.accept();
+  auto expected = detector.hashes();
+
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      auto changed = bgr0;
+      changed[(y * width + x) * 4 + (x + y) % 3] ^= 1 << ((x * 7 + y) % 8);
+
+      ASSERT_EQ(compare(detector, changed, width, height), 1) << x << ',' << y;
+      auto tile_index = (y / tile) * 2 + x / tile;
+      for (int index = 0; index < detector.tile_count(); ++index) {
+        ASSERT_EQ(detector.hashes()[index] != expected[index], index == tile_index) << x << ',' << y;
+      }
+    }
+  }
+}
+
+TEST(VideoChangeTests, MovedPixelsAreDetected) {
+  constexpr int width = 64;
+  constexpr int height = 64;
+  auto bgr0 = random_image(width * 4, height, 3);
+  auto original = hash(bgr0.data(), width * 4, width, height);
+
+  // Two stripes of a row swapped
+  auto stripes = bgr0;
+  std::swap_ranges(stripes.begin() + 32, stripes.begin() + 64, stripes.begin() + 96);
+  EXPECT_NE(hash(stripes.data(), width * 4, width, height), original);
+
+  // Two rows swapped
+  auto rows = bgr0;
+  std::swap_ranges(rows.begin(), rows.begin() + width * 4, rows.begin() + width * 4 * 5);
+  EXPECT_NE(hash(rows.data(), width * 4, width, height), original);
+
+  // The two pixels of a lane swapped
+  auto halves = bgr0;
+  std::swap_ranges(halves.begin(), halves.begin() + 4, halves.begin() + 4);
+  EXPECT_NE(hash(halves.data(), width * 4, width, height), original);
+}
+
+TEST(VideoChangeTests, UnusedByteAndPaddingAreIgnored) {
+  constexpr int width = 150;
+  constexpr int height = 90;
+  constexpr int row_pitch = width * 4 + 24;
+  auto bgr0 = random_image(row_pitch, height, 4);
+
+  detector_t detector;
+  detector.compare(bgr0.data(), row_pitch, width, height);
+  detector.accept();
+
+  auto changed = bgr0;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      changed[y * row_pitch + x * 4 + 3] ^= 0xff;
+    }
+    for (int x = width * 4; x < row_pitch; ++x) {
+      changed[y * row_pitch + x] ^= 0xff;
+    }
+  }
+
+  EXPECT_EQ(detector.compare(changed.data(), row_pitch, width, height), 0);
+}
+
+TEST(VideoChangeTests, SizeChangesAreChanges) {
+  auto bgr0 = random_image(128 * 4, 128, 5);
+
+  detector_t detector;
+  compare(detector, bgr0, 128, 128);
+  detector.accept();
+
+  EXPECT_EQ(detector.compare(bgr0.data(), 128 * 4, 128, 127), 4);
+  detector.accept();
+  EXPECT_EQ(detector.compare(bgr0.data(), 128 * 4, 128, 127), 0);
+
+  // A tile of zeros doesn't hash like a smaller one
+  std::vector<std::uint8_t> zeros(64 * 64 * 4);
+  EXPECT_NE(hash(zeros.data(), 64 * 4, 64, 64), hash(zeros.data(), 64 * 4, 63, 64));
+  EXPECT_NE(hash(zeros.data(), 64 * 4, 64, 64), hash(zeros.data(), 64 * 4, 64, 63));
+}
+
+TEST(VideoChangeTests, InstructionSetsHashLikeScalar) {
+  const std::pair<int, int> sizes[] {{1, 1}, {7, 3}, {8, 1}, {33, 17}, {64, 64}, {67, 9}};
+
+  for (auto isa : isas) {
+    if (!video::convert::isa_supported(isa)) {
+      std::cout << video::convert::isa_name(isa) << " isn't supported here" << std::endl;
+      continue;
+    }
+
+    for (auto [width, height] : sizes) {
+      auto row_pitch = width * 4 + 12;
+      auto bgr0 = random_image(row_pitch, height, width * height);
+      EXPECT_EQ(hash(bgr0.data(), row_pitch, width, height, isa), hash(bgr0.data(), row_pitch, width, height, isa_e::scalar)) << video::convert::isa_name(isa) << ' ' << width << 'x' << height;
+    }
+
+    detector_t scalar {isa_e::scalar};
+    detector_t simd {isa};
+    auto bgr0 = random_image(1366 * 4, 769, 6);
+    compare(scalar, bgr0, 1366, 769);
+    compare(simd, bgr0, 1366, 769);
+    EXPECT_EQ(simd.hashes(), scalar.hashes()) << video::convert::isa_name(isa);
+  }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(VideoChangeTests, DISABLED_CompareTimeBenchmark) {
+  constexpr int width = 1920;
+  constexpr int height = 1080;
+  auto bgr0 = random_image(width * 4, height, 7);
+
+  for (auto isa : {isa_e::scalar, isa_e::sse41, isa_e::avx2, isa_e::neon}) {
+    if (!video::convert::isa_supported(isa)) {
+      continue;
+    }
+
+    detector_t detector {isa};
+    compare(detector, bgr0, width, height);
+    detector.accept();
+
+    constexpr int frames = 200;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+      EXPECT_EQ(compare(detector, bgr0, width, height), 0);
+    }
+    auto us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    std::cout << video::convert::isa_name(isa) << " 1920x1080: " << us << " us/frame" << std::endl;
+  }
+}
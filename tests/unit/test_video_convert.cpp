@@ -0,0 +1,399 @@
+/**
+ * @file tests/unit/test_video_convert.cpp
+ * @brief Test src/video_convert.cpp
+ */
+#include "../tests_common.h"
+
+#include <src/video_convert.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace video::convert;
+
+namespace {
+  struct format_info_t {
+    format_e format;
+    const char *name;
+    int bit_depth;
+    bool subsampled;
+    bool interleaved;
+    int shift;
+  };
+
+  const format_info_t formats[] {
+    {format_e::yuv420p, "yuv420p", 8, true, false, 0},
+    {format_e::yuv420p10, "yuv420p10", 10, true, false, 0},
+    {format_e::yuv444p, "yuv444p", 8, false, false, 0},
+    {format_e::yuv444p10, "yuv444p10", 10, false, false, 0},
+    {format_e::nv12, "nv12", 8, true, true, 0},
+    {format_e::p010, "p010", 10, true, true, 6},
+  };
+
+  constexpr isa_e isas[] {isa_e::sse41, isa_e::avx2, isa_e::neon};
+
+  // Same as color_vectors_from_colorspace() with UINT output
+  matrix_t matrix_for(double Kr, double Kb, bool full_range, int bit_depth) {
+    double Kg = 1.0 - Kr - Kb;
+    double y_mult, y_add, uv_mult, uv_add;
+    if (full_range) {
+      y_mult = (1 << bit_depth) - 1;
+      y_add = 0;
+      uv_mult = (1 << bit_depth) - 1;
+      uv_add = 1 << (bit_depth - 1);
+    } else {
+      y_mult = (1 << (bit_depth - 8)) * 219;
+      y_add = (1 << (bit_depth - 8)) * 16;
+      uv_mult = (1 << (bit_depth - 8)) * 224;
+      uv_add = (1 << (bit_depth - 8)) * 128;
+    }
+    y_add += 0.5;
+    uv_add += 0.5;
+
+    return {
+      {(float) (Kr * y_mult), (float) (Kg * y_mult), (float) (Kb * y_mult), (float) y_add},
+      {(float) (-0.5 * Kr / (1.0 - Kb) * uv_mult), (float) (-0.5 * Kg / (1.0 - Kb) * uv_mult), (float) (0.5 * uv_mult), (float) uv_add},
+      {(float) (0.5 * uv_mult), (float) (-0.5 * Kg / (1.0 - Kr) * uv_mult), (float) (-0.5 * Kb / (1.0 - Kr) * uv_mult), (float) uv_add},
+    };
+  }
+
+  struct output_t {
+    int width;
+    int height;
+    format_info_t info;
+    std::vector<std::uint8_t> planes[3];
+    int linesize[3] {};
+    int heights[3] {};
+
+    output_t(const format_info_t &info, int width, int height, int padding = 0):
+        width {width},
+        height {height},
+        info {info} {
+      auto sample = info.bit_depth > 8 ? 2 : 1;
+      auto chroma_width = info.subsampled ? (width + 1) / 2 : width;
+      auto chroma_height = info.subsampled ? (height + 1) / 2 : height;
+
+      linesize[0] = width * sample + padding;
+      heights[0] = height;
+      if (info.interleaved) {
+        linesize[1] = chroma_width * 2 * sample + padding;
+        heights[1] = chroma_height;
+      } else {
+        linesize[1] = linesize[2] = chroma_width * sample + padding;
+        heights[1] = heights[2] = chroma_height;
+      }
+
+      for (int plane = 0; plane < 3; ++plane) {
+        planes[plane].assign((std::size_t) linesize[plane] * heights[plane], 0xa5);
+      }
+    }
+
+    image_t image() {
+      return {{planes[0].data(), planes[1].data(), planes[2].data()}, {linesize[0], linesize[1], linesize[2]}};
+    }
+
+    int sample(int plane, int x, int y) const {
+      auto row = planes[plane].data() + y * linesize[plane];
+      if (info.bit_depth > 8) {
+        std::uint16_t value;
+        std::memcpy(&value, row + x * 2, 2);
+        return value >> info.shift;
+      }
+      return row[x];
+    }
+
+    int u(int x, int y) const {
+      return info.interleaved ? sample(1, x * 2, y) : sample(1, x, y);
+    }
+
+    int v(int x, int y) const {
+      return info.interleaved ? sample(1, x * 2 + 1, y) : sample(2, x, y);
+    }
+  };
+
+  std::vector<std::uint8_t> random_image(int height, int row_pitch, unsigned seed) {
+    std::mt19937 random {seed};
+    std::vector<std::uint8_t> image((std::size_t) row_pitch * height);
+    for (auto &byte : image) {
+      byte = (std::uint8_t) random();
+    }
+    return image;
+  }
+
+  output_t convert(const format_info_t &info, const std::vector<std::uint8_t> &bgr0, int width, int height, int row_pitch, int threads, isa_e isa, const matrix_t &matrix) {
+    output_t out {info, width, height};
+    converter_t converter {info.format, width, height, matrix, threads, isa};
+    converter.convert(bgr0.data(), row_pitch, out.image());
+    return out;
+  }
+}  // namespace
+
+TEST(VideoConvertTests, MatchesFloatingPointWithinOne) {
+  constexpr int width = 64;
+  constexpr int height = 32;
+  auto bgr0 = random_image(height, width * 4, 1);
+
+  for (const auto &info : formats) {
+    for (bool full_range : {false, true}) {
+      auto matrix = matrix_for(0.2126, 0.0722, full_range, info.bit_depth);
+      auto out = convert(info, bgr0, width, height, width * 4, 1, isa_e::scalar, matrix);
+      auto max = (1 << info.bit_depth) - 1;
+
+      auto expected = [&](const float (&row)[4], double b, double g, double r) {
+        auto value = (row[0] * r + row[1] * g + row[2] * b) / 255.0 + row[3];
+        return std::clamp((int) std::floor(value), 0, max);
+      };
+
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          auto pixel = bgr0.data() + (y * width + x) * 4;
+          ASSERT_NEAR(out.sample(0, x, y), expected(matrix.y, pixel[0], pixel[1], pixel[2]), 1) << info.name << ' ' << x << ',' << y;
+        }
+      }
+
+      auto chroma_width = info.subsampled ? width / 2 : width;
+      auto chroma_height = info.subsampled ? height / 2 : height;
+      for (int y = 0; y < chroma_height; ++y) {
+        for (int x = 0; x < chroma_width; ++x) {
+          double sum[3] {};
+          auto size = info.subsampled ? 2 : 1;
+          for (int dy = 0; dy < size; ++dy) {
+            for (int dx = 0; dx < size; ++dx) {
+              auto pixel = bgr0.data() + ((y * size + dy) * width + x * size + dx) * 4;
+              for (int c = 0; c < 3; ++c) {
+                sum[c] += pixel[c] / (double) (size * size);
+              }
+            }
+          }
+
+          ASSERT_NEAR(out.u(x, y), expected(matrix.u, sum[0], sum[1], sum[2]), 1) << info.name << ' ' << x << ',' << y;
+          ASSERT_NEAR(out.v(x, y), expected(matrix.v, sum[0], sum[1], sum[2]), 1) << info.name << ' ' << x << ',' << y;
+        }
+      }
+    }
+  }
+}
+
+TEST(VideoConvertTests, BlackAndWhiteHitTheRangeLimits) {
+  std::vector<std::uint8_t> bgr0 {0, 0, 0, 0xff, 255, 255, 255, 0xff};
+
+  for (const auto &info : formats) {
+    auto scale = 1 << (info.bit_depth - 8);
+
+    auto limited = convert(info, bgr0, 2, 1, 8, 1, isa_e::scalar, matrix_for(0.2126, 0.0722, false, info.bit_depth));
+    EXPECT_EQ(limited.sample(0, 0, 0), 16 * scale) << info.name;
+    EXPECT_EQ(limited.sample(0, 1, 0), 235 * scale) << info.name;
+    EXPECT_EQ(limited.u(0, 0), 128 * scale) << info.name;
+    EXPECT_EQ(limited.v(0, 0), 128 * scale) << info.name;
+
+    auto full = convert(info, bgr0, 2, 1, 8, 1, isa_e::scalar, matrix_for(0.299, 0.114, true, info.bit_depth));
+    EXPECT_EQ(full.sample(0, 0, 0), 0) << info.name;
+    EXPECT_EQ(full.sample(0, 1, 0), (1 << info.bit_depth) - 1) << info.name;
+  }
+}
+
+TEST(VideoConvertTests, InstructionSetsMatchScalarExactly) {
+  const std::pair<int, int> sizes[] {{1, 1}, {2, 2}, {33, 17}, {67, 9}, {640, 360}, {1366, 768}};
+
+  for (auto isa : isas) {
+    if (!isa_supported(isa)) {
+      std::cout << isa_name(isa) << " isn't supported here" << std::endl;
+      continue;
+    }
+
+    for (const auto &info : formats) {
+      for (bool full_range : {false, true}) {
+        auto matrix = matrix_for(0.2627, 0.0593, full_range, info.bit_depth);
+        for (auto [width, height] : sizes) {
+          auto row_pitch = width * 4 + 12;
+          auto bgr0 = random_image(height, row_pitch, width * height);
+
+          auto expected = convert(info, bgr0, width, height, row_pitch, 1, isa_e::scalar, matrix);
+          auto actual = convert(info, bgr0, width, height, row_pitch, 1, isa, matrix);
+          for (int plane = 0; plane < 3; ++plane) {
+            ASSERT_EQ(actual.planes[plane], expected.planes[plane]) << isa_name(isa) << ' ' << info.name << ' ' << width << 'x' << height << " plane " << plane;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(VideoConvertTests, ThreadsProduceTheSameImage) {
+  constexpr int width = 1280;
+  constexpr int height = 721;
+  auto bgr0 = random_image(height, width * 4, 7);
+
+  for (const auto &info : formats) {
+    auto matrix = matrix_for(0.2126, 0.0722, false, info.bit_depth);
+    auto expected = convert(info, bgr0, width, height, width * 4, 1, best_isa(), matrix);
+
+    for (int threads : {2, 3, 8}) {
+      output_t actual {info, width, height};
+      converter_t converter {info.format, width, height, matrix, threads, best_isa()};
+      EXPECT_EQ(converter.threads(), threads);
+
+      // Twice, so the workers go round again
+      for (int x = 0; x < 2; ++x) {
+        converter.convert(bgr0.data(), width * 4, actual.image());
+        for (int plane = 0; plane < 3; ++plane) {
+          ASSERT_EQ(actual.planes[plane], expected.planes[plane]) << info.name << ' ' << threads << " threads, plane " << plane;
+        }
+      }
+    }
+  }
+}
+
+TEST(VideoConvertTests, LinePaddingIsUntouched) {
+  constexpr int width = 100;
+  constexpr int height = 10;
+  auto bgr0 = random_image(height, width * 4, 3);
+
+  for (const auto &info : formats) {
+    output_t out {info, width, height, 32};
+    converter_t converter {info.format, width, height, matrix_for(0.2126, 0.0722, false, info.bit_depth), 1, best_isa()};
+    converter.convert(bgr0.data(), width * 4, out.image());
+
+    for (int plane = 0; plane < 3; ++plane) {
+      for (int y = 0; y < out.heights[plane]; ++y) {
+        auto row = out.planes[plane].data() + y * out.linesize[plane];
+        for (int x = out.linesize[plane] - 32; x < out.linesize[plane]; ++x) {
+          ASSERT_EQ(row[x], 0xa5) << info.name << " plane " << plane << " row " << y;
+        }
+      }
+    }
+  }
+}
+
+TEST(VideoConvertTests, DamageConvertsOnlyTouchedTiles) {
+  constexpr int width = 333;
+  constexpr int height = 201;
+  constexpr int tile = converter_t::tile_size;
+  auto before = random_image(height, width * 4, 5);
+  auto after = random_image(height, width * 4, 6);
+
+  const std::vector<rect_t> damage {{70, 10, 5, 5}, {-20, 195, 40, 100}, {320, 120, 30, 1}, {500, 0, 10, 10}};
+
+  for (const auto &info : formats) {
+    for (int threads : {1, 4}) {
+      auto matrix = matrix_for(0.2126, 0.0722, false, info.bit_depth);
+      auto expected_before = convert(info, before, width, height, width * 4, 1, isa_e::scalar, matrix);
+      auto expected_after = convert(info, after, width, height, width * 4, 1, isa_e::scalar, matrix);
+
+      output_t actual {info, width, height};
+      converter_t converter {info.format, width, height, matrix, threads, best_isa()};
+      converter.convert(before.data(), width * 4, actual.image());
+
+      // Tiles (64, 0), (0, 192) and (320, 64)
+      EXPECT_EQ(converter.convert(after.data(), width * 4, actual.image(), damage), 3) << info.name;
+
+      auto in_damaged_tile = [&](int x, int y) {
+        auto tx = x / tile;
+        auto ty = y / tile;
+        return (tx == 1 && ty == 0) || (tx == 0 && ty == 3) || (tx == 5 && ty == 1);
+      };
+
+      auto chroma_scale = info.subsampled ? 2 : 1;
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          const auto &expected = in_damaged_tile(x, y) ? expected_after : expected_before;
+          ASSERT_EQ(actual.sample(0, x, y), expected.sample(0, x, y)) << info.name << ' ' << x << ',' << y;
+
+          if (x % chroma_scale == 0 && y % chroma_scale == 0) {
+            auto cx = x / chroma_scale;
+            auto cy = y / chroma_scale;
+            ASSERT_EQ(actual.u(cx, cy), expected.u(cx, cy)) << info.name << ' ' << x << ',' << y;
+            ASSERT_EQ(actual.v(cx, cy), expected.v(cx, cy)) << info.name << ' ' << x << ',' << y;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(VideoConvertTests, WholeImageDamageMatchesFullConversion) {
+  constexpr int width = 129;
+  constexpr int height = 67;
+  auto bgr0 = random_image(height, width * 4, 9);
+
+  for (const auto &info : formats) {
+    auto matrix = matrix_for(0.299, 0.114, true, info.bit_depth);
+    auto expected = convert(info, bgr0, width, height, width * 4, 1, isa_e::scalar, matrix);
+
+    output_t actual {info, width, height};
+    converter_t converter {info.format, width, height, matrix, 2, best_isa()};
+    EXPECT_EQ(converter.convert(bgr0.data(), width * 4, actual.image(), {{0, 0, width, height}}), converter.tile_count());
+    for (int plane = 0; plane < 3; ++plane) {
+      ASSERT_EQ(actual.planes[plane], expected.planes[plane]) << info.name << " plane " << plane;
+    }
+  }
+}
+
+TEST(VideoConvertTests, NoDamageWritesNothing) {
+  auto bgr0 = random_image(64, 256, 2);
+
+  for (const auto &info : formats) {
+    output_t out {info, 64, 64};
+    auto untouched = out.planes[0];
+
+    converter_t converter {info.format, 64, 64, matrix_for(0.2126, 0.0722, false, info.bit_depth), 1};
+    EXPECT_EQ(converter.convert(bgr0.data(), 256, out.image(), {}), 0);
+    EXPECT_EQ(converter.convert(bgr0.data(), 256, out.image(), {{10, 10, 0, 5}, {64, 0, 5, 5}}), 0);
+    EXPECT_EQ(out.planes[0], untouched) << info.name;
+  }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(VideoConvertTests, DISABLED_FrameTimeBenchmark) {
+  const std::pair<int, int> sizes[] {{1920, 1080}, {2560, 1440}, {3840, 2160}};
+
+  for (auto [width, height] : sizes) {
+    auto bgr0 = random_image(height, width * 4, 11);
+
+    for (const auto &info : formats) {
+      output_t out {info, width, height};
+      auto matrix = matrix_for(0.2126, 0.0722, false, info.bit_depth);
+
+      for (auto isa : {isa_e::scalar, best_isa()}) {
+        for (int threads : {1, 2, 4}) {
+          if (isa == isa_e::scalar && threads > 1) {
+            continue;
+          }
+
+          converter_t converter {info.format, width, height, matrix, threads, isa};
+          converter.convert(bgr0.data(), width * 4, out.image());
+
+          constexpr int frames = 30;
+          auto start = std::chrono::steady_clock::now();
+          for (int x = 0; x < frames; ++x) {
+            converter.convert(bgr0.data(), width * 4, out.image());
+          }
+          auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+          std::cout << width << 'x' << height << ' ' << info.name << ", " << isa_name(isa) << ", " << threads
+                    << (threads == 1 ? " thread: " : " threads: ") << ms << " ms/frame" << std::endl;
+          EXPECT_GT(ms, 0.0);
+        }
+      }
+
+      // A caret and a line of typing, as on a mostly static desktop
+      converter_t converter {info.format, width, height, matrix, 4, best_isa()};
+      const std::vector<rect_t> damage {{width / 3, height / 4, 2, 16}, {width / 3, height / 4 + 20, 400, 16}};
+
+      constexpr int frames = 300;
+      auto start = std::chrono::steady_clock::now();
+      for (int x = 0; x < frames; ++x) {
+        converter.convert(bgr0.data(), width * 4, out.image(), damage);
+      }
+      auto us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+      std::cout << width << 'x' << height << ' ' << info.name << ", " << isa_name(best_isa()) << ", damaged tiles only: " << us << " us/frame" << std::endl;
+      EXPECT_GT(us, 0.0);
+    }
+  }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file tests/unit/test_video_pacing.cpp
+ * @brief Test src/video_pacing.*
+ */
+
+#include "../tests_common.h"
+#include "src/video_pacing.h"
+
+#include <chrono>
+
+using namespace std::literals;
+
+namespace {
+  // Rate cap high enough to never bind
+  constexpr std::size_t unlimited = 100000;
+
+  // 60 fps with a 75% budget spreads frames over 12.5 ms
+  constexpr auto budget = 12500000ns;
+}  // namespace
+
+TEST(VideoPacingTests, SpreadIsEvenAndExact) {
+  const auto start = std::chrono::steady_clock::time_point {} + 1s;
+
+  // Per-millisecond rate pacing rounds to whole packets, the spread schedule does not
+  EXPECT_EQ(stream::pacing_due(start, 0, 7, 7ms), start);
+  EXPECT_EQ(stream::pacing_due(start, 3, 7, 7ms), start + 3ms);
+  EXPECT_EQ(stream::pacing_due(start, 7, 7, 7ms), start + 7ms);
+  EXPECT_EQ(stream::pacing_due(start, 1, 3, 1ms), start + 333333ns);
+  EXPECT_EQ(stream::pacing_due(start, 0, 0, 1ms), start);
+}
+
+TEST(VideoPacingTests, FramesSpreadOverBudgetWhateverTheirSize) {
+  stream::frame_pacer_t pacer {60, 75};
+  EXPECT_EQ(pacer.budget(), budget);
+
+  EXPECT_EQ(pacer.plan(10, false, 0ns, unlimited), budget);
+  EXPECT_EQ(pacer.plan(100, false, 0ns, unlimited), budget);
+  EXPECT_EQ(pacer.plan(1000, false, 0ns, unlimited), budget);
+}
+
+TEST(VideoPacingTests, RateCapStillApplies) {
+  stream::frame_pacer_t pacer {60, 75};
+
+  // 10 packets per ms needs 40 ms for 400 packets
+  EXPECT_EQ(pacer.plan(400, false, 0ns, 10), 40ms);
+  EXPECT_EQ(pacer.plan(100, false, 0ns, 10), budget);
+}
+
+TEST(VideoPacingTests, KeyFramesBorrowFromLaterFrames) {
+  stream::frame_pacer_t pacer {60, 75};
+  const auto interval = std::chrono::nanoseconds {1s} / 60;
+
+  for (int i = 0; i < 32; ++i) {
+    pacer.plan(100, false, 0ns, unlimited);
+  }
+
+  // Twice the usual size spreads twice as long at the same rate
+  EXPECT_EQ(pacer.plan(200, true, 0ns, unlimited), budget * 2);
+
+  // Much larger key frames stop at the borrowing limit
+  EXPECT_EQ(pacer.plan(2000, true, 0ns, unlimited), budget + interval * stream::frame_pacer_t::MAX_BORROW_FRAMES);
+
+  // Small key frames still get the full budget
+  EXPECT_EQ(pacer.plan(50, true, 0ns, unlimited), budget);
+}
+
+TEST(VideoPacingTests, FirstKeyFrameBorrowsTheLimit) {
+  stream::frame_pacer_t pacer {60, 75};
+  const auto interval = std::chrono::nanoseconds {1s} / 60;
+
+  EXPECT_EQ(pacer.plan(500, true, 0ns, unlimited), budget + interval * stream::frame_pacer_t::MAX_BORROW_FRAMES);
+}
+
+TEST(VideoPacingTests, QueuedFramesRepayTheBacklog) {
+  stream::frame_pacer_t pacer {60, 75};
+
+  EXPECT_EQ(pacer.plan(100, false, 5ms, unlimited), budget - 5ms);
+
+  // A long backlog leaves frames a quarter of their budget
+  EXPECT_EQ(pacer.plan(100, false, 30ms, unlimited), budget / 4);
+}
+
+TEST(VideoPacingTests, KeyFrameBacklogDrainsWithinBorrowedFrames) {
+  stream::frame_pacer_t pacer {60, 75};
+  const auto interval = std::chrono::nanoseconds {1s} / 60;
+
+  for (int i = 0; i < 32; ++i) {
+    pacer.plan(100, false, 0ns, unlimited);
+  }
+
+  // Replay the schedule: frames arrive every interval and wait for the previous one
+  auto arrival = 0ns;
+  auto next_start = 0ns;
+  auto backlog = 0ns;
+  int frames_delayed = 0;
+  for (int frame = 0; frame < 10; ++frame) {
+    auto start = std::max(arrival, next_start);
+    backlog = start - arrival;
+    if (backlog > 0ns) {
+      ++frames_delayed;
+    }
+    next_start = start + pacer.plan(frame == 0 ? 2000 : 100, frame == 0, backlog, unlimited);
+    arrival += interval;
+  }
+
+  EXPECT_EQ(backlog, 0ns);
+  EXPECT_LE(frames_delayed, stream::frame_pacer_t::MAX_BORROW_FRAMES + 2);
+}
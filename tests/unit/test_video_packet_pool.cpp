@@ -0,0 +1,338 @@
+/**
+ * @file tests/unit/test_video_packet_pool.cpp
+ * @brief Test src/video_packet_pool.h
+ */
+
+#include "../support/allocation_counter.h"
+#include "../tests_common.h"
+#include "src/thread_safe.h"
+#include "src/video_packet_pool.h"
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using video::packet_raw_generic;
+using video::packet_t;
+using packet_pool_t = video::packet_pool_t<packet_raw_generic>;
+
+namespace {
+  // Stands in for FFmpeg's AVBufferPool: buffers of one size, kept once they come back.
+  // Buffers still in flight keep a replaced pool alive
+  struct buffer_pool_t {
+    explicit buffer_pool_t(std::size_t size):
+        size {size} {
+      spare.reserve(64);
+    }
+
+    ~buffer_pool_t() {
+      for (auto buffer : spare) {
+        delete[] buffer;
+      }
+    }
+
+    std::uint8_t *get() {
+      {
+        std::lock_guard lg {mutex};
+        if (!spare.empty()) {
+          auto buffer = spare.back();
+          spare.pop_back();
+          return buffer;
+        }
+      }
+      return new std::uint8_t[size];
+    }
+
+    void put(std::uint8_t *buffer) {
+      std::lock_guard lg {mutex};
+      spare.push_back(buffer);
+    }
+
+    const std::size_t size;
+    std::mutex mutex;
+    std::vector<std::uint8_t *> spare;
+  };
+
+  // Stands in for video::packet_raw_avcodec, whose AVPacket gets its payload from the
+  // encode session's avcodec_payload_pool_t
+  struct buffer_packet_t: video::pooled_packet_t<buffer_packet_t> {
+    void clear_payload() {
+      if (buffers) {
+        buffers->put(payload);
+        buffers.reset();
+      } else {
+        delete[] payload;
+      }
+      payload = nullptr;
+      size = 0;
+    }
+
+    bool is_idr() override {
+      return false;
+    }
+
+    int64_t frame_index() override {
+      return index;
+    }
+
+    uint8_t *data() override {
+      return payload;
+    }
+
+    size_t data_size() override {
+      return size;
+    }
+
+    std::uint8_t *payload = nullptr;
+    std::size_t size = 0;
+    std::int64_t index = 0;
+    std::shared_ptr<buffer_pool_t> buffers;
+  };
+
+  // Hands out payloads like avcodec_payload_pool_t::get_encode_buffer
+  struct payload_source_t {
+    void get(buffer_packet_t &packet, std::size_t size) {
+      auto wanted = sizer.pool_buffer_size(size, buffer_size);
+      if (wanted != buffer_size) {
+        buffers = std::make_shared<buffer_pool_t>(wanted);
+        buffer_size = wanted;
+      }
+
+      if (size > buffer_size) {
+        packet.payload = new std::uint8_t[size];
+      } else {
+        packet.payload = buffers->get();
+        packet.buffers = buffers;
+      }
+      packet.size = size;
+    }
+
+    std::shared_ptr<buffer_pool_t> buffers;
+    std::size_t buffer_size = 0;
+    video::payload_sizer_t sizer;
+  };
+
+  /**
+   * Runs frames from an encode thread through a queue to the broadcast, as video::encode_*
+   * and stream::videoBroadcastThread do, and counts the allocations made once warmed up.
+   * @param encode Makes the packet of a frame, whose payload is size bytes starting with the frame number.
+   */
+  std::uint64_t steady_state_allocations(const std::function<packet_t(int frame, std::size_t size)> &encode) {
+    constexpr int warmup_frames = 500;
+    constexpr int measured_frames = 5000;
+    constexpr int total_frames = warmup_frames + measured_frames;
+
+    safe::ring_queue_t<packet_t> packets {32, safe::drop_e::oldest};
+    std::atomic<int> queued_packets {0};
+
+    std::thread encoder {[&]() {
+      std::mt19937 rng {1};
+      std::uniform_int_distribution<std::size_t> frame_size {1'000, 40'000};
+
+      for (int frame = 0; frame < total_frames; ++frame) {
+        // During warmup, encode as many packets as can be in flight at once: queued, being
+        // encoded and being sent, as a deep enough queue eventually would
+        if (frame == warmup_frames / 2) {
+          std::vector<packet_t> in_flight;
+          for (int x = 0; x < 18; ++x) {
+            in_flight.emplace_back(encode(frame, frame_size(rng)));
+          }
+        }
+
+        auto packet = encode(frame, frame_size(rng));
+
+        // Wait for the broadcast side so no packet is lost to a full queue
+        while (queued_packets.load() >= 16) {
+          std::this_thread::yield();
+        }
+        ++queued_packets;
+        packets.raise(std::move(packet));
+      }
+    }};
+
+    std::uint64_t before = 0;
+    std::int64_t last = -1;
+    for (int frame = 0; frame < total_frames; ++frame) {
+      if (frame == warmup_frames) {
+        before = test_utils::allocation_count();
+      }
+      auto packet = packets.pop();
+      --queued_packets;
+
+      int value;
+      std::memcpy(&value, packet->data(), sizeof(value));
+      EXPECT_EQ(value, last + 1);
+      EXPECT_EQ(packet->frame_index(), last + 1);
+      last = value;
+    }
+    const auto after = test_utils::allocation_count();
+
+    encoder.join();
+    return after - before;
+  }
+}  // namespace
+
+TEST(VideoPacketPoolTests, PacketsAreRecycled) {
+  auto pool = packet_pool_t::make(4);
+
+  auto first = pool->acquire();
+  EXPECT_EQ(first->pool, pool);
+  first->frame_data.assign(1000, 0xab);
+  auto data = first->frame_data.data();
+  packet_t {first};
+  EXPECT_FALSE(first->pool);
+
+  // The packet just released is the next one handed out, emptied but with its capacity
+  auto again = pool->acquire();
+  packet_t packet {again};
+  EXPECT_EQ(again, first);
+  EXPECT_TRUE(again->frame_data.empty());
+  EXPECT_EQ(again->frame_data.data(), data);
+}
+
+TEST(VideoPacketPoolTests, PoolKeepsUpToItsLimit) {
+  auto pool = packet_pool_t::make(2);
+
+  std::vector<packet_raw_generic *> first;
+  for (int x = 0; x < 3; ++x) {
+    first.push_back(pool->acquire());
+  }
+  for (auto packet : first) {
+    packet_t {packet};
+  }
+
+  // Two came back, and the third was freed
+  std::vector<packet_t> second;
+  int reused = 0;
+  for (int x = 0; x < 3; ++x) {
+    auto packet = pool->acquire();
+    reused += packet == first[0] || packet == first[1];
+    second.emplace_back(packet);
+  }
+  EXPECT_EQ(reused, 2);
+}
+
+TEST(VideoPacketPoolTests, PacketsKeepPoolAlive) {
+  auto pool = packet_pool_t::make(4);
+  packet_t packet {pool->acquire()};
+  std::weak_ptr<packet_pool_t> weak = pool;
+  pool.reset();
+
+  EXPECT_FALSE(weak.expired());
+  packet.reset();
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(VideoPacketPoolTests, SizerFollowsFrameSizes) {
+  video::payload_sizer_t sizer;
+  EXPECT_EQ(sizer.reserve_size(), video::payload_sizer_t::granularity);
+
+  for (int x = 0; x < 100; ++x) {
+    sizer.observe(10'000);
+  }
+  EXPECT_EQ(sizer.average_size(), 10'000u);
+  EXPECT_EQ(sizer.reserve_size(), 12'288u);
+  EXPECT_FALSE(sizer.oversized(video::payload_sizer_t::min_kept));
+  EXPECT_TRUE(sizer.oversized(video::payload_sizer_t::min_kept + 1));
+
+  // A single large frame barely moves the average, or the size of new buffers
+  sizer.observe(1'000'000);
+  EXPECT_LT(sizer.average_size(), 15'000u);
+  EXPECT_EQ(sizer.reserve_size(), 40'960u);
+
+  for (int x = 0; x < 100; ++x) {
+    sizer.observe(100'000);
+  }
+  EXPECT_NEAR((double) sizer.average_size(), 100'000.0, 1'000.0);
+  EXPECT_FALSE(sizer.oversized(500'000));
+  EXPECT_TRUE(sizer.oversized(1'000'000));
+}
+
+TEST(VideoPacketPoolTests, OversizedPayloadsAreFreed) {
+  video::payload_sizer_t sizer;
+  std::vector<std::uint8_t> payload;
+
+  for (int x = 0; x < 10; ++x) {
+    payload.assign(20'000, 1);
+    sizer.recycle(payload);
+  }
+  EXPECT_TRUE(payload.empty());
+  EXPECT_GE(payload.capacity(), 20'000u);
+
+  // An IDR frame far larger than the rest
+  payload.assign(2'000'000, 1);
+  sizer.recycle(payload);
+  EXPECT_EQ(payload.capacity(), 0u);
+
+  sizer.reserve(payload);
+  EXPECT_EQ(payload.capacity(), sizer.reserve_size());
+}
+
+TEST(VideoPacketPoolTests, PooledBuffersAreReturned) {
+  payload_source_t source;
+  auto pool = video::packet_pool_t<buffer_packet_t>::make(4);
+
+  auto first = pool->acquire();
+  source.get(*first, 1000);
+  auto payload = first->payload;
+  packet_t {first};
+  EXPECT_FALSE(first->buffers);
+
+  auto again = pool->acquire();
+  packet_t packet {again};
+  source.get(*again, 1000);
+  EXPECT_EQ(again->payload, payload);
+
+  // A payload far larger than the rest gets a buffer of its own
+  auto large = pool->acquire();
+  packet_t large_packet {large};
+  source.get(*large, 100'000);
+  EXPECT_FALSE(large->buffers);
+
+  // Until payloads that large are the norm, and the pool is replaced
+  for (int x = 0; x < 30; ++x) {
+    auto next = pool->acquire();
+    packet_t next_packet {next};
+    source.get(*next, 100'000);
+  }
+  EXPECT_GE(source.buffer_size, 100'000u);
+  EXPECT_NE(source.buffers, again->buffers);
+}
+
+TEST(VideoPacketPoolTests, SteadyStateGenericEncodeDoesNotAllocate) {
+  // Mirrors video::encode_nvenc, and AMF's output pump
+  auto pool = packet_pool_t::make(32);
+
+  auto allocations = steady_state_allocations([&](int frame, std::size_t size) {
+    auto generic = pool->acquire();
+    packet_t packet {generic};
+    pool->sizer.reserve(generic->frame_data);
+    generic->frame_data.resize(size);
+    std::memcpy(generic->frame_data.data(), &frame, sizeof(frame));
+    generic->index = frame;
+    return packet;
+  });
+
+  EXPECT_EQ(allocations, 0u);
+}
+
+TEST(VideoPacketPoolTests, SteadyStateSoftwareEncodeDoesNotAllocate) {
+  // Mirrors video::encode_avcodec, apart from the AVBufferRef FFmpeg allocates per packet
+  payload_source_t source;
+  auto pool = video::packet_pool_t<buffer_packet_t>::make(32);
+
+  auto allocations = steady_state_allocations([&](int frame, std::size_t size) {
+    auto buffer = pool->acquire();
+    packet_t packet {buffer};
+    source.get(*buffer, size);
+    std::memcpy(buffer->payload, &frame, sizeof(frame));
+    buffer->index = frame;
+    return packet;
+  });
+
+  EXPECT_EQ(allocations, 0u);
+}
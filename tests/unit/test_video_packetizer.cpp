@@ -0,0 +1,110 @@
+/**
+ * @file tests/unit/test_video_packetizer.cpp
+ * @brief Test src/video_packetizer.*
+ */
+
+#include "../tests_common.h"
+#include "src/video_packetizer.h"
+
+#include <string>
+
+namespace {
+  std::string shard_string(const stream::payload_layout_t &layout, std::size_t x, std::size_t payload_size) {
+    return std::string {layout.shards[x], payload_size};
+  }
+
+  std::string joined(const std::vector<std::string_view> &segments) {
+    std::string result;
+    for (auto &segment : segments) {
+      result.append(segment);
+    }
+    return result;
+  }
+}  // namespace
+
+TEST(VideoPacketizerTests, AlignedShardsAliasTheFrame) {
+  std::string frame = "abcdefghijkl";
+  auto layout = stream::layout_shard_payloads({frame}, 4);
+
+  ASSERT_EQ(layout.shards.size(), 3u);
+  for (std::size_t x = 0; x < 3; ++x) {
+    EXPECT_EQ(layout.shards[x], frame.data() + x * 4);
+  }
+  EXPECT_TRUE(layout.scratch.empty());
+  EXPECT_EQ(layout.copied_bytes, 0u);
+}
+
+TEST(VideoPacketizerTests, FrameHeaderShardIsTheOnlyCopyBeforePadding) {
+  std::string header = "HH";
+  std::string frame = "abcdefghij";
+  auto layout = stream::layout_shard_payloads({header, frame}, 4);
+
+  // HHab | cdef | ghij
+  ASSERT_EQ(layout.shards.size(), 3u);
+  EXPECT_EQ(shard_string(layout, 0, 4), "HHab");
+  EXPECT_EQ(layout.shards[1], frame.data() + 2);
+  EXPECT_EQ(layout.shards[2], frame.data() + 6);
+  EXPECT_EQ(layout.copied_bytes, 4u);
+}
+
+TEST(VideoPacketizerTests, FinalShardIsZeroPadded) {
+  std::string frame = "abcdefghi";
+  auto layout = stream::layout_shard_payloads({frame}, 4);
+
+  ASSERT_EQ(layout.shards.size(), 3u);
+  EXPECT_EQ(layout.shards[1], frame.data() + 4);
+  EXPECT_EQ(shard_string(layout, 2, 4), std::string("i\0\0\0", 4));
+  EXPECT_EQ(layout.copied_bytes, 1u);
+}
+
+TEST(VideoPacketizerTests, MatchesConcatenatedFrameAcrossManySegments) {
+  std::vector<std::string> storage {"H", "", "abc", "defghijklmn", "o", "", "pqrstuvwxyz0123"};
+  std::vector<std::string_view> segments {std::begin(storage), std::end(storage)};
+  auto expected = joined(segments);
+
+  for (std::size_t payload_size = 1; payload_size <= expected.size() + 1; ++payload_size) {
+    auto layout = stream::layout_shard_payloads(segments, payload_size);
+    ASSERT_EQ(layout.shards.size(), (expected.size() + payload_size - 1) / payload_size);
+
+    std::string rebuilt;
+    for (std::size_t x = 0; x < layout.shards.size(); ++x) {
+      rebuilt.append(layout.shards[x], payload_size);
+    }
+    EXPECT_EQ(rebuilt.substr(0, expected.size()), expected) << payload_size;
+    EXPECT_EQ(rebuilt.find_first_not_of('\0', expected.size()), std::string::npos) << payload_size;
+    EXPECT_LE(layout.copied_bytes, expected.size()) << payload_size;
+  }
+}
+
+TEST(VideoPacketizerTests, EmptyFrameHasNoShards) {
+  auto layout = stream::layout_shard_payloads({}, 4);
+  EXPECT_TRUE(layout.shards.empty());
+
+  layout = stream::layout_shard_payloads({"abc"}, 0);
+  EXPECT_TRUE(layout.shards.empty());
+}
+
+TEST(VideoPacketizerTests, ReplacementSplitsSegmentWithoutCopying) {
+  std::string frame = "xxSPSyy";
+  std::string replacement = "NEWSPS";
+  std::vector<std::string_view> segments {frame};
+
+  ASSERT_TRUE(stream::replace_in_segments(segments, "SPS", replacement));
+  ASSERT_EQ(segments.size(), 3u);
+  EXPECT_EQ(segments[0].data(), frame.data());
+  EXPECT_EQ(segments[1].data(), replacement.data());
+  EXPECT_EQ(segments[2].data(), frame.data() + 5);
+  EXPECT_EQ(joined(segments), "xxNEWSPSyy");
+}
+
+TEST(VideoPacketizerTests, SequentialReplacementsMatchFirstOccurrence) {
+  std::string frame = "aVPSbSPScSPS";
+  std::vector<std::string_view> segments {frame};
+
+  ASSERT_TRUE(stream::replace_in_segments(segments, "VPS", "v"));
+  ASSERT_TRUE(stream::replace_in_segments(segments, "SPS", "s"));
+  EXPECT_EQ(joined(segments), "avbscSPS");
+
+  EXPECT_FALSE(stream::replace_in_segments(segments, "PPS", "p"));
+  EXPECT_EQ(joined(segments), "avbscSPS");
+}